@@ -0,0 +1,79 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATIONPOLICY_H_
+#define ALLOCATIONPOLICY_H_
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * Where the engine's large, long lived buffers (tuple blocks, relocatable
+ * string pool buffers and exact-sized object pages) are placed.  The
+ * default policy leaves placement to the heap and to first touch.
+ * A NUMA node of -1 means "don't bind".  Huge pages are only used for
+ * buffers that fill most of a huge page.
+ */
+struct AllocationPolicy {
+    enum HugePages {
+        HUGE_PAGES_NONE,
+        // madvise the buffer as a candidate for transparent huge pages
+        HUGE_PAGES_TRANSPARENT,
+        // map the buffer from the hugetlbfs reserve, falling back to
+        // normal pages when the reserve is exhausted
+        HUGE_PAGES_EXPLICIT
+    };
+
+    AllocationPolicy() : m_numaNode(-1), m_hugePages(HUGE_PAGES_NONE) { }
+    AllocationPolicy(int32_t numaNode, HugePages hugePages)
+        : m_numaNode(numaNode), m_hugePages(hugePages) { }
+
+    bool isDefault() const {
+        return m_numaNode < 0 && m_hugePages == HUGE_PAGES_NONE;
+    }
+
+    int32_t m_numaNode;
+    HugePages m_hugePages;
+};
+
+/**
+ * How a buffer returned by ThreadLocalPool::allocateBlock was obtained,
+ * so that it can be returned (possibly from another thread) and counted
+ * against the right node.
+ */
+struct BlockAllocation {
+    BlockAllocation() : m_address(NULL), m_bytes(0), m_mappedBytes(0), m_numaNode(-1), m_hugePages(false) { }
+
+    char* m_address;
+    std::size_t m_bytes;
+    // zero when the buffer came from the heap rather than from mmap
+    std::size_t m_mappedBytes;
+    int32_t m_numaNode;
+    bool m_hugePages;
+};
+
+/** Bytes currently allocated through ThreadLocalPool::allocateBlock on one NUMA node. */
+struct NumaNodeStats {
+    int64_t m_allocatedBytes;
+    int64_t m_hugePageBytes;
+};
+
+}
+
+#endif /* ALLOCATIONPOLICY_H_ */
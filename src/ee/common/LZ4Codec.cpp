@@ -0,0 +1,234 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/LZ4Codec.h"
+
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+namespace voltdb {
+
+namespace {
+
+const std::size_t MIN_MATCH = 4;
+// The last five bytes of a block are always literals and the last match
+// has to start at least twelve bytes before the end.
+const std::size_t LAST_LITERALS = 5;
+const std::size_t MF_LIMIT = 12;
+const std::size_t MAX_DISTANCE = 65535;
+const int HASH_LOG = 16;
+const uint8_t RUN_MASK = 15;
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    ::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hashPosition(const uint8_t* p) {
+    return (read32(p) * 2654435761U) >> (32 - HASH_LOG);
+}
+
+/** Write the 255-continued tail of a length that overflowed its nibble. */
+inline uint8_t* writeLengthTail(uint8_t* op, std::size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+/**
+ * Emit one sequence: the literals from anchor up to literalEnd, then a
+ * match of matchLength bytes at the given distance back, or no match at
+ * all if matchLength is zero (the final sequence). Returns NULL if the
+ * sequence does not fit.
+ */
+uint8_t* writeSequence(uint8_t* op, const uint8_t* oend,
+                       const uint8_t* anchor, const uint8_t* literalEnd,
+                       std::size_t distance, std::size_t matchLength) {
+    const std::size_t literalLength = literalEnd - anchor;
+    const std::size_t worstCase = 1 + literalLength / 255 + 1 + literalLength
+                                + 2 + matchLength / 255 + 1;
+    if (static_cast<std::size_t>(oend - op) < worstCase) {
+        return NULL;
+    }
+
+    uint8_t* token = op++;
+    if (literalLength >= RUN_MASK) {
+        *token = RUN_MASK << 4;
+        op = writeLengthTail(op, literalLength - RUN_MASK);
+    }
+    else {
+        *token = static_cast<uint8_t>(literalLength << 4);
+    }
+    ::memcpy(op, anchor, literalLength);
+    op += literalLength;
+
+    if (matchLength == 0) {
+        return op;
+    }
+
+    *op++ = static_cast<uint8_t>(distance);
+    *op++ = static_cast<uint8_t>(distance >> 8);
+    std::size_t extra = matchLength - MIN_MATCH;
+    if (extra >= RUN_MASK) {
+        *token |= RUN_MASK;
+        op = writeLengthTail(op, extra - RUN_MASK);
+    }
+    else {
+        *token |= static_cast<uint8_t>(extra);
+    }
+    return op;
+}
+
+} // namespace
+
+std::size_t LZ4Codec::compress(const char* source, std::size_t sourceSize,
+                               char* dest, std::size_t destCapacity) {
+    const uint8_t* const base = reinterpret_cast<const uint8_t*>(source);
+    const uint8_t* const iend = base + sourceSize;
+    const uint8_t* anchor = base;
+    uint8_t* op = reinterpret_cast<uint8_t*>(dest);
+    const uint8_t* const oend = op + destCapacity;
+
+    if (sourceSize > MF_LIMIT) {
+        const uint8_t* const mflimit = iend - MF_LIMIT;
+        const uint8_t* const matchlimit = iend - LAST_LITERALS;
+        std::vector<uint32_t> table(1 << HASH_LOG, 0);
+        const uint8_t* ip = base;
+        // Step faster through data that does not seem to compress.
+        unsigned misses = 0;
+
+        while (ip < mflimit) {
+            const uint32_t h = hashPosition(ip);
+            const uint8_t* ref = base + table[h];
+            table[h] = static_cast<uint32_t>(ip - base);
+            if (ref >= ip || static_cast<std::size_t>(ip - ref) > MAX_DISTANCE || read32(ref) != read32(ip)) {
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                --ip;
+                --ref;
+            }
+            std::size_t matchLength = MIN_MATCH;
+            while (ip + matchLength < matchlimit && ip[matchLength] == ref[matchLength]) {
+                ++matchLength;
+            }
+
+            op = writeSequence(op, oend, anchor, ip, ip - ref, matchLength);
+            if (op == NULL) {
+                return 0;
+            }
+            ip += matchLength;
+            anchor = ip;
+            if (ip < mflimit) {
+                table[hashPosition(ip - 2)] = static_cast<uint32_t>(ip - 2 - base);
+            }
+        }
+    }
+
+    op = writeSequence(op, oend, anchor, iend, 0, 0);
+    if (op == NULL) {
+        return 0;
+    }
+    return op - reinterpret_cast<uint8_t*>(dest);
+}
+
+long LZ4Codec::decompress(const char* source, std::size_t sourceSize,
+                          char* dest, std::size_t destCapacity) {
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(source);
+    const uint8_t* const iend = ip + sourceSize;
+    uint8_t* const obase = reinterpret_cast<uint8_t*>(dest);
+    uint8_t* op = obase;
+    uint8_t* const oend = op + destCapacity;
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+
+        std::size_t literalLength = token >> 4;
+        if (literalLength == RUN_MASK) {
+            uint8_t b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                literalLength += b;
+            } while (b == 255);
+        }
+        if (literalLength > static_cast<std::size_t>(iend - ip)
+            || literalLength > static_cast<std::size_t>(oend - op)) {
+            return -1;
+        }
+        ::memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == iend) {
+            // The final sequence has literals only.
+            return op - obase;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        const std::size_t distance = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (distance == 0 || distance > static_cast<std::size_t>(op - obase)) {
+            return -1;
+        }
+
+        std::size_t matchLength = token & RUN_MASK;
+        if (matchLength == RUN_MASK) {
+            uint8_t b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                matchLength += b;
+            } while (b == 255);
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > static_cast<std::size_t>(oend - op)) {
+            return -1;
+        }
+
+        const uint8_t* match = op - distance;
+        if (distance >= matchLength) {
+            ::memcpy(op, match, matchLength);
+            op += matchLength;
+        }
+        else {
+            // Overlapping copy: the match repeats the bytes just written.
+            for (std::size_t i = 0; i < matchLength; ++i) {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    // An empty input is only valid as the encoding of an empty block.
+    return sourceSize == 0 ? 0 : -1;
+}
+
+} // namespace voltdb
@@ -0,0 +1,60 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLTDB_LZ4CODEC_H
+#define VOLTDB_LZ4CODEC_H
+
+#include <cstddef>
+
+namespace voltdb {
+
+/**
+ * A compressor and decompressor for the LZ4 block format.
+ *
+ * Output is a plain LZ4 block (no frame header or checksum), so anything
+ * that reads LZ4 blocks, such as the lz4-java library the Java side
+ * already ships with, can read it too. The compressor does a single greedy
+ * pass with a hash table of recent positions; it favours speed over ratio,
+ * which is the right trade for data that is about to be written to disk
+ * and read back shortly afterwards.
+ */
+class LZ4Codec {
+public:
+    /** The largest compressed size of sourceSize bytes of input. */
+    static std::size_t compressBound(std::size_t sourceSize) {
+        return sourceSize + sourceSize / 255 + 16;
+    }
+
+    /**
+     * Compress sourceSize bytes from source into dest. Returns the
+     * compressed size, or zero if it would not fit in destCapacity bytes.
+     */
+    static std::size_t compress(const char* source, std::size_t sourceSize,
+                                char* dest, std::size_t destCapacity);
+
+    /**
+     * Decompress an LZ4 block of sourceSize bytes into dest. Returns the
+     * decompressed size, or -1 if the input is malformed or would
+     * overflow destCapacity bytes.
+     */
+    static long decompress(const char* source, std::size_t sourceSize,
+                           char* dest, std::size_t destCapacity);
+};
+
+} // namespace voltdb
+
+#endif // VOLTDB_LZ4CODEC_H
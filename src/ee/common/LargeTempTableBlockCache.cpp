@@ -15,6 +15,7 @@
  * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <new>
 #include <sstream>
 
 #include "LargeTempTableBlockCache.h"
@@ -33,10 +34,43 @@ LargeTempTableBlockCache::LargeTempTableBlockCache(Topend *topend,
     , m_blockList()
     , m_idToBlockMap()
     , m_nextId(siteId, 0)
-    , m_totalAllocatedBytes(0) { }
+    , m_totalAllocatedBytes(0)
+    , m_numCacheMisses(0)
+    , m_numCacheHits(0)
+    , m_numBlocksStored(0)
+    , m_numBytesStored(0)
+    , m_numPrefetchHits(0)
+    , m_numPrefetchStalls(0)
+    , m_numPrefetchesIssued(0)
+    , m_compressBlocks(true)
+    , m_compressionScratch()
+    , m_canPrefetch(topend != NULL && topend->canPrefetchLargeTempTableBlocks())
+    , m_readAheadBlocks(2)
+    , m_prefetchThread()
+    , m_prefetchThreadStarted(false)
+    , m_prefetchShutdown(false)
+    , m_prefetchQueue()
+    , m_prefetches()
+{
+    pthread_mutex_init(&m_prefetchMutex, NULL);
+    pthread_cond_init(&m_prefetchWorkCondition, NULL);
+    pthread_cond_init(&m_prefetchDoneCondition, NULL);
+}
 
 LargeTempTableBlockCache::~LargeTempTableBlockCache() {
     assert (m_blockList.size() == 0);
+    if (m_prefetchThreadStarted) {
+        pthread_mutex_lock(&m_prefetchMutex);
+        m_prefetchShutdown = true;
+        pthread_cond_broadcast(&m_prefetchWorkCondition);
+        pthread_mutex_unlock(&m_prefetchMutex);
+        pthread_join(m_prefetchThread, NULL);
+    }
+
+    assert (m_prefetches.empty());
+    pthread_cond_destroy(&m_prefetchDoneCondition);
+    pthread_cond_destroy(&m_prefetchWorkCondition);
+    pthread_mutex_destroy(&m_prefetchMutex);
 }
 
 LargeTempTableBlock* LargeTempTableBlockCache::getEmptyBlock(const TupleSchema* schema) {
@@ -65,12 +99,16 @@ LargeTempTableBlock* LargeTempTableBlockCache::fetchBlock(LargeTempTableBlockId
     assert ((*listIt)->id() == blockId);
     if (! (*listIt)->isResident()) {
         ++m_numCacheMisses;
-        ensureSpaceForNewBlock();
-
-        bool rc = m_topend->loadLargeTempTableBlock(listIt->get());
-        assert(rc);
+        // A prefetched block's memory was accounted for when the
+        // prefetch was issued.
+        if (! takePrefetchedData(listIt->get())) {
+            ensureSpaceForNewBlock();
+
+            bool rc = m_topend->loadLargeTempTableBlock(listIt->get());
+            assert(rc);
+            m_totalAllocatedBytes += LargeTempTableBlock::BLOCK_SIZE_IN_BYTES;
+        }
         assert (! (*listIt)->isPinned());
-        m_totalAllocatedBytes += LargeTempTableBlock::BLOCK_SIZE_IN_BYTES;
     }
     else {
         ++m_numCacheHits;
@@ -93,6 +131,67 @@ LargeTempTableBlock* LargeTempTableBlockCache::fetchBlock(LargeTempTableBlockId
     return block;
 }
 
+void LargeTempTableBlockCache::prefetchBlocks(std::vector<LargeTempTableBlockId>::const_iterator begin,
+                                              std::vector<LargeTempTableBlockId>::const_iterator end) {
+    const int readAhead = readAheadBlocks();
+    int considered = 0;
+    for (auto it = begin; it != end && considered < readAhead; ++it, ++considered) {
+        auto mapIt = m_idToBlockMap.find(*it);
+        if (mapIt == m_idToBlockMap.end()) {
+            continue;
+        }
+
+        LargeTempTableBlock* block = mapIt->second->get();
+        if (block->isResident() || ! block->isStored()) {
+            continue;
+        }
+
+        if (m_totalAllocatedBytes + LargeTempTableBlock::BLOCK_SIZE_IN_BYTES > m_maxCacheSizeInBytes) {
+            // Make room only if that does not require a store, by
+            // dropping an unpinned block that already has a copy on
+            // disk.  Same victim order as ensureSpaceForNewBlock.
+            LargeTempTableBlock* victim = NULL;
+            for (auto victimIt = m_blockList.rbegin(); victimIt != m_blockList.rend(); ++victimIt) {
+                LargeTempTableBlock* candidate = victimIt->get();
+                if (! candidate->isPinned() && candidate->isResident() && candidate->isStored()) {
+                    victim = candidate;
+                    break;
+                }
+            }
+
+            if (victim == NULL) {
+                return;
+            }
+
+            victim->releaseData();
+            m_totalAllocatedBytes -= LargeTempTableBlock::BLOCK_SIZE_IN_BYTES;
+        }
+
+        if (! m_prefetchThreadStarted) {
+            if (pthread_create(&m_prefetchThread, NULL, prefetchMain, this) != 0) {
+                // Carry on with synchronous loads.
+                m_readAheadBlocks = 0;
+                return;
+            }
+            m_prefetchThreadStarted = true;
+        }
+
+        pthread_mutex_lock(&m_prefetchMutex);
+        bool isNew = m_prefetches.find(*it) == m_prefetches.end();
+        if (isNew) {
+            m_prefetches[*it];
+            m_prefetchQueue.push_back(*it);
+            pthread_cond_signal(&m_prefetchWorkCondition);
+        }
+        pthread_mutex_unlock(&m_prefetchMutex);
+
+        if (isNew) {
+            m_totalAllocatedBytes += LargeTempTableBlock::BLOCK_SIZE_IN_BYTES;
+            ++m_numPrefetchesIssued;
+        }
+    }
+}
+
 void LargeTempTableBlockCache::unpinBlock(LargeTempTableBlockId blockId) {
     auto mapIt = m_idToBlockMap.find(blockId);
     if (mapIt == m_idToBlockMap.end()) {
@@ -136,6 +235,12 @@ void LargeTempTableBlockCache::releaseBlock(LargeTempTableBlockId blockId) {
         throwSerializableEEException("Request to release pinned block");
     }
 
+    if (! (*it)->isResident()) {
+        // Make sure the prefetch thread is done with the stored copy
+        // before it goes away.
+        cancelPrefetch(blockId);
+    }
+
     if ((*it)->isStored()) {
         bool success = m_topend->releaseLargeTempTableBlock(blockId);
         if (! success) {
@@ -161,6 +266,10 @@ void LargeTempTableBlockCache::releaseAllBlocks() {
                 throwSerializableEEException("Request to release pinned block (releaseAllBlocks)");
             }
 
+            if (! block->isResident()) {
+                cancelPrefetch(block->id());
+            }
+
             if (block->isStored()) {
                 bool rc = m_topend->releaseLargeTempTableBlock(block->id());
                 assert(rc);
@@ -200,10 +309,7 @@ void LargeTempTableBlockCache::ensureSpaceForNewBlock() {
             // this block may have already been stored, in which case
             // we do not need to store it again.
             if (! block->isStored()) {
-                bool success = m_topend->storeLargeTempTableBlock(block);
-                if (! success) {
-                    throwSerializableEEException("Topend failed to store LTT block");
-                }
+                storeBlock(block);
             }
             else {
                 // Block is already stored, so just release its storage.
@@ -218,9 +324,191 @@ void LargeTempTableBlockCache::ensureSpaceForNewBlock() {
     }
     while (it != m_blockList.begin());
 
+    // Blocks being read ahead are expendable.
+    if (dropOnePrefetch()) {
+        return;
+    }
+
     throwSerializableEEException("Failed to find unpinned LTT block to make space");
 }
 
+void LargeTempTableBlockCache::storeBlock(LargeTempTableBlock* block) {
+    if (m_compressBlocks) {
+        if (! m_compressionScratch) {
+            m_compressionScratch.reset(new char[LargeTempTableBlock::compressionScratchSize()]);
+        }
+        block->compressData(m_compressionScratch.get());
+    }
+
+    int64_t storedSize = block->storedDataSize();
+    bool success = m_topend->storeLargeTempTableBlock(block);
+    if (! success) {
+        throwSerializableEEException("Topend failed to store LTT block");
+    }
+
+    ++m_numBlocksStored;
+    m_numBytesStored += storedSize;
+}
+
+bool LargeTempTableBlockCache::takePrefetchedData(LargeTempTableBlock* block) {
+    if (! m_prefetchThreadStarted) {
+        return false;
+    }
+
+    pthread_mutex_lock(&m_prefetchMutex);
+    auto it = m_prefetches.find(block->id());
+    if (it == m_prefetches.end()) {
+        pthread_mutex_unlock(&m_prefetchMutex);
+        return false;
+    }
+
+    Prefetch& prefetch = it->second;
+    bool stalled = false;
+    if (prefetch.m_state == Prefetch::QUEUED) {
+        // Not started yet, so it's no faster than loading it here,
+        // but the read-ahead still came too late.
+        stalled = true;
+        eraseQueuedPrefetch(block->id());
+    }
+    else {
+        while (prefetch.m_state == Prefetch::LOADING) {
+            stalled = true;
+            pthread_cond_wait(&m_prefetchDoneCondition, &m_prefetchMutex);
+        }
+    }
+
+    bool loaded = prefetch.m_state == Prefetch::LOADED;
+    std::unique_ptr<char[]> storage;
+    storage.swap(prefetch.m_storage);
+    char* origAddress = prefetch.m_origAddress;
+    m_prefetches.erase(it);
+    pthread_mutex_unlock(&m_prefetchMutex);
+
+    if (stalled) {
+        ++m_numPrefetchStalls;
+    }
+    else if (loaded) {
+        ++m_numPrefetchHits;
+    }
+
+    if (! loaded) {
+        m_totalAllocatedBytes -= LargeTempTableBlock::BLOCK_SIZE_IN_BYTES;
+        assert (m_totalAllocatedBytes >= 0);
+        return false;
+    }
+
+    block->setData(origAddress, std::move(storage));
+    return true;
+}
+
+void LargeTempTableBlockCache::cancelPrefetch(LargeTempTableBlockId blockId) {
+    if (! m_prefetchThreadStarted) {
+        return;
+    }
+
+    pthread_mutex_lock(&m_prefetchMutex);
+    auto it = m_prefetches.find(blockId);
+    if (it == m_prefetches.end()) {
+        pthread_mutex_unlock(&m_prefetchMutex);
+        return;
+    }
+
+    if (it->second.m_state == Prefetch::QUEUED) {
+        eraseQueuedPrefetch(blockId);
+    }
+
+    while (it->second.m_state == Prefetch::LOADING) {
+        pthread_cond_wait(&m_prefetchDoneCondition, &m_prefetchMutex);
+    }
+
+    m_prefetches.erase(it);
+    pthread_mutex_unlock(&m_prefetchMutex);
+
+    m_totalAllocatedBytes -= LargeTempTableBlock::BLOCK_SIZE_IN_BYTES;
+    assert (m_totalAllocatedBytes >= 0);
+}
+
+bool LargeTempTableBlockCache::dropOnePrefetch() {
+    if (! m_prefetchThreadStarted) {
+        return false;
+    }
+
+    pthread_mutex_lock(&m_prefetchMutex);
+    if (m_prefetches.empty()) {
+        pthread_mutex_unlock(&m_prefetchMutex);
+        return false;
+    }
+
+    if (! m_prefetchQueue.empty()) {
+        // The last one queued is the one needed furthest in the future.
+        m_prefetches.erase(m_prefetchQueue.back());
+        m_prefetchQueue.pop_back();
+    }
+    else {
+        auto it = m_prefetches.begin();
+        while (it->second.m_state == Prefetch::LOADING) {
+            pthread_cond_wait(&m_prefetchDoneCondition, &m_prefetchMutex);
+        }
+        m_prefetches.erase(it);
+    }
+    pthread_mutex_unlock(&m_prefetchMutex);
+
+    m_totalAllocatedBytes -= LargeTempTableBlock::BLOCK_SIZE_IN_BYTES;
+    assert (m_totalAllocatedBytes >= 0);
+    return true;
+}
+
+void LargeTempTableBlockCache::eraseQueuedPrefetch(LargeTempTableBlockId blockId) {
+    auto queueIt = std::find(m_prefetchQueue.begin(), m_prefetchQueue.end(), blockId);
+    assert (queueIt != m_prefetchQueue.end());
+    m_prefetchQueue.erase(queueIt);
+}
+
+void* LargeTempTableBlockCache::prefetchMain(void* arg) {
+    static_cast<LargeTempTableBlockCache*>(arg)->prefetchLoop();
+    return NULL;
+}
+
+void LargeTempTableBlockCache::prefetchLoop() {
+    pthread_mutex_lock(&m_prefetchMutex);
+    while (true) {
+        while (! m_prefetchShutdown && m_prefetchQueue.empty()) {
+            pthread_cond_wait(&m_prefetchWorkCondition, &m_prefetchMutex);
+        }
+
+        if (m_prefetchShutdown) {
+            break;
+        }
+
+        LargeTempTableBlockId blockId = m_prefetchQueue.front();
+        m_prefetchQueue.pop_front();
+        // Entries are only erased by the site thread, which waits
+        // for LOADING entries to finish, so this stays valid.
+        auto it = m_prefetches.find(blockId);
+        assert (it != m_prefetches.end() && it->second.m_state == Prefetch::QUEUED);
+        it->second.m_state = Prefetch::LOADING;
+        pthread_mutex_unlock(&m_prefetchMutex);
+
+        std::unique_ptr<char[]> storage(new (std::nothrow) char[LargeTempTableBlock::BLOCK_SIZE_IN_BYTES]);
+        char* origAddress = NULL;
+        if (storage) {
+            origAddress = m_topend->readLargeTempTableBlock(blockId, storage.get());
+        }
+
+        pthread_mutex_lock(&m_prefetchMutex);
+        if (origAddress != NULL) {
+            it->second.m_state = Prefetch::LOADED;
+            it->second.m_storage.swap(storage);
+            it->second.m_origAddress = origAddress;
+        }
+        else {
+            it->second.m_state = Prefetch::FAILED;
+        }
+        pthread_cond_broadcast(&m_prefetchDoneCondition);
+    }
+    pthread_mutex_unlock(&m_prefetchMutex);
+}
+
 std::string LargeTempTableBlockCache::debug() const {
     std::ostringstream oss;
     oss << "LargeTempTableBlockCache:\n";
@@ -250,7 +538,14 @@ std::string LargeTempTableBlockCache::statsForDebug() const {
     std::ostringstream oss;
     oss << "LargeTempTableBlockCache stats:\n"
         << "    Number of cache hits:    " << m_numCacheHits << "\n"
-        << "    Number of cache misses:  " << m_numCacheMisses << "\n";
+        << "    Number of cache misses:  " << m_numCacheMisses << "\n"
+        << "    Blocks stored:           " << m_numBlocksStored << "\n"
+        << "    Bytes stored:            " << m_numBytesStored << "\n"
+        << "    Bytes saved:             " << spilledBytesSaved() << "\n"
+        << "    Compression ratio:       " << compressionRatio() << "\n"
+        << "    Prefetches issued:       " << m_numPrefetchesIssued << "\n"
+        << "    Prefetch hits:           " << m_numPrefetchHits << "\n"
+        << "    Prefetch stalls:         " << m_numPrefetchStalls << "\n";
     return oss.str();
 }
 
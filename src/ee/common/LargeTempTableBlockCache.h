@@ -18,12 +18,15 @@
 #ifndef VOLTDB_LARGETEMPTABLEBLOCKCACHE_H
 #define VOLTDB_LARGETEMPTABLEBLOCKCACHE_H
 
+#include <algorithm>
 #include <deque>
 #include <list>
 #include <map>
 #include <utility>
 #include <vector>
 
+#include <pthread.h>
+
 #include <boost/foreach.hpp>
 #include <boost/scoped_array.hpp>
 
@@ -61,7 +64,7 @@ class LargeTempTableBlockCache {
                              LargeTempTableBlockId::siteId_t siteId);
 
     /**
-     * A do-nothing destructor
+     * Stops the prefetch thread, if it was started.
      */
     ~LargeTempTableBlockCache();
 
@@ -79,6 +82,46 @@ class LargeTempTableBlockCache {
         necessary.  */
     LargeTempTableBlock* fetchBlock(LargeTempTableBlockId blockId);
 
+    /** Announce that the blocks in [begin, end) will be fetched
+        next, in that order.  Up to readAheadBlocks() of them that are
+        stored and not resident are read in the background, as long as
+        that fits in the cache without storing anything else. */
+    void prefetchBlocks(std::vector<LargeTempTableBlockId>::const_iterator begin,
+                        std::vector<LargeTempTableBlockId>::const_iterator end);
+
+    /** The number of blocks that may be read ahead of a scan, or zero
+        if the topend does not support prefetching.  Never more than a
+        quarter of the cache. */
+    int readAheadBlocks() const {
+        if (m_readAheadBlocks <= 0 || ! m_canPrefetch) {
+            return 0;
+        }
+
+        return std::min(m_readAheadBlocks, maxCacheSizeInBlocks() / 4);
+    }
+
+    void setReadAheadBlocks(int numBlocks) {
+        m_readAheadBlocks = numBlocks;
+    }
+
+    /** Fetches of non-resident blocks that a finished prefetch
+        had already read */
+    int64_t prefetchHits() const {
+        return m_numPrefetchHits;
+    }
+
+    /** Fetches of non-resident blocks whose prefetch was still
+        queued or in flight.  Misses with no prefetch issued are
+        only counted as cache misses. */
+    int64_t prefetchStalls() const {
+        return m_numPrefetchStalls;
+    }
+
+    /** Prefetches started, including those dropped before use */
+    int64_t prefetchesIssued() const {
+        return m_numPrefetchesIssued;
+    }
+
     /** The large temp table for this block is being destroyed, so
         release all resources associated with this block. */
     void releaseBlock(LargeTempTableBlockId blockId);
@@ -166,6 +209,42 @@ class LargeTempTableBlockCache {
     /** Produce a string describing the number of cache hits and misses. */
     std::string statsForDebug() const;
 
+    /** When enabled (the default), blocks are LZ4 compressed before
+        they are handed to the topend to be stored. */
+    void setBlockCompression(bool enabled) {
+        m_compressBlocks = enabled;
+    }
+
+    bool blockCompression() const {
+        return m_compressBlocks;
+    }
+
+    /** The number of blocks handed to the topend to be stored */
+    int64_t storedBlockCount() const {
+        return m_numBlocksStored;
+    }
+
+    /** The number of bytes the stored blocks would have taken up
+        uncompressed */
+    int64_t spilledRawBytes() const {
+        return m_numBlocksStored * LargeTempTableBlock::BLOCK_SIZE_IN_BYTES;
+    }
+
+    /** The number of bytes actually handed to the topend to be stored */
+    int64_t spilledBytes() const {
+        return m_numBytesStored;
+    }
+
+    /** The spill bytes saved by compression */
+    int64_t spilledBytesSaved() const {
+        return spilledRawBytes() - spilledBytes();
+    }
+
+    /** Raw bytes per stored byte, or 1.0 if nothing has been stored */
+    double compressionRatio() const {
+        return m_numBytesStored == 0 ? 1.0 : double(spilledRawBytes()) / double(m_numBytesStored);
+    }
+
  private:
 
     // This at some point may need to be unique across the entire cluster
@@ -179,6 +258,43 @@ class LargeTempTableBlockCache {
     // to make room for another block.
     void ensureSpaceForNewBlock();
 
+    // Hands the block to the topend to be stored, compressing it
+    // first if compression is enabled.
+    void storeBlock(LargeTempTableBlock* block);
+
+    // The state of a block being read by the prefetch thread.
+    // Guarded by m_prefetchMutex.
+    struct Prefetch {
+        enum State { QUEUED, LOADING, LOADED, FAILED };
+
+        Prefetch() : m_state(QUEUED), m_storage(), m_origAddress(NULL) { }
+
+        State m_state;
+        std::unique_ptr<char[]> m_storage;
+        char* m_origAddress;
+    };
+
+    typedef std::map<LargeTempTableBlockId, Prefetch> PrefetchMap;
+
+    // If the block has been prefetched, hands it the data and returns
+    // true.  Otherwise cancels any pending prefetch and returns false.
+    // Either way the block's prefetch reservation is consumed.
+    bool takePrefetchedData(LargeTempTableBlock* block);
+
+    // Forgets any prefetch of the block, waiting for a read in
+    // flight to finish, and gives back its reservation.
+    void cancelPrefetch(LargeTempTableBlockId blockId);
+
+    // Drops the prefetch furthest from being needed to free its
+    // reservation.  Returns false if there were none.
+    bool dropOnePrefetch();
+
+    // Must be called with m_prefetchMutex held.
+    void eraseQueuedPrefetch(LargeTempTableBlockId blockId);
+
+    static void* prefetchMain(void* arg);
+    void prefetchLoop();
+
     Topend * const m_topend;
 
     const int64_t m_maxCacheSizeInBytes;
@@ -197,6 +313,32 @@ class LargeTempTableBlockCache {
     /** stats: */
     int64_t m_numCacheMisses; // calls to "fetch" that required a store/load
     int64_t m_numCacheHits; // calls to "fetch" blocks already resident
+    int64_t m_numBlocksStored; // blocks handed to the topend to store
+    int64_t m_numBytesStored; // bytes handed to the topend to store
+
+    int64_t m_numPrefetchHits;
+    int64_t m_numPrefetchStalls;
+    int64_t m_numPrefetchesIssued;
+
+    bool m_compressBlocks;
+    // Compression output goes here before it is copied to a buffer
+    // of the right size.  Allocated the first time a block is stored.
+    boost::scoped_array<char> m_compressionScratch;
+
+    const bool m_canPrefetch;
+    int m_readAheadBlocks;
+
+    // Blocks are read by a single thread started on the first
+    // prefetch.  Each queued, loading or loaded block has
+    // BLOCK_SIZE_IN_BYTES reserved in m_totalAllocatedBytes.
+    pthread_t m_prefetchThread;
+    bool m_prefetchThreadStarted;
+    bool m_prefetchShutdown;
+    pthread_mutex_t m_prefetchMutex;
+    pthread_cond_t m_prefetchWorkCondition;
+    pthread_cond_t m_prefetchDoneCondition;
+    std::deque<LargeTempTableBlockId> m_prefetchQueue;
+    PrefetchMap m_prefetches;
 };
 
 }
@@ -70,6 +70,14 @@ typedef ttmath::Int<2> TTInt;
 //Long integer with space for multiplication and division without carry/overflow
 typedef ttmath::Int<4> TTLInt;
 
+// DECIMAL arithmetic runs on native 128-bit integers where GCC provides them,
+// and falls back to ttmath when an intermediate result overflows.
+// (Clang may leave __builtin_mul_overflow on __int128 to a runtime library
+// that libgcc does not have.)
+#if defined(__SIZEOF_INT128__) && defined(TTMATH_PLATFORM64) && ! defined(__clang__)
+#define VOLT_NATIVE_DECIMAL_ARITHMETIC
+#endif
+
 template<typename T>
 void throwCastSQLValueOutOfRangeException(
         const T value,
@@ -649,6 +657,42 @@ class NValue {
     static const uint16_t kMaxDecPrec = 38;
     static const uint16_t kMaxDecScale = 12;
     static const int64_t kMaxScaleFactor = 1000000000000;         // == 10**12
+
+    /**
+     * A running SUM of DECIMAL values for aggregates.  Every step is
+     * checked against the DECIMAL range just as op_add checks it, but
+     * without the type dispatch and the intermediate NValue per row.
+     */
+    class DecimalSum {
+    public:
+        DecimalSum() : m_sum(0) { }
+
+        void reset() { m_sum = 0; }
+
+        /** Add a non-null DECIMAL value to the total. */
+        void add(const NValue& value) {
+            assert(value.getValueType() == VALUE_TYPE_DECIMAL);
+            assert( ! value.isNull());
+#ifdef VOLT_NATIVE_DECIMAL_ARITHMETIC
+            NativeDecimal sum;
+            if ( ! __builtin_add_overflow(decimalToNative(m_sum),
+                                          decimalToNative(value.getDecimal()), &sum) &&
+                    nativeDecimalInRange(sum)) {
+                m_sum = nativeToDecimal(sum);
+                return;
+            }
+#endif
+            m_sum = opAddDecimals(getDecimalValue(m_sum), value).getDecimal();
+        }
+
+        NValue value() const { return getDecimalValue(m_sum); }
+
+    private:
+        // Kept as a TTInt rather than an __int128, which would need
+        // 16 byte alignment from the pools that aggregates live in.
+        TTInt m_sum;
+    };
+
   private:
     // Our maximum scale is 12.  Our maximum precision is 38.  So,
     // the maximum number of decimal digits is 38 - 12 = 26.  We can't
@@ -819,6 +863,30 @@ private:
     static TTInt s_maxInt64AsDecimal;
     static TTInt s_minInt64AsDecimal;
 
+#ifdef VOLT_NATIVE_DECIMAL_ARITHMETIC
+    typedef __int128 NativeDecimal;
+
+    // A TTInt holds its two's complement words least significant first.
+    static NativeDecimal decimalToNative(const TTInt& value) {
+        return static_cast<NativeDecimal>(
+                (static_cast<unsigned __int128>(value.table[1]) << 64) | value.table[0]);
+    }
+
+    static TTInt nativeToDecimal(NativeDecimal value) {
+        TTInt result;
+        result.table[0] = static_cast<ttmath::uint>(value);
+        result.table[1] = static_cast<ttmath::uint>(static_cast<unsigned __int128>(value) >> 64);
+        return result;
+    }
+
+    // The same bounds as s_maxDecimalValue and s_minDecimalValue: +/-(10**38 - 1).
+    static bool nativeDecimalInRange(NativeDecimal value) {
+        const NativeDecimal maxDecimal =
+                static_cast<NativeDecimal>(10000000000000000000ULL) * 10000000000000000000ULL - 1;
+        return value <= maxDecimal && value >= -maxDecimal;
+    }
+#endif
+
     enum AttrBits : uint8_t {
         SOURCE_INLINED = 0x1,
         VOLATILE = 0x2
@@ -2327,6 +2395,15 @@ private:
         assert(lhs.getValueType() == VALUE_TYPE_DECIMAL);
         assert(rhs.getValueType() == VALUE_TYPE_DECIMAL);
 
+#ifdef VOLT_NATIVE_DECIMAL_ARITHMETIC
+        NativeDecimal sum;
+        if ( ! __builtin_add_overflow(decimalToNative(lhs.getDecimal()),
+                                      decimalToNative(rhs.getDecimal()), &sum) &&
+                nativeDecimalInRange(sum)) {
+            return getDecimalValue(nativeToDecimal(sum));
+        }
+        // Out of range: ttmath reports it below.
+#endif
         TTInt retval(lhs.getDecimal());
         if (retval.Add(rhs.getDecimal()) || retval > s_maxDecimalValue || retval < s_minDecimalValue) {
             char message[4096];
@@ -2345,6 +2422,15 @@ private:
         assert(lhs.getValueType() == VALUE_TYPE_DECIMAL);
         assert(rhs.getValueType() == VALUE_TYPE_DECIMAL);
 
+#ifdef VOLT_NATIVE_DECIMAL_ARITHMETIC
+        NativeDecimal difference;
+        if ( ! __builtin_sub_overflow(decimalToNative(lhs.getDecimal()),
+                                      decimalToNative(rhs.getDecimal()), &difference) &&
+                nativeDecimalInRange(difference)) {
+            return getDecimalValue(nativeToDecimal(difference));
+        }
+        // Out of range: ttmath reports it below.
+#endif
         TTInt retval(lhs.getDecimal());
         if (retval.Sub(rhs.getDecimal()) || retval > s_maxDecimalValue || retval < s_minDecimalValue) {
             char message[4096];
@@ -2369,6 +2455,17 @@ private:
         assert(lhs.getValueType() == VALUE_TYPE_DECIMAL);
         assert(rhs.getValueType() == VALUE_TYPE_DECIMAL);
 
+#ifdef VOLT_NATIVE_DECIMAL_ARITHMETIC
+        NativeDecimal product;
+        if ( ! __builtin_mul_overflow(decimalToNative(lhs.getDecimal()),
+                                      decimalToNative(rhs.getDecimal()), &product)) {
+            product /= kMaxScaleFactor;
+            if (nativeDecimalInRange(product)) {
+                return getDecimalValue(nativeToDecimal(product));
+            }
+        }
+        // The unscaled product needs more than 128 bits or the result is out of range.
+#endif
         TTLInt calc;
         calc.FromInt(lhs.getDecimal());
         calc *= rhs.getDecimal();
@@ -2404,6 +2501,20 @@ private:
         assert(lhs.getValueType() == VALUE_TYPE_DECIMAL);
         assert(rhs.getValueType() == VALUE_TYPE_DECIMAL);
 
+#ifdef VOLT_NATIVE_DECIMAL_ARITHMETIC
+        NativeDecimal divisor = decimalToNative(rhs.getDecimal());
+        NativeDecimal dividend;
+        if (divisor != 0 &&
+                ! __builtin_mul_overflow(decimalToNative(lhs.getDecimal()),
+                                         static_cast<NativeDecimal>(kMaxScaleFactor), &dividend)) {
+            NativeDecimal quotient = dividend / divisor;
+            if (nativeDecimalInRange(quotient)) {
+                return getDecimalValue(nativeToDecimal(quotient));
+            }
+        }
+        // Division by zero, a scaled dividend wider than 128 bits or a
+        // result out of range.
+#endif
         TTLInt calc;
         calc.FromInt(lhs.getDecimal());
         calc *= kMaxScaleFactor;
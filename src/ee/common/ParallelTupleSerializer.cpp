@@ -0,0 +1,188 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/ParallelTupleSerializer.h"
+
+#include "common/FatalException.hpp"
+#include "common/NValue.hpp"
+#include "common/serializeio.h"
+#include "common/tabletuple.h"
+
+namespace voltdb {
+
+// Below this many rows per thread the hand off costs more than it saves.
+static const std::size_t MIN_ROWS_PER_THREAD = 64;
+
+ParallelTupleSerializer::ParallelTupleSerializer(int helperCount)
+    : m_schema(NULL)
+    , m_generation(0)
+    , m_busyHelpers(0)
+    , m_failed(false)
+    , m_shutdown(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workCondition, NULL);
+    pthread_cond_init(&m_doneCondition, NULL);
+    // Reserve up front: the helpers hold pointers into m_helperStarts.
+    m_helperStarts.reserve(helperCount > 0 ? helperCount : 0);
+    for (int i = 0; i < helperCount; ++i) {
+        HelperStart start = { this, static_cast<std::size_t>(i + 1) };
+        m_helperStarts.push_back(start);
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, helperMain, &m_helperStarts.back()) != 0) {
+            m_helperStarts.pop_back();
+            break;
+        }
+        m_helpers.push_back(thread);
+    }
+}
+
+ParallelTupleSerializer::~ParallelTupleSerializer()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_shutdown = true;
+    pthread_cond_broadcast(&m_workCondition);
+    pthread_mutex_unlock(&m_mutex);
+    for (std::size_t i = 0; i < m_helpers.size(); ++i) {
+        pthread_join(m_helpers[i], NULL);
+    }
+    pthread_cond_destroy(&m_doneCondition);
+    pthread_cond_destroy(&m_workCondition);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+std::size_t ParallelTupleSerializer::serializedSize(const TableTuple &tuple)
+{
+    std::size_t bytes = sizeof(int32_t);
+    const TupleSchema *schema = tuple.getSchema();
+    for (int i = 0; i < schema->columnCount(); ++i) {
+        bytes += tuple.getNValue(i).serializedSize();
+    }
+    for (int i = 0; i < schema->hiddenColumnCount(); ++i) {
+        bytes += tuple.getHiddenNValue(i).serializedSize();
+    }
+    return bytes;
+}
+
+void ParallelTupleSerializer::add(const TableTuple &tuple, char *target, std::size_t size)
+{
+    assert(m_rows.empty() || m_schema == tuple.getSchema());
+    m_schema = tuple.getSchema();
+    PendingRow row = { tuple.address(), target, size };
+    m_rows.push_back(row);
+}
+
+void ParallelTupleSerializer::sliceBounds(std::size_t slice, std::size_t &begin, std::size_t &end) const
+{
+    const std::size_t slices = m_helpers.size() + 1;
+    begin = m_rows.size() * slice / slices;
+    end = m_rows.size() * (slice + 1) / slices;
+}
+
+bool ParallelTupleSerializer::serializeRange(std::size_t begin, std::size_t end)
+{
+    TableTuple tuple(m_schema);
+    try {
+        for (std::size_t i = begin; i < end; ++i) {
+            const PendingRow &row = m_rows[i];
+            tuple.move(row.m_tupleAddress);
+            ReferenceSerializeOutput out(row.m_target, row.m_size);
+            tuple.serializeTo(out, true);
+            if (out.position() != row.m_size) {
+                return false;
+            }
+        }
+    }
+    catch (...) {
+        return false;
+    }
+    return true;
+}
+
+void ParallelTupleSerializer::flush()
+{
+    if (m_rows.empty()) {
+        return;
+    }
+
+    bool succeeded;
+    if (m_helpers.empty() || m_rows.size() < MIN_ROWS_PER_THREAD * (m_helpers.size() + 1)) {
+        succeeded = serializeRange(0, m_rows.size());
+    }
+    else {
+        pthread_mutex_lock(&m_mutex);
+        m_failed = false;
+        m_busyHelpers = static_cast<int>(m_helpers.size());
+        ++m_generation;
+        pthread_cond_broadcast(&m_workCondition);
+        pthread_mutex_unlock(&m_mutex);
+
+        std::size_t begin, end;
+        sliceBounds(0, begin, end);
+        succeeded = serializeRange(begin, end);
+
+        pthread_mutex_lock(&m_mutex);
+        while (m_busyHelpers > 0) {
+            pthread_cond_wait(&m_doneCondition, &m_mutex);
+        }
+        succeeded = succeeded && !m_failed;
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    m_rows.clear();
+    if (!succeeded) {
+        throwFatalException("Failed to serialize a snapshot row into its reserved buffer space.");
+    }
+}
+
+void *ParallelTupleSerializer::helperMain(void *arg)
+{
+    HelperStart *start = static_cast<HelperStart*>(arg);
+    start->m_owner->helperLoop(start->m_slice);
+    return NULL;
+}
+
+void ParallelTupleSerializer::helperLoop(std::size_t slice)
+{
+    uint64_t seenGeneration = 0;
+    pthread_mutex_lock(&m_mutex);
+    while (true) {
+        while (!m_shutdown && m_generation == seenGeneration) {
+            pthread_cond_wait(&m_workCondition, &m_mutex);
+        }
+        if (m_shutdown) {
+            break;
+        }
+        seenGeneration = m_generation;
+        pthread_mutex_unlock(&m_mutex);
+
+        std::size_t begin, end;
+        sliceBounds(slice, begin, end);
+        bool succeeded = serializeRange(begin, end);
+
+        pthread_mutex_lock(&m_mutex);
+        if (!succeeded) {
+            m_failed = true;
+        }
+        if (--m_busyHelpers == 0) {
+            pthread_cond_signal(&m_doneCondition);
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+} // namespace voltdb
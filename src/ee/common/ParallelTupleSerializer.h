@@ -0,0 +1,109 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARALLELTUPLESERIALIZER_H_
+#define PARALLELTUPLESERIALIZER_H_
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+#include <pthread.h>
+
+namespace voltdb {
+class TableTuple;
+class TupleSchema;
+
+/**
+ * Serializes rows into space that was already reserved for them in an output
+ * buffer, spreading the work over a small set of helper threads.
+ *
+ * The caller works out the exact serialized size of each row, reserves that
+ * many bytes in its output stream and queues the row with add(). Nothing is
+ * written until flush(), which splits the queued rows between the helpers
+ * and the calling thread and returns once every row has been written. The
+ * tuples must not be changed or freed until then, which is why the snapshot
+ * stream flushes before it deletes a tuple or returns to the site.
+ *
+ * The helpers only read tuple storage and write to disjoint parts of the
+ * output buffers, so they need no locking beyond the hand off itself.
+ */
+class ParallelTupleSerializer {
+public:
+    /** Start helperCount threads; with no helpers flush() works inline. */
+    ParallelTupleSerializer(int helperCount);
+    ~ParallelTupleSerializer();
+
+    int helperCount() const {
+        return static_cast<int>(m_helpers.size());
+    }
+
+    /** Queue a row to be written to the size bytes starting at target. */
+    void add(const TableTuple &tuple, char *target, std::size_t size);
+
+    /** Write all the queued rows. Throws a fatal exception if a row fails. */
+    void flush();
+
+    std::size_t pendingRows() const {
+        return m_rows.size();
+    }
+
+    /**
+     * The exact number of bytes TableTuple::serializeTo() produces for the
+     * tuple, including its length prefix and hidden columns.
+     */
+    static std::size_t serializedSize(const TableTuple &tuple);
+
+private:
+    struct PendingRow {
+        char *m_tupleAddress;
+        char *m_target;
+        std::size_t m_size;
+    };
+
+    struct HelperStart {
+        ParallelTupleSerializer *m_owner;
+        std::size_t m_slice;
+    };
+
+    static void *helperMain(void *arg);
+    void helperLoop(std::size_t slice);
+
+    /** Write rows [begin, end) of the queue; return false on failure. */
+    bool serializeRange(std::size_t begin, std::size_t end);
+
+    /** The bounds of the nth of (helpers + 1) slices of the queue. */
+    void sliceBounds(std::size_t slice, std::size_t &begin, std::size_t &end) const;
+
+    std::vector<pthread_t> m_helpers;
+    std::vector<HelperStart> m_helperStarts;
+    std::vector<PendingRow> m_rows;
+    const TupleSchema *m_schema;
+
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_workCondition;
+    pthread_cond_t m_doneCondition;
+    // Bumped for every flush() handed to the helpers.
+    uint64_t m_generation;
+    // Helpers which have not finished the current generation.
+    int m_busyHelpers;
+    bool m_failed;
+    bool m_shutdown;
+};
+
+} // namespace voltdb
+
+#endif // PARALLELTUPLESERIALIZER_H_
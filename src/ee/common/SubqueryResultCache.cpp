@@ -0,0 +1,212 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/SubqueryResultCache.h"
+
+#include "common/debuglog.h"
+#include "common/StringRef.h"
+#include "common/tabletuple.h"
+#include "common/ThreadLocalPool.h"
+#include "common/ValuePeeker.hpp"
+#include "storage/AbstractTempTable.hpp"
+#include "storage/tableiterator.h"
+#include "storage/TempTableLimits.h"
+
+namespace voltdb {
+
+int64_t SubqueryResultCache::memoryCapFor(const TempTableLimits* limits)
+{
+    if (limits == NULL || limits->getMemoryLimit() <= 0) {
+        return DEFAULT_MEMORY_CAP;
+    }
+    return limits->getMemoryLimit() / MEMORY_LIMIT_DIVISOR;
+}
+
+bool SubqueryResultCache::isCacheable(const std::vector<NValue>& params)
+{
+    for (size_t i = 0; i < params.size(); ++i) {
+        switch (ValuePeeker::peekValueType(params[i])) {
+        case VALUE_TYPE_TINYINT:
+        case VALUE_TYPE_SMALLINT:
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+        case VALUE_TYPE_DOUBLE:
+        case VALUE_TYPE_VARCHAR:
+        case VALUE_TYPE_VARBINARY:
+        case VALUE_TYPE_DECIMAL:
+        case VALUE_TYPE_POINT:
+        case VALUE_TYPE_GEOGRAPHY:
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+int64_t SubqueryResultCache::objectBytes(const NValue& value)
+{
+    if ( ! isVariableLengthType(ValuePeeker::peekValueType(value)) || value.isNull()) {
+        return 0;
+    }
+    int32_t length;
+    ValuePeeker::peekObject_withoutNull(value, &length);
+    // What StringRef::create takes from a Pool, which keeps each
+    // allocation 8 byte aligned.
+    int64_t bytes = sizeof(StringRef) + sizeof(ThreadLocalPool::Sized) + length;
+    return bytes + 8 - bytes % 8;
+}
+
+/**
+ * Unlike NValue::copyNValue, also copy out non-inlined objects: a temp
+ * table row may point into a persistent table or a large temp table
+ * block that changes before the cached row is next used.
+ */
+NValue SubqueryResultCache::copyForCache(const NValue& value, Pool* pool)
+{
+    NValue copy = value;
+    if (isVariableLengthType(ValuePeeker::peekValueType(value))) {
+        copy.allocateObjectFromPool(pool);
+    }
+    return copy;
+}
+
+bool SubqueryResultCache::restore(const std::vector<NValue>& params, AbstractTempTable* output)
+{
+    EntryMap::iterator found = m_entries.find(params);
+    if (found == m_entries.end()) {
+        return false;
+    }
+    EntryList::iterator entry = found->second;
+    m_lru.splice(m_lru.begin(), m_lru, entry);
+
+    output->deleteAllTempTuples();
+    TableTuple& tuple = output->tempTuple();
+    const std::vector<NValue>& values = entry->m_values;
+    for (size_t row = 0; row < values.size(); row += entry->m_columnCount) {
+        for (int col = 0; col < entry->m_columnCount; ++col) {
+            tuple.setNValue(col, values[row + col]);
+        }
+        output->insertTempTuple(tuple);
+    }
+    output->finishInserts();
+    return true;
+}
+
+bool SubqueryResultCache::store(const std::vector<NValue>& params, Table* output)
+{
+    if ( ! isCacheable(params)) {
+        return false;
+    }
+    // The caller only stores results it could not restore, but the old
+    // entry's key points into its pool, so it cannot simply be updated.
+    EntryMap::iterator existing = m_entries.find(params);
+    if (existing != m_entries.end()) {
+        EntryList::iterator stale = existing->second;
+        m_entries.erase(existing);
+        release(stale->m_bytes);
+        m_lru.erase(stale);
+    }
+    if (m_lru.empty()) {
+        AbstractTempTable* tempOutput = dynamic_cast<AbstractTempTable*>(output);
+        m_limits = tempOutput == NULL ? NULL : tempOutput->getTempTableLimits();
+        if (m_memoryCap < 0) {
+            m_memoryCap = memoryCapFor(m_limits);
+        }
+    }
+
+    Entry entry;
+    entry.m_columnCount = output->columnCount();
+    // Size the entry first, so that a result that is not kept costs no
+    // copies and one that is gets a pool of exactly the right size.
+    int64_t poolBytes = 0;
+    for (size_t i = 0; i < params.size(); ++i) {
+        poolBytes += objectBytes(params[i]);
+    }
+    TableTuple tuple(output->schema());
+    TableIterator sizer = output->iterator();
+    while (sizer.next(tuple)) {
+        for (int col = 0; col < entry.m_columnCount; ++col) {
+            poolBytes += objectBytes(tuple.getNValue(col));
+        }
+    }
+    int64_t valueCount = params.size() + output->activeTupleCount() * entry.m_columnCount;
+    entry.m_bytes = valueCount * static_cast<int64_t>(sizeof(NValue)) + poolBytes;
+    if (entry.m_bytes > m_memoryCap) {
+        VOLT_DEBUG("Subquery result of %jd bytes exceeds the cache cap of %jd bytes",
+                   (intmax_t)entry.m_bytes, (intmax_t)m_memoryCap);
+        return false;
+    }
+
+    while ( ! m_lru.empty() && m_allocated + entry.m_bytes > m_memoryCap) {
+        evictLeastRecentlyUsed();
+    }
+    // Caching a result must never be what makes the fragment fail.
+    if (m_limits != NULL && m_limits->getMemoryLimit() > 0 &&
+            m_limits->getAllocated() + entry.m_bytes > m_limits->getMemoryLimit()) {
+        return false;
+    }
+
+    if (poolBytes > 0) {
+        entry.m_pool.reset(new Pool(poolBytes, 1));
+    }
+    entry.m_params.reserve(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+        entry.m_params.push_back(copyForCache(params[i], entry.m_pool.get()));
+    }
+    entry.m_values.reserve(valueCount - params.size());
+    TableIterator iterator = output->iterator();
+    while (iterator.next(tuple)) {
+        for (int col = 0; col < entry.m_columnCount; ++col) {
+            entry.m_values.push_back(copyForCache(tuple.getNValue(col), entry.m_pool.get()));
+        }
+    }
+
+    if (m_limits != NULL) {
+        m_limits->increaseAllocated(static_cast<int>(entry.m_bytes));
+    }
+    m_allocated += entry.m_bytes;
+    m_lru.push_front(std::move(entry));
+    m_entries.insert(std::make_pair(m_lru.front().m_params, m_lru.begin()));
+    return true;
+}
+
+void SubqueryResultCache::evictLeastRecentlyUsed()
+{
+    Entry& victim = m_lru.back();
+    m_entries.erase(victim.m_params);
+    release(victim.m_bytes);
+    m_lru.pop_back();
+}
+
+void SubqueryResultCache::release(int64_t bytes)
+{
+    m_allocated -= bytes;
+    if (m_limits != NULL) {
+        m_limits->reduceAllocated(static_cast<int>(bytes));
+    }
+}
+
+void SubqueryResultCache::clear()
+{
+    m_entries.clear();
+    m_lru.clear();
+    release(m_allocated);
+}
+
+} // namespace voltdb
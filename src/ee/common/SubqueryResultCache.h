@@ -0,0 +1,166 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLTDB_SUBQUERYRESULTCACHE_H
+#define VOLTDB_SUBQUERYRESULTCACHE_H
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "common/NValue.hpp"
+#include "common/Pool.hpp"
+
+namespace voltdb {
+
+class AbstractTempTable;
+class Table;
+class TempTableLimits;
+
+/**
+ * Remembers the results of a correlated subquery for the parameter
+ * values it has already been run with.  A subquery whose outer rows
+ * do not arrive in correlation key order would otherwise re-run its
+ * executors for nearly every row, since SubqueryContext only keeps
+ * the result for the most recent parameters.
+ *
+ * Each cached result owns a pool sized to hold exactly its non-inlined
+ * objects, which is freed when the result is evicted.  The memory held
+ * by the cached rows and keys is charged to the TempTableLimits of the
+ * table the results came from, so a cache must not outlive the fragment
+ * that filled it.  It is also held under a cap derived from those
+ * limits; the least recently used results are evicted to make room.
+ */
+class SubqueryResultCache {
+public:
+    /** The cached results together may use up to 1/MEMORY_LIMIT_DIVISOR of the temp table memory limit. */
+    static const int64_t MEMORY_LIMIT_DIVISOR = 4;
+    /** The cap used when the fragment has no temp table memory limit. */
+    static const int64_t DEFAULT_MEMORY_CAP = 16 * 1024 * 1024;
+
+    SubqueryResultCache()
+      : m_memoryCap(-1)
+      , m_allocated(0)
+      , m_limits(NULL)
+    { }
+
+    /** A cache with a fixed cap rather than one taken from the first stored table's limits. */
+    explicit SubqueryResultCache(int64_t memoryCap)
+      : m_memoryCap(memoryCap)
+      , m_allocated(0)
+      , m_limits(NULL)
+    { }
+
+    /** Copies start out empty: the cached rows belong to one SubqueryContext. */
+    SubqueryResultCache(const SubqueryResultCache& other)
+      : m_memoryCap(other.m_memoryCap)
+      , m_allocated(0)
+      , m_limits(NULL)
+    { }
+
+    ~SubqueryResultCache() { clear(); }
+
+    /**
+     * If a result is cached for the given parameter values, replace the
+     * contents of the output table with it and return true.
+     */
+    bool restore(const std::vector<NValue>& params, AbstractTempTable* output);
+
+    /**
+     * Remember the rows currently in the output table as the result for
+     * the given parameter values.  Returns false if the parameters cannot
+     * be hashed, or the result does not fit under the memory cap or in
+     * what is left of the temp table memory limit.
+     */
+    bool store(const std::vector<NValue>& params, Table* output);
+
+    /** Drop all results and give their memory back to the temp table limits. */
+    void clear();
+
+    size_t entryCount() const { return m_entries.size(); }
+    int64_t allocated() const { return m_allocated; }
+    int64_t memoryCap() const { return m_memoryCap; }
+
+    static int64_t memoryCapFor(const TempTableLimits* limits);
+
+    /** Only parameter types that NValue::hashCombine supports can key the cache. */
+    static bool isCacheable(const std::vector<NValue>& params);
+
+private:
+    struct ParamsHash {
+        std::size_t operator()(const std::vector<NValue>& params) const {
+            std::size_t seed = 0;
+            for (size_t i = 0; i < params.size(); ++i) {
+                params[i].hashCombine(seed);
+            }
+            return seed;
+        }
+    };
+
+    struct ParamsEqual {
+        bool operator()(const std::vector<NValue>& lhs, const std::vector<NValue>& rhs) const {
+            if (lhs.size() != rhs.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < lhs.size(); ++i) {
+                if (lhs[i].compare(rhs[i]) != VALUE_COMPARE_EQUAL) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    struct Entry {
+        std::vector<NValue> m_params;
+        // The cached rows, one column after another.
+        std::vector<NValue> m_values;
+        // Holds the non-inlined objects of m_params and m_values, if any.
+        std::unique_ptr<Pool> m_pool;
+        int m_columnCount;
+        int64_t m_bytes;
+    };
+
+    typedef std::list<Entry> EntryList;
+    typedef boost::unordered_map<std::vector<NValue>, EntryList::iterator,
+                                 ParamsHash, ParamsEqual> EntryMap;
+
+    static int64_t objectBytes(const NValue& value);
+
+    static NValue copyForCache(const NValue& value, Pool* pool);
+
+    void evictLeastRecentlyUsed();
+
+    void release(int64_t bytes);
+
+    // No assignment.
+    SubqueryResultCache& operator=(const SubqueryResultCache&);
+
+    int64_t m_memoryCap;
+    int64_t m_allocated;
+    // Charged for the cached results; taken from the first stored table.
+    TempTableLimits* m_limits;
+    // Most recently used first.
+    EntryList m_lru;
+    EntryMap m_entries;
+};
+
+} // namespace voltdb
+
+#endif // VOLTDB_SUBQUERYRESULTCACHE_H
@@ -22,8 +22,14 @@
 #include "common/SynchronizedThreadLock.h"
 #include "ExecuteWithMpMemory.h"
 
+#include <atomic>
+#include <cstdio>
+#include <dirent.h>
 #include <iostream>
 #include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace voltdb {
 
@@ -44,6 +50,10 @@ pthread_key_t m_stringKey;
 pthread_key_t m_allocatedKey;
 pthread_key_t m_threadPartitionIdKey;
 pthread_key_t m_enginePartitionIdKey;
+/**
+ * Thread local key for the placement policy of the thread's large buffers
+ */
+pthread_key_t m_allocationPolicyKey;
 pthread_once_t m_keyOnce = PTHREAD_ONCE_INIT;
 
 }
@@ -60,6 +70,7 @@ void createThreadLocalKey() {
     (void) pthread_key_create(&m_allocatedKey, NULL);
     (void) pthread_key_create(&m_threadPartitionIdKey, NULL);
     (void) pthread_key_create(&m_enginePartitionIdKey, NULL);
+    (void) pthread_key_create(&m_allocationPolicyKey, NULL);
 }
 }
 
@@ -156,6 +167,8 @@ ThreadLocalPool::~ThreadLocalPool() {
             }
             delete threadPartitionIdPtr;
             delete enginePartitionIdPtr;
+            delete static_cast<AllocationPolicy*>(pthread_getspecific(m_allocationPolicyKey));
+            pthread_setspecific(m_allocationPolicyKey, NULL);
             delete p;
         } else {
             p->first--;
@@ -192,6 +205,7 @@ void ThreadLocalPool::resetStateForTest() {
     pthread_setspecific(m_stringKey, NULL);
     pthread_setspecific(m_enginePartitionIdKey, NULL);
     pthread_setspecific(m_threadPartitionIdKey, NULL);
+    pthread_setspecific(m_allocationPolicyKey, NULL);
 }
 int32_t* ThreadLocalPool::getThreadPartitionIdForTest() {
     return static_cast< int32_t* >(pthread_getspecific(m_threadPartitionIdKey));
@@ -624,16 +638,282 @@ int32_t ThreadLocalPool::getEnginePartitionIdWithNullCheck() {
     return *ptrToPartitionId;
 }
 
+namespace {
+// Per node totals for allocateBlock, with slot 0 for unbound buffers.
+std::atomic<int64_t> s_numaAllocatedBytes[ThreadLocalPool::MAX_NUMA_NODES + 1];
+std::atomic<int64_t> s_numaHugePageBytes[ThreadLocalPool::MAX_NUMA_NODES + 1];
+
+inline int32_t numaStatsSlot(int32_t numaNode) {
+    if (numaNode < 0 || numaNode >= ThreadLocalPool::MAX_NUMA_NODES) {
+        return 0;
+    }
+    return numaNode + 1;
+}
+
+void countBlock(const BlockAllocation& block, int64_t sign) {
+    int32_t slot = numaStatsSlot(block.m_numaNode);
+    int64_t bytes = static_cast<int64_t>(block.m_mappedBytes != 0 ? block.m_mappedBytes : block.m_bytes);
+    s_numaAllocatedBytes[slot] += sign * bytes;
+    if (block.m_hugePages) {
+        s_numaHugePageBytes[slot] += sign * bytes;
+    }
+}
+
+inline std::size_t roundUp(std::size_t bytes, std::size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+inline std::size_t pageSize() {
+    return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+// The layout of a packed BlockAllocation: the requested size in the low
+// 48 bits, then how the block was mapped, the NUMA node plus one (zero for
+// unbound) and the huge page flag.
+const int PACKED_BYTES_BITS = 48;
+const uint64_t PACKED_BYTES_MASK = (static_cast<uint64_t>(1) << PACKED_BYTES_BITS) - 1;
+const int PACKED_MAPPING_SHIFT = PACKED_BYTES_BITS;
+const int PACKED_NODE_SHIFT = PACKED_MAPPING_SHIFT + 2;
+const int PACKED_HUGE_PAGES_SHIFT = PACKED_NODE_SHIFT + 7;
+
+enum PackedMapping {
+    MAPPED_FROM_HEAP = 0,
+    MAPPED_IN_PAGES = 1,
+    MAPPED_IN_HUGE_PAGES = 2
+};
+
+AllocationPolicy* getThreadAllocationPolicy() {
+    (void)pthread_once(&m_keyOnce, createThreadLocalKey);
+    return static_cast<AllocationPolicy*>(pthread_getspecific(m_allocationPolicyKey));
+}
+
+char* mapAnonymous(std::size_t bytes, int extraFlags) {
+    void* address = ::mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+    return address == MAP_FAILED ? NULL : static_cast<char*>(address);
+}
+
+/**
+ * Transparent huge pages are only used for huge page aligned ranges, so
+ * over-map by one huge page and trim the unaligned ends.
+ */
+char* mapHugePageAligned(std::size_t bytes) {
+    std::size_t span = bytes + ThreadLocalPool::HUGE_PAGE_SIZE;
+    char* raw = mapAnonymous(span, 0);
+    if (raw == NULL) {
+        return NULL;
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    start = roundUp(start, ThreadLocalPool::HUGE_PAGE_SIZE);
+    char* aligned = reinterpret_cast<char*>(start);
+    if (aligned > raw) {
+        ::munmap(raw, aligned - raw);
+    }
+    std::size_t tail = (raw + span) - (aligned + bytes);
+    if (tail > 0) {
+        ::munmap(aligned + bytes, tail);
+    }
+    return aligned;
+}
+
+// MPOL_PREFERRED from <linux/mempolicy.h>.  The engine does not link
+// libnuma, so mbind is invoked as a raw system call.
+const int VOLT_MPOL_PREFERRED = 1;
+
+bool bindToNumaNode(char* address, std::size_t bytes, int32_t numaNode) {
+#ifdef SYS_mbind
+    unsigned long nodeMask = 1UL << numaNode;
+    // The kernel only looks at the first maxnode - 1 bits of the mask.
+    unsigned long maxNode = sizeof(nodeMask) * 8 + 1;
+    return ::syscall(SYS_mbind, address, bytes, VOLT_MPOL_PREFERRED, &nodeMask, maxNode, 0) == 0;
+#else
+    return false;
+#endif
+}
+}
+
+void ThreadLocalPool::setAllocationPolicy(const AllocationPolicy& policy) {
+    AllocationPolicy* current = getThreadAllocationPolicy();
+    if (current == NULL) {
+        pthread_setspecific(m_allocationPolicyKey, static_cast<const void*>(new AllocationPolicy(policy)));
+    }
+    else {
+        *current = policy;
+    }
+}
+
+AllocationPolicy ThreadLocalPool::getAllocationPolicy() {
+    AllocationPolicy* current = getThreadAllocationPolicy();
+    return current == NULL ? AllocationPolicy() : *current;
+}
+
+int32_t ThreadLocalPool::getNumaNodeCount() {
+    DIR* nodes = ::opendir("/sys/devices/system/node");
+    if (nodes == NULL) {
+        return 1;
+    }
+    int32_t count = 0;
+    int node;
+    char extra;
+    struct dirent* entry;
+    while ((entry = ::readdir(nodes)) != NULL) {
+        if (::sscanf(entry->d_name, "node%d%c", &node, &extra) == 1) {
+            ++count;
+        }
+    }
+    ::closedir(nodes);
+    return count > 0 ? count : 1;
+}
+
+int32_t ThreadLocalPool::getCurrentNumaNode() {
+#ifdef SYS_getcpu
+    unsigned cpu;
+    unsigned node;
+    if (::syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+        return static_cast<int32_t>(node);
+    }
+#endif
+    return -1;
+}
+
+BlockAllocation ThreadLocalPool::allocateBlock(std::size_t bytes) {
+    BlockAllocation block;
+    block.m_bytes = bytes;
+    AllocationPolicy* policy = getThreadAllocationPolicy();
+    if (policy == NULL || policy->isDefault() || bytes < MIN_PLACED_BLOCK_SIZE) {
+        block.m_address = new (std::nothrow) char[bytes];
+        if (block.m_address != NULL) {
+            countBlock(block, 1);
+        }
+        return block;
+    }
+
+    // Rounding a buffer up to whole huge pages must not waste more than
+    // an eighth of it; smaller buffers get normal pages.
+    std::size_t hugeBytes = roundUp(bytes, HUGE_PAGE_SIZE);
+    bool useHugePages = policy->m_hugePages != AllocationPolicy::HUGE_PAGES_NONE &&
+                        hugeBytes - bytes <= bytes / 8;
+#ifdef MAP_HUGETLB
+    if (useHugePages && policy->m_hugePages == AllocationPolicy::HUGE_PAGES_EXPLICIT) {
+        block.m_address = mapAnonymous(hugeBytes, MAP_HUGETLB);
+        if (block.m_address != NULL) {
+            block.m_mappedBytes = hugeBytes;
+            block.m_hugePages = true;
+        }
+        else {
+            VOLT_DEBUG("Huge page reserve exhausted, using normal pages for a %lu byte buffer",
+                       static_cast<unsigned long>(bytes));
+        }
+    }
+#endif
+    if (block.m_address == NULL) {
+        if (useHugePages && policy->m_hugePages == AllocationPolicy::HUGE_PAGES_TRANSPARENT) {
+            block.m_mappedBytes = hugeBytes;
+            block.m_address = mapHugePageAligned(hugeBytes);
+#ifdef MADV_HUGEPAGE
+            block.m_hugePages = block.m_address != NULL &&
+                                ::madvise(block.m_address, hugeBytes, MADV_HUGEPAGE) == 0;
+#endif
+        }
+        else {
+            block.m_mappedBytes = roundUp(bytes, pageSize());
+            block.m_address = mapAnonymous(block.m_mappedBytes, 0);
+        }
+        if (block.m_address == NULL) {
+            return BlockAllocation();
+        }
+    }
+
+    // The pages have not been touched yet, so binding the range now
+    // places every page of it.
+    if (policy->m_numaNode >= 0 && policy->m_numaNode < MAX_NUMA_NODES &&
+            bindToNumaNode(block.m_address, block.m_mappedBytes, policy->m_numaNode)) {
+        block.m_numaNode = policy->m_numaNode;
+    }
+    countBlock(block, 1);
+    return block;
+}
+
+void ThreadLocalPool::freeBlock(BlockAllocation block) {
+    if (block.m_address == NULL) {
+        return;
+    }
+    countBlock(block, -1);
+    if (block.m_mappedBytes == 0) {
+        delete [] block.m_address;
+    }
+    else if (::munmap(block.m_address, block.m_mappedBytes) != 0) {
+        throwFatalException("Failed to unmap a %lu byte buffer", static_cast<unsigned long>(block.m_mappedBytes));
+    }
+}
+
+uint64_t ThreadLocalPool::packBlockAllocation(const BlockAllocation& block) {
+    assert((static_cast<uint64_t>(block.m_bytes) & ~PACKED_BYTES_MASK) == 0);
+    uint64_t mapping = MAPPED_FROM_HEAP;
+    if (block.m_mappedBytes != 0) {
+        mapping = block.m_mappedBytes == roundUp(block.m_bytes, pageSize()) ?
+                MAPPED_IN_PAGES : MAPPED_IN_HUGE_PAGES;
+        assert(mapping == MAPPED_IN_PAGES ||
+               block.m_mappedBytes == roundUp(block.m_bytes, HUGE_PAGE_SIZE));
+    }
+    uint64_t node = static_cast<uint64_t>(numaStatsSlot(block.m_numaNode));
+    return static_cast<uint64_t>(block.m_bytes) |
+           (mapping << PACKED_MAPPING_SHIFT) |
+           (node << PACKED_NODE_SHIFT) |
+           (static_cast<uint64_t>(block.m_hugePages) << PACKED_HUGE_PAGES_SHIFT);
+}
+
+BlockAllocation ThreadLocalPool::unpackBlockAllocation(char* address, uint64_t packed) {
+    BlockAllocation block;
+    block.m_address = address;
+    block.m_bytes = static_cast<std::size_t>(packed & PACKED_BYTES_MASK);
+    switch ((packed >> PACKED_MAPPING_SHIFT) & 0x3) {
+    case MAPPED_IN_PAGES:
+        block.m_mappedBytes = roundUp(block.m_bytes, pageSize());
+        break;
+    case MAPPED_IN_HUGE_PAGES:
+        block.m_mappedBytes = roundUp(block.m_bytes, HUGE_PAGE_SIZE);
+        break;
+    default:
+        break;
+    }
+    block.m_numaNode = static_cast<int32_t>((packed >> PACKED_NODE_SHIFT) & 0x7f) - 1;
+    block.m_hugePages = ((packed >> PACKED_HUGE_PAGES_SHIFT) & 0x1) != 0;
+    return block;
+}
+
+NumaNodeStats ThreadLocalPool::getNumaNodeStats(int32_t numaNode) {
+    NumaNodeStats stats;
+    if (numaNode >= MAX_NUMA_NODES) {
+        // don't report the unbound totals for an out of range node
+        stats.m_allocatedBytes = 0;
+        stats.m_hugePageBytes = 0;
+        return stats;
+    }
+    int32_t slot = numaStatsSlot(numaNode);
+    stats.m_allocatedBytes = s_numaAllocatedBytes[slot];
+    stats.m_hugePageBytes = s_numaHugePageBytes[slot];
+    return stats;
+}
+
+// Each page starts with the packed BlockAllocation it came from, in the
+// same 8 bytes that used to hold just its size.
 char * voltdb_pool_allocator_new_delete::malloc(const size_type bytes) {
-    (*static_cast< std::size_t* >(pthread_getspecific(m_allocatedKey))) += bytes + sizeof(std::size_t);
-    char *retval = new (std::nothrow) char[bytes + sizeof(std::size_t)];
-    *reinterpret_cast<std::size_t*>(retval) = bytes + sizeof(std::size_t);
-    return &retval[sizeof(std::size_t)];
+    BlockAllocation block = ThreadLocalPool::allocateBlock(bytes + sizeof(uint64_t));
+    if (block.m_address == NULL) {
+        return NULL;
+    }
+    (*static_cast< std::size_t* >(pthread_getspecific(m_allocatedKey))) += block.m_bytes;
+    *reinterpret_cast<uint64_t*>(block.m_address) = ThreadLocalPool::packBlockAllocation(block);
+    return &block.m_address[sizeof(uint64_t)];
 }
 
 void voltdb_pool_allocator_new_delete::free(char * const block) {
-    (*static_cast< std::size_t* >(pthread_getspecific(m_allocatedKey))) -= *reinterpret_cast<std::size_t*>(block - sizeof(std::size_t));
-    delete [](block - sizeof(std::size_t));
+    char* address = block - sizeof(uint64_t);
+    BlockAllocation allocation =
+        ThreadLocalPool::unpackBlockAllocation(address, *reinterpret_cast<uint64_t*>(address));
+    (*static_cast< std::size_t* >(pthread_getspecific(m_allocatedKey))) -= allocation.m_bytes;
+    ThreadLocalPool::freeBlock(allocation);
 }
 
 PoolLocals::PoolLocals() {
@@ -18,6 +18,7 @@
 #ifndef THREADLOCALPOOL_H_
 #define THREADLOCALPOOL_H_
 
+#include "common/AllocationPolicy.h"
 #include "structures/CompactingPool.h"
 
 #include "boost/pool/pool.hpp"
@@ -196,6 +197,52 @@ public:
      */
     static void freeRelocatable(Sized* string);
 
+    /** Buffers at least this large are placed according to the allocation policy. */
+    static const std::size_t MIN_PLACED_BLOCK_SIZE = 1024 * 1024;
+    static const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    /** NUMA nodes at or beyond this limit are treated as unbound. */
+    static const int32_t MAX_NUMA_NODES = 64;
+
+    /**
+     * Set the placement policy for the buffers later allocated by this
+     * thread.  Buffers that are already allocated stay where they are.
+     */
+    static void setAllocationPolicy(const AllocationPolicy& policy);
+    static AllocationPolicy getAllocationPolicy();
+
+    /** The NUMA node of the CPU the calling thread is running on, or -1 if unknown. */
+    static int32_t getCurrentNumaNode();
+
+    /** The number of NUMA nodes with memory or CPUs on this host, at least 1. */
+    static int32_t getNumaNodeCount();
+
+    /**
+     * Allocate a large buffer for long lived storage, placed according to
+     * the calling thread's allocation policy.  Buffers smaller than
+     * MIN_PLACED_BLOCK_SIZE, and all buffers under the default policy,
+     * come from the heap as before.  Returns a BlockAllocation with a NULL
+     * address if the memory could not be allocated.
+     */
+    static BlockAllocation allocateBlock(std::size_t bytes);
+
+    /** Return a buffer obtained from allocateBlock.  May be called from any thread. */
+    static void freeBlock(BlockAllocation block);
+
+    /**
+     * Squeeze a BlockAllocation, less its address, into 8 bytes for the
+     * headers kept in front of pool pages and ContiguousAllocator buffers.
+     * The address is passed back in to unpack it.
+     */
+    static uint64_t packBlockAllocation(const BlockAllocation& block);
+    static BlockAllocation unpackBlockAllocation(char* address, uint64_t packed);
+
+    /**
+     * Process-wide totals for the buffers currently allocated through
+     * allocateBlock on the given node.  Node -1 reports the buffers that
+     * were not bound to any node.
+     */
+    static NumaNodeStats getNumaNodeStats(int32_t numaNode);
+
     static void resetStateForTest();
     static int32_t* getThreadPartitionIdForTest();
     static void setThreadPartitionIdForTest(int32_t* partitionId);
@@ -97,6 +97,22 @@ class Topend {
     /** Delete any data for the specified block that is stored on disk. */
     virtual bool releaseLargeTempTableBlock(LargeTempTableBlockId blockId) = 0;
 
+    /** True if readLargeTempTableBlock may be called from a thread
+        other than the site thread, so that stored blocks can be read
+        ahead of the scan that needs them. */
+    virtual bool canPrefetchLargeTempTableBlocks() {
+        return false;
+    }
+
+    /** Read the stored image of the given block into storage (which
+        is BLOCK_SIZE_IN_BYTES long) without touching the block object
+        itself.  Called from the cache's prefetch thread, concurrently
+        with the site thread.  Returns the address the block had when
+        it was stored, or NULL on failure. */
+    virtual char* readLargeTempTableBlock(LargeTempTableBlockId blockId, char* storage) {
+        return NULL;
+    }
+
     // Call into the Java top end to execute a user-defined function.
     // The function ID for the function to be called and the parameter data is stored in a
     // buffer shared by the top end and the EE.
@@ -52,6 +52,14 @@ std::size_t TupleOutputStream::writeRow(const TableTuple &tuple)
     return bytesSerialized;
 }
 
+char *TupleOutputStream::reserveRow(std::size_t nbytes)
+{
+    const std::size_t startPos = reserveBytes(nbytes);
+    m_rowCount++;
+    m_totalBytesSerialized += nbytes;
+    return const_cast<char*>(data()) + startPos;
+}
+
 bool TupleOutputStream::canFit(std::size_t nbytes) const
 {
     return (remaining() >= nbytes + sizeof(int32_t));
@@ -54,6 +54,12 @@ public:
      */
     std::size_t writeRow(const TableTuple &tuple);
 
+    /**
+     * Account for a row of nbytes that will be serialized later and return
+     * the space set aside for it.
+     */
+    char *reserveRow(std::size_t nbytes);
+
     /**
      * Return true if nbytes can fit in the buffer's remaining space.
      */
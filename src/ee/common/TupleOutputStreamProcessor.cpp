@@ -17,6 +17,7 @@
 
 #include "TupleOutputStream.h"
 #include "TupleOutputStreamProcessor.h"
+#include "ParallelTupleSerializer.h"
 #include "tabletuple.h"
 
 namespace voltdb {
@@ -49,6 +50,7 @@ void TupleOutputStreamProcessor::clearState()
     m_maxTupleLength = 0;
     m_predicates = NULL;
     m_table = NULL;
+    m_serializer = NULL;
 }
 
 /** Convenience method to create and add a new TupleOutputStream. */
@@ -80,9 +82,18 @@ void TupleOutputStreamProcessor::open(PersistentTable &table,
     }
 }
 
+/** Finish writing deferred rows. */
+void TupleOutputStreamProcessor::flush()
+{
+    if (m_serializer != NULL) {
+        m_serializer->flush();
+    }
+}
+
 /** Stop serializing. */
 void TupleOutputStreamProcessor::close()
 {
+    flush();
     for (TupleOutputStreamProcessor::iterator iter = begin(); iter != end(); ++iter) {
         iter->endRows();
     }
@@ -111,6 +122,7 @@ bool TupleOutputStreamProcessor::writeRow(TableTuple &tuple, bool *deleteRow)
     }
 
     bool yield = false;
+    std::size_t rowSize = 0;
     for (TupleOutputStreamProcessor::iterator iter = begin(); iter != end(); ++iter) {
         // Get approval from corresponding output stream predicate, if provided.
         bool accepted = true;
@@ -134,7 +146,16 @@ bool TupleOutputStreamProcessor::writeRow(TableTuple &tuple, bool *deleteRow)
                 throwFatalException(
                     "TupleOutputStreamProcessor::writeRow() failed because buffer has no space.");
             }
-            iter->writeRow(tuple);
+            if (m_serializer == NULL) {
+                iter->writeRow(tuple);
+            }
+            else {
+                // The size is the same for every stream, so only work it out once.
+                if (rowSize == 0) {
+                    rowSize = ParallelTupleSerializer::serializedSize(tuple);
+                }
+                m_serializer->add(tuple, iter->reserveRow(rowSize), rowSize);
+            }
 
             // Check if we'll need to yield after handling this row.
             if (!yield) {
@@ -27,6 +27,7 @@ class TableTuple;
 class PersistentTable;
 class TupleOutputStream;
 class StreamPredicateList;
+class ParallelTupleSerializer;
 
 /** TupleOutputStream processor. Manages and outputs to multiple TupleOutputStream's. */
 class TupleOutputStreamProcessor : public boost::ptr_vector<TupleOutputStream> {
@@ -52,6 +53,21 @@ public:
               StreamPredicateList &predicates,
               std::vector<bool> &predicateDeletes);
 
+    /**
+     * Hand row serialization off to serializer until close(). Rows are then
+     * only sized and given space by writeRow() and are written by flush().
+     * Must be called before open().
+     */
+    void setSerializer(ParallelTupleSerializer *serializer) {
+        m_serializer = serializer;
+    }
+
+    /**
+     * Finish writing any rows writeRow() deferred. The tuples passed to
+     * writeRow() must stay intact until this has been called.
+     */
+    void flush();
+
     /** Stop serializing. */
     void close();
 
@@ -81,6 +97,9 @@ private:
     /** Vector of booleans that indicates whether the predicate return true means the row should be deleted */
     std::vector<bool> *m_predicateDeletes;
 
+    /** Writes deferred rows, if set. */
+    ParallelTupleSerializer *m_serializer;
+
     /** Private method used by constructors, etc. to clear state. */
     void clearState();
 };
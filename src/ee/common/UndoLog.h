@@ -159,6 +159,11 @@ namespace voltdb
             }
         }
 
+        /** True while any undo quantum has been neither released nor undone. */
+        bool hasPendingQuantums() const {
+            return ! m_undoQuantums.empty();
+        }
+
         int64_t getSize() const
         {
             int64_t total = 0;
@@ -112,6 +112,7 @@ ExecutorContext::ExecutorContext(int64_t siteId,
     m_undoQuantum(undoQuantum),
     m_staticParams(MAX_PARAM_COUNT),
     m_usedParamcnt(0),
+    m_parameterGeneration(0),
     m_tuplesModifiedStack(),
     m_executorsMap(NULL),
     m_subqueryContextMap(),
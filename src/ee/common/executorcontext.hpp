@@ -365,6 +365,13 @@ class ExecutorContext {
     int getUsedParameterCount() const { return m_usedParamcnt; }
     NValueArray& getParameterContainer() { return m_staticParams; }
     const NValueArray& getParameterContainer() const { return m_staticParams; }
+    /**
+     * Anything that writes new values into the parameter container advances
+     * the parameter generation, so that expressions can keep what they derive
+     * from parameter values until the generation moves on.
+     */
+    void advanceParameterGeneration() { ++m_parameterGeneration; }
+    int64_t getParameterGeneration() const { return m_parameterGeneration; }
 
     void pushNewModifiedTupleCounter() { m_tuplesModifiedStack.push(0); }
     void popModifiedTupleCounter() { m_tuplesModifiedStack.pop(); }
@@ -464,6 +471,7 @@ class ExecutorContext {
     NValueArray m_staticParams;
     /** TODO : should be passed as execute() parameter..*/
     int m_usedParamcnt;
+    int64_t m_parameterGeneration;
 
     /** Counts tuples modified by a plan fragments.  Top of stack is the
      * most deeply nested executing plan fragment.
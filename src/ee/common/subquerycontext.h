@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "common/NValue.hpp"
+#include "common/SubqueryResultCache.h"
 
 namespace voltdb {
 
@@ -34,6 +35,8 @@ namespace voltdb {
 *    by columns from the join's OUTER side would effectively get run once per OUTER row.
 * -- subqueries that were correlated by a parent's indexed column (producing ordered values)
 *    could get executed once per unique value.
+* -- results for parameter values seen before, but not immediately before, are
+*    restored from a bounded cache of earlier results instead of being recomputed.
 * The subquery context is registered with the global executor context as candidates for
 * post-fragment cleanup, allowing results to be retained between invocations.
 */
@@ -46,6 +49,7 @@ struct SubqueryContext {
     SubqueryContext(const SubqueryContext& other)
       : m_hasValidResult(other.m_hasValidResult)
       , m_lastParams(other.m_lastParams)
+      , m_resultCache(other.m_resultCache)
     {
         if (m_hasValidResult) {
             m_lastResult = other.m_lastResult;
@@ -65,12 +69,16 @@ struct SubqueryContext {
 
     std::vector<NValue>& accessLastParams() { return m_lastParams; }
 
+    SubqueryResultCache& accessResultCache() { return m_resultCache; }
+
 private:
     bool m_hasValidResult;
     NValue m_lastResult;
     // The parameter values that were used to obtain the last result in the ascending
     // order of the parameter indexes
     std::vector<NValue> m_lastParams;
+    // The output tables of earlier executions, keyed by all of their parameter values
+    SubqueryResultCache m_resultCache;
 };
 
 }
@@ -279,6 +279,12 @@ string joinToString(JoinType type)
     case JOIN_TYPE_RIGHT: {
         return "RIGHT";
     }
+    case JOIN_TYPE_SEMI: {
+        return "SEMI";
+    }
+    case JOIN_TYPE_ANTI: {
+        return "ANTI";
+    }
     }
     return "INVALID";
 }
@@ -295,6 +301,10 @@ JoinType stringToJoin(string str )
         return JOIN_TYPE_FULL;
     } else if (str == "RIGHT") {
         return JOIN_TYPE_RIGHT;
+    } else if (str == "SEMI") {
+        return JOIN_TYPE_SEMI;
+    } else if (str == "ANTI") {
+        return JOIN_TYPE_ANTI;
     }
     return JOIN_TYPE_INVALID;
 }
@@ -351,6 +361,12 @@ string planNodeToString(PlanNodeType type)
     case PLAN_NODE_TYPE_NESTLOOPINDEX: {
         return "NESTLOOPINDEX";
     }
+    case PLAN_NODE_TYPE_HASHJOIN: {
+        return "HASHJOIN";
+    }
+    case PLAN_NODE_TYPE_MERGEJOIN: {
+        return "MERGEJOIN";
+    }
     case PLAN_NODE_TYPE_UPDATE: {
         return "UPDATE";
     }
@@ -428,6 +444,10 @@ PlanNodeType stringToPlanNode(string str )
         return PLAN_NODE_TYPE_NESTLOOP;
     } else if (str == "NESTLOOPINDEX") {
         return PLAN_NODE_TYPE_NESTLOOPINDEX;
+    } else if (str == "HASHJOIN") {
+        return PLAN_NODE_TYPE_HASHJOIN;
+    } else if (str == "MERGEJOIN") {
+        return PLAN_NODE_TYPE_MERGEJOIN;
     } else if (str == "UPDATE") {
         return PLAN_NODE_TYPE_UPDATE;
     } else if (str == "INSERT") {
@@ -126,6 +126,10 @@ enum JoinType {
     JOIN_TYPE_LEFT          = 2,
     JOIN_TYPE_FULL          = 3,
     JOIN_TYPE_RIGHT         = 4,
+    // Emit each outer tuple at most once, when it has a match
+    JOIN_TYPE_SEMI          = 5,
+    // Emit each outer tuple that has no match
+    JOIN_TYPE_ANTI          = 6,
 };
 
 // ------------------------------------------------------------------
@@ -186,6 +190,8 @@ enum PlanNodeType {
     //
     PLAN_NODE_TYPE_NESTLOOP         = 20,
     PLAN_NODE_TYPE_NESTLOOPINDEX    = 21,
+    PLAN_NODE_TYPE_HASHJOIN         = 22,
+    PLAN_NODE_TYPE_MERGEJOIN        = 23,
 
     //
     // Operator Nodes
@@ -359,7 +365,7 @@ enum QuantifierType {
 enum TableIndexType {
     BALANCED_TREE_INDEX     = 1,
     HASH_TABLE_INDEX        = 2,
-    BTREE_INDEX             = 3, // unused
+    BTREE_INDEX             = 3, // tree index backed by CompactingBTree
     COVERING_CELL_INDEX     = 4
 };
 
@@ -452,7 +458,16 @@ inline bool tableStreamTypeIsStreamIndexing(TableStreamType streamType) {
 // ------------------------------------------------------------------
 enum StatisticsSelectorType {
     STATISTICS_SELECTOR_TYPE_TABLE,
-    STATISTICS_SELECTOR_TYPE_INDEX
+    STATISTICS_SELECTOR_TYPE_INDEX,
+    STATISTICS_SELECTOR_TYPE_PLANNODE
+};
+
+// ------------------------------------------------------------------
+// Bits of the argument to the toggleProfiler entry points
+// ------------------------------------------------------------------
+enum ProfilerToggleBits {
+    PROFILER_TOGGLE_GPERFTOOLS  = 1,
+    PROFILER_TOGGLE_PLAN_NODES  = 2
 };
 
 // ------------------------------------------------------------------
@@ -49,6 +49,7 @@
 #include "catalog/statement.h"
 #include "executors/abstractexecutor.h"
 #include "executors/executorfactory.h"
+#include "storage/temptable.h"
 
 namespace voltdb {
 
@@ -118,11 +119,73 @@ void ExecutorVector::init(VoltDBEngine* engine) {
             initPlanNode(engine, planNode);
             executorList->push_back(planNode->getExecutor());
         }
+        setupPipelines(*executorList);
         m_subplanExecListMap.insert(make_pair(it->first, executorList.get()));
         executorList.release();
     }
 }
 
+/**
+ * Whether everything the node outputs can be handed straight to its
+ * parent as it is produced.  That takes an executor that only ever
+ * appends to its output temp table: one that sorts it or reads it back
+ * (ORDER BY, window functions), loads it wholesale (RECEIVE) or hands out
+ * a table it does not own (a SEQSCAN with nothing to do) must materialize.
+ */
+static bool canPipelineOutput(AbstractPlanNode* node)
+{
+    switch (node->getPlanNodeType()) {
+    case PLAN_NODE_TYPE_SEQSCAN:
+    case PLAN_NODE_TYPE_INDEXSCAN:
+    case PLAN_NODE_TYPE_PROJECTION:
+    case PLAN_NODE_TYPE_LIMIT:
+    case PLAN_NODE_TYPE_NESTLOOP:
+    case PLAN_NODE_TYPE_NESTLOOPINDEX:
+    case PLAN_NODE_TYPE_UNION:
+    case PLAN_NODE_TYPE_MATERIALIZE:
+        break;
+    default:
+        return false;
+    }
+    TempTable* output = dynamic_cast<TempTable*>(node->getOutputTable());
+    if (output == NULL || output->isPipelined()) {
+        return false;
+    }
+    for (size_t i = 0; i < node->getInputTableCount(); ++i) {
+        if (node->getInputTable(static_cast<int>(i)) == output) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ExecutorVector::setupPipelines(const std::vector<AbstractExecutor*>& executorList)
+{
+    // Large temp tables are paged out block by block; keep those plans
+    // materialized.
+    if (isLargeQuery()) {
+        return;
+    }
+    BOOST_FOREACH (AbstractExecutor* executor, executorList) {
+        if ( ! executor->supportsPipelinedInput()) {
+            continue;
+        }
+        // All or nothing: an executor runs either from its materialized
+        // input tables or from the pipeline.
+        const std::vector<AbstractPlanNode*>& children = executor->getPlanNode()->getChildren();
+        bool pipelined = ! children.empty();
+        BOOST_FOREACH (AbstractPlanNode* child, children) {
+            pipelined = pipelined && canPipelineOutput(child);
+        }
+        if ( ! pipelined) {
+            continue;
+        }
+        BOOST_FOREACH (AbstractPlanNode* child, children) {
+            executor->pipelineFrom(child->getExecutor());
+        }
+    }
+}
+
 std::string ExecutorVector::debug() const {
     std::ostringstream oss;
     std::map<int, std::vector<AbstractExecutor*>* >::const_iterator it;
@@ -135,6 +135,13 @@ private:
 
     void initPlanNode(VoltDBEngine* engine, AbstractPlanNode* node);
 
+    /**
+     * Connect each executor that can take pipelined input to the
+     * children that can produce it, so that their rows go directly from
+     * one to the other without being stored in between.
+     */
+    void setupPipelines(const std::vector<AbstractExecutor*>& executorList);
+
     const int64_t m_fragId;
     std::map<int, std::vector<AbstractExecutor*>* > m_subplanExecListMap;
     TempTableLimits m_limits;
@@ -66,7 +66,13 @@ class JNILocalFrameBarrier {
     }
 };
 
-JNITopend::JNITopend(JNIEnv *env, jobject caller) : m_jniEnv(env), m_javaExecutionEngine(caller) {
+JNITopend::JNITopend(JNIEnv *env, jobject caller) : m_jniEnv(env), m_javaVM(NULL), m_javaExecutionEngine(caller) {
+    if (m_jniEnv->GetJavaVM(&m_javaVM) != JNI_OK) {
+        // Without the VM we cannot call into Java off the site thread,
+        // so large temp table blocks just won't be prefetched.
+        m_javaVM = NULL;
+    }
+
     // Cache the method id for better performance. It is valid until the JVM unloads the class:
     // http://java.sun.com/javase/6/docs/technotes/guides/jni/spec/design.html#wp17074
     jclass jniClass = m_jniEnv->GetObjectClass(m_javaExecutionEngine);
@@ -429,8 +435,12 @@ bool JNITopend::storeLargeTempTableBlock(LargeTempTableBlock* block) {
         throw std::exception();
     }
 
+    // The block may have been compressed, in which case only the
+    // compressed image is written.  Loads still get a full sized
+    // buffer, which the block expands the image out of.
+    int64_t storedSize = block->storedDataSize();
     std::unique_ptr<char[]> storage = block->releaseData();
-    jobject blockByteBuffer = m_jniEnv->NewDirectByteBuffer(storage.get(), LargeTempTableBlock::BLOCK_SIZE_IN_BYTES);
+    jobject blockByteBuffer = m_jniEnv->NewDirectByteBuffer(storage.get(), storedSize);
     if (blockByteBuffer == NULL) {
         m_jniEnv->ExceptionDescribe();
         throw std::exception();
@@ -470,7 +480,8 @@ bool JNITopend::loadLargeTempTableBlock(LargeTempTableBlock* block) {
 
     int64_t origAddress = m_jniEnv->CallLongMethod(m_javaExecutionEngine,
                                                    m_loadLargeTempTableBlockMID,
-                                                   block->id(),
+                                                   block->id().getSiteId(),
+                                                   block->id().getBlockCounter(),
                                                    blockByteBuffer);
     if (origAddress != 0) {
         block->setData(reinterpret_cast<char*>(origAddress), std::move(storage));
@@ -479,6 +490,52 @@ bool JNITopend::loadLargeTempTableBlock(LargeTempTableBlock* block) {
     return origAddress != 0;
 }
 
+char* JNITopend::readLargeTempTableBlock(LargeTempTableBlockId blockId, char* storage) {
+    if (m_javaVM == NULL) {
+        return NULL;
+    }
+
+    // This runs on the LTT block cache's prefetch thread, which needs
+    // its own JNIEnv.  Attach for the duration of the call only, so
+    // the thread never exits while still attached.
+    JNIEnv* env = NULL;
+    bool attached = false;
+    if (m_javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_EDETACHED) {
+        if (m_javaVM->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(&env), NULL) != JNI_OK) {
+            return NULL;
+        }
+        attached = true;
+    }
+
+    int64_t origAddress = 0;
+    {
+        JNILocalFrameBarrier jni_frame = JNILocalFrameBarrier(env, 1);
+        if (jni_frame.checkResult() == 0) {
+            jobject blockByteBuffer = env->NewDirectByteBuffer(storage, LargeTempTableBlock::BLOCK_SIZE_IN_BYTES);
+            if (blockByteBuffer != NULL) {
+                origAddress = env->CallLongMethod(m_javaExecutionEngine,
+                                                  m_loadLargeTempTableBlockMID,
+                                                  blockId.getSiteId(),
+                                                  blockId.getBlockCounter(),
+                                                  blockByteBuffer);
+            }
+        }
+
+        if (env->ExceptionCheck()) {
+            // The site thread will retry synchronously and report
+            // the failure there.
+            env->ExceptionClear();
+            origAddress = 0;
+        }
+    }
+
+    if (attached) {
+        m_javaVM->DetachCurrentThread();
+    }
+
+    return reinterpret_cast<char*>(origAddress);
+}
+
 bool JNITopend::releaseLargeTempTableBlock(LargeTempTableBlockId blockId) {
     jboolean success = (jboolean)m_jniEnv->CallBooleanMethod(m_javaExecutionEngine,
                                                              m_releaseLargeTempTableBlockMID,
@@ -75,12 +75,22 @@ public:
 
     bool releaseLargeTempTableBlock(LargeTempTableBlockId blockId);
 
+    bool canPrefetchLargeTempTableBlocks() {
+        return m_javaVM != NULL;
+    }
+
+    char* readLargeTempTableBlock(LargeTempTableBlockId blockId, char* storage);
+
     int32_t callJavaUserDefinedFunction();
     void resizeUDFBuffer(int32_t size);
 
 private:
     JNIEnv *m_jniEnv;
 
+    /** Used to attach the LTT block prefetch thread, which may not
+        use m_jniEnv. */
+    JavaVM *m_javaVM;
+
     /**
      * JNI object corresponding to this engine. for callback functions.
      * if this is NULL, VoltDBEngine will fail to call sendDependency().
@@ -111,6 +111,7 @@
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <locale>
 #include <typeinfo>
@@ -165,11 +166,15 @@ class EnginePlanSet : public PlanSet { };
 
 int64_t VoltDBEngine::s_loadTableResult = 0;
 
+// Default time each tick may spend on incremental compaction.
+static const int64_t DEFAULT_COMPACTION_PAUSE_BUDGET_MICROS = 1000;
+
 VoltDBEngine::VoltDBEngine(Topend* topend, LogProxy* logProxy)
     : m_currentIndexInBatch(-1),
       m_currentUndoQuantum(NULL),
       m_siteId(-1),
       m_isLowestSite(false),
+      m_planNodeProfiling(false),
       m_partitionId(-1),
       m_hashinator(NULL),
       m_isActiveActiveDREnabled(false),
@@ -180,6 +185,7 @@ VoltDBEngine::VoltDBEngine(Topend* topend, LogProxy* logProxy)
       m_templateSingleLongTable(NULL),
       m_topend(topend),
       m_executorContext(NULL),
+      m_compactionPauseBudgetMicros(DEFAULT_COMPACTION_PAUSE_BUDGET_MICROS),
       m_drPartitionedConflictStreamedTable(NULL),
       m_drReplicatedConflictStreamedTable(NULL),
       m_drStream(NULL),
@@ -199,7 +205,9 @@ VoltDBEngine::initialize(int32_t clusterIndex,
                          int32_t defaultDrBufferSize,
                          int64_t tempTableMemoryLimit,
                          bool isLowestSiteId,
-                         int32_t compactionThreshold)
+                         int32_t compactionThreshold,
+                         int64_t compactionPauseBudgetMicros,
+                         AllocationPolicy::HugePages hugePages)
 {
     m_clusterIndex = clusterIndex;
     m_siteId = siteId;
@@ -207,6 +215,20 @@ VoltDBEngine::initialize(int32_t clusterIndex,
     m_partitionId = partitionId;
     m_tempTableMemoryLimit = tempTableMemoryLimit;
     m_compactionThreshold = compactionThreshold;
+    m_compactionPauseBudgetMicros = compactionPauseBudgetMicros;
+
+    // On a host with several NUMA nodes, keep the tuple blocks and pool
+    // pages this site allocates on the node its thread starts on.
+    int32_t numaNode = -1;
+    if (ThreadLocalPool::getNumaNodeCount() > 1) {
+        numaNode = ThreadLocalPool::getCurrentNumaNode();
+    }
+    AllocationPolicy allocationPolicy(numaNode, hugePages);
+    if ( ! allocationPolicy.isDefault()) {
+        ThreadLocalPool::setAllocationPolicy(allocationPolicy);
+        VOLT_DEBUG("Site %jd allocates from NUMA node %d with huge page mode %d",
+                   (intmax_t)siteId, numaNode, static_cast<int>(hugePages));
+    }
 
     // Instantiate our catalog - it will be populated later on by load()
     m_catalog.reset(new catalog::Catalog());
@@ -470,6 +492,7 @@ int VoltDBEngine::executePlanFragments(int32_t numFragments,
         for (int j = 0; j < usedParamcnt; ++j) {
             params[j].deserializeFromAllocateForStorage(serialInput, &m_stringPool);
         }
+        m_executorContext->advanceParameterGeneration();
 
         if (perFragmentTimingEnabled) {
             startTime = std::chrono::high_resolution_clock::now();
@@ -2095,6 +2118,43 @@ void VoltDBEngine::tick(int64_t timeInMillis, int64_t lastCommittedSpHandle) {
     if (m_executorContext->drReplicatedStream()) {
         m_executorContext->drReplicatedStream()->periodicFlush(timeInMillis, lastCommittedSpHandle);
     }
+
+    doIncrementalCompaction();
+}
+
+int64_t VoltDBEngine::doIncrementalCompaction() {
+    // Ticks can arrive while a transaction is still open. Its insert and
+    // update undo actions hold the addresses of the tuples they changed,
+    // and compaction moves tuples, so wait until every quantum is gone.
+    if (m_compactionPauseBudgetMicros <= 0 || m_undoLog.hasPendingQuantums()) {
+        return 0;
+    }
+    typedef std::pair<int32_t, PersistentTable*> FragmentedTable;
+    std::vector<FragmentedTable> candidates;
+    BOOST_FOREACH (LabeledTCD delegatePair, m_catalogDelegates) {
+        PersistentTable* table = delegatePair.second->getPersistentTable();
+        // Replicated tables are shared by all sites and are only
+        // compacted under the replicated table lock.
+        if (table == NULL || table->isReplicatedTable() || !table->incrementalCompactionPredicate()) {
+            continue;
+        }
+        candidates.push_back(std::make_pair(table->fragmentationPercent(), table));
+    }
+    // most fragmented first
+    std::sort(candidates.rbegin(), candidates.rend());
+
+    int64_t tuplesMoved = 0;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    BOOST_FOREACH (FragmentedTable& candidate, candidates) {
+        int64_t remainingMicros = m_compactionPauseBudgetMicros -
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - startTime).count();
+        if (remainingMicros <= 0) {
+            break;
+        }
+        tuplesMoved += candidate.second->doIncrementalCompaction(INT64_MAX, remainingMicros);
+    }
+    return tuplesMoved;
 }
 
 /** Bring the Export and DR system to a steady state with no pending committed data */
@@ -2154,6 +2214,10 @@ int VoltDBEngine::getStats(int selector, int locators[], int numLocators,
 
     for (int ii = 0; ii < numLocators; ii++) {
         CatalogId locator = static_cast<CatalogId>(locators[ii]);
+        if (selector == STATISTICS_SELECTOR_TYPE_PLANNODE) {
+            // Plan node stats are not kept per table; see below.
+            break;
+        }
         if ( ! getTableById(locator)) {
             char message[256];
             snprintf(message, 256,  "getStats() called with selector %d, and"
@@ -2180,6 +2244,16 @@ int VoltDBEngine::getStats(int selector, int locators[], int numLocators,
                     m_siteId, m_partitionId,
                     locatorIds, interval, now);
             break;
+        case STATISTICS_SELECTOR_TYPE_PLANNODE:
+            // Each plan node of each fragment has its own CatalogId
+            // (see PlanNodeStats::statsId), and they are reported all
+            // together.
+            resultTable = m_statsManager.getStats(
+                    (StatisticsSelectorType) selector,
+                    m_siteId, m_partitionId,
+                    m_statsManager.getRegisteredCatalogIds(STATISTICS_SELECTOR_TYPE_PLANNODE),
+                    interval, now);
+            break;
         default:
             char message[256];
             snprintf(message, 256, "getStats() called with an unrecognized selector"
@@ -142,7 +142,9 @@ class __attribute__((visibility("default"))) VoltDBEngine {
                         int32_t defaultDrBufferSize,
                         int64_t tempTableMemoryLimit,
                         bool createDrReplicatedStream,
-                        int32_t compactionThreshold = 95);
+                        int32_t compactionThreshold = 95,
+                        int64_t compactionPauseBudgetMicros = 1000,
+                        AllocationPolicy::HugePages hugePages = AllocationPolicy::HUGE_PAGES_NONE);
         virtual ~VoltDBEngine();
 
         // ------------------------------------------------------------------
@@ -384,6 +386,19 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         /** Perform once per second, non-transactional work. */
         void tick(int64_t timeInMillis, int64_t lastCommittedSpHandle);
 
+        /**
+         * Compact this site's partitioned tables, most fragmented first,
+         * for no longer than the compaction pause budget. Run from tick();
+         * does nothing while any undo quantum is unreleased. Returns the
+         * number of tuples moved.
+         */
+        int64_t doIncrementalCompaction();
+
+        /** How long one round of incremental compaction may hold the site; 0 disables it. */
+        int64_t getCompactionPauseBudget() const {
+            return m_compactionPauseBudgetMicros;
+        }
+
         /** flush active work (like EL buffers) */
         void quiesce(int64_t lastCommittedSpHandle);
 
@@ -447,6 +462,15 @@ class __attribute__((visibility("default"))) VoltDBEngine {
 
         void setLowestSiteForTest() { m_isLowestSite = true; }
 
+        /**
+         * Turn per plan node profiling on or off.  While it is on, every executor
+         * records its elapsed time and tuple counts in a PlanNodeStats source that
+         * is reported through getStats() with STATISTICS_SELECTOR_TYPE_PLANNODE.
+         */
+        void setPlanNodeProfiling(bool enabled) { m_planNodeProfiling = enabled; }
+
+        bool isPlanNodeProfiling() const { return m_planNodeProfiling; }
+
         /**
          * Activate a table stream of the specified type for the specified table.
          * Returns true on success and false on failure
@@ -602,6 +626,9 @@ class __attribute__((visibility("default"))) VoltDBEngine {
 
         bool m_isLowestSite;
 
+        /** True if executors should record PlanNodeStats as they run */
+        bool m_planNodeProfiling;
+
         int32_t m_partitionId;
 
         int32_t m_clusterIndex;
@@ -771,6 +798,8 @@ class __attribute__((visibility("default"))) VoltDBEngine {
 
         int32_t m_compactionThreshold;
 
+        int64_t m_compactionPauseBudgetMicros;
+
         /*
          * DR conflict streamed tables
          */
@@ -0,0 +1,170 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "executors/PlanNodeStats.h"
+
+#include "storage/tablefactory.h"
+#include "storage/temptable.h"
+
+using namespace voltdb;
+using namespace std;
+
+vector<string> PlanNodeStats::generatePlanNodeStatsColumnNames() {
+    vector<string> columnNames = StatsSource::generateBaseStatsColumnNames();
+    columnNames.push_back("PLAN_FRAGMENT_ID");
+    columnNames.push_back("PLAN_NODE_ID");
+    columnNames.push_back("PLAN_NODE_TYPE");
+    columnNames.push_back("INVOCATIONS");
+    columnNames.push_back("ELAPSED_NANOS");
+    columnNames.push_back("TUPLES_IN");
+    columnNames.push_back("TUPLES_OUT");
+    columnNames.push_back("TEMP_TABLE_BYTES");
+    columnNames.push_back("INDEX_PROBES");
+    columnNames.push_back("BLOOM_FILTER_HITS");
+    columnNames.push_back("BLOOM_FILTER_MISSES");
+    return columnNames;
+}
+
+void PlanNodeStats::populatePlanNodeStatsSchema(
+        vector<ValueType> &types,
+        vector<int32_t> &columnLengths,
+        vector<bool> &allowNull,
+        vector<bool> &inBytes) {
+    StatsSource::populateBaseSchema(types, columnLengths, allowNull, inBytes);
+
+    // plan fragment id
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+    inBytes.push_back(false);
+
+    // plan node id
+    types.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    allowNull.push_back(false);
+    inBytes.push_back(false);
+
+    // plan node type
+    types.push_back(VALUE_TYPE_VARCHAR);
+    columnLengths.push_back(64);
+    allowNull.push_back(false);
+    inBytes.push_back(false);
+
+    // invocations, elapsed nanos, tuples in, tuples out, temp table bytes,
+    // index probes, bloom filter hits and misses
+    for (int i = 0; i < 8; ++i) {
+        types.push_back(VALUE_TYPE_BIGINT);
+        columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        allowNull.push_back(false);
+        inBytes.push_back(false);
+    }
+}
+
+TempTable* PlanNodeStats::generateEmptyPlanNodeStatsTable() {
+    string name = "Plan node stats temp table";
+    vector<string> columnNames = PlanNodeStats::generatePlanNodeStatsColumnNames();
+    vector<ValueType> columnTypes;
+    vector<int32_t> columnLengths;
+    vector<bool> columnAllowNull;
+    vector<bool> columnInBytes;
+    PlanNodeStats::populatePlanNodeStatsSchema(columnTypes, columnLengths,
+                                               columnAllowNull, columnInBytes);
+    TupleSchema *schema =
+        TupleSchema::createTupleSchema(columnTypes, columnLengths,
+                                       columnAllowNull, columnInBytes);
+    return TableFactory::buildTempTable(name,
+                                        schema,
+                                        columnNames,
+                                        NULL);
+}
+
+PlanNodeStats::PlanNodeStats(int64_t fragmentId, int32_t planNodeId, PlanNodeType planNodeType)
+    : StatsSource(), m_fragmentId(fragmentId), m_planNodeId(planNodeId),
+      m_invocations(0), m_elapsedNanos(0), m_tuplesIn(0), m_tuplesOut(0),
+      m_tempTableBytes(0), m_indexProbes(0), m_bloomFilterHits(0), m_bloomFilterMisses(0),
+      m_lastInvocations(0), m_lastElapsedNanos(0), m_lastTuplesIn(0), m_lastTuplesOut(0),
+      m_lastTempTableBytes(0), m_lastIndexProbes(0), m_lastBloomFilterHits(0),
+      m_lastBloomFilterMisses(0)
+{
+    StatsSource::configure("Plan node stats");
+    m_planNodeType = ValueFactory::getStringValue(planNodeToString(planNodeType));
+    // There is no table, but the stats agent logs this name.
+    m_tableName = ValueFactory::getStringValue(planNodeToString(planNodeType));
+}
+
+PlanNodeStats::~PlanNodeStats() {
+    m_planNodeType.free();
+    m_tableName.free();
+}
+
+vector<string> PlanNodeStats::generateStatsColumnNames() {
+    return PlanNodeStats::generatePlanNodeStatsColumnNames();
+}
+
+/**
+ * Update the stats tuple with the latest statistics available to this StatsSource.
+ */
+void PlanNodeStats::updateStatsTuple(TableTuple *tuple) {
+    int64_t invocations = m_invocations;
+    int64_t elapsedNanos = m_elapsedNanos;
+    int64_t tuplesIn = m_tuplesIn;
+    int64_t tuplesOut = m_tuplesOut;
+    int64_t tempTableBytes = m_tempTableBytes;
+    int64_t indexProbes = m_indexProbes;
+    int64_t bloomFilterHits = m_bloomFilterHits;
+    int64_t bloomFilterMisses = m_bloomFilterMisses;
+
+    if (interval()) {
+        invocations -= m_lastInvocations;
+        elapsedNanos -= m_lastElapsedNanos;
+        tuplesIn -= m_lastTuplesIn;
+        tuplesOut -= m_lastTuplesOut;
+        tempTableBytes -= m_lastTempTableBytes;
+        indexProbes -= m_lastIndexProbes;
+        bloomFilterHits -= m_lastBloomFilterHits;
+        bloomFilterMisses -= m_lastBloomFilterMisses;
+        m_lastInvocations = m_invocations;
+        m_lastElapsedNanos = m_elapsedNanos;
+        m_lastTuplesIn = m_tuplesIn;
+        m_lastTuplesOut = m_tuplesOut;
+        m_lastTempTableBytes = m_tempTableBytes;
+        m_lastIndexProbes = m_indexProbes;
+        m_lastBloomFilterHits = m_bloomFilterHits;
+        m_lastBloomFilterMisses = m_bloomFilterMisses;
+    }
+
+    tuple->setNValue(m_columnName2Index["PLAN_FRAGMENT_ID"], ValueFactory::getBigIntValue(m_fragmentId));
+    tuple->setNValue(m_columnName2Index["PLAN_NODE_ID"], ValueFactory::getIntegerValue(m_planNodeId));
+    tuple->setNValue(m_columnName2Index["PLAN_NODE_TYPE"], m_planNodeType);
+    tuple->setNValue(m_columnName2Index["INVOCATIONS"], ValueFactory::getBigIntValue(invocations));
+    tuple->setNValue(m_columnName2Index["ELAPSED_NANOS"], ValueFactory::getBigIntValue(elapsedNanos));
+    tuple->setNValue(m_columnName2Index["TUPLES_IN"], ValueFactory::getBigIntValue(tuplesIn));
+    tuple->setNValue(m_columnName2Index["TUPLES_OUT"], ValueFactory::getBigIntValue(tuplesOut));
+    tuple->setNValue(m_columnName2Index["TEMP_TABLE_BYTES"], ValueFactory::getBigIntValue(tempTableBytes));
+    tuple->setNValue(m_columnName2Index["INDEX_PROBES"], ValueFactory::getBigIntValue(indexProbes));
+    tuple->setNValue(m_columnName2Index["BLOOM_FILTER_HITS"], ValueFactory::getBigIntValue(bloomFilterHits));
+    tuple->setNValue(m_columnName2Index["BLOOM_FILTER_MISSES"], ValueFactory::getBigIntValue(bloomFilterMisses));
+}
+
+void PlanNodeStats::populateSchema(
+        vector<ValueType> &types,
+        vector<int32_t> &columnLengths,
+        vector<bool> &allowNull,
+        vector<bool> &inBytes)
+{
+    PlanNodeStats::populatePlanNodeStatsSchema(types, columnLengths, allowNull, inBytes);
+}
@@ -0,0 +1,141 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLANNODESTATS_H_
+#define PLANNODESTATS_H_
+
+#include "common/ids.h"
+#include "common/types.h"
+#include "stats/StatsSource.h"
+
+namespace voltdb {
+class TempTable;
+
+/**
+ * Execution counters for one plan node of one plan fragment, collected by
+ * AbstractExecutor::execute while plan node profiling is turned on (see
+ * VoltDBEngine::setPlanNodeProfiling) and reported through the
+ * STATISTICS_SELECTOR_TYPE_PLANNODE stats selector.
+ *
+ * Elapsed time covers the executor's own work, since its children run
+ * before it does, plus any subqueries it evaluates. Tuples in counts the
+ * rows of the node's input tables or, for a leaf node that scans a
+ * persistent table, the tuples it reported processing to the progress
+ * monitor, which counts the rows it examined and those it emitted. Temp
+ * table bytes is how much the node's output grew the fragment's temp table
+ * memory. Bloom filter hits and misses count the index probes a join let
+ * through or skipped because of its Bloom filter.
+ */
+class PlanNodeStats : public StatsSource {
+public:
+    /**
+     * Static method to generate the column names for the tables which
+     * contain plan node stats.
+     */
+    static std::vector<std::string> generatePlanNodeStatsColumnNames();
+
+    /**
+     * Static method to generate the remaining schema information for
+     * the tables which contain plan node stats.
+     */
+    static void populatePlanNodeStatsSchema(std::vector<voltdb::ValueType>& types,
+                                            std::vector<int32_t>& columnLengths,
+                                            std::vector<bool>& allowNull,
+                                            std::vector<bool>& inBytes);
+
+    static TempTable* generateEmptyPlanNodeStatsTable();
+
+    /**
+     * The CatalogId to register the stats of a plan node under, so that
+     * each plan node of each fragment has its own entry in the StatsAgent.
+     * The fragment id takes the high bits and the plan node id the low 16.
+     */
+    static CatalogId statsId(int64_t fragmentId, int32_t planNodeId)
+    {
+        return static_cast<CatalogId>((fragmentId << 16) | (planNodeId & 0xFFFF));
+    }
+
+    PlanNodeStats(int64_t fragmentId, int32_t planNodeId, PlanNodeType planNodeType);
+
+    ~PlanNodeStats();
+
+    /**
+     * Add one execution of the plan node.
+     */
+    void recordExecution(int64_t elapsedNanos, int64_t tuplesIn, int64_t tuplesOut,
+                         int64_t tempTableBytes, int64_t indexProbes,
+                         int64_t bloomFilterHits, int64_t bloomFilterMisses)
+    {
+        ++m_invocations;
+        m_elapsedNanos += elapsedNanos;
+        m_tuplesIn += tuplesIn;
+        m_tuplesOut += tuplesOut;
+        m_tempTableBytes += tempTableBytes;
+        m_indexProbes += indexProbes;
+        m_bloomFilterHits += bloomFilterHits;
+        m_bloomFilterMisses += bloomFilterMisses;
+    }
+
+protected:
+
+    /**
+     * Update the stats tuple with the latest statistics available to this StatsSource.
+     */
+    virtual void updateStatsTuple(TableTuple *tuple);
+
+    /**
+     * Generates the list of column names that will be in the statTable_. Derived classes must override this method and call
+     * the parent class's version to obtain the list of columns contributed by ancestors and then append the columns they will be
+     * contributing to the end of the list.
+     */
+    virtual std::vector<std::string> generateStatsColumnNames();
+
+    /**
+     * Same pattern as generateStatsColumnNames except the return value is used as an offset into the tuple schema instead of appending to
+     * end of a list.
+     */
+    virtual void populateSchema(std::vector<voltdb::ValueType> &types, std::vector<int32_t> &columnLengths,
+            std::vector<bool> &allowNull, std::vector<bool> &inBytes);
+
+private:
+    const int64_t m_fragmentId;
+    const int32_t m_planNodeId;
+    voltdb::NValue m_planNodeType;
+
+    int64_t m_invocations;
+    int64_t m_elapsedNanos;
+    int64_t m_tuplesIn;
+    int64_t m_tuplesOut;
+    int64_t m_tempTableBytes;
+    int64_t m_indexProbes;
+    int64_t m_bloomFilterHits;
+    int64_t m_bloomFilterMisses;
+
+    // counters as of the last interval poll
+    int64_t m_lastInvocations;
+    int64_t m_lastElapsedNanos;
+    int64_t m_lastTuplesIn;
+    int64_t m_lastTuplesOut;
+    int64_t m_lastTempTableBytes;
+    int64_t m_lastIndexProbes;
+    int64_t m_lastBloomFilterHits;
+    int64_t m_lastBloomFilterMisses;
+};
+
+}
+
+#endif /* PLANNODESTATS_H_ */
@@ -43,11 +43,13 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <chrono>
 #include <sstream>
 #include <vector>
 
 #include "abstractexecutor.h"
 
+#include "executors/PlanNodeStats.h"
 #include "plannodes/abstractoperationnode.h"
 #include "plannodes/abstractscannode.h"
 #include "storage/tablefactory.h"
@@ -60,6 +62,7 @@ bool AbstractExecutor::init(VoltDBEngine* engine,
                             const ExecutorVector& executorVector)
 {
     assert (m_abstractNode);
+    m_fragmentId = executorVector.getFragId();
 
     //
     // Grab the input tables directly from this node's children
@@ -183,7 +186,77 @@ void AbstractExecutor::setDMLCountOutputTable(TempTableLimits* limits) {
     m_abstractNode->setOutputTable(m_tmpOutputTable);
 }
 
-AbstractExecutor::~AbstractExecutor() {}
+void AbstractExecutor::pipelineFrom(AbstractExecutor* child)
+{
+    TempTable* childOutput = dynamic_cast<TempTable*>(child->getPlanNode()->getOutputTable());
+    assert(childOutput != NULL);
+    assert(child->m_pipelinedParent == NULL);
+    childOutput->setPipelineConsumer(this);
+    child->m_pipelinedParent = this;
+    m_hasPipelinedInput = true;
+}
+
+bool AbstractExecutor::profiledExecute(const NValueArray& params)
+{
+    AbstractPlanNode* planNode = getPlanNode();
+    ProgressStats& progress = m_engine->getExecutorContext()->m_progressStats;
+    const TempTableLimits* limits =
+        m_tmpOutputTable == NULL ? NULL : m_tmpOutputTable->getTempTableLimits();
+
+    int64_t tuplesReportedBefore =
+        progress.TuplesProcessedInFragment + progress.TuplesProcessedSinceReport;
+    int64_t allocatedBefore = limits == NULL ? 0 : limits->getAllocated();
+    int64_t indexProbesBefore = m_indexProbes;
+    int64_t bloomFilterHitsBefore = m_bloomFilterHits;
+    int64_t bloomFilterMissesBefore = m_bloomFilterMisses;
+    std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
+
+    bool executorSucceeded = executeOrFinishPipeline(params);
+
+    int64_t elapsedNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now() - start).count();
+
+    // Input tables are still populated here; execute() clears them
+    // after this returns.
+    int64_t tuplesIn = 0;
+    size_t inputTableCount = planNode->getInputTableCount();
+    for (size_t i = 0; i < inputTableCount; ++i) {
+        tuplesIn += planNode->getInputTable(i)->activeTupleCount();
+    }
+    if (inputTableCount == 0) {
+        tuplesIn = progress.TuplesProcessedInFragment + progress.TuplesProcessedSinceReport
+                - tuplesReportedBefore;
+    }
+    int64_t tuplesOut = m_tmpOutputTable == NULL ? 0 : m_tmpOutputTable->activeTupleCount();
+    int64_t tempTableBytes = limits == NULL ? 0 : limits->getAllocated() - allocatedBefore;
+    if (tempTableBytes < 0) {
+        tempTableBytes = 0;
+    }
+
+    if (m_planNodeStats == NULL) {
+        m_planNodeStats = new PlanNodeStats(m_fragmentId,
+                                            planNode->getPlanNodeId(),
+                                            planNode->getPlanNodeType());
+        m_engine->getStatsManager().registerStatsSource(STATISTICS_SELECTOR_TYPE_PLANNODE,
+                                                        PlanNodeStats::statsId(m_fragmentId,
+                                                                               planNode->getPlanNodeId()),
+                                                        m_planNodeStats);
+    }
+    m_planNodeStats->recordExecution(elapsedNanos, tuplesIn, tuplesOut,
+                                     tempTableBytes, m_indexProbes - indexProbesBefore,
+                                     m_bloomFilterHits - bloomFilterHitsBefore,
+                                     m_bloomFilterMisses - bloomFilterMissesBefore);
+    return executorSucceeded;
+}
+
+AbstractExecutor::~AbstractExecutor() {
+    if (m_planNodeStats != NULL) {
+        m_engine->getStatsManager().unregisterStatsSource(STATISTICS_SELECTOR_TYPE_PLANNODE,
+                                                          m_planNodeStats);
+        delete m_planNodeStats;
+    }
+}
 
 AbstractExecutor::TupleComparer::TupleComparer(const std::vector<AbstractExpression*>& keys,
     const std::vector<SortDirectionType>& dirs) : m_keys(keys), m_dirs(dirs), m_keyCount(keys.size())
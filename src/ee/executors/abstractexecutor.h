@@ -52,6 +52,7 @@
 #include "execution/VoltDBEngine.h"
 #include "plannodes/abstractplannode.h"
 #include "storage/AbstractTempTable.hpp"
+#include "storage/temptable.h"
 #include "common/SynchronizedThreadLock.h"
 
 #include <cassert>
@@ -61,13 +62,14 @@ namespace voltdb {
 
 class AbstractExpression;
 class ExecutorVector;
+class PlanNodeStats;
 class TempTableLimits;
 class VoltDBEngine;
 
 /**
  * AbstractExecutor provides the API for initializing and invoking executors.
  */
-class AbstractExecutor {
+class AbstractExecutor : public TempTableConsumer {
   public:
     virtual ~AbstractExecutor();
 
@@ -96,8 +98,29 @@ class AbstractExecutor {
             VOLT_TRACE("Clearing output table...");
             m_tmpOutputTable->deleteAllTempTuples();
         }
+        // A failed execution may not have got as far as finishing
+        // the pipeline this executor is fed by.
+        m_pipelineStarted = false;
     }
 
+    /**
+     * Executors that can process their input a tuple at a time, as their
+     * children produce it, return true.  ExecutorVector then connects
+     * them to their children with pipelineFrom() where it can, so that the
+     * intermediate rows are never stored in a temp table.
+     */
+    virtual bool supportsPipelinedInput() const { return false; }
+
+    /**
+     * Have every tuple that child inserts into its output temp table
+     * passed directly to p_pipeline_tuple() on this executor.
+     */
+    void pipelineFrom(AbstractExecutor* child);
+
+    bool hasPipelinedInput() const { return m_hasPipelinedInput; }
+
+    void consumeTempTuple(TableTuple &tuple) { p_pipeline_tuple(tuple); }
+
     virtual void cleanupMemoryPool() {
         // LEAVE as blank on purpose
     }
@@ -137,6 +160,14 @@ class AbstractExecutor {
         m_tmpOutputTable = NULL;
         m_engine = engine;
         m_replicatedTableOperation = false;
+        m_fragmentId = 0;
+        m_indexProbes = 0;
+        m_bloomFilterHits = 0;
+        m_bloomFilterMisses = 0;
+        m_planNodeStats = NULL;
+        m_pipelinedParent = NULL;
+        m_hasPipelinedInput = false;
+        m_pipelineStarted = false;
     }
 
     /** Concrete executor classes implement initialization in p_init() */
@@ -146,6 +177,17 @@ class AbstractExecutor {
     /** Concrete executor classes implement execution in p_execute() */
     virtual bool p_execute(const NValueArray& params) = 0;
 
+    /**
+     * Executors that support pipelined input implement these instead of
+     * p_execute() for the times they run with it: p_pipeline_init() before
+     * the first child starts producing, p_pipeline_tuple() for each tuple
+     * a child inserts, and p_pipeline_finish() where p_execute() would
+     * otherwise have been called.
+     */
+    virtual void p_pipeline_init(const NValueArray& params) {}
+    virtual void p_pipeline_tuple(TableTuple& tuple) {}
+    virtual bool p_pipeline_finish() { return true; }
+
     /**
      * Set up a multi-column temporary output table for those executors that require one.
      * Called from p_init.
@@ -158,6 +200,26 @@ class AbstractExecutor {
      */
     void setDMLCountOutputTable(TempTableLimits* limits);
 
+    /**
+     * Index scanning executors call this once for each index lookup
+     * they perform, for the plan node profiler.
+     */
+    inline void countIndexProbe() { ++m_indexProbes; }
+
+    /**
+     * Joins that check a Bloom filter before probing an index call this
+     * with the filter's answer, for the plan node profiler.
+     */
+    inline void countBloomFilterProbe(bool mayMatch)
+    {
+        if (mayMatch) {
+            ++m_bloomFilterHits;
+        }
+        else {
+            ++m_bloomFilterMisses;
+        }
+    }
+
     // execution engine owns the plannode allocation.
     AbstractPlanNode* m_abstractNode;
     AbstractTempTable* m_tmpOutputTable;
@@ -167,16 +229,75 @@ class AbstractExecutor {
 
     /** when true, indicates that we should use the SynchronizedThreadLock for any OperationNode */
     bool m_replicatedTableOperation;
+
+  private:
+    /** Run p_execute() and add what it did to this plan node's PlanNodeStats */
+    bool profiledExecute(const NValueArray& params);
+
+    /** p_execute(), or the end of the pipeline if this executor is fed by one */
+    inline bool executeOrFinishPipeline(const NValueArray& params);
+
+    /** Start the pipeline this executor feeds, and any that one feeds in turn */
+    inline void startPipeline(const NValueArray& params);
+
+    int64_t m_fragmentId;
+    int64_t m_indexProbes;
+    int64_t m_bloomFilterHits;
+    int64_t m_bloomFilterMisses;
+
+    /** Created the first time this executor runs with profiling turned on */
+    PlanNodeStats* m_planNodeStats;
+
+    /** The executor this one's output is pipelined into, if any */
+    AbstractExecutor* m_pipelinedParent;
+    bool m_hasPipelinedInput;
+    /** Set once p_pipeline_init() has run for the current execution */
+    bool m_pipelineStarted;
 };
 
+inline void AbstractExecutor::startPipeline(const NValueArray& params)
+{
+    if (m_pipelineStarted) {
+        return;
+    }
+    m_pipelineStarted = true;
+    if (m_pipelinedParent != NULL) {
+        m_pipelinedParent->startPipeline(params);
+    }
+    p_pipeline_init(params);
+}
+
+inline bool AbstractExecutor::executeOrFinishPipeline(const NValueArray& params)
+{
+    if ( ! m_hasPipelinedInput) {
+        return p_execute(params);
+    }
+    // Normally a child has started the pipeline already.
+    startPipeline(params);
+    m_pipelineStarted = false;
+    return p_pipeline_finish();
+}
+
 
 inline bool AbstractExecutor::execute(const NValueArray& params)
 {
     AbstractPlanNode *planNode = getPlanNode();
     VOLT_TRACE("Starting execution of plannode(id=%d)...",  planNode->getPlanNodeId());
 
+    // Anything this executor outputs goes straight into its parent's
+    // pipeline, so the parent has to be ready for it.
+    if (m_pipelinedParent != NULL) {
+        m_pipelinedParent->startPipeline(params);
+    }
+
     // run the executor
-    bool executorSucceeded = p_execute(params);
+    bool executorSucceeded;
+    if (m_engine != NULL && m_engine->isPlanNodeProfiling()) {
+        executorSucceeded = profiledExecute(params);
+    }
+    else {
+        executorSucceeded = executeOrFinishPipeline(params);
+    }
 
     // For large queries, unpin the last tuple block so that it may be
     // stored on disk if needed.  (This is a no-op for normal temp
@@ -44,8 +44,11 @@
  */
 #include "abstractjoinexecutor.h"
 #include "executors/aggregateexecutor.h"
+#include "expressions/abstractexpression.h"
 #include "plannodes/abstractjoinnode.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace voltdb;
 
@@ -69,6 +72,58 @@ void AbstractJoinExecutor::p_init_null_tuples(Table* outer_table, Table* inner_t
     }
 }
 
+namespace {
+
+// Length in bytes of a variable-length key column.
+int32_t sizeInBytes(int32_t size, bool inBytes) {
+    return inBytes ? size : size * MAX_BYTES_PER_UTF8_CHARACTER;
+}
+
+}
+
+TupleSchema* AbstractJoinExecutor::constructJoinKeySchema(const std::vector<AbstractExpression*>& outerExprs,
+                                                          const std::vector<AbstractExpression*>& innerExprs)
+{
+    assert(outerExprs.size() == innerExprs.size());
+    std::vector<ValueType> keyColumnTypes;
+    std::vector<int32_t> keyColumnSizes;
+    std::vector<bool> keyColumnAllowNull;
+    std::vector<bool> keyColumnInBytes;
+    for (int ii = 0; ii < outerExprs.size(); ii++) {
+        AbstractExpression* outerExpr = outerExprs[ii];
+        AbstractExpression* innerExpr = innerExprs[ii];
+        ValueType outerType = outerExpr->getValueType();
+        ValueType innerType = innerExpr->getValueType();
+        if (outerType == innerType) {
+            int32_t size = std::max(outerExpr->getValueSize(), innerExpr->getValueSize());
+            bool inBytes = outerExpr->getInBytes();
+            if (outerExpr->getInBytes() != innerExpr->getInBytes()) {
+                size = std::max(sizeInBytes(outerExpr->getValueSize(), outerExpr->getInBytes()),
+                                sizeInBytes(innerExpr->getValueSize(), innerExpr->getInBytes()));
+                inBytes = true;
+            }
+            keyColumnTypes.push_back(outerType);
+            keyColumnSizes.push_back(size);
+            keyColumnInBytes.push_back(inBytes);
+        }
+        else if (isIntegralType(outerType) && isIntegralType(innerType)) {
+            keyColumnTypes.push_back(VALUE_TYPE_BIGINT);
+            keyColumnSizes.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+            keyColumnInBytes.push_back(false);
+        }
+        else {
+            VOLT_ERROR("Join key %d has mismatched types %s and %s", ii,
+                       getTypeName(outerType).c_str(), getTypeName(innerType).c_str());
+            return NULL;
+        }
+        keyColumnAllowNull.push_back(true);
+    }
+    return TupleSchema::createTupleSchema(keyColumnTypes,
+                                          keyColumnSizes,
+                                          keyColumnAllowNull,
+                                          keyColumnInBytes);
+}
+
 bool AbstractJoinExecutor::p_init(AbstractPlanNode* abstract_node,
                                   const ExecutorVector& executorVector)
 {
@@ -78,7 +133,8 @@ bool AbstractJoinExecutor::p_init(AbstractPlanNode* abstract_node,
     assert(node);
 
     m_joinType = node->getJoinType();
-    assert(m_joinType == JOIN_TYPE_INNER || m_joinType == JOIN_TYPE_LEFT || m_joinType == JOIN_TYPE_FULL);
+    assert(m_joinType == JOIN_TYPE_INNER || m_joinType == JOIN_TYPE_LEFT || m_joinType == JOIN_TYPE_FULL ||
+           m_joinType == JOIN_TYPE_SEMI || m_joinType == JOIN_TYPE_ANTI);
 
     // Create output table based on output schema from the plan
     setTempOutputTable(executorVector);
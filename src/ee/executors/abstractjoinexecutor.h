@@ -50,8 +50,11 @@
 #include "common/tabletuple.h"
 #include "executors/abstractexecutor.h"
 
+#include <vector>
+
 namespace voltdb {
 
+class AbstractExpression;
 class AbstractPlanNode;
 class AggregateExecutorBase;
 struct CountingPostfilter;
@@ -76,6 +79,12 @@ class AbstractJoinExecutor : public AbstractExecutor {
         // Write tuple to the output table
         void outputTuple(CountingPostfilter& postfilter, TableTuple& join_tuple, ProgressMonitorProxy& pmp);
 
+        // Build a schema for join keys whose columns can hold the values of both
+        // the outer and inner key expressions, so keys from either side hash and
+        // compare alike.  Returns NULL if some pair of key types is incompatible.
+        static TupleSchema* constructJoinKeySchema(const std::vector<AbstractExpression*>& outerExprs,
+                                                   const std::vector<AbstractExpression*>& innerExprs);
+
         JoinType m_joinType;
 
         StandAloneTupleStorage m_null_outer_tuple;
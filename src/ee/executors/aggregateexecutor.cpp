@@ -45,12 +45,20 @@
 
 #include "executors/aggregateexecutor.h"
 
+#include "common/LargeTempTableBlockCache.h"
+#include "common/executorcontext.hpp"
+#include "execution/ExecutorVector.h"
 #include "plannodes/aggregatenode.h"
 #include "plannodes/limitnode.h"
+#include "storage/LargeTempTable.h"
+#include "storage/tablefactory.h"
+#include "storage/TempTableLimits.h"
 #include "storage/temptable.h"
 
 #include "hyperloglog/hyperloglog.hpp" // for APPROX_COUNT_DISTINCT
 
+#include <sstream>
+
 namespace voltdb {
 /*
  * Type of the hash set used to check for column aggregate distinctness
@@ -128,6 +136,7 @@ public:
     // issues as inlined strings.
     SumAgg()
         : ifDistinct(NULL)
+        , m_summingDecimals(false)
     {
     }
 
@@ -136,6 +145,15 @@ public:
         if (val.isNull() || ifDistinct.excludeValue(val)) {
             return;
         }
+        // DECIMAL inputs are totalled in m_decimalSum until finalize,
+        // or until an input of another type turns up.
+        if (ValuePeeker::peekValueType(val) == VALUE_TYPE_DECIMAL && (m_summingDecimals || !m_haveAdvanced)) {
+            m_decimalSum.add(val);
+            m_summingDecimals = true;
+            m_haveAdvanced = true;
+            return;
+        }
+        flushDecimalSum();
         if (!m_haveAdvanced) {
             m_value = val;
             m_haveAdvanced = true;
@@ -147,12 +165,31 @@ public:
 
     virtual NValue finalize(ValueType type)
     {
+        flushDecimalSum();
         ifDistinct.clear();
         return Agg::finalize(type);
     }
 
+    virtual void resetAgg()
+    {
+        m_decimalSum.reset();
+        m_summingDecimals = false;
+        Agg::resetAgg();
+    }
+
 private:
+    void flushDecimalSum()
+    {
+        if (m_summingDecimals) {
+            m_value = m_decimalSum.value();
+            m_decimalSum.reset();
+            m_summingDecimals = false;
+        }
+    }
+
     D ifDistinct;
+    NValue::DecimalSum m_decimalSum;
+    bool m_summingDecimals;
 };
 
 
@@ -757,7 +794,68 @@ void AggregateExecutorBase::p_execute_finish()
     m_memoryPool.purge();
 }
 
-AggregateHashExecutor::~AggregateHashExecutor() {}
+namespace {
+
+// Bounds on the number of partitions a hash aggregation spills to.
+// Always a power of two.
+const int MIN_SPILL_PARTITIONS = 2;
+const int MAX_SPILL_PARTITIONS = 32;
+
+// Rough per-group cost of a hash map node and its bucket.
+const int64_t HASH_NODE_OVERHEAD = 48;
+
+// Check the memory used by the groups every this many new groups.
+const size_t MEMORY_CHECK_INTERVAL = 1024;
+
+// Spread the bits of a group key's hash, so that each spill level
+// can partition on bits of its own.
+inline uint64_t mixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+inline int log2OfPowerOfTwo(int n) {
+    int bits = 0;
+    while ((1 << bits) < n) {
+        ++bits;
+    }
+    return bits;
+}
+
+}
+
+AggregateHashExecutor::~AggregateHashExecutor() {
+    releaseSpillPartitions();
+}
+
+bool AggregateHashExecutor::p_init(AbstractPlanNode* abstractNode, const ExecutorVector& executorVector)
+{
+    if (!AggregateExecutorBase::p_init(abstractNode, executorVector)) {
+        return false;
+    }
+
+    // Only large queries have a large temp table block cache to spill to.
+    if (!executorVector.isLargeQuery()) {
+        return true;
+    }
+
+    // Every partition being written pins one block of the cache, and the
+    // scan of the input and the output table may pin one more each.
+    LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+    int partitionCount = MAX_SPILL_PARTITIONS;
+    while (partitionCount > lttBlockCache->maxCacheSizeInBlocks() - 3) {
+        partitionCount /= 2;
+    }
+    if (partitionCount >= MIN_SPILL_PARTITIONS) {
+        m_spillPartitionCount = partitionCount;
+        m_memoryBudget = executorVector.limits()->getMemoryLimit() / 2;
+    }
+    return true;
+}
 
 TableTuple AggregateHashExecutor::p_execute_init(const NValueArray& params,
                                                  ProgressMonitorProxy* pmp,
@@ -767,6 +865,8 @@ TableTuple AggregateHashExecutor::p_execute_init(const NValueArray& params,
 {
     VOLT_TRACE("hash aggregate executor init..");
     m_hash.clear();
+    releaseSpillPartitions();
+    m_spillLevel = 0;
 
     return AggregateExecutorBase::p_execute_init(params, pmp, schema, newTempTable, parentPostfilter);
 }
@@ -805,7 +905,21 @@ void AggregateHashExecutor::p_execute_tuple(const TableTuple& nextTuple) {
 
     // Group not found. Make a new entry in the hash for this new group.
     if (keyIter == m_hash.end()) {
+        if (!m_spillPartitions.empty()) {
+            // Memory is full, so this group is aggregated in a later pass.
+            spillTuple(nextTuple);
+            return;
+        }
+
         VOLT_TRACE("hash aggregate: new group..");
+        if (nextGroupByKeyTuple.nonInlinedDataIsVolatile()) {
+            // The key points into a large temp table block, which is
+            // released while the group is still in the hash.
+            for (int ii = 0; ii < m_groupByExpressions.size(); ii++) {
+                nextGroupByKeyTuple.setNValueAllocateForObjectCopies(ii, nextGroupByKeyTuple.getNValue(ii),
+                                                                     &m_memoryPool);
+            }
+        }
         aggregateRow = new (m_memoryPool, m_aggTypes.size()) AggregateRow();
         m_hash.insert(HashAggregateMapType::value_type(nextGroupByKeyTuple, aggregateRow));
 
@@ -815,10 +929,17 @@ void AggregateHashExecutor::p_execute_tuple(const TableTuple& nextTuple) {
         TableTuple passThroughTupleSource = TableTuple(storage, m_inputSchema);
 
         aggregateRow->recordPassThroughTuple(passThroughTupleSource, nextTuple);
+        if (nextTuple.nonInlinedDataIsVolatile()) {
+            aggregateRow->m_passThroughTuple.copyForPersistentInsert(nextTuple, &m_memoryPool);
+        }
         // The map is referencing the current key tuple for use by the new group,
         // so force a new tuple allocation to hold the next candidate key.
         nextGroupByKeyTuple.move(NULL);
 
+        if (m_memoryBudget > 0 && m_hash.size() % MEMORY_CHECK_INTERVAL == 0 && overMemoryBudget()) {
+            startSpilling();
+        }
+
         if (m_aggTypes.size() == 0) {
             insertOutputTuple(aggregateRow);
             return;
@@ -833,7 +954,35 @@ void AggregateHashExecutor::p_execute_tuple(const TableTuple& nextTuple) {
 
 void AggregateHashExecutor::p_execute_finish() {
     VOLT_TRACE("finalizing..");
+    outputGroups();
+    finishSpilling();
+
+    // Each spilled partition holds all the input of its groups, so it is
+    // aggregated in a pass of its own, which may spill again.
+    while (!m_pendingPartitions.empty() && m_postfilter.isUnderLimit()) {
+        LargeTempTable* partition = m_pendingPartitions.front().first;
+        m_spillLevel = m_pendingPartitions.front().second;
+        VOLT_DEBUG("hash aggregate: aggregating %ld spilled tuples at level %d",
+                   static_cast<long>(partition->activeTupleCount()), m_spillLevel);
+        {
+            TableTuple nextTuple(partition->schema());
+            TableIterator it = partition->iteratorDeletingAsWeGo();
+            while (it.next(nextTuple)) {
+                p_execute_tuple(nextTuple);
+            }
+        }
+        outputGroups();
+        finishSpilling();
+        m_pendingPartitions.pop_front();
+        partition->decrementRefcount();
+    }
 
+    // Clean up
+    releaseSpillPartitions();
+    m_spillLevel = 0;
+}
+
+void AggregateHashExecutor::outputGroups() {
     // If there is no aggregation, results are already inserted already
     if (m_aggTypes.size() != 0) {
         for (HashAggregateMapType::const_iterator iter = m_hash.begin(); iter != m_hash.end(); iter++) {
@@ -845,11 +994,76 @@ void AggregateHashExecutor::p_execute_finish() {
         }
     }
 
-    // Clean up
     m_hash.clear();
     AggregateExecutorBase::p_execute_finish();
 }
 
+bool AggregateHashExecutor::overMemoryBudget() {
+    int64_t bytes = m_memoryPool.getAllocatedMemory()
+        + static_cast<int64_t>(m_hash.size()) * HASH_NODE_OVERHEAD
+        + static_cast<int64_t>(m_hash.bucket_count() * sizeof(void*));
+    return bytes > m_memoryBudget;
+}
+
+void AggregateHashExecutor::startSpilling() {
+    assert(m_spillPartitions.empty());
+    int bitsPerLevel = log2OfPowerOfTwo(m_spillPartitionCount);
+    if ((m_spillLevel + 1) * bitsPerLevel > 64) {
+        // The hash has no bits left to tell the groups apart by.
+        VOLT_DEBUG("hash aggregate: not spilling beyond level %d", m_spillLevel);
+        return;
+    }
+
+    VOLT_DEBUG("hash aggregate: spilling new groups at level %d into %d partitions",
+               m_spillLevel, m_spillPartitionCount);
+    std::vector<std::string> columnNames;
+    for (int ii = 0; ii < m_inputSchema->columnCount(); ii++) {
+        std::ostringstream oss;
+        oss << "C" << ii;
+        columnNames.push_back(oss.str());
+    }
+    for (int ii = 0; ii < m_spillPartitionCount; ii++) {
+        LargeTempTable* partition =
+            TableFactory::buildLargeTempTable("HASHAGG_SPILL",
+                                              TupleSchema::createTupleSchema(m_inputSchema),
+                                              columnNames);
+        partition->incrementRefcount();
+        m_spillPartitions.push_back(partition);
+    }
+}
+
+void AggregateHashExecutor::spillTuple(const TableTuple& nextTuple) {
+    const TableTuple& nextGroupByKeyTuple = m_nextGroupByKeyStorage;
+    int bitsPerLevel = log2OfPowerOfTwo(m_spillPartitionCount);
+    uint64_t hash = mixHash(nextGroupByKeyTuple.hashCode()) >> (m_spillLevel * bitsPerLevel);
+    TableTuple tuple(nextTuple);
+    m_spillPartitions[hash & (m_spillPartitionCount - 1)]->insertTuple(tuple);
+}
+
+void AggregateHashExecutor::finishSpilling() {
+    BOOST_FOREACH(LargeTempTable* partition, m_spillPartitions) {
+        partition->finishInserts();
+        if (partition->activeTupleCount() == 0) {
+            partition->decrementRefcount();
+        }
+        else {
+            m_pendingPartitions.push_back(std::make_pair(partition, m_spillLevel + 1));
+        }
+    }
+    m_spillPartitions.clear();
+}
+
+void AggregateHashExecutor::releaseSpillPartitions() {
+    BOOST_FOREACH(LargeTempTable* partition, m_spillPartitions) {
+        partition->decrementRefcount();
+    }
+    m_spillPartitions.clear();
+    while (!m_pendingPartitions.empty()) {
+        m_pendingPartitions.front().first->decrementRefcount();
+        m_pendingPartitions.pop_front();
+    }
+}
+
 AggregateSerialExecutor::~AggregateSerialExecutor() {}
 
 
@@ -56,8 +56,12 @@
 #include "execution/ProgressMonitorProxy.h"
 #include "executors/executorutil.h"
 
+#include <deque>
+
 namespace voltdb {
 
+class LargeTempTable;
+
 /*
  * Base class for an individual aggregate that aggregates a specific
  * column for a group
@@ -272,9 +276,10 @@ class AggregateHashExecutor : public AggregateExecutorBase
 {
 public:
     AggregateHashExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node) :
-        AggregateExecutorBase(engine, abstract_node) { }
+        AggregateExecutorBase(engine, abstract_node),
+        m_memoryBudget(0), m_spillPartitionCount(0), m_spillLevel(0) { }
 
-    // empty destructor defined in .cpp file because of it is called virtually (not inline)
+    // destructor defined in .cpp file because of it is called virtually (not inline)
     // same reason for serial and partial
     ~AggregateHashExecutor();
 
@@ -284,9 +289,45 @@ public:
     void p_execute_tuple(const TableTuple& nextTuple);
     void p_execute_finish();
 
+    virtual void cleanupMemoryPool() {
+        releaseSpillPartitions();
+        AggregateExecutorBase::cleanupMemoryPool();
+    }
+
+protected:
+    virtual bool p_init(AbstractPlanNode*, const ExecutorVector& executorVector);
+
 private:
     virtual bool p_execute(const NValueArray& params);
+
+    /// Insert the groups held in memory into the output table and forget them.
+    void outputGroups();
+
+    /// Whether the groups held in memory have outgrown the memory budget.
+    bool overMemoryBudget();
+
+    /// Start sending the input tuples of groups not held in memory
+    /// to partitions that are aggregated in later passes.
+    void startSpilling();
+    void spillTuple(const TableTuple& nextTuple);
+
+    /// Queue the partitions written by the current pass.
+    void finishSpilling();
+    void releaseSpillPartitions();
+
     HashAggregateMapType m_hash;
+
+    // In large queries, when the groups held in memory use more than
+    // this many bytes, the input of any new group is spilled to large
+    // temp tables.  Zero if spilling is disabled.
+    int64_t m_memoryBudget;
+    int m_spillPartitionCount;
+    // How many times the input of the current pass has been spilled
+    int m_spillLevel;
+    // Partitions being written by the current pass
+    std::vector<LargeTempTable*> m_spillPartitions;
+    // Partitions waiting for a pass of their own, with their spill level
+    std::deque<std::pair<LargeTempTable*, int> > m_pendingPartitions;
 };
 
 /**
@@ -116,6 +116,8 @@ bool DeleteExecutor::p_execute(const NValueArray &params) {
                 assert(m_inputTable);
                 assert(m_inputTuple.columnCount() == m_inputTable->columnCount());
                 assert(targetTuple.columnCount() == targetTable->columnCount());
+                std::vector<TableTuple> targets;
+                targets.reserve(m_inputTable->tempTableTupleCount());
                 TableIterator inputIterator = m_inputTable->iterator();
                 while (inputIterator.next(m_inputTuple)) {
                     //
@@ -127,10 +129,10 @@ bool DeleteExecutor::p_execute(const NValueArray &params) {
                     //
                     void *targetAddress = m_inputTuple.getNValue(0).castAsAddress();
                     targetTuple.move(targetAddress);
-
-                    // Delete from target table
-                    targetTable->deleteTuple(targetTuple, true);
+                    targets.push_back(targetTuple);
                 }
+                // Delete from target table
+                targetTable->deleteTuples(targets, true);
                 modified_tuples = m_inputTable->tempTableTupleCount();
                 VOLT_TRACE("Deleted %d rows from table : %s with %d active, %d visible, %d allocated",
                            (int)modified_tuples,
@@ -0,0 +1,445 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hashjoinexecutor.h"
+
+#include "common/LargeTempTableBlockCache.h"
+#include "common/executorcontext.hpp"
+#include "executors/aggregateexecutor.h"
+#include "expressions/abstractexpression.h"
+#include "plannodes/hashjoinnode.h"
+#include "plannodes/limitnode.h"
+#include "storage/LargeTempTable.h"
+#include "storage/LargeTempTableBlock.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "storage/TempTableLimits.h"
+
+#include <boost/foreach.hpp>
+
+#include <sstream>
+
+using namespace std;
+using namespace voltdb;
+
+namespace {
+
+// Bounds on the number of partitions used when the build side
+// does not fit in memory.  Always a power of two.
+const int MIN_PARTITIONS = 2;
+const int MAX_PARTITIONS = 64;
+
+// Rough per-entry cost of a hash table node, on top of the key tuple.
+const int64_t HASH_NODE_OVERHEAD = 48;
+
+// Recheck the memory used by the build side every this many inserts.
+const size_t ACCOUNTING_INTERVAL = 1024;
+
+/**
+ * Releases the partitions of a partitioned join, on both normal and
+ * exceptional exit.
+ */
+class PartitionHolder {
+public:
+    ~PartitionHolder() {
+        BOOST_FOREACH(LargeTempTable* table, m_tables) {
+            table->decrementRefcount();
+        }
+    }
+
+    LargeTempTable* add(const string& name, Table* templateTable) {
+        LargeTempTable* table = TableFactory::buildCopiedLargeTempTable(name, templateTable);
+        table->incrementRefcount();
+        m_tables.push_back(table);
+        return table;
+    }
+
+private:
+    vector<LargeTempTable*> m_tables;
+};
+
+}
+
+/**
+ * Drops the hash table when a build/probe cycle finishes or throws.
+ */
+class HashJoinExecutor::HashTableReleaser {
+public:
+    HashTableReleaser(HashJoinExecutor* executor) : m_executor(executor) { }
+    ~HashTableReleaser() { m_executor->releaseHashTable(); }
+private:
+    HashJoinExecutor* m_executor;
+};
+
+HashJoinExecutor::HashJoinExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node)
+    : AbstractJoinExecutor(engine, abstract_node)
+    , m_preJoinPredicate(NULL)
+    , m_joinPredicate(NULL)
+    , m_outerCols(0)
+    , m_innerCols(0)
+    , m_keySchema(NULL)
+    , m_keyStorage()
+    , m_hashTable()
+    , m_buildPool()
+    , m_limits(NULL)
+    , m_accountedBytes(0)
+{ }
+
+HashJoinExecutor::~HashJoinExecutor() {
+    m_hashTable.reset();
+    if (m_keySchema != NULL) {
+        TupleSchema::freeTupleSchema(m_keySchema);
+    }
+}
+
+bool HashJoinExecutor::p_init(AbstractPlanNode* abstractNode,
+                              const ExecutorVector& executorVector)
+{
+    VOLT_TRACE("init HashJoin Executor");
+
+    HashJoinPlanNode* node = dynamic_cast<HashJoinPlanNode*>(m_abstractNode);
+    assert(node);
+
+    // Init parent first
+    if (!AbstractJoinExecutor::p_init(abstractNode, executorVector)) {
+        return false;
+    }
+
+    if (m_joinType == JOIN_TYPE_FULL) {
+        VOLT_ERROR("Hash join does not support FULL joins");
+        return false;
+    }
+
+    // NULL tuples for left and anti joins
+    p_init_null_tuples(node->getInputTable(), node->getInputTable(1));
+
+    m_outerHashExpressions = node->getOuterHashExpressions();
+    m_innerHashExpressions = node->getInnerHashExpressions();
+    m_preJoinPredicate = node->getPreJoinPredicate();
+    m_joinPredicate = node->getJoinPredicate();
+    m_outerCols = node->getInputTable()->columnCount();
+    m_innerCols = node->getInputTable(1)->columnCount();
+    m_limits = executorVector.limits();
+
+    // Both sides must hash a key to the same value, so each key column
+    // has a single type that both sides' values are cast to.
+    m_keySchema = constructJoinKeySchema(m_outerHashExpressions, m_innerHashExpressions);
+    if (m_keySchema == NULL) {
+        return false;
+    }
+    m_keyStorage.init(m_keySchema);
+
+    return true;
+}
+
+bool HashJoinExecutor::evalKey(const std::vector<AbstractExpression*>& exprs,
+                               const TableTuple* outerTuple, const TableTuple* innerTuple)
+{
+    TableTuple& key = m_keyStorage.tuple();
+    for (int ii = 0; ii < exprs.size(); ii++) {
+        NValue value = exprs[ii]->eval(outerTuple, innerTuple);
+        if (value.isNull()) {
+            return false;
+        }
+        key.setNValue(ii, value);
+    }
+    return true;
+}
+
+int HashJoinExecutor::choosePartitionCount(Table* innerTable) const
+{
+    bool innerIsLarge = dynamic_cast<LargeTempTable*>(innerTable) != NULL;
+    int64_t bytesPerTuple = m_keySchema->tupleLength() + TUPLE_HEADER_SIZE + HASH_NODE_OVERHEAD;
+    if (innerIsLarge) {
+        // Inner tuples get copied out of the large temp table blocks
+        bytesPerTuple += innerTable->schema()->tupleLength() + TUPLE_HEADER_SIZE;
+    }
+    int64_t estimate = innerTable->activeTupleCount() * bytesPerTuple;
+    int64_t budget = m_limits->getMemoryLimit() / 2;
+    if (budget <= 0) {
+        if (!innerIsLarge) {
+            return 0;
+        }
+        budget = estimate;
+    }
+    if (!innerIsLarge && estimate <= budget) {
+        return 0;
+    }
+
+    // Every partition being written pins one block of the cache, and the
+    // scan of the input and the output table may pin one more each.
+    LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+    int maxPartitions = MAX_PARTITIONS;
+    while (maxPartitions > lttBlockCache->maxCacheSizeInBlocks() - 3) {
+        maxPartitions /= 2;
+    }
+    if (maxPartitions < MIN_PARTITIONS) {
+        return 0;
+    }
+
+    int partitionCount = MIN_PARTITIONS;
+    while (partitionCount < maxPartitions && estimate > budget * partitionCount) {
+        partitionCount *= 2;
+    }
+    return partitionCount;
+}
+
+void HashJoinExecutor::buildHashTable(Table* innerTable, bool copyTuples, ProgressMonitorProxy& pmp)
+{
+    releaseHashTable();
+    m_hashTable.reset(new HashTable(false));
+
+    const TupleSchema* innerSchema = innerTable->schema();
+    TableTuple innerTuple(innerSchema);
+    TableTuple key(m_keySchema);
+    TableTuple copy(innerSchema);
+    TableIterator iterator = copyTuples ? innerTable->iteratorDeletingAsWeGo() : innerTable->iterator();
+    while (iterator.next(innerTuple)) {
+        pmp.countdownProgress();
+        if (!evalKey(m_innerHashExpressions, NULL, &innerTuple)) {
+            // A NULL key never matches
+            continue;
+        }
+        key.move(m_buildPool.allocate(key.tupleLength()));
+        key.copyForPersistentInsert(m_keyStorage.tuple(), &m_buildPool);
+        char* value = innerTuple.address();
+        if (copyTuples) {
+            copy.move(m_buildPool.allocate(copy.tupleLength()));
+            copy.copyForPersistentInsert(innerTuple, &m_buildPool);
+            value = copy.address();
+        }
+        m_hashTable->insert(key, value);
+        if (m_hashTable->size() % ACCOUNTING_INTERVAL == 0) {
+            updateMemoryAccounting();
+        }
+    }
+    updateMemoryAccounting();
+}
+
+void HashJoinExecutor::probe(const TableTuple& outerTuple, TableTuple& joinTuple,
+                             CountingPostfilter& postfilter, ProgressMonitorProxy& pmp)
+{
+    const TableTuple& null_inner_tuple = m_null_inner_tuple.tuple();
+    joinTuple.setNValues(0, outerTuple, 0, m_outerCols);
+
+    // did this probe find at least one match for this tuple?
+    bool outerMatch = false;
+    // For outer joins if outer tuple fails pre-join predicate
+    // (join expression based on the outer table only)
+    // it can't match any of inner tuples
+    if ((m_preJoinPredicate == NULL || m_preJoinPredicate->eval(&outerTuple, NULL).isTrue()) &&
+        evalKey(m_outerHashExpressions, &outerTuple, NULL)) {
+        TableTuple innerTuple(m_abstractNode->getInputTable(1)->schema());
+        for (HashTable::iterator it = m_hashTable->find(m_keyStorage.tuple());
+             !it.isEnd() && postfilter.isUnderLimit(); it.moveNext()) {
+            pmp.countdownProgress();
+            innerTuple.move(it.value());
+            if (m_joinPredicate == NULL || m_joinPredicate->eval(&outerTuple, &innerTuple).isTrue()) {
+                outerMatch = true;
+                if (m_joinType == JOIN_TYPE_SEMI || m_joinType == JOIN_TYPE_ANTI) {
+                    // One match settles it; these joins produce outer columns only
+                    break;
+                }
+                // Filter the joined tuple
+                if (postfilter.eval(&outerTuple, &innerTuple)) {
+                    // Matched! Complete the joined tuple with the inner column values.
+                    joinTuple.setNValues(m_outerCols, innerTuple, 0, m_innerCols);
+                    outputTuple(postfilter, joinTuple, pmp);
+                }
+            }
+        }
+    }
+
+    if (m_joinType == JOIN_TYPE_SEMI) {
+        if (outerMatch && postfilter.isUnderLimit() &&
+            postfilter.eval(&outerTuple, &null_inner_tuple)) {
+            outputTuple(postfilter, joinTuple, pmp);
+        }
+    }
+    else if ((m_joinType == JOIN_TYPE_LEFT || m_joinType == JOIN_TYPE_ANTI) &&
+             !outerMatch && postfilter.isUnderLimit()) {
+        // Still needs to pass the filter
+        if (postfilter.eval(&outerTuple, &null_inner_tuple)) {
+            if (m_joinType == JOIN_TYPE_LEFT) {
+                joinTuple.setNValues(m_outerCols, null_inner_tuple, 0, m_innerCols);
+            }
+            outputTuple(postfilter, joinTuple, pmp);
+        }
+    }
+}
+
+void HashJoinExecutor::partitionedJoin(Table* outerTable, Table* innerTable, int partitionCount,
+                                       TableTuple& joinTuple, CountingPostfilter& postfilter,
+                                       ProgressMonitorProxy& pmp)
+{
+    VOLT_DEBUG("Hash join spilling both inputs into %d partitions", partitionCount);
+    assert((partitionCount & (partitionCount - 1)) == 0);
+
+    PartitionHolder holder;
+    vector<LargeTempTable*> outerPartitions;
+    vector<LargeTempTable*> innerPartitions;
+    for (int ii = 0; ii < partitionCount; ii++) {
+        ostringstream suffix;
+        suffix << ii;
+        outerPartitions.push_back(holder.add("HASHJOIN_OUTER_" + suffix.str(), outerTable));
+        innerPartitions.push_back(holder.add("HASHJOIN_INNER_" + suffix.str(), innerTable));
+    }
+
+    // Inner tuples with a NULL key can never match, so they are dropped here.
+    {
+        TableTuple innerTuple(innerTable->schema());
+        TableIterator iterator = innerTable->iteratorDeletingAsWeGo();
+        while (iterator.next(innerTuple)) {
+            pmp.countdownProgress();
+            if (evalKey(m_innerHashExpressions, NULL, &innerTuple)) {
+                TableTuple& key = m_keyStorage.tuple();
+                size_t partition = key.hashCode() & (partitionCount - 1);
+                innerPartitions[partition]->insertTuple(innerTuple);
+            }
+        }
+        BOOST_FOREACH(LargeTempTable* table, innerPartitions) {
+            table->finishInserts();
+        }
+    }
+
+    // Outer tuples that cannot match anything are finished right away.
+    {
+        TableTuple outerTuple(outerTable->schema());
+        TableIterator iterator = outerTable->iteratorDeletingAsWeGo();
+        while (postfilter.isUnderLimit() && iterator.next(outerTuple)) {
+            pmp.countdownProgress();
+            if ((m_preJoinPredicate == NULL || m_preJoinPredicate->eval(&outerTuple, NULL).isTrue()) &&
+                evalKey(m_outerHashExpressions, &outerTuple, NULL)) {
+                TableTuple& key = m_keyStorage.tuple();
+                size_t partition = key.hashCode() & (partitionCount - 1);
+                outerPartitions[partition]->insertTuple(outerTuple);
+            }
+            else {
+                probe(outerTuple, joinTuple, postfilter, pmp);
+            }
+        }
+        BOOST_FOREACH(LargeTempTable* table, outerPartitions) {
+            table->finishInserts();
+        }
+    }
+
+    TableTuple outerTuple(outerTable->schema());
+    for (int ii = 0; ii < partitionCount && postfilter.isUnderLimit(); ii++) {
+        if (outerPartitions[ii]->activeTupleCount() == 0) {
+            continue;
+        }
+        HashTableReleaser releaser(this);
+        buildHashTable(innerPartitions[ii], true, pmp);
+        TableIterator iterator = outerPartitions[ii]->iteratorDeletingAsWeGo();
+        while (postfilter.isUnderLimit() && iterator.next(outerTuple)) {
+            pmp.countdownProgress();
+            probe(outerTuple, joinTuple, postfilter, pmp);
+        }
+    }
+}
+
+void HashJoinExecutor::updateMemoryAccounting()
+{
+    int64_t bytes = m_buildPool.getAllocatedMemory();
+    if (m_hashTable) {
+        bytes += m_hashTable->bytesAllocated();
+    }
+    int64_t delta = bytes - m_accountedBytes;
+    m_accountedBytes = bytes;
+    if (delta > 0) {
+        m_limits->increaseAllocated(static_cast<int>(delta));
+    }
+    else if (delta < 0) {
+        m_limits->reduceAllocated(static_cast<int>(-delta));
+    }
+}
+
+void HashJoinExecutor::releaseHashTable()
+{
+    m_hashTable.reset();
+    m_buildPool.purge();
+    if (m_accountedBytes > 0) {
+        m_limits->reduceAllocated(static_cast<int>(m_accountedBytes));
+        m_accountedBytes = 0;
+    }
+}
+
+bool HashJoinExecutor::p_execute(const NValueArray &params) {
+    VOLT_DEBUG("executing HashJoin...");
+
+    HashJoinPlanNode* node = dynamic_cast<HashJoinPlanNode*>(m_abstractNode);
+    assert(node);
+    assert(node->getInputTableCount() == 2);
+
+    // output table must be a temp table
+    assert(m_tmpOutputTable);
+
+    Table* outer_table = node->getInputTable();
+    assert(outer_table);
+
+    Table* inner_table = node->getInputTable(1);
+    assert(inner_table);
+
+    VOLT_TRACE ("input table left:\n %s", outer_table->debug().c_str());
+    VOLT_TRACE ("input table right:\n %s", inner_table->debug().c_str());
+
+    AbstractExpression *wherePredicate = node->getWherePredicate();
+
+    LimitPlanNode* limit_node = dynamic_cast<LimitPlanNode*>(node->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
+    int limit = CountingPostfilter::NO_LIMIT;
+    int offset = CountingPostfilter::NO_OFFSET;
+    if (limit_node) {
+        limit_node->getLimitAndOffsetByReference(params, limit, offset);
+    }
+
+    ProgressMonitorProxy pmp(m_engine->getExecutorContext(), this);
+    // Init the postfilter
+    CountingPostfilter postfilter(m_tmpOutputTable, wherePredicate, limit, offset);
+
+    TableTuple join_tuple;
+    if (m_aggExec != NULL) {
+        VOLT_TRACE("Init inline aggregate...");
+        const TupleSchema * aggInputSchema = node->getTupleSchemaPreAgg();
+        join_tuple = m_aggExec->p_execute_init(params, &pmp, aggInputSchema, m_tmpOutputTable, &postfilter);
+    } else {
+        join_tuple = m_tmpOutputTable->tempTuple();
+    }
+
+    int partitionCount = choosePartitionCount(inner_table);
+    if (partitionCount > 0) {
+        partitionedJoin(outer_table, inner_table, partitionCount, join_tuple, postfilter, pmp);
+    }
+    else {
+        HashTableReleaser releaser(this);
+        // Tuples of a large temp table may move once their block is unpinned
+        bool copyTuples = dynamic_cast<LargeTempTable*>(inner_table) != NULL;
+        buildHashTable(inner_table, copyTuples, pmp);
+
+        TableTuple outer_tuple(outer_table->schema());
+        TableIterator iterator0 = outer_table->iteratorDeletingAsWeGo();
+        while (postfilter.isUnderLimit() && iterator0.next(outer_tuple)) {
+            pmp.countdownProgress();
+            probe(outer_tuple, join_tuple, postfilter, pmp);
+        }
+    }
+
+    if (m_aggExec != NULL) {
+        m_aggExec->p_execute_finish();
+    }
+
+    return (true);
+}
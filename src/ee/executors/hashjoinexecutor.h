@@ -0,0 +1,114 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASHJOINEXECUTOR_H
+#define HASHJOINEXECUTOR_H
+
+#include "common/common.h"
+#include "common/Pool.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "executors/abstractjoinexecutor.h"
+#include "structures/CompactingHashTable.h"
+
+#include <boost/scoped_ptr.hpp>
+
+#include <vector>
+
+namespace voltdb {
+
+class AbstractExpression;
+class LargeTempTable;
+class TempTableLimits;
+
+/**
+ * Executes a HashJoinPlanNode.  The inner input is loaded into a hash
+ * table keyed on the inner hash expressions, then each outer tuple is
+ * probed against it.
+ *
+ * When the inner input is a large temp table, or when the hash table
+ * would take more than half of the fragment's temp table memory, both
+ * inputs are first split by key hash into large temp table partitions
+ * and each pair of partitions is joined in turn, so that only one
+ * partition of the inner input is held in memory at a time.
+ */
+class HashJoinExecutor : public AbstractJoinExecutor {
+public:
+    HashJoinExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node);
+    ~HashJoinExecutor();
+
+private:
+    typedef CompactingHashTable<TableTuple, char*,
+                                TableTupleHasher, TableTupleEqualityChecker> HashTable;
+    class HashTableReleaser;
+
+    bool p_init(AbstractPlanNode*, const ExecutorVector& executorVector);
+    bool p_execute(const NValueArray &params);
+
+    /**
+     * Evaluate the given hash expressions into the scratch key tuple.
+     * Returns false if any key component is NULL.
+     */
+    bool evalKey(const std::vector<AbstractExpression*>& exprs,
+                 const TableTuple* outerTuple, const TableTuple* innerTuple);
+
+    /** How many partitions to split the inputs into, or 0 to join in memory. */
+    int choosePartitionCount(Table* innerTable) const;
+
+    /**
+     * Load the inner tuples into a new hash table.  When copyTuples is
+     * set the tuples are copied into the build pool, since blocks of a
+     * large temp table may move once they are unpinned.
+     */
+    void buildHashTable(Table* innerTable, bool copyTuples, ProgressMonitorProxy& pmp);
+
+    /** Join one outer tuple against the current hash table. */
+    void probe(const TableTuple& outerTuple, TableTuple& joinTuple,
+               CountingPostfilter& postfilter, ProgressMonitorProxy& pmp);
+
+    /** Split both inputs by key hash, then join each pair of partitions. */
+    void partitionedJoin(Table* outerTable, Table* innerTable, int partitionCount,
+                         TableTuple& joinTuple, CountingPostfilter& postfilter,
+                         ProgressMonitorProxy& pmp);
+
+    /** Charge the hash table and build pool to the temp table limits. */
+    void updateMemoryAccounting();
+    /** Drop the hash table and build pool and release their memory. */
+    void releaseHashTable();
+
+    std::vector<AbstractExpression*> m_outerHashExpressions;
+    std::vector<AbstractExpression*> m_innerHashExpressions;
+    AbstractExpression* m_preJoinPredicate;
+    AbstractExpression* m_joinPredicate;
+
+    int m_outerCols;
+    int m_innerCols;
+
+    /** Schema of the hash keys, shared by the build and probe sides. */
+    TupleSchema* m_keySchema;
+    StandAloneTupleStorage m_keyStorage;
+
+    boost::scoped_ptr<HashTable> m_hashTable;
+    /** Holds the hash keys and, when partitioning, copies of the inner tuples. */
+    Pool m_buildPool;
+    TempTableLimits* m_limits;
+    int64_t m_accountedBytes;
+};
+
+}
+
+#endif
@@ -356,6 +356,7 @@ bool IndexCountExecutor::p_execute(const NValueArray &params)
         // Deal with multi-map
         VOLT_DEBUG("INDEX_LOOKUP_TYPE(%d) m_numSearchkeys(%d) key:%s",
                    localLookupType, activeNumOfSearchKeys, searchKey.debugNoHeader().c_str());
+        countIndexProbe();
         if (searchKeyUnderflow == false) {
             if (localLookupType == INDEX_LOOKUP_TYPE_GT) {
                 rkStart = tableIndex->getCounterLET(&searchKey, true, indexCursor);
@@ -397,6 +398,7 @@ bool IndexCountExecutor::p_execute(const NValueArray &params)
     }
 
     if (m_numOfEndkeys != 0) {
+        countIndexProbe();
         if (endKeyOverflow) {
             rkEnd = tableIndex->getCounterGET(&endKey, true, indexCursor);
         } else {
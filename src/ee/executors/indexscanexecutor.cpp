@@ -453,6 +453,7 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
     if (activeNumOfSearchKeys > 0) {
         VOLT_TRACE("INDEX_LOOKUP_TYPE(%d) m_numSearchkeys(%d) key:%s",
                 localLookupType, activeNumOfSearchKeys, searchKey.debugNoHeader().c_str());
+        countIndexProbe();
 
         if (localLookupType == INDEX_LOOKUP_TYPE_EQ) {
             tableIndex->moveToKey(&searchKey, indexCursor);
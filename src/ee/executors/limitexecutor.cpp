@@ -122,3 +122,31 @@ LimitExecutor::p_execute(const NValueArray &params)
 
     return true;
 }
+
+void
+LimitExecutor::p_pipeline_init(const NValueArray &params)
+{
+    LimitPlanNode* node = dynamic_cast<LimitPlanNode*>(m_abstractNode);
+    assert(node);
+    m_limit = -1;
+    m_offset = -1;
+    node->getLimitAndOffsetByReference(params, m_limit, m_offset);
+    m_tuplesSkipped = 0;
+    m_tuplesEmitted = 0;
+}
+
+void
+LimitExecutor::p_pipeline_tuple(TableTuple &tuple)
+{
+    // The child keeps producing after the limit is reached; the rest of
+    // its tuples are just dropped here.
+    if (m_limit != -1 && m_tuplesEmitted >= m_limit) {
+        return;
+    }
+    if (m_tuplesSkipped < m_offset) {
+        m_tuplesSkipped++;
+        return;
+    }
+    m_tuplesEmitted++;
+    m_tmpOutputTable->insertTempTuple(tuple);
+}
@@ -58,16 +58,31 @@ namespace voltdb
     public:
         LimitExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node)
             : AbstractExecutor(engine, abstract_node)
+            , m_limit(-1)
+            , m_offset(-1)
+            , m_tuplesSkipped(0)
+            , m_tuplesEmitted(0)
         {
         }
 
         ~LimitExecutor() {
         }
 
+        bool supportsPipelinedInput() const { return true; }
+
     private:
         bool p_init(AbstractPlanNode*,
                     const ExecutorVector& executorVector);
         bool p_execute(const NValueArray &params);
+
+        void p_pipeline_init(const NValueArray &params);
+        void p_pipeline_tuple(TableTuple &tuple);
+
+        // Pipelined execution state
+        int m_limit;
+        int m_offset;
+        int m_tuplesSkipped;
+        int m_tuplesEmitted;
     };
 
 }
@@ -0,0 +1,310 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mergejoinexecutor.h"
+
+#include "executors/aggregateexecutor.h"
+#include "expressions/abstractexpression.h"
+#include "plannodes/limitnode.h"
+#include "plannodes/mergejoinnode.h"
+#include "storage/LargeTempTable.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+MergeJoinExecutor::MergeJoinExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node)
+    : AbstractJoinExecutor(engine, abstract_node)
+    , m_preJoinPredicate(NULL)
+    , m_joinPredicate(NULL)
+    , m_sortOrder(1)
+    , m_outerCols(0)
+    , m_innerCols(0)
+    , m_keySchema(NULL)
+    , m_outerKey()
+    , m_innerKey()
+    , m_runKey()
+    , m_run()
+    , m_runMatched()
+    , m_runPool()
+{ }
+
+MergeJoinExecutor::~MergeJoinExecutor() {
+    if (m_keySchema != NULL) {
+        TupleSchema::freeTupleSchema(m_keySchema);
+    }
+}
+
+bool MergeJoinExecutor::p_init(AbstractPlanNode* abstractNode,
+                               const ExecutorVector& executorVector)
+{
+    VOLT_TRACE("init MergeJoin Executor");
+
+    MergeJoinPlanNode* node = dynamic_cast<MergeJoinPlanNode*>(m_abstractNode);
+    assert(node);
+
+    // Init parent first
+    if (!AbstractJoinExecutor::p_init(abstractNode, executorVector)) {
+        return false;
+    }
+
+    // NULL tuples for outer and anti joins
+    p_init_null_tuples(node->getInputTable(), node->getInputTable(1));
+
+    m_outerKeyExpressions = node->getOuterKeyExpressions();
+    m_innerKeyExpressions = node->getInnerKeyExpressions();
+    m_preJoinPredicate = node->getPreJoinPredicate();
+    m_joinPredicate = node->getJoinPredicate();
+    m_sortOrder = (node->getSortDirection() == SORT_DIRECTION_TYPE_DESC) ? -1 : 1;
+    m_outerCols = node->getInputTable()->columnCount();
+    m_innerCols = node->getInputTable(1)->columnCount();
+
+    // Keys from both sides are compared column by column, so each key
+    // column has a single type that both sides' values are cast to.
+    m_keySchema = constructJoinKeySchema(m_outerKeyExpressions, m_innerKeyExpressions);
+    if (m_keySchema == NULL) {
+        return false;
+    }
+    m_outerKey.init(m_keySchema);
+    m_innerKey.init(m_keySchema);
+    m_runKey.init(m_keySchema);
+
+    return true;
+}
+
+bool MergeJoinExecutor::evalKey(const std::vector<AbstractExpression*>& exprs,
+                                const TableTuple* outerTuple, const TableTuple* innerTuple,
+                                TableTuple& key)
+{
+    for (int ii = 0; ii < exprs.size(); ii++) {
+        NValue value = exprs[ii]->eval(outerTuple, innerTuple);
+        if (value.isNull()) {
+            return false;
+        }
+        key.setNValue(ii, value);
+    }
+    return true;
+}
+
+int MergeJoinExecutor::compareKeys(const TableTuple& lhs, const TableTuple& rhs) const
+{
+    for (int ii = 0; ii < m_keySchema->columnCount(); ii++) {
+        int cmp = lhs.getNValue(ii).compare(rhs.getNValue(ii));
+        if (cmp != VALUE_COMPARE_EQUAL) {
+            return cmp * m_sortOrder;
+        }
+    }
+    return VALUE_COMPARE_EQUAL;
+}
+
+void MergeJoinExecutor::addToRun(const TableTuple& innerTuple, bool copyTuples)
+{
+    char* address = innerTuple.address();
+    if (copyTuples) {
+        TableTuple copy(innerTuple.getSchema());
+        copy.move(m_runPool.allocate(copy.tupleLength()));
+        copy.copyForPersistentInsert(innerTuple, &m_runPool);
+        address = copy.address();
+    }
+    m_run.push_back(address);
+    m_runMatched.push_back(false);
+}
+
+void MergeJoinExecutor::clearRun(TableTuple& joinTuple, CountingPostfilter& postfilter,
+                                 ProgressMonitorProxy& pmp)
+{
+    if (m_joinType == JOIN_TYPE_FULL) {
+        TableTuple innerTuple(m_abstractNode->getInputTable(1)->schema());
+        for (size_t ii = 0; ii < m_run.size() && postfilter.isUnderLimit(); ii++) {
+            if (!m_runMatched[ii]) {
+                innerTuple.move(m_run[ii]);
+                outputUnmatchedInner(innerTuple, joinTuple, postfilter, pmp);
+            }
+        }
+    }
+    m_run.clear();
+    m_runMatched.clear();
+    m_runPool.purge();
+}
+
+void MergeJoinExecutor::outputUnmatchedInner(const TableTuple& innerTuple, TableTuple& joinTuple,
+                                             CountingPostfilter& postfilter,
+                                             ProgressMonitorProxy& pmp)
+{
+    assert(m_joinType == JOIN_TYPE_FULL);
+    const TableTuple& null_outer_tuple = m_null_outer_tuple.tuple();
+    if (postfilter.eval(&null_outer_tuple, &innerTuple)) {
+        joinTuple.setNValues(0, null_outer_tuple, 0, m_outerCols);
+        joinTuple.setNValues(m_outerCols, innerTuple, 0, m_innerCols);
+        outputTuple(postfilter, joinTuple, pmp);
+    }
+}
+
+bool MergeJoinExecutor::p_execute(const NValueArray &params) {
+    VOLT_DEBUG("executing MergeJoin...");
+
+    MergeJoinPlanNode* node = dynamic_cast<MergeJoinPlanNode*>(m_abstractNode);
+    assert(node);
+    assert(node->getInputTableCount() == 2);
+
+    // output table must be a temp table
+    assert(m_tmpOutputTable);
+
+    Table* outer_table = node->getInputTable();
+    assert(outer_table);
+
+    Table* inner_table = node->getInputTable(1);
+    assert(inner_table);
+
+    VOLT_TRACE ("input table left:\n %s", outer_table->debug().c_str());
+    VOLT_TRACE ("input table right:\n %s", inner_table->debug().c_str());
+
+    AbstractExpression *wherePredicate = node->getWherePredicate();
+
+    LimitPlanNode* limit_node = dynamic_cast<LimitPlanNode*>(node->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
+    int limit = CountingPostfilter::NO_LIMIT;
+    int offset = CountingPostfilter::NO_OFFSET;
+    if (limit_node) {
+        limit_node->getLimitAndOffsetByReference(params, limit, offset);
+    }
+
+    ProgressMonitorProxy pmp(m_engine->getExecutorContext(), this);
+    // Init the postfilter
+    CountingPostfilter postfilter(m_tmpOutputTable, wherePredicate, limit, offset);
+
+    TableTuple join_tuple;
+    if (m_aggExec != NULL) {
+        VOLT_TRACE("Init inline aggregate...");
+        const TupleSchema * aggInputSchema = node->getTupleSchemaPreAgg();
+        join_tuple = m_aggExec->p_execute_init(params, &pmp, aggInputSchema, m_tmpOutputTable, &postfilter);
+    } else {
+        join_tuple = m_tmpOutputTable->tempTuple();
+    }
+
+    const TableTuple& null_inner_tuple = m_null_inner_tuple.tuple();
+    TableTuple& outerKey = m_outerKey.tuple();
+    TableTuple& innerKey = m_innerKey.tuple();
+    TableTuple& runKey = m_runKey.tuple();
+
+    // Tuples of a large temp table may move once their block is unpinned,
+    // so the current run is copied out of it.
+    bool copyTuples = dynamic_cast<LargeTempTable*>(inner_table) != NULL;
+    TableIterator iterator1 = copyTuples ? inner_table->iteratorDeletingAsWeGo() : inner_table->iterator();
+    TableTuple inner_tuple(inner_table->schema());
+    bool innerValid = iterator1.next(inner_tuple);
+    bool innerHasKey = innerValid && evalKey(m_innerKeyExpressions, NULL, &inner_tuple, innerKey);
+
+    TableTuple outer_tuple(outer_table->schema());
+    TableTuple run_tuple(inner_table->schema());
+    TableIterator iterator0 = outer_table->iteratorDeletingAsWeGo();
+    clearRun(join_tuple, postfilter, pmp);
+    while (postfilter.isUnderLimit() && iterator0.next(outer_tuple)) {
+        pmp.countdownProgress();
+
+        // did this outer tuple find at least one match?
+        bool outerMatch = false;
+        // For outer joins if outer tuple fails pre-join predicate
+        // (join expression based on the outer table only)
+        // or has a NULL key, it can't match any of inner tuples
+        if ((m_preJoinPredicate == NULL || m_preJoinPredicate->eval(&outer_tuple, NULL).isTrue()) &&
+            evalKey(m_outerKeyExpressions, &outer_tuple, NULL, outerKey)) {
+
+            if (m_run.empty() || compareKeys(runKey, outerKey) != VALUE_COMPARE_EQUAL) {
+                // The outer input moved past the current run.
+                clearRun(join_tuple, postfilter, pmp);
+
+                // Skip the inner tuples that sort before the outer key.
+                while (innerValid &&
+                       (!innerHasKey || compareKeys(innerKey, outerKey) < VALUE_COMPARE_EQUAL)) {
+                    pmp.countdownProgress();
+                    if (m_joinType == JOIN_TYPE_FULL && postfilter.isUnderLimit()) {
+                        outputUnmatchedInner(inner_tuple, join_tuple, postfilter, pmp);
+                    }
+                    innerValid = iterator1.next(inner_tuple);
+                    innerHasKey = innerValid && evalKey(m_innerKeyExpressions, NULL, &inner_tuple, innerKey);
+                }
+
+                // Collect the run of inner tuples sharing the outer key.
+                if (innerValid && compareKeys(innerKey, outerKey) == VALUE_COMPARE_EQUAL) {
+                    runKey.copyForPersistentInsert(innerKey, &m_runPool);
+                    do {
+                        pmp.countdownProgress();
+                        addToRun(inner_tuple, copyTuples);
+                        innerValid = iterator1.next(inner_tuple);
+                        innerHasKey = innerValid &&
+                            evalKey(m_innerKeyExpressions, NULL, &inner_tuple, innerKey);
+                    } while (innerHasKey && compareKeys(innerKey, runKey) == VALUE_COMPARE_EQUAL);
+                }
+            }
+
+            join_tuple.setNValues(0, outer_tuple, 0, m_outerCols);
+            for (size_t ii = 0; ii < m_run.size() && postfilter.isUnderLimit(); ii++) {
+                run_tuple.move(m_run[ii]);
+                if (m_joinPredicate == NULL || m_joinPredicate->eval(&outer_tuple, &run_tuple).isTrue()) {
+                    outerMatch = true;
+                    m_runMatched[ii] = true;
+                    if (m_joinType == JOIN_TYPE_SEMI || m_joinType == JOIN_TYPE_ANTI) {
+                        // One match settles it; these joins produce outer columns only
+                        break;
+                    }
+                    // Filter the joined tuple
+                    if (postfilter.eval(&outer_tuple, &run_tuple)) {
+                        // Matched! Complete the joined tuple with the inner column values.
+                        join_tuple.setNValues(m_outerCols, run_tuple, 0, m_innerCols);
+                        outputTuple(postfilter, join_tuple, pmp);
+                    }
+                }
+            }
+        }
+
+        if (m_joinType == JOIN_TYPE_SEMI) {
+            if (outerMatch && postfilter.isUnderLimit() &&
+                postfilter.eval(&outer_tuple, &null_inner_tuple)) {
+                join_tuple.setNValues(0, outer_tuple, 0, m_outerCols);
+                outputTuple(postfilter, join_tuple, pmp);
+            }
+        }
+        else if ((m_joinType == JOIN_TYPE_LEFT || m_joinType == JOIN_TYPE_FULL ||
+                  m_joinType == JOIN_TYPE_ANTI) &&
+                 !outerMatch && postfilter.isUnderLimit()) {
+            // Still needs to pass the filter
+            if (postfilter.eval(&outer_tuple, &null_inner_tuple)) {
+                join_tuple.setNValues(0, outer_tuple, 0, m_outerCols);
+                if (m_joinType != JOIN_TYPE_ANTI) {
+                    join_tuple.setNValues(m_outerCols, null_inner_tuple, 0, m_innerCols);
+                }
+                outputTuple(postfilter, join_tuple, pmp);
+            }
+        }
+    }
+
+    // For FULL joins, whatever is left of the inner input matched nothing.
+    clearRun(join_tuple, postfilter, pmp);
+    if (m_joinType == JOIN_TYPE_FULL) {
+        while (innerValid && postfilter.isUnderLimit()) {
+            pmp.countdownProgress();
+            outputUnmatchedInner(inner_tuple, join_tuple, postfilter, pmp);
+            innerValid = iterator1.next(inner_tuple);
+        }
+    }
+
+    if (m_aggExec != NULL) {
+        m_aggExec->p_execute_finish();
+    }
+
+    return (true);
+}
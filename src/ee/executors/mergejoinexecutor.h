@@ -0,0 +1,94 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MERGEJOINEXECUTOR_H
+#define MERGEJOINEXECUTOR_H
+
+#include "common/common.h"
+#include "common/Pool.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "executors/abstractjoinexecutor.h"
+
+#include <vector>
+
+namespace voltdb {
+
+class AbstractExpression;
+
+/**
+ * Executes a MergeJoinPlanNode by streaming both ordered inputs side by
+ * side.  The only inner tuples held at a time are the run sharing the
+ * current key, so that duplicate keys on the outer side can be joined
+ * against it again.  That run is referenced in place, or copied when the
+ * inner input is a large temp table whose blocks may move.
+ */
+class MergeJoinExecutor : public AbstractJoinExecutor {
+public:
+    MergeJoinExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node);
+    ~MergeJoinExecutor();
+
+private:
+    bool p_init(AbstractPlanNode*, const ExecutorVector& executorVector);
+    bool p_execute(const NValueArray &params);
+
+    /**
+     * Evaluate the given key expressions into a key tuple.
+     * Returns false if any key component is NULL.
+     */
+    static bool evalKey(const std::vector<AbstractExpression*>& exprs,
+                        const TableTuple* outerTuple, const TableTuple* innerTuple,
+                        TableTuple& key);
+
+    /** Compare two keys in the order the inputs are sorted in. */
+    int compareKeys(const TableTuple& lhs, const TableTuple& rhs) const;
+
+    /** Remember an inner tuple as part of the current run. */
+    void addToRun(const TableTuple& innerTuple, bool copyTuples);
+
+    /** For FULL joins, emit the tuples of the run that matched nothing, then forget the run. */
+    void clearRun(TableTuple& joinTuple, CountingPostfilter& postfilter, ProgressMonitorProxy& pmp);
+
+    /** For FULL joins, emit an inner tuple padded with NULL outer columns. */
+    void outputUnmatchedInner(const TableTuple& innerTuple, TableTuple& joinTuple,
+                              CountingPostfilter& postfilter, ProgressMonitorProxy& pmp);
+
+    std::vector<AbstractExpression*> m_outerKeyExpressions;
+    std::vector<AbstractExpression*> m_innerKeyExpressions;
+    AbstractExpression* m_preJoinPredicate;
+    AbstractExpression* m_joinPredicate;
+    // 1 for ascending inputs, -1 for descending ones
+    int m_sortOrder;
+
+    int m_outerCols;
+    int m_innerCols;
+
+    TupleSchema* m_keySchema;
+    StandAloneTupleStorage m_outerKey;
+    StandAloneTupleStorage m_innerKey;
+    StandAloneTupleStorage m_runKey;
+
+    /** The inner tuples sharing m_runKey, and whether each has matched (for FULL joins). */
+    std::vector<char*> m_run;
+    std::vector<bool> m_runMatched;
+    /** Holds the run's key objects and, for large temp table inputs, copies of its tuples. */
+    Pool m_runPool;
+};
+
+}
+
+#endif
@@ -67,6 +67,42 @@ using namespace voltdb;
 const static int8_t UNMATCHED_TUPLE(TableTupleFilter::ACTIVE_TUPLE);
 const static int8_t MATCHED_TUPLE(TableTupleFilter::ACTIVE_TUPLE + 1);
 
+// Equality probes are counted for this many outer tuples before deciding
+// whether to build a Bloom filter over the inner table's keys.
+const static int64_t BLOOM_FILTER_SAMPLE_PROBES = 1024;
+// Build the filter only when at least this fraction of the sampled probes
+// found no index entry ...
+const static double BLOOM_FILTER_MIN_MISS_RATIO = 0.5;
+// ... and the outer tuples still to probe number at least the inner table's
+// size over this divisor, so that building the filter can pay for itself.
+const static int64_t BLOOM_FILTER_INNER_ROWS_PER_PROBE = 4;
+// Never spend more memory than this on the filter.
+const static size_t BLOOM_FILTER_MAX_BYTES = 64 * 1024 * 1024;
+
+static inline uint64_t hashSearchKey(const TableTuple& key, int numOfSearchKeys)
+{
+    std::size_t seed = 0;
+    for (int ctr = 0; ctr < numOfSearchKeys; ctr++) {
+        key.getNValue(ctr).hashCombine(seed);
+    }
+    return BlockedBloomFilter::mix(seed);
+}
+
+namespace {
+/**
+ * Frees a Bloom filter when p_execute returns or throws, so that the plan
+ * fragments kept in the plan cache don't each hold on to up to
+ * BLOOM_FILTER_MAX_BYTES of bits between executions.
+ */
+class BloomFilterReleaser {
+public:
+    BloomFilterReleaser(BlockedBloomFilter& filter) : m_filter(filter) { }
+    ~BloomFilterReleaser() { m_filter.release(); }
+private:
+    BlockedBloomFilter& m_filter;
+};
+}
+
 bool NestLoopIndexExecutor::p_init(AbstractPlanNode* abstractNode,
                                    const ExecutorVector& executorVector)
 {
@@ -131,6 +167,52 @@ bool NestLoopIndexExecutor::p_init(AbstractPlanNode* abstractNode,
     p_init_null_tuples(node->getInputTable(), m_indexNode->getTargetTable());
 
     m_indexValues.init(index->getKeySchema());
+
+    // A Bloom filter can only skip probes that must find an exact match,
+    // and only for key types whose hash agrees with index equality.
+    m_bloomFilterEligible = (m_lookupType == INDEX_LOOKUP_TYPE_EQ && num_of_searchkeys > 0);
+    for (int ctr = 0; ctr < num_of_searchkeys && m_bloomFilterEligible; ctr++) {
+        ValueType keyType = index->getKeySchema()->columnType(ctr);
+        if (keyType == VALUE_TYPE_POINT || keyType == VALUE_TYPE_GEOGRAPHY) {
+            m_bloomFilterEligible = false;
+        }
+    }
+    if (m_bloomFilterEligible) {
+        m_innerKeyValues.init(index->getKeySchema());
+    }
+    return true;
+}
+
+bool NestLoopIndexExecutor::buildInnerKeyFilter(PersistentTable* innerTable,
+                                                TableIndex* index,
+                                                int numOfSearchKeys)
+{
+    const std::vector<int>& columnIndices = index->getColumnIndices();
+    const std::vector<AbstractExpression*>& indexedExpressions = index->getIndexedExpressions();
+    m_innerKeyFilter.reset(innerTable->activeTupleCount());
+
+    TableTuple innerTuple(innerTable->schema());
+    TableTuple keyTuple = m_innerKeyValues.tuple();
+    TableIterator iterator = innerTable->iterator();
+    try {
+        while (iterator.next(innerTuple)) {
+            // Set the key columns the same way the probes do, so that
+            // values are cast to the key types before they are hashed.
+            for (int ctr = 0; ctr < numOfSearchKeys; ctr++) {
+                if (indexedExpressions.empty()) {
+                    keyTuple.setNValue(ctr, innerTuple.getNValue(columnIndices[ctr]));
+                }
+                else {
+                    keyTuple.setNValue(ctr, indexedExpressions[ctr]->eval(&innerTuple, NULL));
+                }
+            }
+            m_innerKeyFilter.add(hashSearchKey(keyTuple, numOfSearchKeys));
+        }
+    }
+    catch (const SQLException &e) {
+        VOLT_DEBUG("Not using a Bloom filter for NestLoopIndex: %s", e.message().c_str());
+        return false;
+    }
     return true;
 }
 
@@ -224,6 +306,22 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
     const TableTuple &null_inner_tuple = m_null_inner_tuple.tuple();
     ProgressMonitorProxy pmp(m_engine->getExecutorContext(), this);
 
+    // On selective equality joins most probes find nothing.  Sample the
+    // first probes and, if enough of them miss, build a Bloom filter over
+    // the inner keys and test each remaining search key against it first.
+    bool sampleProbes = m_bloomFilterEligible;
+    bool useBloomFilter = false;
+    BloomFilterReleaser releaseInnerKeyFilter(m_innerKeyFilter);
+    int64_t sampledProbes = 0;
+    int64_t sampledMisses = 0;
+    int64_t outerTuplesLeft = outer_table->activeTupleCount();
+    if (sampleProbes &&
+        (outerTuplesLeft < BLOOM_FILTER_SAMPLE_PROBES * 2 ||
+         inner_table->activeTupleCount() * (BlockedBloomFilter::DEFAULT_BITS_PER_KEY / 8)
+             > BLOOM_FILTER_MAX_BYTES)) {
+        sampleProbes = false;
+    }
+
     // The table filter to keep track of inner tuples that don't match any of outer tuples for FULL joins
     TableTupleFilter innerTableFilter;
     if (m_joinType == JOIN_TYPE_FULL) {
@@ -268,6 +366,7 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
         VOLT_TRACE("outer_tuple:%s",
                    outer_tuple.debug(outer_table->name()).c_str());
         pmp.countdownProgress();
+        --outerTuplesLeft;
 
         // Set the join tuple columns that originate solely from the outer tuple.
         // Must be outside the inner loop in case of the empty inner table.
@@ -391,6 +490,13 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
             } // End for each active search key
             VOLT_TRACE("Searching %s", index_values.debug("").c_str());
 
+            // a probe the Bloom filter rules out cannot find a match either
+            if (!keyException && useBloomFilter) {
+                bool mayMatch = m_innerKeyFilter.mayContain(hashSearchKey(index_values, num_of_searchkeys));
+                countBloomFilterProbe(mayMatch);
+                keyException = !mayMatch;
+            }
+
             // if a search value didn't fit into the targeted index key, skip this key
             if (!keyException) {
                 //
@@ -410,6 +516,7 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
                 // Essentially cut and pasted this if ladder from
                 // index scan executor
                 if (num_of_searchkeys > 0) {
+                    countIndexProbe();
                     if (localLookupType == INDEX_LOOKUP_TYPE_EQ) {
                         index->moveToKey(&index_values, indexCursor);
                     }
@@ -457,6 +564,7 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
                 }
 
                 AbstractExpression* skipNullExprIteration = skipNullExpr;
+                bool indexMatched = false;
 
                 while (postfilter.isUnderLimit() &&
                        IndexScanExecutor::getNextTuple(localLookupType,
@@ -464,6 +572,7 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
                                                        index,
                                                        &indexCursor,
                                                        num_of_searchkeys)) {
+                    indexMatched = true;
                     if (inner_tuple.isPendingDelete()) {
                         continue;
                     }
@@ -521,6 +630,21 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
                         }
                     }
                 } // END INNER WHILE LOOP
+
+                if (sampleProbes && localLookupType == INDEX_LOOKUP_TYPE_EQ) {
+                    ++sampledProbes;
+                    if (!indexMatched) {
+                        ++sampledMisses;
+                    }
+                    if (sampledProbes == BLOOM_FILTER_SAMPLE_PROBES) {
+                        sampleProbes = false;
+                        if (sampledMisses >= sampledProbes * BLOOM_FILTER_MIN_MISS_RATIO &&
+                            outerTuplesLeft * BLOOM_FILTER_INNER_ROWS_PER_PROBE >=
+                                inner_table->activeTupleCount()) {
+                            useBloomFilter = buildInnerKeyFilter(inner_table, index, num_of_searchkeys);
+                        }
+                    }
+                }
             } // END IF INDEX KEY EXCEPTION CONDITION
         } // END IF PRE JOIN CONDITION
 
@@ -51,6 +51,7 @@
 #include "common/tabletuple.h"
 #include "expressions/abstractexpression.h"
 #include "executors/abstractjoinexecutor.h"
+#include "structures/BlockedBloomFilter.h"
 
 
 namespace voltdb {
@@ -58,7 +59,9 @@ namespace voltdb {
 class NestLoopIndexPlanNode;
 class IndexScanPlanNode;
 class AggregateExecutorBase;
+class PersistentTable;
 class ProgressMonitorProxy;
+class TableIndex;
 class TableTuple;
 
 /**
@@ -76,6 +79,7 @@ public:
         : AbstractJoinExecutor(engine, abstract_node)
         , m_indexNode(NULL)
         , m_lookupType(INDEX_LOOKUP_TYPE_INVALID)
+        , m_bloomFilterEligible(false)
     { }
 
     ~NestLoopIndexExecutor();
@@ -91,6 +95,21 @@ protected:
     std::vector<AbstractExpression*> m_outputExpressions;
     SortDirectionType m_sortDirection;
     StandAloneTupleStorage m_indexValues;
+
+private:
+    /**
+     * Fill m_innerKeyFilter with the search key prefix of every tuple in the
+     * inner table.  Returns false if some inner key could not be converted to
+     * the index key type, in which case the filter must not be used.
+     */
+    bool buildInnerKeyFilter(PersistentTable* innerTable, TableIndex* index, int numOfSearchKeys);
+
+    // True for equality lookups on key types that hash the way they compare
+    bool m_bloomFilterEligible;
+    // Filter over the inner table's search key prefixes, rebuilt by each
+    // p_execute that decides it is worthwhile
+    BlockedBloomFilter m_innerKeyFilter;
+    StandAloneTupleStorage m_innerKeyValues;
 };
 
 }
@@ -47,6 +47,7 @@
 #include "execution/ProgressMonitorProxy.h"
 #include "plannodes/orderbynode.h"
 #include "plannodes/limitnode.h"
+#include "storage/LargeTempTable.h"
 #include "storage/tableiterator.h"
 #include "storage/tablefactory.h"
 
@@ -57,8 +58,6 @@ OrderByExecutor::p_init(AbstractPlanNode* abstract_node,
                         const ExecutorVector& executorVector)
 {
     VOLT_TRACE("init OrderBy Executor");
-    // We cannot yet do any sorting with large queries.
-    assert(! executorVector.isLargeQuery());
 
     OrderByPlanNode* node = dynamic_cast<OrderByPlanNode*>(abstract_node);
     assert(node);
@@ -69,7 +68,9 @@ OrderByExecutor::p_init(AbstractPlanNode* abstract_node,
         assert(node->getChildren()[0] != NULL);
 
         //
-        // Our output table should look exactly like our input table
+        // Our output table should look exactly like our input table.
+        // In a large query it is a large temp table, which is sorted
+        // externally in p_execute.
         //
         node->setOutputTable(TableFactory::buildCopiedTempTable(node->getInputTable()->name(),
                                                                 node->getInputTable(),
@@ -120,6 +121,15 @@ OrderByExecutor::p_execute(const NValueArray &params)
     VOLT_TRACE("Input Table:\n '%s'", input_table->debug().c_str());
     TableTuple tuple(input_table->schema());
 
+    LargeTempTable* large_output_table = dynamic_cast<LargeTempTable*>(output_table);
+    if (large_output_table != NULL) {
+        if (limit != 0) {
+            externalSort(input_table, large_output_table, limit, offset);
+        }
+        VOLT_TRACE("Result of OrderBy:\n '%s'", output_table->debug().c_str());
+        return true;
+    }
+
     // If limit == 0 we have no work here.  There's no need to sort anything,
     // or to fetch the vector of tuples from the input.  If limit < 0 we
     // need to do the loop below, though.  The only case where we can skip
@@ -177,6 +187,33 @@ OrderByExecutor::p_execute(const NValueArray &params)
     return true;
 }
 
+void
+OrderByExecutor::externalSort(Table* input_table, LargeTempTable* output_table,
+                              int limit, int offset)
+{
+    OrderByPlanNode* node = dynamic_cast<OrderByPlanNode*>(m_abstractNode);
+    assert(node);
+
+    // Copy the input into the output table, freeing the input's blocks
+    // as they are consumed, so the input never has to fit in memory.
+    ProgressMonitorProxy pmp(m_engine->getExecutorContext(), this);
+    TableTuple tuple(input_table->schema());
+    TableIterator iterator = input_table->iteratorDeletingAsWeGo();
+    while (iterator.next(tuple))
+    {
+        pmp.countdownProgress();
+        output_table->insertTuple(tuple);
+    }
+    output_table->finishInserts();
+
+    // Sorts each block into a run, then merges the runs as many at a
+    // time as the block cache can hold, applying the limit and offset
+    // in the last pass.
+    output_table->sort(AbstractExecutor::TupleComparer(node->getSortExpressions(),
+                                                       node->getSortDirections()),
+                       limit, offset < 0 ? 0 : offset);
+}
+
 OrderByExecutor::~OrderByExecutor() {
 }
 
@@ -55,6 +55,7 @@ namespace voltdb {
     class UndoLog;
     class ReadWriteSet;
     class LimitPlanNode;
+    class LargeTempTable;
 
     /**
      *
@@ -72,6 +73,10 @@ namespace voltdb {
         bool p_execute(const NValueArray &params);
 
     private:
+        /** Sort an input too large for memory into a large temp table. */
+        void externalSort(Table* input_table, LargeTempTable* output_table,
+                          int limit, int offset);
+
         LimitPlanNode *limit_node;
     };
 
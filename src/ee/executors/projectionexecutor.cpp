@@ -126,33 +126,45 @@ bool ProjectionExecutor::p_execute(const NValueArray &params) {
     TableIterator iterator = input_table->iteratorDeletingAsWeGo();
     assert (m_tuple.columnCount() == input_table->columnCount());
     while (iterator.next(m_tuple)) {
-        //
-        // Project (or replace) values from input tuple
-        //
-        TableTuple &temp_tuple = m_outputTable->tempTuple();
-        if (m_allTupleArray != NULL) {
-            VOLT_TRACE("sweet, all tuples");
-            for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
-                temp_tuple.setNValue(ctr, m_tuple.getNValue(m_allTupleArray[ctr]));
-            }
-        } else if (m_allParamArray != NULL) {
-            VOLT_TRACE("sweet, all params");
-            for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
-                temp_tuple.setNValue(ctr, params[m_allParamArray[ctr]]);
-            }
-        } else {
-            for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
-                temp_tuple.setNValue(ctr, expression_array[ctr]->eval(&m_tuple, NULL));
-            }
-        }
-        m_outputTable->insertTempTuple(temp_tuple);
-
-        VOLT_TRACE("OUTPUT TABLE: %s\n", m_outputTable->debug().c_str());
+        projectTuple(m_tuple, params);
     }
 
     return true;
 }
 
+void ProjectionExecutor::p_pipeline_init(const NValueArray &params) {
+    m_params = &params;
+}
+
+void ProjectionExecutor::p_pipeline_tuple(TableTuple &tuple) {
+    projectTuple(tuple, *m_params);
+}
+
+void ProjectionExecutor::projectTuple(const TableTuple &input, const NValueArray &params) {
+    //
+    // Project (or replace) values from input tuple
+    //
+    TableTuple &temp_tuple = m_outputTable->tempTuple();
+    if (m_allTupleArray != NULL) {
+        VOLT_TRACE("sweet, all tuples");
+        for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
+            temp_tuple.setNValue(ctr, input.getNValue(m_allTupleArray[ctr]));
+        }
+    } else if (m_allParamArray != NULL) {
+        VOLT_TRACE("sweet, all params");
+        for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
+            temp_tuple.setNValue(ctr, params[m_allParamArray[ctr]]);
+        }
+    } else {
+        for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
+            temp_tuple.setNValue(ctr, expression_array[ctr]->eval(&input, NULL));
+        }
+    }
+    m_outputTable->insertTempTuple(temp_tuple);
+
+    VOLT_TRACE("OUTPUT TABLE: %s\n", m_outputTable->debug().c_str());
+}
+
 ProjectionExecutor::~ProjectionExecutor() {
 }
 
@@ -66,14 +66,22 @@ class ProjectionExecutor : public AbstractExecutor {
     public:
         ProjectionExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node) : AbstractExecutor(engine, abstract_node) {
             m_outputTable = NULL;
+            m_params = NULL;
         }
         ~ProjectionExecutor();
+
+        bool supportsPipelinedInput() const { return true; }
     protected:
         bool p_init(AbstractPlanNode*,
                     const ExecutorVector& executorVector);
         bool p_execute(const NValueArray &params);
 
+        void p_pipeline_init(const NValueArray &params);
+        void p_pipeline_tuple(TableTuple &tuple);
+
     private:
+        void projectTuple(const TableTuple &input, const NValueArray &params);
+
         AbstractTempTable* m_outputTable;
         int m_columnCount;
         boost::shared_array<int> m_allTupleArrayPtr;
@@ -83,6 +91,8 @@ class ProjectionExecutor : public AbstractExecutor {
         boost::shared_array<bool> m_needsSubstitutePtr;
         bool *m_needsSubstitute;
         TableTuple m_tuple;
+        // The parameters of the current execution, while pipelined
+        const NValueArray *m_params;
 
         boost::shared_array<AbstractExpression*> expression_array_ptr;
         AbstractExpression** expression_array;
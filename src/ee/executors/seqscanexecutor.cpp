@@ -54,6 +54,8 @@
 #include "storage/temptable.h"
 #include "storage/tablefactory.h"
 
+#include <algorithm>
+
 using namespace voltdb;
 
 bool SeqScanExecutor::p_init(AbstractPlanNode* abstract_node,
@@ -82,6 +84,16 @@ bool SeqScanExecutor::p_init(AbstractPlanNode* abstract_node,
     // confuses things.
     assert(m_aggExec == NULL || m_insertExec == NULL);
 
+    // Batch evaluation reads tuples in place a batch at a time, so
+    // it is only used for persistent tables, whose tuples stay put
+    // for the whole scan.
+    m_batchPredicate.reset();
+    if (node->isBatched() && node->isPersistentTableScan() &&
+        node->getPredicate() != NULL) {
+        m_batchPredicate.reset(BatchPredicate::compile(node->getPredicate(),
+                                                       node->getTargetTable()->schema()));
+    }
+
     //
     // OPTIMIZATION: If there is no predicate for this SeqScan,
     // then we want to just set our OutputTable pointer to be the
@@ -202,8 +214,17 @@ bool SeqScanExecutor::p_execute(const NValueArray &params) {
         if (limit_node) {
             limit_node->getLimitAndOffsetByReference(params, limit, offset);
         }
+        // If the predicate is evaluated in batches the postfilter
+        // only applies the limit and offset.
+        BatchPredicate* batchPredicate = NULL;
+        if (m_batchPredicate && m_batchPredicate->bind()) {
+            batchPredicate = m_batchPredicate.get();
+        }
+
         // Initialize the postfilter
-        CountingPostfilter postfilter(m_tmpOutputTable, predicate, limit, offset);
+        CountingPostfilter postfilter(m_tmpOutputTable,
+                                      batchPredicate == NULL ? predicate : NULL,
+                                      limit, offset);
 
         ProgressMonitorProxy pmp(m_engine->getExecutorContext(), this);
         TableTuple temp_tuple;
@@ -251,45 +272,72 @@ bool SeqScanExecutor::p_execute(const NValueArray &params) {
             temp_tuple = m_tmpOutputTable->tempTuple();
         }
 
-        while (postfilter.isUnderLimit() && iterator.next(tuple))
-        {
-#if   defined(VOLT_TRACE_ENABLED)
-            int tuple_ctr = 0;
-#endif
-            VOLT_TRACE("INPUT TUPLE: %s, %d/%d\n",
-                       tuple.debug(input_table->name()).c_str(),
-                       ++tuple_ctr,
-                       (int)input_table->activeTupleCount());
-            pmp.countdownProgress();
-
+        if (batchPredicate != NULL) {
             //
-            // For each tuple we need to evaluate it against our predicate and limit/offset
+            // Gather a batch of tuples, evaluate the predicate over
+            // all of them at once and then output the ones that
+            // satisfy it.
             //
-            if (postfilter.eval(&tuple, NULL))
+            // With a limit and nothing inline that consumes the rows,
+            // only limit + offset selected tuples are ever needed.  The
+            // batches start out no bigger than that and double while
+            // the predicate keeps filtering, so that a LIMIT 1 scan
+            // doesn't read a full batch to output one row.
+            int wanted = -1;
+            if (limit >= 0 && m_aggExec == NULL && m_insertExec == NULL) {
+                wanted = limit + (offset > 0 ? offset : 0);
+            }
+            char* batch[BatchPredicate::BATCH_SIZE];
+            char selected[BatchPredicate::BATCH_SIZE];
+            int batchSize = wanted > 0 ? 0 : BatchPredicate::BATCH_SIZE;
+            bool hasMore = true;
+            while (hasMore && postfilter.isUnderLimit() && wanted != 0) {
+                if (wanted > 0) {
+                    batchSize = std::min(BatchPredicate::BATCH_SIZE,
+                                         std::max(wanted, batchSize * 2));
+                }
+                int count = 0;
+                while (count < batchSize && (hasMore = iterator.next(tuple))) {
+                    pmp.countdownProgress();
+                    batch[count++] = tuple.address();
+                }
+                batchPredicate->eval(batch, count, selected);
+                for (int i = 0; i < count && postfilter.isUnderLimit() && wanted != 0; ++i) {
+                    if (selected[i]) {
+                        if (wanted > 0) {
+                            --wanted;
+                        }
+                        tuple.move(batch[i]);
+                        if (postfilter.eval(&tuple, NULL)) {
+                            projectAndOutputTuple(tuple, temp_tuple, projectionNode, num_of_columns);
+                            pmp.countdownProgress();
+                        }
+                    }
+                }
+            }
+        }
+        else {
+            while (postfilter.isUnderLimit() && iterator.next(tuple))
             {
+#if   defined(VOLT_TRACE_ENABLED)
+                int tuple_ctr = 0;
+#endif
+                VOLT_TRACE("INPUT TUPLE: %s, %d/%d\n",
+                           tuple.debug(input_table->name()).c_str(),
+                           ++tuple_ctr,
+                           (int)input_table->activeTupleCount());
+                pmp.countdownProgress();
+
                 //
-                // Nested Projection
-                // Project (or replace) values from input tuple
+                // For each tuple we need to evaluate it against our predicate and limit/offset
                 //
-                if (projectionNode != NULL)
+                if (postfilter.eval(&tuple, NULL))
                 {
-                    VOLT_TRACE("inline projection...");
-                    // Project the scanned table row onto
-                    // the columns of the select list in the
-                    // select statement.
-                    for (int ctr = 0; ctr < num_of_columns; ctr++) {
-                        NValue value = projectionNode->getOutputColumnExpressions()[ctr]->eval(&tuple, NULL);
-                        temp_tuple.setNValue(ctr, value);
-                    }
-                    outputTuple(temp_tuple);
+                    projectAndOutputTuple(tuple, temp_tuple, projectionNode, num_of_columns);
+                    pmp.countdownProgress();
                 }
-                else
-                {
-                    outputTuple(tuple);
-                }
-                pmp.countdownProgress();
-            }
-        } // end while we have more tuples to scan
+            } // end while we have more tuples to scan
+        }
 
         if (m_aggExec != NULL) {
             m_aggExec->p_execute_finish();
@@ -307,6 +355,32 @@ bool SeqScanExecutor::p_execute(const NValueArray &params) {
     return true;
 }
 
+void SeqScanExecutor::projectAndOutputTuple(TableTuple& tuple,
+                                            TableTuple& temp_tuple,
+                                            ProjectionPlanNode* projectionNode,
+                                            int num_of_columns) {
+    //
+    // Nested Projection
+    // Project (or replace) values from input tuple
+    //
+    if (projectionNode != NULL)
+    {
+        VOLT_TRACE("inline projection...");
+        // Project the scanned table row onto
+        // the columns of the select list in the
+        // select statement.
+        for (int ctr = 0; ctr < num_of_columns; ctr++) {
+            NValue value = projectionNode->getOutputColumnExpressions()[ctr]->eval(&tuple, NULL);
+            temp_tuple.setNValue(ctr, value);
+        }
+        outputTuple(temp_tuple);
+    }
+    else
+    {
+        outputTuple(tuple);
+    }
+}
+
 /*
  * We may output a tuple to an inline aggregate or
  * inline insert node.  If there is a limit or projection, this will have
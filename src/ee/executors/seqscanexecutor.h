@@ -50,12 +50,16 @@
 #include "common/valuevector.h"
 #include "executors/abstractexecutor.h"
 #include "execution/VoltDBEngine.h"
+#include "expressions/batchpredicate.h"
+
+#include <boost/scoped_ptr.hpp>
 
 namespace voltdb
 {
     class AggregateExecutorBase;
     struct CountingPostfilter;
     class InsertExecutor;
+    class ProjectionPlanNode;
 
     class SeqScanExecutor : public AbstractExecutor {
     public:
@@ -77,6 +81,15 @@ namespace voltdb
          */
         void outputTuple(TableTuple& tuple);
 
+        /**
+         * Apply the inline projection, if any, to a tuple that
+         * passed the predicate and limit, and output it.
+         */
+        void projectAndOutputTuple(TableTuple& tuple,
+                                   TableTuple& temp_tuple,
+                                   ProjectionPlanNode* projectionNode,
+                                   int num_of_columns);
+
         // These are logically local variables to p_execute.
         // But we need to share them between p_execute and
         // outputTuple, so we save them here.  They come out of
@@ -85,6 +98,10 @@ namespace voltdb
         // freeing them.
         AggregateExecutorBase* m_aggExec;
         InsertExecutor* m_insertExec;
+
+        // The predicate compiled for batch evaluation, if the plan
+        // asked for it and the predicate supports it.
+        boost::scoped_ptr<BatchPredicate> m_batchPredicate;
     };
 }
 
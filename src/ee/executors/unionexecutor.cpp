@@ -373,4 +373,15 @@ bool UnionExecutor::p_execute(const NValueArray &params) {
     return m_setOperator->processTuples();
 }
 
+bool UnionExecutor::supportsPipelinedInput() const {
+    // Only UNION ALL passes its input through without looking back at it.
+    const UnionPlanNode* node = dynamic_cast<const UnionPlanNode*>(m_abstractNode);
+    assert(node);
+    return node->getUnionType() == UNION_TYPE_UNION_ALL;
+}
+
+void UnionExecutor::p_pipeline_tuple(TableTuple &tuple) {
+    m_tmpOutputTable->insertTempTuple(tuple);
+}
+
 }
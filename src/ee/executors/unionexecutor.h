@@ -68,11 +68,15 @@ class UnionExecutor : public AbstractExecutor {
     public:
         UnionExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node);
 
+        bool supportsPipelinedInput() const;
+
     protected:
         bool p_init(AbstractPlanNode*,
                     const ExecutorVector& executorVector);
         bool p_execute(const NValueArray &params);
 
+        void p_pipeline_tuple(TableTuple &tuple);
+
     private:
         boost::shared_ptr<detail::SetOperator> m_setOperator;
 };
@@ -0,0 +1,486 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "expressions/batchpredicate.h"
+
+#include "common/tabletuple.h"
+#include "common/TupleSchema.h"
+#include "common/ValuePeeker.hpp"
+#include "common/value_defs.h"
+#include "expressions/abstractexpression.h"
+#include "expressions/tuplevalueexpression.h"
+
+#include <boost/scoped_ptr.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace voltdb {
+
+namespace {
+
+/**
+ * Map a double onto an int64_t so that comparing the integers orders the
+ * doubles the way NValue does: -0.0 equals 0.0, and NaN equals NaN and
+ * is smaller than every other value.  This lets all comparisons share
+ * the same integer kernels.
+ */
+inline int64_t doubleKey(double value)
+{
+    if (std::isnan(value)) {
+        return INT64_MIN;
+    }
+    value += 0.0; // turns -0.0 into 0.0
+    int64_t bits;
+    ::memcpy(&bits, &value, sizeof(bits));
+    return bits ^ ((bits >> 63) & INT64_MAX);
+}
+
+/** Whether values of the type are compared as 64-bit integers. */
+bool hasIntegerKey(ValueType type)
+{
+    switch (type) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+template <typename T>
+void loadIntegers(char* const* tuples, int count, uint32_t offset, T nullValue,
+                  bool asDouble, int64_t* keys, char* nulls)
+{
+    if (asDouble) {
+        for (int i = 0; i < count; ++i) {
+            T value;
+            ::memcpy(&value, tuples[i] + offset, sizeof(T));
+            keys[i] = doubleKey(static_cast<double>(value));
+            nulls[i] = (value == nullValue);
+        }
+    }
+    else {
+        for (int i = 0; i < count; ++i) {
+            T value;
+            ::memcpy(&value, tuples[i] + offset, sizeof(T));
+            keys[i] = value;
+            nulls[i] = (value == nullValue);
+        }
+    }
+}
+
+void loadDoubles(char* const* tuples, int count, uint32_t offset,
+                 int64_t* keys, char* nulls)
+{
+    for (int i = 0; i < count; ++i) {
+        double value;
+        ::memcpy(&value, tuples[i] + offset, sizeof(double));
+        keys[i] = doubleKey(value);
+        nulls[i] = (value <= DOUBLE_NULL);
+    }
+}
+
+/**
+ * One side of a comparison: either a numeric column of the scanned
+ * tuple, or a constant or parameter that is evaluated once per
+ * execution.
+ */
+class Operand {
+public:
+    static Operand* compile(const AbstractExpression* expr, const TupleSchema* schema)
+    {
+        switch (expr->getExpressionType()) {
+        case EXPRESSION_TYPE_VALUE_TUPLE: {
+            const TupleValueExpression* tve = static_cast<const TupleValueExpression*>(expr);
+            if (tve->getTupleId() != 0 || tve->getColumnId() >= schema->columnCount()) {
+                return NULL;
+            }
+            const TupleSchema::ColumnInfo* info = schema->getColumnInfo(tve->getColumnId());
+            ValueType type = info->getVoltType();
+            if ( ! hasIntegerKey(type) && type != VALUE_TYPE_DOUBLE) {
+                return NULL;
+            }
+            return new Operand(NULL, type, TUPLE_HEADER_SIZE + info->offset);
+        }
+        case EXPRESSION_TYPE_VALUE_CONSTANT:
+        case EXPRESSION_TYPE_VALUE_PARAMETER:
+            return new Operand(expr, VALUE_TYPE_INVALID, 0);
+        default:
+            return NULL;
+        }
+    }
+
+    bool isColumn() const { return m_value == NULL; }
+
+    bool isDouble() const { return m_type == VALUE_TYPE_DOUBLE; }
+
+    bool isTimestamp() const { return m_type == VALUE_TYPE_TIMESTAMP; }
+
+    bool isNull() const { return m_isNull; }
+
+    /** Evaluate a constant or parameter for the current execution. */
+    bool bind()
+    {
+        if (isColumn()) {
+            return true;
+        }
+        NValue value = m_value->eval(NULL, NULL);
+        m_type = ValuePeeker::peekValueType(value);
+        m_isNull = value.isNull();
+        if (m_isNull) {
+            return true;
+        }
+        if (m_type == VALUE_TYPE_DOUBLE) {
+            m_double = ValuePeeker::peekDouble(value);
+            return true;
+        }
+        if (hasIntegerKey(m_type)) {
+            m_bigint = ValuePeeker::peekAsBigInt(value);
+            return true;
+        }
+        return false;
+    }
+
+    /** The key of a bound constant or parameter. */
+    int64_t key(bool asDouble) const
+    {
+        if (m_type == VALUE_TYPE_DOUBLE) {
+            return doubleKey(m_double);
+        }
+        return asDouble ? doubleKey(static_cast<double>(m_bigint)) : m_bigint;
+    }
+
+    /** Read the column from each tuple in the batch. */
+    void load(char* const* tuples, int count, bool asDouble, int64_t* keys, char* nulls) const
+    {
+        switch (m_type) {
+        case VALUE_TYPE_TINYINT:
+            loadIntegers<int8_t>(tuples, count, m_offset, INT8_NULL, asDouble, keys, nulls);
+            break;
+        case VALUE_TYPE_SMALLINT:
+            loadIntegers<int16_t>(tuples, count, m_offset, INT16_NULL, asDouble, keys, nulls);
+            break;
+        case VALUE_TYPE_INTEGER:
+            loadIntegers<int32_t>(tuples, count, m_offset, INT32_NULL, asDouble, keys, nulls);
+            break;
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+            loadIntegers<int64_t>(tuples, count, m_offset, INT64_NULL, asDouble, keys, nulls);
+            break;
+        case VALUE_TYPE_DOUBLE:
+            loadDoubles(tuples, count, m_offset, keys, nulls);
+            break;
+        default:
+            assert(false);
+        }
+    }
+
+private:
+    Operand(const AbstractExpression* value, ValueType type, uint32_t offset)
+        : m_value(value)
+        , m_type(type)
+        , m_offset(offset)
+        , m_isNull(false)
+        , m_bigint(0)
+        , m_double(0.0)
+    { }
+
+    // The constant or parameter expression, or NULL for a column
+    const AbstractExpression* m_value;
+    // The column type, or the type of the bound value
+    ValueType m_type;
+    // Offset of the column from the start of the tuple storage
+    const uint32_t m_offset;
+    bool m_isNull;
+    int64_t m_bigint;
+    double m_double;
+};
+
+struct KeyEq  { static bool apply(int64_t l, int64_t r) { return l == r; } };
+struct KeyNe  { static bool apply(int64_t l, int64_t r) { return l != r; } };
+struct KeyLt  { static bool apply(int64_t l, int64_t r) { return l < r; } };
+struct KeyGt  { static bool apply(int64_t l, int64_t r) { return l > r; } };
+struct KeyLte { static bool apply(int64_t l, int64_t r) { return l <= r; } };
+struct KeyGte { static bool apply(int64_t l, int64_t r) { return l >= r; } };
+
+template <class OP>
+void compareKeys(const int64_t* leftKeys, const char* leftNulls,
+                 const int64_t* rightKeys, const char* rightNulls,
+                 int count, char* selected)
+{
+    for (int i = 0; i < count; ++i) {
+        selected[i] = static_cast<char>(!(leftNulls[i] | rightNulls[i]) &
+                                        OP::apply(leftKeys[i], rightKeys[i]));
+    }
+}
+
+template <class OP>
+void compareKeysToScalar(const int64_t* leftKeys, const char* leftNulls,
+                         int64_t right, int count, char* selected)
+{
+    for (int i = 0; i < count; ++i) {
+        selected[i] = static_cast<char>(!leftNulls[i] & OP::apply(leftKeys[i], right));
+    }
+}
+
+template <class OP>
+void compare(const int64_t* leftKeys, const char* leftNulls,
+             const int64_t* rightKeys, const char* rightNulls,
+             bool rightIsScalar, int count, char* selected)
+{
+    if (rightIsScalar) {
+        compareKeysToScalar<OP>(leftKeys, leftNulls, rightKeys[0], count, selected);
+    }
+    else {
+        compareKeys<OP>(leftKeys, leftNulls, rightKeys, rightNulls, count, selected);
+    }
+}
+
+/** Flip a comparison so that its operands can be swapped. */
+ExpressionType reverseComparison(ExpressionType type)
+{
+    switch (type) {
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+        return EXPRESSION_TYPE_COMPARE_GREATERTHAN;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+        return EXPRESSION_TYPE_COMPARE_LESSTHAN;
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+        return EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+        return EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO;
+    default:
+        return type;
+    }
+}
+
+class BatchComparison : public BatchPredicate {
+public:
+    BatchComparison(ExpressionType type, Operand* left, Operand* right)
+        : m_type(type)
+        , m_left(left)
+        , m_right(right)
+        , m_asDouble(false)
+    {
+        // Keep any column on the left so that the scalar case only has
+        // to be handled on the right.
+        if ( ! m_left->isColumn() && m_right->isColumn()) {
+            m_left.swap(m_right);
+            m_type = reverseComparison(m_type);
+        }
+    }
+
+    bool bind()
+    {
+        if ( ! m_left->bind() || ! m_right->bind()) {
+            return false;
+        }
+        // A TIMESTAMP is only compared with another TIMESTAMP here.
+        // Mixed comparisons go through NValue, which owns their rules.
+        if (m_left->isTimestamp() != m_right->isTimestamp() &&
+            ! m_left->isNull() && ! m_right->isNull()) {
+            return false;
+        }
+        m_asDouble = m_left->isDouble() || m_right->isDouble();
+        return true;
+    }
+
+    void eval(char* const* tuples, int count, char* selected)
+    {
+        assert(count <= BATCH_SIZE);
+        if ( ! m_left->isColumn()) {
+            // Both sides are scalars, so every tuple gets the same answer.
+            bool result = false;
+            if ( ! m_left->isNull() && ! m_right->isNull()) {
+                m_leftKeys[0] = m_left->key(m_asDouble);
+                m_rightKeys[0] = m_right->key(m_asDouble);
+                m_leftNulls[0] = 0;
+                dispatch(1, selected);
+                result = selected[0];
+            }
+            ::memset(selected, result, count);
+            return;
+        }
+
+        bool rightIsScalar = ! m_right->isColumn();
+        if (rightIsScalar && m_right->isNull()) {
+            ::memset(selected, 0, count);
+            return;
+        }
+        m_left->load(tuples, count, m_asDouble, m_leftKeys, m_leftNulls);
+        if (rightIsScalar) {
+            m_rightKeys[0] = m_right->key(m_asDouble);
+        }
+        else {
+            m_right->load(tuples, count, m_asDouble, m_rightKeys, m_rightNulls);
+        }
+        dispatch(count, selected);
+    }
+
+private:
+    void dispatch(int count, char* selected)
+    {
+        bool rightIsScalar = ! m_right->isColumn();
+        switch (m_type) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+            compare<KeyEq>(m_leftKeys, m_leftNulls, m_rightKeys, m_rightNulls, rightIsScalar, count, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+            compare<KeyNe>(m_leftKeys, m_leftNulls, m_rightKeys, m_rightNulls, rightIsScalar, count, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+            compare<KeyLt>(m_leftKeys, m_leftNulls, m_rightKeys, m_rightNulls, rightIsScalar, count, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+            compare<KeyGt>(m_leftKeys, m_leftNulls, m_rightKeys, m_rightNulls, rightIsScalar, count, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            compare<KeyLte>(m_leftKeys, m_leftNulls, m_rightKeys, m_rightNulls, rightIsScalar, count, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            compare<KeyGte>(m_leftKeys, m_leftNulls, m_rightKeys, m_rightNulls, rightIsScalar, count, selected);
+            break;
+        default:
+            assert(false);
+        }
+    }
+
+    ExpressionType m_type;
+    boost::scoped_ptr<Operand> m_left;
+    boost::scoped_ptr<Operand> m_right;
+    // Whether this execution compares as doubles rather than integers
+    bool m_asDouble;
+    int64_t m_leftKeys[BATCH_SIZE];
+    int64_t m_rightKeys[BATCH_SIZE];
+    char m_leftNulls[BATCH_SIZE];
+    char m_rightNulls[BATCH_SIZE];
+};
+
+class BatchIsNull : public BatchPredicate {
+public:
+    BatchIsNull(Operand* column) : m_column(column) { }
+
+    bool bind() { return true; }
+
+    void eval(char* const* tuples, int count, char* selected)
+    {
+        assert(count <= BATCH_SIZE);
+        m_column->load(tuples, count, false, m_keys, selected);
+    }
+
+private:
+    boost::scoped_ptr<Operand> m_column;
+    int64_t m_keys[BATCH_SIZE];
+};
+
+/**
+ * AND or OR of two batch predicates.  The right side is skipped for a
+ * batch when the left side already decides every tuple in it.
+ */
+template <bool IS_AND>
+class BatchConjunction : public BatchPredicate {
+public:
+    BatchConjunction(BatchPredicate* left, BatchPredicate* right)
+        : m_left(left)
+        , m_right(right)
+    { }
+
+    bool bind()
+    {
+        return m_left->bind() && m_right->bind();
+    }
+
+    void eval(char* const* tuples, int count, char* selected)
+    {
+        assert(count <= BATCH_SIZE);
+        m_left->eval(tuples, count, selected);
+        int decided = 0;
+        for (int i = 0; i < count; ++i) {
+            decided += (selected[i] != IS_AND);
+        }
+        if (decided == count) {
+            return;
+        }
+        m_right->eval(tuples, count, m_scratch);
+        for (int i = 0; i < count; ++i) {
+            selected[i] = IS_AND ? (selected[i] & m_scratch[i]) : (selected[i] | m_scratch[i]);
+        }
+    }
+
+private:
+    boost::scoped_ptr<BatchPredicate> m_left;
+    boost::scoped_ptr<BatchPredicate> m_right;
+    char m_scratch[BATCH_SIZE];
+};
+
+} // namespace
+
+BatchPredicate* BatchPredicate::compile(const AbstractExpression* predicate,
+                                        const TupleSchema* schema)
+{
+    if (predicate == NULL) {
+        return NULL;
+    }
+    ExpressionType type = predicate->getExpressionType();
+    switch (type) {
+    case EXPRESSION_TYPE_CONJUNCTION_AND:
+    case EXPRESSION_TYPE_CONJUNCTION_OR: {
+        std::unique_ptr<BatchPredicate> left(compile(predicate->getLeft(), schema));
+        std::unique_ptr<BatchPredicate> right(compile(predicate->getRight(), schema));
+        if ( ! left || ! right) {
+            return NULL;
+        }
+        if (type == EXPRESSION_TYPE_CONJUNCTION_AND) {
+            return new BatchConjunction<true>(left.release(), right.release());
+        }
+        return new BatchConjunction<false>(left.release(), right.release());
+    }
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+    case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO: {
+        std::unique_ptr<Operand> left(Operand::compile(predicate->getLeft(), schema));
+        std::unique_ptr<Operand> right(Operand::compile(predicate->getRight(), schema));
+        if ( ! left || ! right) {
+            return NULL;
+        }
+        if (left->isColumn() && right->isColumn() &&
+            left->isTimestamp() != right->isTimestamp()) {
+            return NULL;
+        }
+        return new BatchComparison(type, left.release(), right.release());
+    }
+    case EXPRESSION_TYPE_OPERATOR_IS_NULL: {
+        Operand* column = Operand::compile(predicate->getLeft(), schema);
+        if (column != NULL && ! column->isColumn()) {
+            delete column;
+            return NULL;
+        }
+        return column == NULL ? NULL : new BatchIsNull(column);
+    }
+    default:
+        return NULL;
+    }
+}
+
+} // namespace voltdb
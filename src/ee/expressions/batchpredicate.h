@@ -0,0 +1,75 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCHPREDICATE_H
+#define BATCHPREDICATE_H
+
+namespace voltdb {
+
+class AbstractExpression;
+class TupleSchema;
+
+/**
+ * Evaluates a scan predicate over a batch of tuples at a time.  Numeric
+ * columns are read straight out of tuple storage into arrays, which are
+ * then compared in simple loops that the compiler can vectorize, instead
+ * of building an NValue per column per row as AbstractExpression::eval
+ * does.
+ *
+ * Only predicates built from AND, OR, IS NULL and comparisons of
+ * TINYINT, SMALLINT, INTEGER, BIGINT, TIMESTAMP and DOUBLE columns,
+ * constants and parameters are supported, where a TIMESTAMP is only
+ * compared with another TIMESTAMP.  compile() returns NULL for
+ * anything else, and the caller should keep evaluating the predicate
+ * tuple by tuple.  A NULL operand makes a comparison false rather than
+ * unknown, which gives the same answer as eval() for a filter as long as
+ * there is no NOT in the tree, so NOT is not supported either.
+ */
+class BatchPredicate {
+public:
+    static const int BATCH_SIZE = 1024;
+
+    /**
+     * Build a batch evaluator for the given predicate over tuples with
+     * the given schema, or return NULL if the predicate can't be
+     * evaluated in batches.  The predicate must outlive the result.
+     */
+    static BatchPredicate* compile(const AbstractExpression* predicate,
+                                   const TupleSchema* schema);
+
+    virtual ~BatchPredicate() { }
+
+    /**
+     * Evaluate the constants and parameters in the predicate for the
+     * current execution.  Returns false if any of them has a type the
+     * batch kernels don't handle, or compares a TIMESTAMP with a value
+     * of another type, in which case the predicate must be
+     * evaluated tuple by tuple for this execution.
+     */
+    virtual bool bind() = 0;
+
+    /**
+     * Set selected[i] to 1 if the tuple whose storage starts at
+     * tuples[i] satisfies the predicate, and to 0 if it doesn't.
+     * count must not exceed BATCH_SIZE.
+     */
+    virtual void eval(char* const* tuples, int count, char* selected) = 0;
+};
+
+}
+
+#endif
@@ -49,6 +49,8 @@
 #include "common/common.h"
 #include "common/serializeio.h"
 #include "common/valuevector.h"
+#include "common/tabletuple.h"
+#include "common/ValuePeeker.hpp"
 
 #include "expressions/abstractexpression.h"
 #include "expressions/parametervalueexpression.h"
@@ -57,6 +59,8 @@
 
 #include <string>
 #include <cassert>
+#include <cstring>
+#include <limits>
 
 namespace voltdb {
 
@@ -75,6 +79,8 @@ namespace voltdb {
 // isNullRejecting() returns true if the comparison does not consider NULL values as valid ones
 // during comparison. All comparison except "is distinct from" are null rejecting, therefore
 // returning true.
+// "compareIntegers" applies the same operator to two non-null integer values that have
+// been widened to int64_t, for the ColumnComparisonExpression fast path.
 
 class CmpEq {
 public:
@@ -89,6 +95,7 @@ public:
     inline static bool implies_false_for_row(const NValue& l, const NValue& r) { return true; }
     inline static bool implies_null_for_row() { return false; }
     inline static bool includes_equality() { return true; }
+    inline static bool compareIntegers(int64_t l, int64_t r) { return l == r; }
     inline static bool isNullRejecting() { return true; }
 };
 
@@ -113,6 +120,7 @@ public:
     inline static bool implies_false_for_row(const NValue& l, const NValue& r) { return false; }
     inline static bool implies_null_for_row() { return false; }
     inline static bool includes_equality() { return false; }
+    inline static bool compareIntegers(int64_t l, int64_t r) { return l != r; }
     inline static bool isNullRejecting() { return true; }
 };
 
@@ -130,6 +138,7 @@ public:
     { return l.op_notEquals_withoutNull(r).isTrue(); }
     inline static bool implies_null_for_row() { return true; }
     inline static bool includes_equality() { return false; }
+    inline static bool compareIntegers(int64_t l, int64_t r) { return l < r; }
     inline static bool isNullRejecting() { return true; }
 };
 
@@ -147,6 +156,7 @@ public:
     { return l.op_notEquals_withoutNull(r).isTrue(); }
     inline static bool implies_null_for_row() { return true; }
     inline static bool includes_equality() { return false; }
+    inline static bool compareIntegers(int64_t l, int64_t r) { return l > r; }
     inline static bool isNullRejecting() { return true; }
 };
 
@@ -164,6 +174,7 @@ public:
     inline static bool implies_false_for_row(const NValue& l, const NValue& r) { return true; }
     inline static bool implies_null_for_row() { return true; }
     inline static bool includes_equality() { return true; }
+    inline static bool compareIntegers(int64_t l, int64_t r) { return l <= r; }
     inline static bool isNullRejecting() { return true; }
 };
 
@@ -181,6 +192,7 @@ public:
     inline static bool implies_false_for_row(const NValue& l, const NValue& r) { return true; }
     inline static bool implies_null_for_row() { return true; }
     inline static bool includes_equality() { return true; }
+    inline static bool compareIntegers(int64_t l, int64_t r) { return l >= r; }
     inline static bool isNullRejecting() { return true; }
 };
 
@@ -286,5 +298,103 @@ public:
     {}
 };
 
+// Right-hand operands for ColumnComparisonExpression.  getInteger
+// returns false if the value is not a non-null integer, in which case the
+// comparison falls back to comparing NValues.
+
+/** An integer constant, extracted once when the expression is built. */
+class IntegerConstantOperand {
+public:
+    IntegerConstantOperand(const AbstractExpression* expr)
+        : m_value(ValuePeeker::peekAsRawInt64(expr->eval(NULL, NULL)))
+    {}
+
+    inline bool getInteger(int64_t& value) const
+    {
+        value = m_value;
+        return true;
+    }
+
+private:
+    const int64_t m_value;
+};
+
+/** A parameter, whose type is only known when the plan is executed. */
+class IntegerParameterOperand {
+public:
+    IntegerParameterOperand(const AbstractExpression* expr)
+        : m_param(static_cast<const ParameterValueExpression*>(expr)->getParamValue())
+    {}
+
+    inline bool getInteger(int64_t& value) const
+    {
+        if (m_param->isNull()) {
+            return false;
+        }
+        switch (ValuePeeker::peekValueType(*m_param)) {
+        case VALUE_TYPE_TINYINT:
+        case VALUE_TYPE_SMALLINT:
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+            value = ValuePeeker::peekAsRawInt64(*m_param);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+private:
+    const NValue* m_param;
+};
+
+/**
+ * A comparison of an integer or timestamp column with an integer
+ * constant or parameter, the most common shape of scan predicate.  The
+ * column is read straight out of the tuple as a T and compared as an
+ * int64_t, which avoids constructing NValues and dispatching on their
+ * types for every row.  If the tuple's column turns out not to have the
+ * expected type, or the parameter is not an integer, the comparison is
+ * done by ComparisonExpression instead.
+ */
+template <typename C, typename T, typename R>
+class ColumnComparisonExpression : public ComparisonExpression<C> {
+public:
+    ColumnComparisonExpression(ExpressionType type,
+                               TupleValueExpression *left,
+                               AbstractExpression *right)
+        : ComparisonExpression<C>(type, left, right)
+        , m_tupleIdx(left->getTupleId())
+        , m_columnId(left->getColumnId())
+        , m_columnType(left->getValueType())
+        , m_right(right)
+    {}
+
+    inline NValue eval(const TableTuple *tuple1, const TableTuple *tuple2) const
+    {
+        const TableTuple* tuple = (m_tupleIdx == 0) ? tuple1 : tuple2;
+        int64_t rightValue;
+        if (tuple != NULL && m_right.getInteger(rightValue)) {
+            const TupleSchema::ColumnInfo *columnInfo = tuple->getSchema()->getColumnInfo(m_columnId);
+            if (columnInfo->getVoltType() == m_columnType) {
+                T leftValue;
+                ::memcpy(&leftValue, tuple->address() + TUPLE_HEADER_SIZE + columnInfo->offset, sizeof(T));
+                // The null value of every integer type is its minimum
+                if (leftValue == std::numeric_limits<T>::min()) {
+                    return NValue::getNullValue(VALUE_TYPE_BOOLEAN);
+                }
+                return C::compareIntegers(leftValue, rightValue) ? NValue::getTrue() : NValue::getFalse();
+            }
+        }
+        return ComparisonExpression<C>::eval(tuple1, tuple2);
+    }
+
+private:
+    const int m_tupleIdx;
+    const int m_columnId;
+    const ValueType m_columnType;
+    const R m_right;
+};
+
 }
 #endif
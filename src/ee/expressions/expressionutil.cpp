@@ -262,6 +262,59 @@ getMoreSpecialized(ExpressionType c, L* l, R* r)
     }
 }
 
+template <typename C, typename R>
+static AbstractExpression*
+getColumnComparison(ExpressionType c, TupleValueExpression* l, AbstractExpression* r)
+{
+    switch (l->getValueType()) {
+    case (VALUE_TYPE_TINYINT):
+        return new ColumnComparisonExpression<C, int8_t, R>(c, l, r);
+    case (VALUE_TYPE_SMALLINT):
+        return new ColumnComparisonExpression<C, int16_t, R>(c, l, r);
+    case (VALUE_TYPE_INTEGER):
+        return new ColumnComparisonExpression<C, int32_t, R>(c, l, r);
+    case (VALUE_TYPE_BIGINT):
+    case (VALUE_TYPE_TIMESTAMP):
+        return new ColumnComparisonExpression<C, int64_t, R>(c, l, r);
+    default:
+        return NULL;
+    }
+}
+
+/** Specialize a comparison of an integer column with an integer constant
+ * or a parameter, or return NULL if it can't be. */
+template <typename R>
+static AbstractExpression*
+getColumnComparison(ExpressionType c, TupleValueExpression* l, AbstractExpression* r)
+{
+    switch (c) {
+    case (EXPRESSION_TYPE_COMPARE_EQUAL):
+        return getColumnComparison<CmpEq, R>(c, l, r);
+    case (EXPRESSION_TYPE_COMPARE_NOTEQUAL):
+        return getColumnComparison<CmpNe, R>(c, l, r);
+    case (EXPRESSION_TYPE_COMPARE_LESSTHAN):
+        return getColumnComparison<CmpLt, R>(c, l, r);
+    case (EXPRESSION_TYPE_COMPARE_GREATERTHAN):
+        return getColumnComparison<CmpGt, R>(c, l, r);
+    case (EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO):
+        return getColumnComparison<CmpLte, R>(c, l, r);
+    case (EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO):
+        return getColumnComparison<CmpGte, R>(c, l, r);
+    default:
+        return NULL;
+    }
+}
+
+static bool isIntegerConstant(ConstantValueExpression* expr)
+{
+    NValue value = expr->eval(NULL, NULL);
+    if (value.isNull()) {
+        return false;
+    }
+    ValueType type = ValuePeeker::peekValueType(value);
+    return isIntegralType(type) || type == VALUE_TYPE_TIMESTAMP;
+}
+
 /** convert the enumerated value type into a concrete c type for the
  * comparison helper templates. */
 AbstractExpression *
@@ -282,6 +335,31 @@ ExpressionUtil::comparisonFactory(PlannerDomValue obj, ExpressionType et, Abstra
     TupleValueExpression *r_tuple =
       dynamic_cast<TupleValueExpression*>(rc);
 
+    // IN list that only changes between executions: probe a hashed set.
+    if (et == EXPRESSION_TYPE_COMPARE_IN && rc != NULL && InListExpression::isRowInvariantList(rc)) {
+        return new InListExpression(et, lc, rc);
+    }
+
+    // LIKE against a pattern that is the same for every row: examine it once.
+    if (et == EXPRESSION_TYPE_COMPARE_LIKE && LikeExpression::isRowInvariantPattern(rc)) {
+        return new LikeExpression(et, lc, rc);
+    }
+
+    // Integer column compared with an integer constant or a parameter:
+    // read the column straight from the tuple.
+    if (l_tuple != NULL) {
+        AbstractExpression *specialized = NULL;
+        if (r_const != NULL && isIntegerConstant(r_const)) {
+            specialized = getColumnComparison<IntegerConstantOperand>(et, l_tuple, rc);
+        }
+        else if (dynamic_cast<ParameterValueExpression*>(rc) != NULL) {
+            specialized = getColumnComparison<IntegerParameterOperand>(et, l_tuple, rc);
+        }
+        if (specialized != NULL) {
+            return specialized;
+        }
+    }
+
     // this will inline getValue(), hooray!
     if (l_const != NULL && r_const != NULL) { // CONST-CONST can it happen?
         return getMoreSpecialized<ConstantValueExpression, ConstantValueExpression>(et, l_const, r_const);
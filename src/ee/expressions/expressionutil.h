@@ -90,6 +90,9 @@ public:
 
     static AbstractExpression* vectorFactory(ValueType vt, const std::vector<AbstractExpression*>* args);
 
+    /** Returns the elements of a VectorExpression, or NULL for any other expression. */
+    static const std::vector<AbstractExpression*>* vectorArguments(const AbstractExpression* expr);
+
 };
 
 }
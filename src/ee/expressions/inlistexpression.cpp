@@ -0,0 +1,189 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "expressions/inlistexpression.h"
+
+#include "common/executorcontext.hpp"
+#include "common/ValuePeeker.hpp"
+#include "expressions/constantvalueexpression.h"
+#include "expressions/expressionutil.h"
+#include "expressions/parametervalueexpression.h"
+
+#include <cstring>
+
+namespace voltdb {
+
+bool InListExpression::isRowInvariantList(AbstractExpression* right)
+{
+    if (dynamic_cast<ParameterValueExpression*>(right) != NULL) {
+        return true;
+    }
+    const std::vector<AbstractExpression*>* elements = ExpressionUtil::vectorArguments(right);
+    if (elements == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < elements->size(); ++i) {
+        AbstractExpression* element = (*elements)[i];
+        if (dynamic_cast<ConstantValueExpression*>(element) == NULL &&
+            dynamic_cast<ParameterValueExpression*>(element) == NULL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+InListExpression::InListExpression(ExpressionType type, AbstractExpression* left, AbstractExpression* right)
+    : ComparisonExpression<CmpIn>(type, left, right)
+    , m_leftOperand(left)
+    , m_rightOperand(right)
+    , m_elements(ExpressionUtil::vectorArguments(right))
+    , m_hasParameter(right->hasParameter())
+    , m_loaded(false)
+    , m_parameterGeneration(0)
+    , m_kind(LIST_OTHER)
+{
+    assert(isRowInvariantList(right));
+}
+
+bool InListExpression::isCurrent() const
+{
+    if ( ! m_loaded) {
+        return false;
+    }
+    if ( ! m_hasParameter) {
+        return true;
+    }
+    ExecutorContext* context = ExecutorContext::getExecutorContext();
+    return context != NULL && context->getParameterGeneration() == m_parameterGeneration;
+}
+
+void InListExpression::collectElements(std::vector<NValue>& elements) const
+{
+    if (m_elements != NULL) {
+        elements.reserve(m_elements->size());
+        for (size_t i = 0; i < m_elements->size(); ++i) {
+            elements.push_back((*m_elements)[i]->eval(NULL, NULL));
+        }
+        return;
+    }
+    NValue list = m_rightOperand->eval(NULL, NULL);
+    if (list.isNull() || ValuePeeker::peekValueType(list) != VALUE_TYPE_ARRAY) {
+        // Leave it to ComparisonExpression to return NULL or report the error.
+        m_kind = LIST_OTHER;
+        return;
+    }
+    int length = list.arrayLength();
+    elements.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        elements.push_back(list.itemAtIndex(i));
+    }
+}
+
+void InListExpression::load() const
+{
+    m_integers.clear();
+    m_strings.clear();
+    ExecutorContext* context = ExecutorContext::getExecutorContext();
+    m_parameterGeneration = (context != NULL) ? context->getParameterGeneration() : 0;
+    m_loaded = true;
+    m_kind = LIST_OTHER;
+
+    std::vector<NValue> elements;
+    collectElements(elements);
+    if (elements.empty()) {
+        return;
+    }
+
+    // All the non-null elements must be integers, or all VARCHARs.
+    ValueType kindType = VALUE_TYPE_INVALID;
+    for (size_t i = 0; i < elements.size(); ++i) {
+        if (elements[i].isNull()) {
+            continue;
+        }
+        ValueType type = ValuePeeker::peekValueType(elements[i]);
+        if (isIntegralType(type)) {
+            type = VALUE_TYPE_BIGINT;
+        }
+        else if (type != VALUE_TYPE_VARCHAR) {
+            return;
+        }
+        if (kindType != VALUE_TYPE_INVALID && kindType != type) {
+            return;
+        }
+        kindType = type;
+    }
+
+    if (kindType == VALUE_TYPE_BIGINT) {
+        for (size_t i = 0; i < elements.size(); ++i) {
+            if ( ! elements[i].isNull()) {
+                m_integers.insert(ValuePeeker::peekAsRawInt64(elements[i]));
+            }
+        }
+        m_kind = LIST_INTEGERS;
+    }
+    else if (kindType == VALUE_TYPE_VARCHAR) {
+        for (size_t i = 0; i < elements.size(); ++i) {
+            if (elements[i].isNull()) {
+                continue;
+            }
+            int32_t length;
+            const char* data = ValuePeeker::peekObject_withoutNull(elements[i], &length);
+            // NValue compares strings with strncmp, which stops at a NUL.
+            if (::memchr(data, '\0', length) != NULL) {
+                m_strings.clear();
+                return;
+            }
+            m_strings.insert(std::string(data, length));
+        }
+        m_kind = LIST_STRINGS;
+    }
+}
+
+NValue InListExpression::eval(const TableTuple* tuple1, const TableTuple* tuple2) const
+{
+    if ( ! isCurrent()) {
+        if (m_hasParameter && ExecutorContext::getExecutorContext() == NULL) {
+            // Without an executor context there is no telling when the
+            // parameters change.
+            return ComparisonExpression<CmpIn>::eval(tuple1, tuple2);
+        }
+        load();
+    }
+
+    if (m_kind != LIST_OTHER) {
+        NValue lnv = m_leftOperand->eval(tuple1, tuple2);
+        if (lnv.isNull()) {
+            return NValue::getNullValue(VALUE_TYPE_BOOLEAN);
+        }
+        ValueType leftType = ValuePeeker::peekValueType(lnv);
+        if (m_kind == LIST_INTEGERS && isIntegralType(leftType)) {
+            bool found = m_integers.find(ValuePeeker::peekAsRawInt64(lnv)) != m_integers.end();
+            return found ? NValue::getTrue() : NValue::getFalse();
+        }
+        if (m_kind == LIST_STRINGS && leftType == VALUE_TYPE_VARCHAR) {
+            int32_t length;
+            const char* data = ValuePeeker::peekObject_withoutNull(lnv, &length);
+            if (::memchr(data, '\0', length) == NULL) {
+                bool found = m_strings.find(StringRef(data, length), StringHash(), StringEqual()) != m_strings.end();
+                return found ? NValue::getTrue() : NValue::getFalse();
+            }
+        }
+    }
+    return ComparisonExpression<CmpIn>::eval(tuple1, tuple2);
+}
+
+}
@@ -0,0 +1,106 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INLISTEXPRESSION_H
+#define INLISTEXPRESSION_H
+
+#include "expressions/comparisonexpression.h"
+
+#include "boost/unordered_set.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace voltdb {
+
+/**
+ * An IN comparison whose list doesn't depend on the row: a list of
+ * constants and parameters, like "col IN (1, 2, ?)", or a single
+ * array-valued parameter, like "col IN ?".  Rather than searching the
+ * list for every row, the list is loaded into a hash set the first time
+ * it is needed, and reloaded only after the parameters have changed.
+ *
+ * Lists of integers are probed with the integer value of the left
+ * operand, and lists of VARCHARs with its bytes.  Other lists, and left
+ * operands of some other type, are searched by ComparisonExpression as
+ * before.  Either way a NULL left operand gives NULL and NULL list
+ * elements never match.
+ */
+class InListExpression : public ComparisonExpression<CmpIn> {
+public:
+    /**
+     * Whether right is an array-valued parameter or a list of constants
+     * and parameters, so that its values only change between executions.
+     */
+    static bool isRowInvariantList(AbstractExpression* right);
+
+    InListExpression(ExpressionType type, AbstractExpression* left, AbstractExpression* right);
+
+    NValue eval(const TableTuple* tuple1, const TableTuple* tuple2) const;
+
+    std::string debugInfo(const std::string& spacer) const
+    {
+        return spacer + "InListExpression\n";
+    }
+
+private:
+    enum ListKind {
+        LIST_INTEGERS,
+        LIST_STRINGS,
+        // Searched by ComparisonExpression
+        LIST_OTHER
+    };
+
+    struct StringRef {
+        StringRef(const char* data, size_t length) : m_data(data), m_length(length) { }
+        const char* m_data;
+        size_t m_length;
+    };
+
+    struct StringHash {
+        size_t operator()(const std::string& value) const
+        { return boost::hash_range(value.begin(), value.end()); }
+        size_t operator()(const StringRef& value) const
+        { return boost::hash_range(value.m_data, value.m_data + value.m_length); }
+    };
+
+    struct StringEqual {
+        bool operator()(const StringRef& lhs, const std::string& rhs) const
+        { return lhs.m_length == rhs.size() && ::memcmp(lhs.m_data, rhs.data(), lhs.m_length) == 0; }
+    };
+
+    bool isCurrent() const;
+    void load() const;
+    void collectElements(std::vector<NValue>& elements) const;
+
+    AbstractExpression* m_leftOperand;
+    AbstractExpression* m_rightOperand;
+    // The list elements, or NULL if the list is a single array parameter.
+    const std::vector<AbstractExpression*>* m_elements;
+    bool m_hasParameter;
+
+    mutable bool m_loaded;
+    mutable int64_t m_parameterGeneration;
+    mutable ListKind m_kind;
+    mutable boost::unordered_set<int64_t> m_integers;
+    mutable boost::unordered_set<std::string, StringHash> m_strings;
+};
+
+}
+
+#endif
@@ -27,42 +27,36 @@
 #include <jsoncpp/jsoncpp.h>
 #include <jsoncpp/jsoncpp-forwards.h>
 
-namespace voltdb {
-
-/** a path node is either a field name or an array index */
-struct JsonPathNode {
-    JsonPathNode(int32_t arrayIndex) : m_arrayIndex(arrayIndex) {}
-    JsonPathNode(const char* field) : m_arrayIndex(-1), m_field(field) {}
+#include "expressions/jsonpath.h"
 
-    int32_t m_arrayIndex;
-    std::string m_field;
-};
+namespace voltdb {
 
 /** representation of a JSON document that can be accessed and updated via
     our path syntax */
 class JsonDocument {
 public:
-    JsonDocument(const char* docChars, int32_t lenDoc) : m_head(NULL), m_tail(NULL) {
-        if (docChars == NULL) {
-            // null documents have null everything, but they turn into objects/arrays
-            // if we try to set their properties
-            m_doc = Json::Value::null;
-        } else if (!m_reader.parse(docChars, docChars + lenDoc, m_doc)) {
-            // we have something real, but it isn't JSON
-            throwJsonFormattingError();
+    JsonDocument(const char* docChars, int32_t lenDoc) : m_root(&Json::Value::null) {
+        // null documents have null everything, but they turn into objects/arrays
+        // if we try to set their properties
+        if (docChars != NULL) {
+            // the parsed document is shared with other functions of the same row
+            m_root = &JsonDocumentCache::parse(docChars, lenDoc);
         }
     }
 
-    std::string value() { return m_writer.write(m_doc); }
+    std::string value() { return m_writer.write(*m_root); }
 
     bool get(const char* pathChars, int32_t lenPath, std::string& serializedValue) {
-        if (m_doc.isNull()) {
+        return get(JsonPath::resolve(pathChars, lenPath), serializedValue);
+    }
+
+    bool get(const std::vector<JsonPathNode>& path, std::string& serializedValue) {
+        if (m_root->isNull()) {
             return false;
         }
 
-        // get and traverse the path
-        std::vector<JsonPathNode> path = resolveJsonPath(pathChars, lenPath);
-        const Json::Value* node = &m_doc;
+        // traverse the path
+        const Json::Value* node = m_root;
         for (std::vector<JsonPathNode>::const_iterator cit = path.begin(); cit != path.end(); ++cit) {
             const JsonPathNode& pathNode = *cit;
             if (pathNode.m_arrayIndex != -1) {
@@ -71,7 +65,7 @@ public:
                     return false;
                 }
                 int32_t arrayIndex = pathNode.m_arrayIndex;
-                if (arrayIndex == ARRAY_TAIL) {
+                if (arrayIndex == JsonPath::ARRAY_TAIL) {
                     unsigned int arraySize = node->size();
                     arrayIndex = arraySize > 0 ? arraySize - 1 : 0;
                 }
@@ -112,7 +106,13 @@ public:
             throwJsonFormattingError();
         }
 
-        std::vector<JsonPathNode> path = resolveJsonPath(pathChars, lenPath, true /*enforceArrayIndexLimitForSet*/);
+        const std::vector<JsonPathNode>& path =
+            JsonPath::resolve(pathChars, lenPath, true /*enforceArrayIndexLimitForSet*/);
+        // update a copy, since the parsed document may be shared
+        if (m_root != &m_doc) {
+            m_doc = *m_root;
+            m_root = &m_doc;
+        }
         // the non-const version of the Json::Value [] operator creates a new, null node on attempted
         // access if none already exists
         Json::Value* node = &m_doc;
@@ -124,7 +124,7 @@ public:
                     return;
                 }
                 int32_t arrayIndex = pathNode.m_arrayIndex;
-                if (arrayIndex == ARRAY_TAIL) {
+                if (arrayIndex == JsonPath::ARRAY_TAIL) {
                     arrayIndex = node->size();
                 }
                 // get or create the specified node
@@ -140,161 +140,11 @@ public:
     }
 
 private:
+    const Json::Value* m_root;
     Json::Value m_doc;
     Json::Reader m_reader;
     Json::FastWriter m_writer;
 
-    const char* m_head;
-    const char* m_tail;
-    int32_t m_pos;
-
-    static const int32_t ARRAY_TAIL = -10;
-
-    /** parse our path to its vector representation */
-    std::vector<JsonPathNode> resolveJsonPath(const char* pathChars, int32_t lenPath,
-                                              bool enforceArrayIndexLimitForSet = false) {
-        std::vector<JsonPathNode> path;
-        // NULL path refers directly to the doc root
-        if (pathChars == NULL) {
-            return path;
-        }
-        m_head = pathChars;
-        m_tail = m_head + lenPath;
-
-        m_pos = -1;
-        char c;
-        bool first = true;
-        bool expectArrayIndex = false;
-        bool expectField = false;
-        char strField[lenPath];
-        while (readChar(c)) {
-            if (expectArrayIndex) {
-                // -1 index to refer to the tail of the array
-                bool neg = false;
-                if (c == '-') {
-                    neg = true;
-                    if (!readChar(c)) {
-                        throwInvalidPathError("Unexpected termination (unterminated array access)");
-                    }
-                }
-                if (c < '0' || c > '9') {
-                    throwInvalidPathError("Unexpected character in array index");
-                }
-                // atoi while advancing our pointer
-                int64_t arrayIndex = c - '0';
-                bool terminated = false;
-                while (readChar(c)) {
-                    if (c == ']') {
-                        terminated = true;
-                        break;
-                    } else if (c < '0' || c > '9') {
-                        throwInvalidPathError("Unexpected character in array index");
-                    }
-                    arrayIndex = 10 * arrayIndex + (c - '0');
-                    if (enforceArrayIndexLimitForSet) {
-                        // This 500000 is a mostly arbitrary maximum JSON array index enforced for practical
-                        // purposes. We enforce this up front to avoid excessive delays, ridiculous short-term
-                        // memory growth, and/or bad_alloc errors that the jsoncpp library could produce
-                        // essentially for nothing since our supported JSON document columns are typically not
-                        // wide enough to hold the string representations of arrays this large.
-                        if (arrayIndex > 500000) {
-                            if (neg) {
-                                // other than the special '-1' case, negative indices aren't allowed
-                                throwInvalidPathError("Array index less than -1");
-                            }
-                            throwInvalidPathError("Array index greater than the maximum allowed value of 500000");
-                        }
-                    } else {
-                        if (arrayIndex > static_cast<int64_t>(INT32_MAX)) {
-                            if (neg) {
-                                // other than the special '-1' case, negative indices aren't allowed
-                                throwInvalidPathError("Array index less than -1");
-                            }
-                            throwInvalidPathError("Array index greater than the maximum integer value");
-                        }
-                    }
-                }
-                if ( ! terminated ) {
-                    throwInvalidPathError("Missing ']' after array index");
-                }
-                if (neg) {
-                    // other than the special '-1' case, negative indices aren't allowed
-                    if (arrayIndex != 1) {
-                        throwInvalidPathError("Array index less than -1");
-                    }
-                    arrayIndex = ARRAY_TAIL;
-                }
-                path.push_back(static_cast<int32_t>(arrayIndex));
-                expectArrayIndex = false;
-            } else if (c == '[') {
-                // handle the case of empty field names. for example, getting the first element of the array
-                // in { "a": { "": [ true, false ] } } would be the path 'a.[0]'
-                if (expectField) {
-                    path.push_back(JsonPathNode(""));
-                    expectField = false;
-                }
-                expectArrayIndex = true;
-            } else if (c == '.') {
-                // a leading '.' also involves accessing the "" property of the root...
-                if (expectField || first) {
-                    path.push_back(JsonPathNode(""));
-                }
-                expectField = true;
-            } else {
-                expectField = false;
-                // read a literal field name
-                int32_t i = 0;
-                do {
-                    if (c == '\\') {
-                        if (!readChar(c) || (c != '[' && c != ']' && c != '.' && c != '\\')) {
-                            throwInvalidPathError("Unescaped backslash (double escaping required for path)");
-                        }
-                    } else if (c == '.') {
-                        expectField = true;
-                        break;
-                    } else if (c == '[') {
-                        expectArrayIndex = true;
-                        break;
-                    }
-                    strField[i++] = c;
-                } while (readChar(c));
-                strField[i] = '\0';
-                path.push_back(JsonPathNode(strField));
-            }
-            first = false;
-        }
-        // trailing '['
-        if (expectArrayIndex) {
-            throwInvalidPathError("Unexpected termination (unterminated array access)");
-        }
-        // if we're either empty or ended on a trailing '.', add an empty field name
-        if (expectField || first) {
-            path.push_back(JsonPathNode(""));
-        }
-
-        m_head = NULL;
-        m_tail = NULL;
-        return path;
-    }
-
-    bool readChar(char& c) {
-        assert(m_head != NULL && m_tail != NULL);
-        if (m_head == m_tail) {
-            return false;
-        }
-        c = *m_head++;
-        m_pos++;
-        return true;
-    }
-
-    void throwInvalidPathError(const char* err) const {
-        char msg[1024];
-        snprintf(msg, sizeof(msg), "Invalid JSON path: %s [position %d]", err, m_pos);
-        throw SQLException(SQLException::
-                           data_exception_invalid_parameter,
-                           msg);
-    }
-
     void throwJsonFormattingError() const {
         char msg[1024];
         // getFormatedErrorMessages returns concise message about location
@@ -329,12 +179,33 @@ template<> inline NValue NValue::call<FUNC_VOLT_FIELD>(const std::vector<NValue>
 
     int32_t lenDoc;
     const char* docChars = docNVal.getObject_withoutNull(&lenDoc);
-    JsonDocument doc(docChars, lenDoc);
-
     int32_t lenPath;
     const char* pathChars = pathNVal.getObject_withoutNull(&lenPath);
+
+    const std::vector<JsonPathNode>* path;
+    try {
+        path = &JsonPath::resolve(pathChars, lenPath);
+    }
+    catch (const SQLException&) {
+        // a document that isn't JSON is reported ahead of a bad path
+        JsonDocumentCache::parse(docChars, lenDoc);
+        throw;
+    }
+
+    // most paths lead to a string, a number or a boolean, which a single
+    // pass over the document can find without a DOM
     std::string result;
-    if (doc.get(pathChars, lenPath, result)) {
+    switch (JsonPath::extract(docChars, lenDoc, *path, result)) {
+    case JsonPath::JSON_PATH_FOUND:
+        return getTempStringValue(result.c_str(), result.length());
+    case JsonPath::JSON_PATH_MISSING:
+        return getNullStringValue();
+    default:
+        break;
+    }
+
+    JsonDocument doc(docChars, lenDoc);
+    if (doc.get(*path, result)) {
         return getTempStringValue(result.c_str(), result.length() - 1);
     }
     return getNullStringValue();
@@ -358,23 +229,24 @@ template<> inline NValue NValue::call<FUNC_VOLT_ARRAY_ELEMENT>(const std::vector
     }
     int32_t lenDoc;
     const char* docChars = docNVal.getObject_withoutNull(&lenDoc);
-    const std::string doc(docChars, lenDoc);
 
     int32_t index = indexNVal.castAsIntegerAndGetValue();
 
-    Json::Value root;
-    Json::Reader reader;
-
-    if ( ! reader.parse(doc, root)) {
-        char msg[1024];
-        // getFormatedErrorMessages returns concise message about location
-        // of the error rather than the malformed document itself
-        snprintf(msg, sizeof(msg), "Invalid JSON %s", reader.getFormatedErrorMessages().c_str());
-        throw SQLException(SQLException::
-                           data_exception_invalid_parameter,
-                           msg);
+    if (index >= 0) {
+        std::vector<JsonPathNode> path(1, JsonPathNode(index));
+        std::string result;
+        switch (JsonPath::extract(docChars, lenDoc, path, result)) {
+        case JsonPath::JSON_PATH_FOUND:
+            return getTempStringValue(result.c_str(), result.length());
+        case JsonPath::JSON_PATH_MISSING:
+            return getNullStringValue();
+        default:
+            break;
+        }
     }
 
+    const Json::Value& root = JsonDocumentCache::parse(docChars, lenDoc);
+
     // only array type contains elements. objects, primitives do not
     if ( ! root.isArray()) {
         return getNullStringValue();
@@ -418,21 +290,22 @@ template<> inline NValue NValue::callUnary<FUNC_VOLT_ARRAY_LENGTH>() const {
 
     int32_t lenDoc;
     const char* docChars = getObject_withoutNull(&lenDoc);
-    const std::string doc(docChars, lenDoc);
 
-    Json::Value root;
-    Json::Reader reader;
-
-    if ( ! reader.parse(doc, root)) {
-        char msg[1024];
-        // getFormatedErrorMessages returns concise message about location
-        // of the error rather than the malformed document itself
-        snprintf(msg, sizeof(msg), "Invalid JSON %s", reader.getFormatedErrorMessages().c_str());
-        throw SQLException(SQLException::
-                           data_exception_invalid_parameter,
-                           msg);
+    int32_t length;
+    switch (JsonPath::arrayLength(docChars, lenDoc, length)) {
+    case JsonPath::JSON_PATH_FOUND: {
+        NValue result(VALUE_TYPE_INTEGER);
+        result.getInteger() = length;
+        return result;
+    }
+    case JsonPath::JSON_PATH_MISSING:
+        return getNullValue(VALUE_TYPE_INTEGER);
+    default:
+        break;
     }
 
+    const Json::Value& root = JsonDocumentCache::parse(docChars, lenDoc);
+
     // only array type contains indexed elements. objects, primitives do not
     if ( ! root.isArray()) {
         return getNullValue(VALUE_TYPE_INTEGER);
@@ -0,0 +1,533 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "expressions/jsonpath.h"
+
+#include "common/SQLException.h"
+
+#include "boost/functional/hash.hpp"
+#include "rapidjson/memorystream.h"
+#include "rapidjson/reader.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+
+namespace voltdb {
+
+namespace {
+
+/** Parses the path syntax of FIELD and SET_FIELD. */
+class JsonPathParser {
+public:
+    JsonPathParser(const char* pathChars, int32_t lenPath)
+        : m_head(pathChars), m_tail(pathChars + lenPath), m_pos(-1) { }
+
+    void parse(std::vector<JsonPathNode>& path, bool enforceArrayIndexLimitForSet) {
+        int32_t lenPath = static_cast<int32_t>(m_tail - m_head);
+        char c;
+        bool first = true;
+        bool expectArrayIndex = false;
+        bool expectField = false;
+        char strField[lenPath + 1];
+        while (readChar(c)) {
+            if (expectArrayIndex) {
+                // -1 index to refer to the tail of the array
+                bool neg = false;
+                if (c == '-') {
+                    neg = true;
+                    if (!readChar(c)) {
+                        throwInvalidPathError("Unexpected termination (unterminated array access)");
+                    }
+                }
+                if (c < '0' || c > '9') {
+                    throwInvalidPathError("Unexpected character in array index");
+                }
+                // atoi while advancing our pointer
+                int64_t arrayIndex = c - '0';
+                bool terminated = false;
+                while (readChar(c)) {
+                    if (c == ']') {
+                        terminated = true;
+                        break;
+                    } else if (c < '0' || c > '9') {
+                        throwInvalidPathError("Unexpected character in array index");
+                    }
+                    arrayIndex = 10 * arrayIndex + (c - '0');
+                    if (enforceArrayIndexLimitForSet) {
+                        // This 500000 is a mostly arbitrary maximum JSON array index enforced for practical
+                        // purposes. We enforce this up front to avoid excessive delays, ridiculous short-term
+                        // memory growth, and/or bad_alloc errors that the jsoncpp library could produce
+                        // essentially for nothing since our supported JSON document columns are typically not
+                        // wide enough to hold the string representations of arrays this large.
+                        if (arrayIndex > 500000) {
+                            if (neg) {
+                                // other than the special '-1' case, negative indices aren't allowed
+                                throwInvalidPathError("Array index less than -1");
+                            }
+                            throwInvalidPathError("Array index greater than the maximum allowed value of 500000");
+                        }
+                    } else {
+                        if (arrayIndex > static_cast<int64_t>(INT32_MAX)) {
+                            if (neg) {
+                                // other than the special '-1' case, negative indices aren't allowed
+                                throwInvalidPathError("Array index less than -1");
+                            }
+                            throwInvalidPathError("Array index greater than the maximum integer value");
+                        }
+                    }
+                }
+                if ( ! terminated ) {
+                    throwInvalidPathError("Missing ']' after array index");
+                }
+                if (neg) {
+                    // other than the special '-1' case, negative indices aren't allowed
+                    if (arrayIndex != 1) {
+                        throwInvalidPathError("Array index less than -1");
+                    }
+                    arrayIndex = JsonPath::ARRAY_TAIL;
+                }
+                path.push_back(static_cast<int32_t>(arrayIndex));
+                expectArrayIndex = false;
+            } else if (c == '[') {
+                // handle the case of empty field names. for example, getting the first element of the array
+                // in { "a": { "": [ true, false ] } } would be the path 'a.[0]'
+                if (expectField) {
+                    path.push_back(JsonPathNode(""));
+                    expectField = false;
+                }
+                expectArrayIndex = true;
+            } else if (c == '.') {
+                // a leading '.' also involves accessing the "" property of the root...
+                if (expectField || first) {
+                    path.push_back(JsonPathNode(""));
+                }
+                expectField = true;
+            } else {
+                expectField = false;
+                // read a literal field name
+                int32_t i = 0;
+                do {
+                    if (c == '\\') {
+                        if (!readChar(c) || (c != '[' && c != ']' && c != '.' && c != '\\')) {
+                            throwInvalidPathError("Unescaped backslash (double escaping required for path)");
+                        }
+                    } else if (c == '.') {
+                        expectField = true;
+                        break;
+                    } else if (c == '[') {
+                        expectArrayIndex = true;
+                        break;
+                    }
+                    strField[i++] = c;
+                } while (readChar(c));
+                strField[i] = '\0';
+                path.push_back(JsonPathNode(strField));
+            }
+            first = false;
+        }
+        // trailing '['
+        if (expectArrayIndex) {
+            throwInvalidPathError("Unexpected termination (unterminated array access)");
+        }
+        // if we're either empty or ended on a trailing '.', add an empty field name
+        if (expectField || first) {
+            path.push_back(JsonPathNode(""));
+        }
+    }
+
+private:
+    bool readChar(char& c) {
+        if (m_head == m_tail) {
+            return false;
+        }
+        c = *m_head++;
+        m_pos++;
+        return true;
+    }
+
+    void throwInvalidPathError(const char* err) const {
+        char msg[1024];
+        snprintf(msg, sizeof(msg), "Invalid JSON path: %s [position %d]", err, m_pos);
+        throw SQLException(SQLException::
+                           data_exception_invalid_parameter,
+                           msg);
+    }
+
+    const char* m_head;
+    const char* m_tail;
+    int32_t m_pos;
+};
+
+/**
+ * Follows a path through the events of a SAX parse. A value that begins on
+ * the path replaces whatever was found under an earlier one, as a later
+ * duplicate key replaces an earlier one in jsoncpp. For that reason, and
+ * because a malformed document must still be rejected, the handlers never
+ * cut the parse short once the value is found.
+ */
+class PathHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PathHandler> {
+public:
+    enum Capture {
+        CAPTURE_NONE,
+        CAPTURE_NULL,
+        CAPTURE_VALUE,
+        CAPTURE_UNDECIDED
+    };
+
+    PathHandler(const std::vector<JsonPathNode>& path)
+        : m_path(path)
+        , m_target(static_cast<int32_t>(path.size()))
+        , m_capture(CAPTURE_NONE)
+        , m_rootIsArray(false)
+        , m_rootArrayLength(0)
+    { }
+
+    bool Null()
+    {
+        if (beginValue() == m_target) {
+            m_capture = CAPTURE_NULL;
+        }
+        return true;
+    }
+
+    bool Bool(bool b)
+    {
+        if (beginValue() == m_target) {
+            m_capture = CAPTURE_VALUE;
+            m_value = b ? "true" : "false";
+        }
+        return true;
+    }
+
+    bool RawNumber(const char* str, rapidjson::SizeType length, bool)
+    {
+        if (beginValue() == m_target) {
+            m_capture = integerText(str, length, m_value) ? CAPTURE_VALUE : CAPTURE_UNDECIDED;
+        }
+        return true;
+    }
+
+    bool String(const char* str, rapidjson::SizeType length, bool)
+    {
+        if (beginValue() == m_target) {
+            // jsoncpp keeps strings NUL-terminated, and cuts them short at an escaped NUL.
+            if (::memchr(str, '\0', length) != NULL) {
+                m_capture = CAPTURE_UNDECIDED;
+            }
+            else {
+                m_capture = CAPTURE_VALUE;
+                m_value.assign(str, length);
+            }
+        }
+        return true;
+    }
+
+    bool StartObject() { return startContainer(false); }
+
+    bool Key(const char* str, rapidjson::SizeType length, bool)
+    {
+        // jsoncpp cuts keys short at an escaped NUL, which can merge keys.
+        if (::memchr(str, '\0', length) != NULL) {
+            return false;
+        }
+        Frame& frame = m_frames.back();
+        if (frame.m_onPath) {
+            const std::string& field = m_path[frame.m_level].m_field;
+            frame.m_selected = field.size() == length && ::memcmp(field.data(), str, length) == 0;
+        }
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType)
+    {
+        m_frames.pop_back();
+        return true;
+    }
+
+    bool StartArray() { return startContainer(true); }
+
+    bool EndArray(rapidjson::SizeType elementCount)
+    {
+        if (m_frames.size() == 1) {
+            m_rootArrayLength = static_cast<int32_t>(elementCount);
+        }
+        m_frames.pop_back();
+        return true;
+    }
+
+    Capture capture() const { return m_capture; }
+    const std::string& value() const { return m_value; }
+    bool rootIsArray() const { return m_rootIsArray; }
+    int32_t rootArrayLength() const { return m_rootArrayLength; }
+
+private:
+    static const int32_t OFF_PATH = -1;
+
+    struct Frame {
+        bool m_isArray;
+        // Whether this container is where the path leads after m_level nodes
+        bool m_onPath;
+        int32_t m_level;
+        int32_t m_nextIndex;
+        // Whether the key of the current member is the next path node
+        bool m_selected;
+    };
+
+    /** Return how many path nodes lead to the value that begins now, or OFF_PATH. */
+    int32_t beginValue()
+    {
+        int32_t level = 0;
+        if ( ! m_frames.empty()) {
+            Frame& frame = m_frames.back();
+            bool selected = frame.m_selected;
+            if (frame.m_isArray) {
+                int32_t index = frame.m_nextIndex++;
+                if (frame.m_onPath) {
+                    int32_t arrayIndex = m_path[frame.m_level].m_arrayIndex;
+                    selected = arrayIndex == JsonPath::ARRAY_TAIL || arrayIndex == index;
+                }
+            }
+            level = selected ? frame.m_level + 1 : OFF_PATH;
+        }
+        if (level != OFF_PATH && level < m_target) {
+            m_capture = CAPTURE_NONE;
+        }
+        return level;
+    }
+
+    bool startContainer(bool isArray)
+    {
+        if (m_frames.empty()) {
+            m_rootIsArray = isArray;
+        }
+        int32_t level = beginValue();
+        if (level == m_target) {
+            // jsoncpp writes containers with their keys sorted.
+            m_capture = CAPTURE_UNDECIDED;
+        }
+        Frame frame;
+        frame.m_isArray = isArray;
+        frame.m_onPath = level != OFF_PATH && level < m_target &&
+                         (m_path[level].m_arrayIndex != -1) == isArray;
+        frame.m_level = level;
+        frame.m_nextIndex = 0;
+        frame.m_selected = false;
+        m_frames.push_back(frame);
+        return true;
+    }
+
+    /**
+     * Produce the text jsoncpp gives a number, if it reads the number as an
+     * integer. A fraction, an exponent, or a value too large for 64 bits
+     * makes it a double, whose text only jsoncpp can produce.
+     */
+    static bool integerText(const char* str, size_t length, std::string& text)
+    {
+        bool negative = length > 0 && str[0] == '-';
+        uint64_t limit = negative ? (static_cast<uint64_t>(1) << 63) : UINT64_MAX;
+        uint64_t value = 0;
+        for (size_t i = negative ? 1 : 0; i < length; ++i) {
+            char c = str[i];
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            uint64_t digit = static_cast<uint64_t>(c - '0');
+            if (value > (limit - digit) / 10) {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+        if (negative && value == 0) {
+            text = "0";
+        }
+        else {
+            text.assign(str, length);
+        }
+        return true;
+    }
+
+    const std::vector<JsonPathNode>& m_path;
+    const int32_t m_target;
+    std::vector<Frame> m_frames;
+    Capture m_capture;
+    std::string m_value;
+    bool m_rootIsArray;
+    int32_t m_rootArrayLength;
+};
+
+bool parse(const char* docChars, int32_t lenDoc, PathHandler& handler)
+{
+    rapidjson::Reader reader;
+    rapidjson::MemoryStream stream(docChars, static_cast<size_t>(lenDoc));
+    return ! reader.Parse<rapidjson::kParseNumbersAsStringsFlag>(stream, handler).IsError();
+}
+
+struct PathSlot {
+    PathSlot() : m_used(false), m_enforceArrayIndexLimitForSet(false) { }
+    bool m_used;
+    bool m_enforceArrayIndexLimitForSet;
+    std::string m_text;
+    std::vector<JsonPathNode> m_path;
+};
+
+struct DocumentSlot {
+    DocumentSlot() : m_used(false) { }
+    bool m_used;
+    std::string m_text;
+    Json::Value m_root;
+};
+
+/** The parsed paths and documents of one thread. */
+struct ThreadCaches {
+    static const size_t PATH_SLOTS = 64;
+
+    ThreadCaches() : m_nextDocument(0) { }
+
+    PathSlot m_paths[PATH_SLOTS];
+    DocumentSlot m_documents[JsonDocumentCache::CAPACITY];
+    size_t m_nextDocument;
+};
+
+pthread_key_t cacheKey;
+pthread_once_t cacheKeyOnce = PTHREAD_ONCE_INIT;
+
+void deleteThreadCaches(void* caches)
+{
+    delete static_cast<ThreadCaches*>(caches);
+}
+
+void createCacheKey()
+{
+    (void)pthread_key_create(&cacheKey, deleteThreadCaches);
+}
+
+ThreadCaches& threadCaches()
+{
+    (void)pthread_once(&cacheKeyOnce, createCacheKey);
+    ThreadCaches* caches = static_cast<ThreadCaches*>(pthread_getspecific(cacheKey));
+    if (caches == NULL) {
+        caches = new ThreadCaches();
+        pthread_setspecific(cacheKey, caches);
+    }
+    return *caches;
+}
+
+const std::vector<JsonPathNode> rootPath;
+
+}
+
+const std::vector<JsonPathNode>& JsonPath::resolve(const char* pathChars, int32_t lenPath,
+                                                   bool enforceArrayIndexLimitForSet)
+{
+    // NULL path refers directly to the doc root
+    if (pathChars == NULL) {
+        return rootPath;
+    }
+    size_t hash = boost::hash_range(pathChars, pathChars + lenPath);
+    boost::hash_combine(hash, enforceArrayIndexLimitForSet);
+    PathSlot& slot = threadCaches().m_paths[hash % ThreadCaches::PATH_SLOTS];
+    if (slot.m_used &&
+        slot.m_enforceArrayIndexLimitForSet == enforceArrayIndexLimitForSet &&
+        slot.m_text.size() == static_cast<size_t>(lenPath) &&
+        ::memcmp(slot.m_text.data(), pathChars, lenPath) == 0) {
+        return slot.m_path;
+    }
+
+    std::vector<JsonPathNode> path;
+    JsonPathParser(pathChars, lenPath).parse(path, enforceArrayIndexLimitForSet);
+    slot.m_path.swap(path);
+    slot.m_text.assign(pathChars, lenPath);
+    slot.m_enforceArrayIndexLimitForSet = enforceArrayIndexLimitForSet;
+    slot.m_used = true;
+    return slot.m_path;
+}
+
+JsonPath::Extraction JsonPath::extract(const char* docChars, int32_t lenDoc,
+                                       const std::vector<JsonPathNode>& path, std::string& value)
+{
+    PathHandler handler(path);
+    if ( ! parse(docChars, lenDoc, handler)) {
+        // Either not JSON, or JSON in a form only jsoncpp accepts.
+        return JSON_PATH_UNDECIDED;
+    }
+    switch (handler.capture()) {
+    case PathHandler::CAPTURE_VALUE:
+        value = handler.value();
+        return JSON_PATH_FOUND;
+    case PathHandler::CAPTURE_UNDECIDED:
+        return JSON_PATH_UNDECIDED;
+    default:
+        return JSON_PATH_MISSING;
+    }
+}
+
+JsonPath::Extraction JsonPath::arrayLength(const char* docChars, int32_t lenDoc, int32_t& length)
+{
+    PathHandler handler(rootPath);
+    if ( ! parse(docChars, lenDoc, handler)) {
+        return JSON_PATH_UNDECIDED;
+    }
+    if ( ! handler.rootIsArray()) {
+        return JSON_PATH_MISSING;
+    }
+    length = handler.rootArrayLength();
+    return JSON_PATH_FOUND;
+}
+
+const Json::Value& JsonDocumentCache::parse(const char* docChars, int32_t lenDoc)
+{
+    ThreadCaches& caches = threadCaches();
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        DocumentSlot& slot = caches.m_documents[i];
+        if (slot.m_used &&
+            slot.m_text.size() == static_cast<size_t>(lenDoc) &&
+            ::memcmp(slot.m_text.data(), docChars, lenDoc) == 0) {
+            return slot.m_root;
+        }
+    }
+
+    Json::Value root;
+    Json::Reader reader;
+    if ( ! reader.parse(docChars, docChars + lenDoc, root)) {
+        char msg[1024];
+        // getFormatedErrorMessages returns concise message about location
+        // of the error rather than the malformed document itself
+        snprintf(msg, sizeof(msg), "Invalid JSON %s", reader.getFormatedErrorMessages().c_str());
+        throw SQLException(SQLException::
+                           data_exception_invalid_parameter,
+                           msg);
+    }
+    DocumentSlot& slot = caches.m_documents[caches.m_nextDocument];
+    caches.m_nextDocument = (caches.m_nextDocument + 1) % CAPACITY;
+    slot.m_root.swap(root);
+    slot.m_text.assign(docChars, lenDoc);
+    slot.m_used = true;
+    return slot.m_root;
+}
+
+void JsonDocumentCache::clear()
+{
+    ThreadCaches& caches = threadCaches();
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        caches.m_documents[i] = DocumentSlot();
+    }
+    caches.m_nextDocument = 0;
+}
+
+}
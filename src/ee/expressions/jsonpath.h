@@ -0,0 +1,97 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONPATH_H
+#define JSONPATH_H
+
+#include <jsoncpp/jsoncpp.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace voltdb {
+
+/** a path node is either a field name or an array index */
+struct JsonPathNode {
+    JsonPathNode(int32_t arrayIndex) : m_arrayIndex(arrayIndex) {}
+    JsonPathNode(const char* field) : m_arrayIndex(-1), m_field(field) {}
+
+    int32_t m_arrayIndex;
+    std::string m_field;
+};
+
+/**
+ * Paths of the FIELD and SET_FIELD functions, parsed once per thread and
+ * kept for the rows that follow, and evaluated on documents without
+ * building a DOM for them.
+ */
+class JsonPath {
+public:
+    /** The array index that refers to the last element of an array. */
+    static const int32_t ARRAY_TAIL = -10;
+
+    enum Extraction {
+        JSON_PATH_FOUND,
+        // The document is valid JSON, and the path leads to nothing or to null.
+        JSON_PATH_MISSING,
+        // Only a DOM can tell: the document may not be valid JSON, or the path
+        // leads to a value whose text the DOM writer has to produce.
+        JSON_PATH_UNDECIDED
+    };
+
+    /**
+     * Parse a path into its nodes, which stay valid until the next call on
+     * this thread. A NULL path refers directly to the document root.
+     * Throws a SQLException for an invalid path.
+     */
+    static const std::vector<JsonPathNode>& resolve(const char* pathChars, int32_t lenPath,
+                                                    bool enforceArrayIndexLimitForSet = false);
+
+    /**
+     * Find the value the path leads to in a single pass over the document,
+     * and return it as the FIELD function does. The pass always reaches the
+     * end of the document: text after the value may still make the document
+     * invalid, or repeat the value's key and replace it.
+     */
+    static Extraction extract(const char* docChars, int32_t lenDoc,
+                              const std::vector<JsonPathNode>& path, std::string& value);
+
+    /** Count the elements of a document that is an array. */
+    static Extraction arrayLength(const char* docChars, int32_t lenDoc, int32_t& length);
+};
+
+/**
+ * The last few documents parsed on this thread, so that several JSON
+ * functions applied to the same column of a row parse it only once.
+ */
+class JsonDocumentCache {
+public:
+    static const size_t CAPACITY = 4;
+
+    /**
+     * Return the parsed document, which stays valid until the next call on
+     * this thread. Throws a SQLException if the document is not valid JSON.
+     */
+    static const Json::Value& parse(const char* docChars, int32_t lenDoc);
+
+    static void clear();
+};
+
+}
+
+#endif
@@ -0,0 +1,156 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "expressions/likeexpression.h"
+
+#include "common/ValuePeeker.hpp"
+#include "expressions/constantvalueexpression.h"
+#include "expressions/parametervalueexpression.h"
+
+#include <cstring>
+
+namespace voltdb {
+
+bool LikeExpression::isRowInvariantPattern(AbstractExpression* right)
+{
+    return dynamic_cast<ConstantValueExpression*>(right) != NULL ||
+           dynamic_cast<ParameterValueExpression*>(right) != NULL;
+}
+
+LikeExpression::LikeExpression(ExpressionType type, AbstractExpression* left, AbstractExpression* right)
+    : ComparisonExpression<CmpLike>(type, left, right)
+    , m_leftOperand(left)
+    , m_rightOperand(right)
+    , m_constantPattern(dynamic_cast<ConstantValueExpression*>(right) != NULL)
+    , m_compiled(false)
+    , m_kind(PATTERN_GENERAL)
+{
+    assert(isRowInvariantPattern(right));
+}
+
+LikeExpression::PatternKind LikeExpression::classify(const char* pattern, int32_t length, std::string& literal)
+{
+    literal.clear();
+    if (length == 1 && pattern[0] == '%') {
+        return PATTERN_ANY;
+    }
+    bool leading = length > 0 && pattern[0] == '%';
+    bool trailing = length > 1 && pattern[length - 1] == '%';
+    const char* begin = pattern + (leading ? 1 : 0);
+    const char* end = pattern + length - (trailing ? 1 : 0);
+    // NValue::like treats stacked wildcards such as 'abc%%' differently
+    // from a single '%', so anything but one at either end goes to it.
+    if ((leading || trailing) && begin == end) {
+        return PATTERN_GENERAL;
+    }
+    for (const char* cursor = begin; cursor != end; ++cursor) {
+        if (*cursor == '%' || *cursor == '_') {
+            return PATTERN_GENERAL;
+        }
+    }
+    literal.assign(begin, end);
+    if (leading) {
+        return trailing ? PATTERN_CONTAINS : PATTERN_SUFFIX;
+    }
+    return trailing ? PATTERN_PREFIX : PATTERN_EXACT;
+}
+
+bool LikeExpression::matches(PatternKind kind, const std::string& literal, const char* value, int32_t length)
+{
+    // The literal and the value are both UTF-8, so comparing bytes finds
+    // exactly the matches that comparing code points would.
+    size_t literalLength = literal.size();
+    size_t valueLength = static_cast<size_t>(length);
+    switch (kind) {
+    case PATTERN_ANY:
+        return true;
+    case PATTERN_EXACT:
+        return valueLength == literalLength && ::memcmp(value, literal.data(), literalLength) == 0;
+    case PATTERN_PREFIX:
+        return valueLength >= literalLength && ::memcmp(value, literal.data(), literalLength) == 0;
+    case PATTERN_SUFFIX:
+        return valueLength >= literalLength &&
+               ::memcmp(value + valueLength - literalLength, literal.data(), literalLength) == 0;
+    case PATTERN_CONTAINS: {
+        if (valueLength < literalLength) {
+            return false;
+        }
+        const char first = literal[0];
+        const char* cursor = value;
+        const char* last = value + valueLength - literalLength;
+        while (cursor <= last) {
+            cursor = static_cast<const char*>(::memchr(cursor, first, last - cursor + 1));
+            if (cursor == NULL) {
+                return false;
+            }
+            if (::memcmp(cursor + 1, literal.data() + 1, literalLength - 1) == 0) {
+                return true;
+            }
+            ++cursor;
+        }
+        return false;
+    }
+    default:
+        assert(false);
+        return false;
+    }
+}
+
+bool LikeExpression::isCurrent(const char* pattern, int32_t length) const
+{
+    if ( ! m_compiled) {
+        return false;
+    }
+    // A parameter may hold a new pattern in the next execution.
+    return m_constantPattern ||
+           (m_pattern.size() == static_cast<size_t>(length) &&
+            ::memcmp(m_pattern.data(), pattern, length) == 0);
+}
+
+NValue LikeExpression::eval(const TableTuple* tuple1, const TableTuple* tuple2) const
+{
+    NValue lnv = m_leftOperand->eval(tuple1, tuple2);
+    if (lnv.isNull()) {
+        return NValue::getNullValue(VALUE_TYPE_BOOLEAN);
+    }
+    NValue rnv = m_rightOperand->eval(tuple1, tuple2);
+    if (rnv.isNull()) {
+        return NValue::getNullValue(VALUE_TYPE_BOOLEAN);
+    }
+    if (ValuePeeker::peekValueType(lnv) != VALUE_TYPE_VARCHAR ||
+        ValuePeeker::peekValueType(rnv) != VALUE_TYPE_VARCHAR) {
+        // Let NValue::like report the type error.
+        return lnv.like(rnv);
+    }
+
+    int32_t patternLength;
+    const char* pattern = ValuePeeker::peekObject_withoutNull(rnv, &patternLength);
+    if ( ! isCurrent(pattern, patternLength)) {
+        m_kind = classify(pattern, patternLength, m_literal);
+        m_pattern.assign(pattern, patternLength);
+        m_compiled = true;
+    }
+    if (m_kind == PATTERN_GENERAL) {
+        return lnv.like(rnv);
+    }
+
+    int32_t valueLength;
+    const char* value = ValuePeeker::peekObject_withoutNull(lnv, &valueLength);
+    return matches(m_kind, m_literal, value, valueLength) ? NValue::getTrue() : NValue::getFalse();
+}
+
+}
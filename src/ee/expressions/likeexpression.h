@@ -0,0 +1,81 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIKEEXPRESSION_H
+#define LIKEEXPRESSION_H
+
+#include "expressions/comparisonexpression.h"
+
+#include <string>
+
+namespace voltdb {
+
+/**
+ * LIKE against a pattern that is a constant or a parameter. The pattern is
+ * examined once, instead of being re-parsed for every row, and the common
+ * shapes 'abc', 'abc%', '%abc' and '%abc%' are matched with memcmp and a
+ * memchr-driven search. Any other pattern is left to NValue::like.
+ */
+class LikeExpression : public ComparisonExpression<CmpLike> {
+public:
+    /** Whether right keeps the same value for every row of a scan. */
+    static bool isRowInvariantPattern(AbstractExpression* right);
+
+    LikeExpression(ExpressionType type, AbstractExpression* left, AbstractExpression* right);
+
+    NValue eval(const TableTuple* tuple1, const TableTuple* tuple2) const;
+
+    std::string debugInfo(const std::string& spacer) const
+    {
+        return spacer + "LikeExpression\n";
+    }
+
+    enum PatternKind {
+        PATTERN_EXACT,     // 'abc', with no wildcards
+        PATTERN_PREFIX,    // 'abc%'
+        PATTERN_SUFFIX,    // '%abc'
+        PATTERN_CONTAINS,  // '%abc%'
+        PATTERN_ANY,       // '%'
+        // Matched by NValue::like
+        PATTERN_GENERAL
+    };
+
+    /**
+     * Classify a pattern, and return in literal the text its fast path
+     * compares against.
+     */
+    static PatternKind classify(const char* pattern, int32_t length, std::string& literal);
+
+    /** Match a value against a pattern that classify did not call general. */
+    static bool matches(PatternKind kind, const std::string& literal, const char* value, int32_t length);
+
+private:
+    bool isCurrent(const char* pattern, int32_t length) const;
+
+    AbstractExpression* m_leftOperand;
+    AbstractExpression* m_rightOperand;
+    bool m_constantPattern;
+
+    mutable bool m_compiled;
+    mutable std::string m_pattern;
+    mutable PatternKind m_kind;
+    mutable std::string m_literal;
+};
+
+}
+
+#endif
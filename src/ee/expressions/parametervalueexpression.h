@@ -67,6 +67,7 @@ public:
 
     // Constructor to use for testing purposes
     ParameterValueExpression(int value_idx, voltdb::NValue* paramValue) :
+        AbstractExpression(EXPRESSION_TYPE_VALUE_PARAMETER),
         m_valueIdx(value_idx), m_paramValue(paramValue) {
     }
 
@@ -90,6 +91,12 @@ public:
         return this->m_valueIdx;
     }
 
+    // The NValue this parameter is bound to.  Its value changes from
+    // one execution to the next but its address does not.
+    const voltdb::NValue* getParamValue() const {
+        return m_paramValue;
+    }
+
   private:
     int m_valueIdx;
 
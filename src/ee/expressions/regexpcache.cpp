@@ -0,0 +1,168 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "expressions/regexpcache.h"
+
+#include "boost/functional/hash.hpp"
+#include "boost/unordered_map.hpp"
+
+#include <cstring>
+#include <list>
+#include <pthread.h>
+#include <string>
+
+namespace voltdb {
+
+namespace {
+
+struct Key {
+    Key(const char* pattern, size_t length, uint32_t options)
+        : m_pattern(pattern, length), m_options(options) { }
+    std::string m_pattern;
+    uint32_t m_options;
+};
+
+/** A key that points at the pattern, for lookups that need not copy it. */
+struct KeyRef {
+    KeyRef(const char* pattern, size_t length, uint32_t options)
+        : m_pattern(pattern), m_length(length), m_options(options) { }
+    const char* m_pattern;
+    size_t m_length;
+    uint32_t m_options;
+};
+
+struct KeyHash {
+    size_t hash(const char* pattern, size_t length, uint32_t options) const
+    {
+        size_t seed = boost::hash_range(pattern, pattern + length);
+        boost::hash_combine(seed, options);
+        return seed;
+    }
+    size_t operator()(const Key& key) const
+    { return hash(key.m_pattern.data(), key.m_pattern.size(), key.m_options); }
+    size_t operator()(const KeyRef& key) const
+    { return hash(key.m_pattern, key.m_length, key.m_options); }
+};
+
+struct KeyEqual {
+    bool operator()(const Key& lhs, const Key& rhs) const
+    { return lhs.m_options == rhs.m_options && lhs.m_pattern == rhs.m_pattern; }
+    bool operator()(const KeyRef& lhs, const Key& rhs) const
+    {
+        return lhs.m_options == rhs.m_options &&
+               lhs.m_length == rhs.m_pattern.size() &&
+               ::memcmp(lhs.m_pattern, rhs.m_pattern.data(), lhs.m_length) == 0;
+    }
+};
+
+class ThreadCache {
+public:
+    const RegexpCache::Entry* lookup(const char* pattern, size_t length, uint32_t options, int& errorCode)
+    {
+        Index::iterator found = m_index.find(KeyRef(pattern, length, options), KeyHash(), KeyEqual());
+        if (found != m_index.end()) {
+            // Move the pattern to the front of the recency list.
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            return &found->second->second;
+        }
+
+        PCRE2_SIZE errorOffset = 0;
+        RegexpCache::Entry entry;
+        entry.code.reset(pcre2_compile(reinterpret_cast<PCRE2_SPTR>(pattern), length, options,
+                                       &errorCode, &errorOffset, NULL),
+                         pcre2_code_free);
+        if (entry.code.get() == NULL) {
+            return NULL;
+        }
+        // This fails harmlessly when pcre2 was built without JIT support,
+        // and pcre2_match then interprets the pattern.
+        (void)pcre2_jit_compile(entry.code.get(), PCRE2_JIT_COMPLETE);
+        entry.matchData.reset(pcre2_match_data_create_from_pattern(entry.code.get(), NULL),
+                              pcre2_match_data_free);
+        if (entry.matchData.get() == NULL) {
+            errorCode = PCRE2_ERROR_NOMEMORY;
+            return NULL;
+        }
+
+        if (m_entries.size() >= RegexpCache::CAPACITY) {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+        Key key(pattern, length, options);
+        m_entries.push_front(std::make_pair(key, entry));
+        m_index[key] = m_entries.begin();
+        return &m_entries.front().second;
+    }
+
+    size_t size() const { return m_entries.size(); }
+
+    void clear()
+    {
+        m_index.clear();
+        m_entries.clear();
+    }
+
+private:
+    typedef std::list<std::pair<Key, RegexpCache::Entry> > Entries;
+    typedef boost::unordered_map<Key, Entries::iterator, KeyHash, KeyEqual> Index;
+
+    Entries m_entries;
+    Index m_index;
+};
+
+pthread_key_t cacheKey;
+pthread_once_t cacheKeyOnce = PTHREAD_ONCE_INIT;
+
+void deleteThreadCache(void* cache)
+{
+    delete static_cast<ThreadCache*>(cache);
+}
+
+void createCacheKey()
+{
+    (void)pthread_key_create(&cacheKey, deleteThreadCache);
+}
+
+ThreadCache& threadCache()
+{
+    (void)pthread_once(&cacheKeyOnce, createCacheKey);
+    ThreadCache* cache = static_cast<ThreadCache*>(pthread_getspecific(cacheKey));
+    if (cache == NULL) {
+        cache = new ThreadCache();
+        pthread_setspecific(cacheKey, cache);
+    }
+    return *cache;
+}
+
+}
+
+const RegexpCache::Entry* RegexpCache::lookup(const char* pattern, size_t length, uint32_t options, int& errorCode)
+{
+    return threadCache().lookup(pattern, length, options, errorCode);
+}
+
+size_t RegexpCache::size()
+{
+    return threadCache().size();
+}
+
+void RegexpCache::clear()
+{
+    threadCache().clear();
+}
+
+}
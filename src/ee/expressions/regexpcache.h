@@ -0,0 +1,64 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGEXPCACHE_H
+#define REGEXPCACHE_H
+
+#ifndef PCRE2_CODE_UNIT_WIDTH
+#define PCRE2_CODE_UNIT_WIDTH 8
+#endif
+#include "pcre2.h"
+
+#include "boost/shared_ptr.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * A per-thread cache of compiled regular expressions. A pattern that stays
+ * the same from row to row, such as a constant or a parameter, is compiled
+ * (and JIT compiled, when pcre2 was built with JIT support) once instead of
+ * once per row. The least recently used pattern is dropped when the cache
+ * is full.
+ */
+class RegexpCache {
+public:
+    struct Entry {
+        boost::shared_ptr<pcre2_code> code;
+        boost::shared_ptr<pcre2_match_data> matchData;
+    };
+
+    static const size_t CAPACITY = 64;
+
+    /**
+     * Return the compiled pattern, which stays valid until the next lookup
+     * on this thread, or NULL with errorCode set if it does not compile.
+     * Patterns that fail to compile are not cached.
+     */
+    static const Entry* lookup(const char* pattern, size_t length, uint32_t options, int& errorCode);
+
+    /** The number of patterns this thread has cached. */
+    static size_t size();
+
+    static void clear();
+};
+
+}
+
+#endif
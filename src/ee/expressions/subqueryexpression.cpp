@@ -21,6 +21,7 @@
 
 #include "common/debuglog.h"
 #include "common/executorcontext.hpp"
+#include "storage/AbstractTempTable.hpp"
 
 
 namespace voltdb {
@@ -86,6 +87,7 @@ NValue SubqueryExpression::eval(const TableTuple *tuple1, const TableTuple *tupl
             }
             // Update the value stored in the executor context's parameter container:
             prevParam = param.copyNValue();
+            exeContext->advanceParameterGeneration();
         }
     }
 
@@ -114,8 +116,36 @@ NValue SubqueryExpression::eval(const TableTuple *tuple1, const TableTuple *tupl
         }
     }
 
-    // Out of luck. Need to run the executors. Clean up the output tables with cached results
+    // Clean up the output tables with cached results
     exeContext->cleanupExecutorsForSubquery(m_subqueryId);
+
+    // The result for these parameters may still be cached from an earlier execution.
+    // Only a temp output table can be refilled with it.
+    AbstractTempTable* cacheableOutput = NULL;
+    std::vector<NValue> allParams;
+    if ( ! (m_paramIdxs.empty() && m_otherParamIdxs.empty())) {
+        cacheableOutput = dynamic_cast<AbstractTempTable*>(
+                exeContext->getSubqueryOutputTable(m_subqueryId));
+    }
+    if (cacheableOutput != NULL) {
+        allParams.reserve(m_paramIdxs.size() + m_otherParamIdxs.size());
+        for (size_t i = 0; i < m_paramIdxs.size(); ++i) {
+            allParams.push_back(parameterContainer[m_paramIdxs[i]]);
+        }
+        for (size_t i = 0; i < m_otherParamIdxs.size(); ++i) {
+            allParams.push_back(parameterContainer[m_otherParamIdxs[i]]);
+        }
+        if (context != NULL) {
+            if (context->accessResultCache().restore(allParams, cacheableOutput)) {
+                VOLT_TRACE("Restored subquery %d result from cache", m_subqueryId);
+                NValue retval = ValueFactory::getIntegerValue(m_subqueryId);
+                context->setResult(retval);
+                return retval;
+            }
+        }
+    }
+
+    // Out of luck. Need to run the executors.
     UniqueTempTableResult result = exeContext->executeExecutors(m_subqueryId);
 
     // We don't want this temp table to be cleaned up; we want it to
@@ -137,6 +167,9 @@ NValue SubqueryExpression::eval(const TableTuple *tuple1, const TableTuple *tupl
     // Update the cached result for the current params. All params are already updated
     NValue retval = ValueFactory::getIntegerValue(m_subqueryId);
     context->setResult(retval);
+    if (cacheableOutput != NULL) {
+        context->accessResultCache().store(allParams, cacheableOutput);
+    }
     return retval;
 }
 
@@ -74,6 +74,8 @@ public:
         return spacer + "VectorExpression\n";
     }
 
+    const std::vector<AbstractExpression *>& getArgs() const { return m_args; }
+
 private:
     const std::vector<AbstractExpression *>& m_args;
     NValue m_inList;
@@ -86,5 +88,12 @@ ExpressionUtil::vectorFactory(ValueType elementType, const std::vector<AbstractE
     return new VectorExpression(elementType, *arguments);
 }
 
+const std::vector<AbstractExpression*>*
+ExpressionUtil::vectorArguments(const AbstractExpression* expr)
+{
+    const VectorExpression* vector = dynamic_cast<const VectorExpression*>(expr);
+    return (vector != NULL) ? &vector->getArgs() : NULL;
+}
+
 }
 
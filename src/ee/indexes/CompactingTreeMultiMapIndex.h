@@ -46,24 +46,29 @@
 #ifndef COMPACTINGTREEMULTIMAPINDEX_H_
 #define COMPACTINGTREEMULTIMAPINDEX_H_
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include "indexes/IntsKeySearch.h"
 #include "indexes/tableindex.h"
 #include "common/tabletuple.h"
 #include "structures/CompactingMap.h"
+#include "structures/CompactingBTree.h"
 
 namespace voltdb {
 
 /**
  * Index implemented as a Binary Tree Multimap.
+ * Map is CompactingMap (red-black) or CompactingBTree (B+tree).
  * @see TableIndex
  */
-template<typename KeyValuePair, bool hasRank>
+template<typename KeyValuePair, bool hasRank,
+         template<typename, typename, bool> class Map = CompactingMap>
 class CompactingTreeMultiMapIndex : public TableIndex
 {
     typedef typename KeyValuePair::first_type KeyType;
     typedef typename KeyType::KeyComparator KeyComparator;
-    typedef CompactingMap<KeyValuePair, KeyComparator, hasRank> MapType;
+    typedef Map<KeyValuePair, KeyComparator, hasRank> MapType;
     typedef typename MapType::iterator MapIterator;
     typedef std::pair<MapIterator, MapIterator> MapRange;
 
@@ -94,6 +99,44 @@ class CompactingTreeMultiMapIndex : public TableIndex
         return m_entries.erase(iter);
     }
 
+    bool addEntriesToEmptyDo(const std::vector<const TableTuple*>& tuples, TableTuple *conflictTuple)
+    {
+        std::vector<KeyedTuple> keyed;
+        sortByKey(tuples, keyed);
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(keyed.size());
+        for (size_t ii = 0; ii < keyed.size(); ++ii) {
+            entries.push_back(std::make_pair(keyed[ii].first, keyed[ii].second->address()));
+        }
+        m_entries.buildFromSorted(entries.begin(), static_cast<int64_t>(entries.size()));
+        m_inserts += static_cast<int>(entries.size());
+        return true;
+    }
+
+    bool deleteEntriesDo(const std::vector<const TableTuple*>& tuples)
+    {
+        if (!KeyType::keyDependsOnTupleAddress()) {
+            return TableIndex::deleteEntriesDo(tuples);
+        }
+        std::vector<KeyedTuple> keyed;
+        sortByKey(tuples, keyed);
+        bool success = true;
+        // Keys include the tuple address, so they are unique and each
+        // erase leaves the cursor at or just before the next key.
+        MapIterator cursor;
+        for (size_t ii = 0; ii < keyed.size(); ++ii) {
+            ++m_deletes;
+            MapIterator iter = m_entries.findFrom(cursor, keyed[ii].first);
+            if (iter.isEnd()) {
+                success = false;
+                continue;
+            }
+            m_entries.eraseAndMoveNext(iter);
+            cursor = iter;
+        }
+        return success;
+    }
+
     /**
      * Update in place an index entry with a new tuple address
      * (e.g., due to table compaction)
@@ -383,6 +426,9 @@ class CompactingTreeMultiMapIndex : public TableIndex
     MapIterator findKey(const TableTuple *searchKey) const {
         KeyType tempKey(searchKey);
         MapIterator rv = m_entries.lowerBound(tempKey);
+        if (rv.isEnd()) {
+            return rv;
+        }
         KeyType rvKey = rv.key();
         setPointerValue(tempKey, MAXPOINTER);
         if (m_cmp(rvKey, tempKey) <= 0) {
@@ -415,6 +461,27 @@ class CompactingTreeMultiMapIndex : public TableIndex
         return result;
     }
 
+    typedef std::pair<KeyType, const TableTuple*> KeyedTuple;
+
+    struct KeyedTupleLess {
+        KeyedTupleLess(const KeyComparator& cmp) : m_cmp(cmp) { }
+        bool operator()(const KeyedTuple& lhs, const KeyedTuple& rhs) const {
+            return m_cmp(lhs.first, rhs.first) < 0;
+        }
+        const KeyComparator& m_cmp;
+    };
+
+    // Order a batch by key so that it is applied in one left to right
+    // pass over the tree rather than at random leaves.
+    void sortByKey(const std::vector<const TableTuple*>& tuples, std::vector<KeyedTuple>& keyed) const
+    {
+        keyed.reserve(tuples.size());
+        for (size_t ii = 0; ii < tuples.size(); ++ii) {
+            keyed.push_back(KeyedTuple(setKeyFromTuple(tuples[ii]), tuples[ii]));
+        }
+        std::sort(keyed.begin(), keyed.end(), KeyedTupleLess(m_cmp));
+    }
+
     MapType m_entries;
 
     // comparison stuff
@@ -46,26 +46,31 @@
 #ifndef COMPACTINGTREEUNIQUEINDEX_H_
 #define COMPACTINGTREEUNIQUEINDEX_H_
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 
 #include "common/debuglog.h"
 #include "common/tabletuple.h"
+#include "indexes/IntsKeySearch.h"
 #include "indexes/tableindex.h"
 #include "structures/CompactingMap.h"
+#include "structures/CompactingBTree.h"
 
 namespace voltdb {
 
 /**
  * Index implemented as a Binary Tree Unique Map.
+ * Map is CompactingMap (red-black) or CompactingBTree (B+tree).
  * @see TableIndex
  */
-template<typename KeyValuePair, bool hasRank>
+template<typename KeyValuePair, bool hasRank,
+         template<typename, typename, bool> class Map = CompactingMap>
 class CompactingTreeUniqueIndex : public TableIndex
 {
     typedef typename KeyValuePair::first_type KeyType;
     typedef typename KeyType::KeyComparator KeyComparator;
-    typedef CompactingMap<KeyValuePair, KeyComparator, hasRank> MapType;
+    typedef Map<KeyValuePair, KeyComparator, hasRank> MapType;
     typedef typename MapType::iterator MapIterator;
 
     ~CompactingTreeUniqueIndex() {};
@@ -89,6 +94,47 @@ class CompactingTreeUniqueIndex : public TableIndex
         return m_entries.erase(setKeyFromTuple(tuple));
     }
 
+    bool addEntriesToEmptyDo(const std::vector<const TableTuple*>& tuples, TableTuple *conflictTuple)
+    {
+        std::vector<KeyedTuple> keyed;
+        sortByKey(tuples, keyed);
+        for (size_t ii = 1; ii < keyed.size(); ++ii) {
+            if (m_cmp(keyed[ii - 1].first, keyed[ii].first) == 0) {
+                conflictTuple->move(keyed[ii - 1].second->address());
+                return false;
+            }
+        }
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(keyed.size());
+        for (size_t ii = 0; ii < keyed.size(); ++ii) {
+            entries.push_back(std::make_pair(keyed[ii].first, keyed[ii].second->address()));
+        }
+        m_entries.buildFromSorted(entries.begin(), static_cast<int64_t>(entries.size()));
+        m_inserts += static_cast<int>(entries.size());
+        return true;
+    }
+
+    bool deleteEntriesDo(const std::vector<const TableTuple*>& tuples)
+    {
+        std::vector<KeyedTuple> keyed;
+        sortByKey(tuples, keyed);
+        bool success = true;
+        // Each erase leaves the cursor on the following entry, which is
+        // usually at or just before the next key of the sorted batch.
+        MapIterator cursor;
+        for (size_t ii = 0; ii < keyed.size(); ++ii) {
+            ++m_deletes;
+            MapIterator iter = m_entries.findFrom(cursor, keyed[ii].first);
+            if (iter.isEnd()) {
+                success = false;
+                continue;
+            }
+            m_entries.eraseAndMoveNext(iter);
+            cursor = iter;
+        }
+        return success;
+    }
+
     /**
      * Update in place an index entry with a new tuple address
      */
@@ -366,7 +412,7 @@ class CompactingTreeUniqueIndex : public TableIndex
 
     virtual TableIndex *cloneEmptyNonCountingTreeIndex() const
     {
-        return new CompactingTreeUniqueIndex<KeyValuePair, false >(TupleSchema::createTupleSchema(getKeySchema()), m_scheme);
+        return new CompactingTreeUniqueIndex<KeyValuePair, false, Map>(TupleSchema::createTupleSchema(getKeySchema()), m_scheme);
     }
 
 
@@ -384,6 +430,27 @@ class CompactingTreeUniqueIndex : public TableIndex
         return result;
     }
 
+    typedef std::pair<KeyType, const TableTuple*> KeyedTuple;
+
+    struct KeyedTupleLess {
+        KeyedTupleLess(const KeyComparator& cmp) : m_cmp(cmp) { }
+        bool operator()(const KeyedTuple& lhs, const KeyedTuple& rhs) const {
+            return m_cmp(lhs.first, rhs.first) < 0;
+        }
+        const KeyComparator& m_cmp;
+    };
+
+    // Order a batch by key so that it is applied in one left to right
+    // pass over the tree rather than at random leaves.
+    void sortByKey(const std::vector<const TableTuple*>& tuples, std::vector<KeyedTuple>& keyed) const
+    {
+        keyed.reserve(tuples.size());
+        for (size_t ii = 0; ii < tuples.size(); ++ii) {
+            keyed.push_back(KeyedTuple(setKeyFromTuple(tuples[ii]), tuples[ii]));
+        }
+        std::sort(keyed.begin(), keyed.end(), KeyedTupleLess(m_cmp));
+    }
+
     MapType m_entries;
 
     // comparison stuff
@@ -0,0 +1,245 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "indexes/IntsKeySearch.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define VOLT_INTS_KEY_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace voltdb {
+
+namespace {
+
+int countBelowScalar(const uint64_t *words, int stride, int count, uint64_t key, bool upper)
+{
+    int below = 0;
+    if (upper) {
+        for (int i = 0; i < count; ++i) {
+            below += words[i * stride] <= key;
+        }
+    }
+    else {
+        for (int i = 0; i < count; ++i) {
+            below += words[i * stride] < key;
+        }
+    }
+    return below;
+}
+
+// Comparing a pair takes several branch-free operations, which costs more than the
+// mispredicted branches of a binary search saves.
+int countPairsBelowScalar(const uint64_t *pairs, int count, uint64_t key, uint64_t pointer, bool upper)
+{
+    int lo = 0;
+    int hi = count;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        const uint64_t word = pairs[2 * mid];
+        const uint64_t wordPointer = pairs[2 * mid + 1];
+        if (word < key || (word == key && (wordPointer < pointer || (upper && wordPointer == pointer)))) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+#ifdef VOLT_INTS_KEY_SEARCH_X86
+
+// The vector compares are signed; flipping the sign bit of both sides makes them order unsigned words.
+const long long SIGN_BIT = static_cast<long long>(0x8000000000000000ULL);
+
+// Each true compare lane is -1, so subtracting the masks counts them without leaving the vector unit.
+__attribute__((target("sse4.2")))
+inline int sumLanes(__m128i counts)
+{
+    return static_cast<int>(_mm_cvtsi128_si64(counts) + _mm_extract_epi64(counts, 1));
+}
+
+__attribute__((target("avx2")))
+inline int sumLanes(__m256i counts)
+{
+    return sumLanes(_mm_add_epi64(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1)));
+}
+
+__attribute__((target("sse4.2")))
+int countBelowSse42(const uint64_t *words, int stride, int count, uint64_t key, bool upper)
+{
+    const __m128i bias = _mm_set1_epi64x(SIGN_BIT);
+    const __m128i biasedKey = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(key)), bias);
+    __m128i below = _mm_setzero_si128();
+    __m128i above = _mm_setzero_si128();
+    int i = 0;
+    if (stride == 1 || stride == 2) {
+        for (; i + 2 <= count; i += 2) {
+            __m128i w;
+            if (stride == 1) {
+                w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+            }
+            else {
+                w = _mm_unpacklo_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + 2 * i)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + 2 * i + 2)));
+            }
+            w = _mm_xor_si128(w, bias);
+            if (upper) {
+                above = _mm_sub_epi64(above, _mm_cmpgt_epi64(w, biasedKey));
+            }
+            else {
+                below = _mm_sub_epi64(below, _mm_cmpgt_epi64(biasedKey, w));
+            }
+        }
+    }
+    const int vectorBelow = upper ? i - sumLanes(above) : sumLanes(below);
+    return vectorBelow + countBelowScalar(words + i * stride, stride, count - i, key, upper);
+}
+
+__attribute__((target("sse4.2")))
+int countPairsBelowSse42(const uint64_t *pairs, int count, uint64_t key, uint64_t pointer, bool upper)
+{
+    const __m128i bias = _mm_set1_epi64x(SIGN_BIT);
+    const __m128i biasedKey = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(key)), bias);
+    const __m128i biasedPointer = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(pointer)), bias);
+    __m128i below = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs + 2 * i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs + 2 * i + 2));
+        const __m128i words = _mm_xor_si128(_mm_unpacklo_epi64(a, b), bias);
+        const __m128i pointers = _mm_xor_si128(_mm_unpackhi_epi64(a, b), bias);
+        const __m128i equal = _mm_cmpeq_epi64(words, biasedKey);
+        const __m128i pointerBelow = upper ?
+            _mm_andnot_si128(_mm_cmpgt_epi64(pointers, biasedPointer), equal) :
+            _mm_and_si128(_mm_cmpgt_epi64(biasedPointer, pointers), equal);
+        below = _mm_sub_epi64(below, _mm_or_si128(_mm_cmpgt_epi64(biasedKey, words), pointerBelow));
+    }
+    return sumLanes(below) + countPairsBelowScalar(pairs + 2 * i, count - i, key, pointer, upper);
+}
+
+__attribute__((target("avx2")))
+int countBelowAvx2(const uint64_t *words, int stride, int count, uint64_t key, bool upper)
+{
+    const __m256i bias = _mm256_set1_epi64x(SIGN_BIT);
+    const __m256i biasedKey = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(key)), bias);
+    __m256i below = _mm256_setzero_si256();
+    __m256i above = _mm256_setzero_si256();
+    int i = 0;
+    if (stride == 1 || stride == 2) {
+        for (; i + 4 <= count; i += 4) {
+            __m256i w;
+            if (stride == 1) {
+                w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+            }
+            else {
+                // unpacking within 128 bit lanes takes the words out of order, which doesn't matter for a count
+                w = _mm256_unpacklo_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + 2 * i)),
+                                          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + 2 * i + 4)));
+            }
+            w = _mm256_xor_si256(w, bias);
+            if (upper) {
+                above = _mm256_sub_epi64(above, _mm256_cmpgt_epi64(w, biasedKey));
+            }
+            else {
+                below = _mm256_sub_epi64(below, _mm256_cmpgt_epi64(biasedKey, w));
+            }
+        }
+    }
+    const int vectorBelow = upper ? i - sumLanes(above) : sumLanes(below);
+    return vectorBelow + countBelowScalar(words + i * stride, stride, count - i, key, upper);
+}
+
+__attribute__((target("avx2")))
+int countPairsBelowAvx2(const uint64_t *pairs, int count, uint64_t key, uint64_t pointer, bool upper)
+{
+    const __m256i bias = _mm256_set1_epi64x(SIGN_BIT);
+    const __m256i biasedKey = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(key)), bias);
+    const __m256i biasedPointer = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(pointer)), bias);
+    __m256i below = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs + 2 * i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs + 2 * i + 4));
+        const __m256i words = _mm256_xor_si256(_mm256_unpacklo_epi64(a, b), bias);
+        const __m256i pointers = _mm256_xor_si256(_mm256_unpackhi_epi64(a, b), bias);
+        const __m256i equal = _mm256_cmpeq_epi64(words, biasedKey);
+        const __m256i pointerBelow = upper ?
+            _mm256_andnot_si256(_mm256_cmpgt_epi64(pointers, biasedPointer), equal) :
+            _mm256_and_si256(_mm256_cmpgt_epi64(biasedPointer, pointers), equal);
+        below = _mm256_sub_epi64(below, _mm256_or_si256(_mm256_cmpgt_epi64(biasedKey, words), pointerBelow));
+    }
+    return sumLanes(below) + countPairsBelowScalar(pairs + 2 * i, count - i, key, pointer, upper);
+}
+
+#endif // VOLT_INTS_KEY_SEARCH_X86
+
+}
+
+IntsKeySearch::Level IntsKeySearch::supportedLevel()
+{
+#ifdef VOLT_INTS_KEY_SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return SSE42;
+    }
+#endif
+    return SCALAR;
+}
+
+void IntsKeySearch::setLevel(Level level)
+{
+    if (level > supportedLevel()) {
+        level = supportedLevel();
+    }
+    s_level = level;
+    switch (level) {
+#ifdef VOLT_INTS_KEY_SEARCH_X86
+    case AVX2:
+        s_countBelow = countBelowAvx2;
+        s_countPairsBelow = countPairsBelowAvx2;
+        break;
+    case SSE42:
+        s_countBelow = countBelowSse42;
+        s_countPairsBelow = countPairsBelowSse42;
+        break;
+#endif
+    default:
+        s_countBelow = countBelowScalar;
+        s_countPairsBelow = countPairsBelowScalar;
+        break;
+    }
+}
+
+IntsKeySearch::Level IntsKeySearch::s_level = IntsKeySearch::SCALAR;
+IntsKeySearch::CountBelowFn IntsKeySearch::s_countBelow = countBelowScalar;
+IntsKeySearch::CountPairsBelowFn IntsKeySearch::s_countPairsBelow = countPairsBelowScalar;
+
+namespace {
+
+// Pick the fastest search before any index is built.
+struct IntsKeySearchInit {
+    IntsKeySearchInit() { IntsKeySearch::setLevel(IntsKeySearch::supportedLevel()); }
+} intsKeySearchInit;
+
+}
+
+}
@@ -0,0 +1,128 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INTSKEYSEARCH_H_
+#define INTSKEYSEARCH_H_
+
+#include "indexes/indexkey.h"
+#include "structures/CompactingBTree.h"
+
+#include <boost/static_assert.hpp>
+
+namespace voltdb {
+
+/**
+ * Positions a single word IntsKey within a sorted B+tree node by counting
+ * the entries below it, several words per instruction where the CPU allows.
+ * The instruction set is picked once at startup: AVX2 if the CPU has it,
+ * else SSE4.2, else a branch-free scalar loop. A node holds a few dozen
+ * entries at most, so a compare over all of them without a mispredicted
+ * branch beats a binary search.
+ *
+ * Entries are read as words spaced stride words apart; with a pointer,
+ * each entry is a (key, tuple pointer) pair ordered by key, then pointer.
+ */
+class IntsKeySearch {
+public:
+    enum Level {
+        SCALAR = 0,
+        SSE42 = 1,
+        AVX2 = 2
+    };
+
+    // the best level this CPU supports
+    static Level supportedLevel();
+
+    static Level level() { return s_level; }
+    // Switches to level (at most supportedLevel()). Benchmarks and tests use
+    // this to compare the paths; it must not race with index lookups.
+    static void setLevel(Level level);
+
+    // number of words[i * stride], i < count, less than (or, if upper, not greater than) key
+    static int countBelow(const uint64_t *words, int stride, int count, uint64_t key, bool upper)
+    {
+        return s_countBelow(words, stride, count, key, upper);
+    }
+
+    // number of (pairs[2 * i], pairs[2 * i + 1]), i < count, less than
+    // (or, if upper, not greater than) (key, pointer)
+    static int countPairsBelow(const uint64_t *pairs, int count, uint64_t key, uint64_t pointer, bool upper)
+    {
+        return s_countPairsBelow(pairs, count, key, pointer, upper);
+    }
+
+private:
+    typedef int (*CountBelowFn)(const uint64_t *, int, int, uint64_t, bool);
+    typedef int (*CountPairsBelowFn)(const uint64_t *, int, uint64_t, uint64_t, bool);
+
+    static Level s_level;
+    static CountBelowFn s_countBelow;
+    static CountPairsBelowFn s_countPairsBelow;
+};
+
+/**
+ * Unique tree indexes on keys that pack into one word.
+ */
+template<>
+struct CompactingBTreeNodeSearch<NormalKeyValuePair<IntsKey<1>, const void*>, IntsComparator<1> > {
+    typedef IntsKey<1> Key;
+    typedef NormalKeyValuePair<IntsKey<1>, const void*> KeyValuePair;
+    BOOST_STATIC_ASSERT_MSG(sizeof(Key) == sizeof(uint64_t), "IntsKey<1> must be a bare word");
+    BOOST_STATIC_ASSERT_MSG(sizeof(KeyValuePair) == 2 * sizeof(uint64_t),
+                            "unique index entries must be a key word and a pointer");
+
+    static int keySlot(const IntsComparator<1> &comper, const Key *keys, int count, const Key &key, bool upper)
+    {
+        return IntsKeySearch::countBelow(keys->data, 1, count, key.data[0], upper);
+    }
+
+    static int entrySlot(const IntsComparator<1> &comper, const KeyValuePair *entries, int count,
+                         const Key &key, bool upper)
+    {
+        return IntsKeySearch::countBelow(entries->first.data, 2, count, key.data[0], upper);
+    }
+};
+
+/**
+ * Multimap tree indexes on keys that pack into one word, where each key
+ * carries the address of its tuple.
+ */
+template<>
+struct CompactingBTreeNodeSearch<PointerKeyValuePair<IntsKey<1>, const void*>, ComparatorWithPointer<IntsKey<1> > > {
+    typedef KeyWithPointer<IntsKey<1> > Key;
+    typedef PointerKeyValuePair<IntsKey<1>, const void*> KeyValuePair;
+    BOOST_STATIC_ASSERT_MSG(sizeof(Key) == 2 * sizeof(uint64_t),
+                            "KeyWithPointer<IntsKey<1> > must be a key word and a pointer");
+    BOOST_STATIC_ASSERT_MSG(sizeof(KeyValuePair) == sizeof(Key), "multimap index entries must be bare keys");
+
+    static int keySlot(const ComparatorWithPointer<IntsKey<1> > &comper, const Key *keys, int count,
+                       const Key &key, bool upper)
+    {
+        return IntsKeySearch::countPairsBelow(keys->data, count, key.data[0],
+                                              reinterpret_cast<uintptr_t>(key.getValue()), upper);
+    }
+
+    static int entrySlot(const ComparatorWithPointer<IntsKey<1> > &comper, const KeyValuePair *entries,
+                         int count, const Key &key, bool upper)
+    {
+        return keySlot(comper, &entries->getKey(), count, key, upper);
+    }
+};
+
+}
+
+#endif // INTSKEYSEARCH_H_
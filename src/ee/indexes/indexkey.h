@@ -133,33 +133,35 @@ struct IntsKey
     static inline bool keyDependsOnTupleAddress() { return false; }
     static inline bool keyUsesNonInlinedMemory() { return false; }
 
+    /*
+     * Mask selecting the low byteCount bytes of a uint64_t.
+     */
+    static inline uint64_t lowBytesMask(int byteCount) {
+        return byteCount >= static_cast<int>(sizeof(uint64_t)) ?
+            ~static_cast<uint64_t>(0) : (static_cast<uint64_t>(1) << (byteCount * 8)) - 1;
+    }
+
     /*
      * Take a value that is part of the key (already converted to a uint64_t) and inserts it into the
      * most significant bytes available in the key. Templated on the size of the type of key being inserted.
-     * This allows the compiler to unroll the loop.
      *
      *
      * Algorithm is:
-     * Start with the most significant byte of the keyValue we are inserting and put into the most significant byte
-     * of the uint64_t portion of the key that is indexed by keyOffset. The most significant available byte within
-     * the uint64_t portion of the key is indexed by intraKeyOffset. Both keyOffset and intraKeyOffset are passed
-     * by reference so they can be updated.
-     *
-     *
-     * Rinse and repeat with the less significant bytes.
+     * The most significant available byte within the uint64_t portion of the key indexed by keyOffset is
+     * indexed by intraKeyOffset. If the whole value fits below it, shift the value up so its most significant
+     * byte lands there and OR it in. Otherwise the value straddles two uint64_ts: its high bytes fill the rest
+     * of this one and its low bytes become the most significant bytes of the next. Both keyOffset and
+     * intraKeyOffset are passed by reference so they can be updated.
      *
      */
     template <typename keyValueType>
     inline void insertKeyValue(int &keyOffset, int &intraKeyOffset, uint64_t keyValue) {
-        for (int ii = static_cast<int>(sizeof(keyValueType)) - 1; ii >= 0; ii--) {
-
-            /*
-             * Extract the most significant byte from keyValue by shifting it all the way to the right.
-             * Mask off the rest. Then shift it to the left to the most significant byte location available
-             * in the key and OR it in.
-             */
-            data[keyOffset] |= (0xFF & (keyValue >> (ii * 8))) << (intraKeyOffset * 8); //
-            intraKeyOffset--;//Move the offset inside the uint64 key back one.
+        const int valueBytes = static_cast<int>(sizeof(keyValueType));
+        const int availableBytes = intraKeyOffset + 1;
+        keyValue &= lowBytesMask(valueBytes);
+        if (valueBytes <= availableBytes) {
+            data[keyOffset] |= keyValue << ((availableBytes - valueBytes) * 8);
+            intraKeyOffset -= valueBytes;
             /*
              * If there are no more bytes available in the uint64_t indexed by keyOffset then increment keyOffset
              * to point to the next uint64_t and set intraKeyOffset to index to the most significant byte
@@ -170,6 +172,13 @@ struct IntsKey
                 keyOffset++;
             }
         }
+        else {
+            const int spilledBytes = valueBytes - availableBytes;
+            data[keyOffset] |= keyValue >> (spilledBytes * 8);
+            keyOffset++;
+            data[keyOffset] |= keyValue << ((static_cast<int>(sizeof(uint64_t)) - spilledBytes) * 8);
+            intraKeyOffset = static_cast<int>(sizeof(uint64_t) - 1) - spilledBytes;
+        }
     }
 
     /*
@@ -177,15 +186,24 @@ struct IntsKey
      */
     template <typename keyValueType>
     inline uint64_t extractKeyValue(int &keyOffset, int &intraKeyOffset) const {
-        uint64_t retval = 0;
-        for (int ii = static_cast<int>(sizeof(keyValueType)) - 1; ii >= 0; ii--) {
-            retval |= (0xFF & (data[keyOffset] >> (intraKeyOffset * 8))) << (ii * 8);
-            intraKeyOffset--;
+        const int valueBytes = static_cast<int>(sizeof(keyValueType));
+        const int availableBytes = intraKeyOffset + 1;
+        uint64_t retval;
+        if (valueBytes <= availableBytes) {
+            retval = (data[keyOffset] >> ((availableBytes - valueBytes) * 8)) & lowBytesMask(valueBytes);
+            intraKeyOffset -= valueBytes;
             if (intraKeyOffset < 0) {
                 intraKeyOffset = static_cast<int>(sizeof(uint64_t) - 1);
                 keyOffset++;
             }
         }
+        else {
+            const int spilledBytes = valueBytes - availableBytes;
+            retval = (data[keyOffset] & lowBytesMask(availableBytes)) << (spilledBytes * 8);
+            keyOffset++;
+            retval |= data[keyOffset] >> ((static_cast<int>(sizeof(uint64_t)) - spilledBytes) * 8);
+            intraKeyOffset = static_cast<int>(sizeof(uint64_t) - 1) - spilledBytes;
+        }
         return retval;
     }
 
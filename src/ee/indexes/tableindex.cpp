@@ -172,6 +172,36 @@ void TableIndex::addEntry(const TableTuple *tuple, TableTuple *conflictTuple)
     addEntryDo(tuple, conflictTuple);
 }
 
+bool TableIndex::addEntriesToEmpty(const std::vector<TableTuple>& tuples, TableTuple *conflictTuple)
+{
+    assert(getSize() == 0);
+    std::vector<const TableTuple*> indexed;
+    indexed.reserve(tuples.size());
+    for (size_t ii = 0; ii < tuples.size(); ++ii) {
+        if (isPartialIndex() && !getPredicate()->eval(&tuples[ii], NULL).isTrue()) {
+            // Tuple fails the predicate. Do not add it.
+            continue;
+        }
+        indexed.push_back(&tuples[ii]);
+    }
+    return addEntriesToEmptyDo(indexed, conflictTuple);
+}
+
+bool TableIndex::addEntriesToEmptyDo(const std::vector<const TableTuple*>& tuples, TableTuple *conflictTuple)
+{
+    for (size_t ii = 0; ii < tuples.size(); ++ii) {
+        addEntryDo(tuples[ii], conflictTuple);
+        if (!conflictTuple->isNullTuple()) {
+            // Back out what was added so that the index is empty again.
+            for (size_t jj = 0; jj < ii; ++jj) {
+                deleteEntryDo(tuples[jj]);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
 bool TableIndex::deleteEntry(const TableTuple *tuple)
 {
     if (isPartialIndex() && !getPredicate()->eval(tuple, NULL).isTrue()) {
@@ -181,6 +211,31 @@ bool TableIndex::deleteEntry(const TableTuple *tuple)
     return deleteEntryDo(tuple);
 }
 
+bool TableIndex::deleteEntries(const std::vector<TableTuple>& tuples)
+{
+    std::vector<const TableTuple*> indexed;
+    indexed.reserve(tuples.size());
+    for (size_t ii = 0; ii < tuples.size(); ++ii) {
+        if (isPartialIndex() && !getPredicate()->eval(&tuples[ii], NULL).isTrue()) {
+            // Tuple fails the predicate. Nothing to delete
+            continue;
+        }
+        indexed.push_back(&tuples[ii]);
+    }
+    return deleteEntriesDo(indexed);
+}
+
+bool TableIndex::deleteEntriesDo(const std::vector<const TableTuple*>& tuples)
+{
+    bool success = true;
+    for (size_t ii = 0; ii < tuples.size(); ++ii) {
+        if (!deleteEntryDo(tuples[ii])) {
+            success = false;
+        }
+    }
+    return success;
+}
+
 bool TableIndex::replaceEntryNoKeyChange(const TableTuple &destinationTuple, const TableTuple &originalTuple)
 {
     assert(originalTuple.address() != destinationTuple.address());
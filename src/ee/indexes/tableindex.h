@@ -223,12 +223,28 @@ public:
      */
     void addEntry(const TableTuple *tuple, TableTuple *conflictTuple);
 
+    /**
+     * adds index entries for all of the given tuples to an empty index.
+     * Tree indexes sort the batch and build the tree from the bottom up.
+     * If two of the tuples collide on a unique index, one of them is
+     * copied into conflictTuple, the index is left empty and false is
+     * returned.
+     */
+    bool addEntriesToEmpty(const std::vector<TableTuple>& tuples, TableTuple *conflictTuple);
+
     /**
      * removes the index entry linked to given value (and tuple
      * pointer, if it's non-unique index).
      */
     bool deleteEntry(const TableTuple *tuple);
 
+    /**
+     * removes the index entries linked to all of the given tuples.
+     * Tree indexes remove them in key order. Returns false if any
+     * of the entries could not be found.
+     */
+    bool deleteEntries(const std::vector<TableTuple>& tuples);
+
     /**
      * Update in place an index entry with a new tuple address
      */
@@ -564,7 +580,9 @@ protected:
 protected:
     // Index specific implementations
     virtual void addEntryDo(const TableTuple *tuple, TableTuple *conflictTuple) = 0;
+    virtual bool addEntriesToEmptyDo(const std::vector<const TableTuple*>& tuples, TableTuple *conflictTuple);
     virtual bool deleteEntryDo(const TableTuple *tuple) = 0;
+    virtual bool deleteEntriesDo(const std::vector<const TableTuple*>& tuples);
     virtual bool replaceEntryNoKeyChangeDo(const TableTuple &destinationTuple,
                                          const TableTuple &originalTuple) = 0;
     virtual bool existsDo(const TableTuple* values) const = 0;
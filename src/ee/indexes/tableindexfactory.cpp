@@ -58,9 +58,30 @@ namespace voltdb {
 
 class TableIndexPicker
 {
+    template <class TKeyType>
+    TableIndex *getBTreeInstanceForKeyType() const
+    {
+        if (m_scheme.unique) {
+            if (m_scheme.countable) {
+                return new CompactingTreeUniqueIndex<NormalKeyValuePair<TKeyType>, true, CompactingBTree>(m_keySchema, m_scheme);
+            } else {
+                return new CompactingTreeUniqueIndex<NormalKeyValuePair<TKeyType>, false, CompactingBTree>(m_keySchema, m_scheme);
+            }
+        } else {
+            if (m_scheme.countable) {
+                return new CompactingTreeMultiMapIndex<PointerKeyValuePair<TKeyType>, true, CompactingBTree>(m_keySchema, m_scheme);
+            } else {
+                return new CompactingTreeMultiMapIndex<PointerKeyValuePair<TKeyType>, false, CompactingBTree>(m_keySchema, m_scheme);
+            }
+        }
+    }
+
     template <class TKeyType>
     TableIndex *getInstanceForKeyType() const
     {
+        if (m_type == BTREE_INDEX) {
+            return getBTreeInstanceForKeyType<TKeyType>();
+        }
         if (m_scheme.unique) {
             if (m_type != BALANCED_TREE_INDEX) {
                 return new CompactingHashUniqueIndex<TKeyType >(m_keySchema, m_scheme);
@@ -178,6 +199,7 @@ public:
             return result;
         }
 
+        // Keys too wide for a GenericKey always use the red-black tree.
         if (m_scheme.unique) {
             if (m_scheme.countable) {
                 return new CompactingTreeUniqueIndex<NormalKeyValuePair<TupleKey>, true >(m_keySchema, m_scheme);
@@ -0,0 +1,59 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hashjoinnode.h"
+
+#include "common/FatalException.hpp"
+
+#include <sstream>
+
+namespace voltdb {
+
+HashJoinPlanNode::~HashJoinPlanNode() { }
+
+PlanNodeType HashJoinPlanNode::getPlanNodeType() const { return PLAN_NODE_TYPE_HASHJOIN; }
+
+std::string HashJoinPlanNode::debugInfo(const std::string& spacer) const
+{
+    std::ostringstream buffer;
+    buffer << AbstractJoinPlanNode::debugInfo(spacer);
+    buffer << spacer << "Outer Hash Expressions:\n";
+    for (int ctr = 0, cnt = (int)m_outerHashExpressions.size(); ctr < cnt; ctr++) {
+        buffer << m_outerHashExpressions[ctr]->debug(spacer);
+    }
+    buffer << spacer << "Inner Hash Expressions:\n";
+    for (int ctr = 0, cnt = (int)m_innerHashExpressions.size(); ctr < cnt; ctr++) {
+        buffer << m_innerHashExpressions[ctr]->debug(spacer);
+    }
+    return buffer.str();
+}
+
+void HashJoinPlanNode::loadFromJSONObject(PlannerDomValue obj)
+{
+    AbstractJoinPlanNode::loadFromJSONObject(obj);
+
+    m_outerHashExpressions.loadExpressionArrayFromJSONObject("OUTER_HASH_EXPRESSIONS", obj);
+    m_innerHashExpressions.loadExpressionArrayFromJSONObject("INNER_HASH_EXPRESSIONS", obj);
+    if (m_outerHashExpressions.size() != m_innerHashExpressions.size() ||
+        m_outerHashExpressions.empty()) {
+        throwFatalLogicErrorStreamed("Hash join requires matching, non-empty outer and inner hash key lists, "
+                                     << "but got " << m_outerHashExpressions.size() << " outer and "
+                                     << m_innerHashExpressions.size() << " inner expressions");
+    }
+}
+
+} // namespace voltdb
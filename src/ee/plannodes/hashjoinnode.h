@@ -0,0 +1,68 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASHJOINNODE_H
+#define HASHJOINNODE_H
+
+#include "abstractjoinnode.h"
+
+namespace voltdb {
+
+/**
+ * A join that builds an in-memory hash table over the inner (second)
+ * input, keyed on the inner hash expressions, and probes it with the
+ * outer hash expressions evaluated against each outer tuple.  It is
+ * meant for equi-joins where neither input has a usable index, for
+ * example joins between the temp tables produced by receive nodes.
+ *
+ * The outer hash expressions are evaluated against the outer tuple,
+ * and the inner hash expressions against the inner tuple, using the
+ * same tuple indexes (0 for outer, 1 for inner) as the join
+ * predicate.  Tuples whose hash key contains a NULL never match.
+ * The join predicate, if any, is evaluated on each candidate pair
+ * whose keys are equal.
+ *
+ * Supported join types are INNER, LEFT, SEMI and ANTI.  SEMI and ANTI
+ * joins only produce outer columns.
+ */
+class HashJoinPlanNode : public AbstractJoinPlanNode
+{
+public:
+    HashJoinPlanNode() { }
+    ~HashJoinPlanNode();
+    PlanNodeType getPlanNodeType() const;
+    std::string debugInfo(const std::string& spacer) const;
+
+    const std::vector<AbstractExpression*>& getOuterHashExpressions() const
+    { return m_outerHashExpressions; }
+
+    const std::vector<AbstractExpression*>& getInnerHashExpressions() const
+    { return m_innerHashExpressions; }
+
+protected:
+    void loadFromJSONObject(PlannerDomValue obj);
+
+    // Key expressions evaluated against the probing outer tuples
+    OwningExpressionVector m_outerHashExpressions;
+
+    // Key expressions evaluated against the inner tuples at build time
+    OwningExpressionVector m_innerHashExpressions;
+};
+
+} // namespace voltdb
+
+#endif
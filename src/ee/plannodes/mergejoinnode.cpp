@@ -0,0 +1,70 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mergejoinnode.h"
+
+#include "common/FatalException.hpp"
+
+#include <sstream>
+
+namespace voltdb {
+
+MergeJoinPlanNode::~MergeJoinPlanNode() { }
+
+PlanNodeType MergeJoinPlanNode::getPlanNodeType() const { return PLAN_NODE_TYPE_MERGEJOIN; }
+
+std::string MergeJoinPlanNode::debugInfo(const std::string& spacer) const
+{
+    std::ostringstream buffer;
+    buffer << AbstractJoinPlanNode::debugInfo(spacer);
+    buffer << spacer << "Sort Direction: " << sortDirectionToString(m_sortDirection) << "\n";
+    buffer << spacer << "Outer Key Expressions:\n";
+    for (int ctr = 0, cnt = (int)m_outerKeyExpressions.size(); ctr < cnt; ctr++) {
+        buffer << m_outerKeyExpressions[ctr]->debug(spacer);
+    }
+    buffer << spacer << "Inner Key Expressions:\n";
+    for (int ctr = 0, cnt = (int)m_innerKeyExpressions.size(); ctr < cnt; ctr++) {
+        buffer << m_innerKeyExpressions[ctr]->debug(spacer);
+    }
+    return buffer.str();
+}
+
+void MergeJoinPlanNode::loadFromJSONObject(PlannerDomValue obj)
+{
+    AbstractJoinPlanNode::loadFromJSONObject(obj);
+
+    m_outerKeyExpressions.loadExpressionArrayFromJSONObject("OUTER_KEY_EXPRESSIONS", obj);
+    m_innerKeyExpressions.loadExpressionArrayFromJSONObject("INNER_KEY_EXPRESSIONS", obj);
+    if (m_outerKeyExpressions.size() != m_innerKeyExpressions.size() ||
+        m_outerKeyExpressions.empty()) {
+        throwFatalLogicErrorStreamed("Merge join requires matching, non-empty outer and inner key lists, "
+                                     << "but got " << m_outerKeyExpressions.size() << " outer and "
+                                     << m_innerKeyExpressions.size() << " inner expressions");
+    }
+
+    m_sortDirection = SORT_DIRECTION_TYPE_ASC;
+    if (obj.hasNonNullKey("SORT_DIRECTION")) {
+        std::string sortDirectionString = obj.valueForKey("SORT_DIRECTION").asStr();
+        m_sortDirection = stringToSortDirection(sortDirectionString);
+    }
+    if (m_sortDirection != SORT_DIRECTION_TYPE_ASC && m_sortDirection != SORT_DIRECTION_TYPE_DESC) {
+        throwFatalLogicErrorStreamed("Merge join requires an ASC or DESC sort direction, but got "
+                                     << sortDirectionToString(m_sortDirection));
+    }
+}
+
+} // namespace voltdb
@@ -0,0 +1,70 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MERGEJOINNODE_H
+#define MERGEJOINNODE_H
+
+#include "abstractjoinnode.h"
+
+namespace voltdb {
+
+/**
+ * A join of two inputs that both arrive ordered on their join keys, for
+ * example the output of index scans or of a MergeReceive node.  The
+ * outer key expressions are evaluated against the outer tuple and the
+ * inner key expressions against the inner tuple, using the same tuple
+ * indexes (0 for outer, 1 for inner) as the join predicate.  Both inputs
+ * must be sorted on their keys in the node's sort direction, with NULL
+ * keys ordered as the lowest values.  Tuples whose key contains a NULL
+ * never match.  The join predicate, if any, is evaluated on each pair of
+ * tuples whose keys are equal.
+ *
+ * Supported join types are INNER, LEFT, FULL, SEMI and ANTI.  SEMI and
+ * ANTI joins only produce outer columns.
+ */
+class MergeJoinPlanNode : public AbstractJoinPlanNode
+{
+public:
+    MergeJoinPlanNode() : m_sortDirection(SORT_DIRECTION_TYPE_ASC) { }
+    ~MergeJoinPlanNode();
+    PlanNodeType getPlanNodeType() const;
+    std::string debugInfo(const std::string& spacer) const;
+
+    const std::vector<AbstractExpression*>& getOuterKeyExpressions() const
+    { return m_outerKeyExpressions; }
+
+    const std::vector<AbstractExpression*>& getInnerKeyExpressions() const
+    { return m_innerKeyExpressions; }
+
+    SortDirectionType getSortDirection() const { return m_sortDirection; }
+
+protected:
+    void loadFromJSONObject(PlannerDomValue obj);
+
+    // Key expressions the outer input is ordered by
+    OwningExpressionVector m_outerKeyExpressions;
+
+    // Key expressions the inner input is ordered by
+    OwningExpressionVector m_innerKeyExpressions;
+
+    // Direction in which both inputs are ordered
+    SortDirectionType m_sortDirection;
+};
+
+} // namespace voltdb
+
+#endif
@@ -46,6 +46,8 @@
 #include "plannodes/plannodeutil.h"
 #include "plannodes/aggregatenode.h"
 #include "plannodes/deletenode.h"
+#include "plannodes/hashjoinnode.h"
+#include "plannodes/mergejoinnode.h"
 #include "plannodes/indexscannode.h"
 #include "plannodes/indexcountnode.h"
 #include "plannodes/tablecountnode.h"
@@ -127,6 +129,18 @@ voltdb::AbstractPlanNode* getEmptyPlanNode(voltdb::PlanNodeType type) {
             ret = new voltdb::NestLoopIndexPlanNode();
             break;
         // ------------------------------------------------------------------
+        // HashJoin
+        // ------------------------------------------------------------------
+        case (voltdb::PLAN_NODE_TYPE_HASHJOIN):
+            ret = new voltdb::HashJoinPlanNode();
+            break;
+        // ------------------------------------------------------------------
+        // MergeJoin
+        // ------------------------------------------------------------------
+        case (voltdb::PLAN_NODE_TYPE_MERGEJOIN):
+            ret = new voltdb::MergeJoinPlanNode();
+            break;
+        // ------------------------------------------------------------------
         // Update
         // ------------------------------------------------------------------
         case (voltdb::PLAN_NODE_TYPE_UPDATE):
@@ -71,7 +71,17 @@ std::string SeqScanPlanNode::debugInfo(const std::string &spacer) const
     } else {
         buffer << "<NULL>\n";
     }
+    buffer << spacer << "Batched: " << (m_isBatched ? "true" : "false") << "\n";
     return buffer.str();
 }
 
+void SeqScanPlanNode::loadFromJSONObject(PlannerDomValue obj)
+{
+    AbstractScanPlanNode::loadFromJSONObject(obj);
+
+    if (obj.hasNonNullKey("BATCHED")) {
+        m_isBatched = obj.valueForKey("BATCHED").asBool();
+    }
+}
+
 } // namespace voltdb
@@ -57,11 +57,22 @@ class AbstractExpression;
  */
 class SeqScanPlanNode : public AbstractScanPlanNode {
 public:
-    SeqScanPlanNode()  { }
+    SeqScanPlanNode() : m_isBatched(false) { }
     ~SeqScanPlanNode();
     PlanNodeType getPlanNodeType() const;
     std::string debugInfo(const std::string &spacer) const;
 
+    /**
+     * Whether the planner asked for the predicate to be evaluated a
+     * batch of tuples at a time when it can be (see BatchPredicate).
+     */
+    bool isBatched() const { return m_isBatched; }
+
+protected:
+    void loadFromJSONObject(PlannerDomValue obj);
+
+private:
+    bool m_isBatched;
 };
 
 }
@@ -17,6 +17,7 @@
 #include "StatsAgent.h"
 
 #include "StatsSource.h"
+#include "executors/PlanNodeStats.h"
 #include "indexes/IndexStats.h"
 #include "storage/TableStats.h"
 #include "storage/temptable.h"
@@ -38,6 +39,8 @@ namespace
             return TableStats::generateEmptyTableStatsTable();
         case STATISTICS_SELECTOR_TYPE_INDEX:
             return IndexStats::generateEmptyIndexStatsTable();
+        case STATISTICS_SELECTOR_TYPE_PLANNODE:
+            return PlanNodeStats::generateEmptyPlanNodeStatsTable();
         default:
             throwFatalException("Attempted to get unsupported stats type");
         }
@@ -87,6 +90,28 @@ void StatsAgent::unregisterStatsSource(StatisticsSelectorType sst, int32_t relat
     }
 }
 
+void StatsAgent::unregisterStatsSource(StatisticsSelectorType sst, StatsSource* statsSource) {
+    multimap<CatalogId, StatsSource*> &statsSources = m_statsCategoryByStatsSelector[sst];
+    for (multimap<CatalogId, StatsSource*>::iterator iter = statsSources.begin();
+         iter != statsSources.end(); ++iter) {
+        if (iter->second == statsSource) {
+            statsSources.erase(iter);
+            return;
+        }
+    }
+}
+
+std::vector<CatalogId> StatsAgent::getRegisteredCatalogIds(StatisticsSelectorType sst) {
+    vector<CatalogId> catalogIds;
+    const multimap<CatalogId, StatsSource*> &statsSources = m_statsCategoryByStatsSelector[sst];
+    for (multimap<CatalogId, StatsSource*>::const_iterator iter = statsSources.begin();
+         iter != statsSources.end();
+         iter = statsSources.upper_bound(iter->first)) {
+        catalogIds.push_back(iter->first);
+    }
+    return catalogIds;
+}
+
 /**
  * Get statistics for the specified resources
  * @param sst StatisticsSelectorType of the resources
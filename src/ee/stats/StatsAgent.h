@@ -52,6 +52,17 @@ public:
      */
     void unregisterStatsSource(voltdb::StatisticsSelectorType sst, int32_t relativeIndexOfTable = -1);
 
+    /**
+     * Unassociate one StatsSource, whatever CatalogId it was registered with
+     */
+    void unregisterStatsSource(voltdb::StatisticsSelectorType sst, voltdb::StatsSource* statsSource);
+
+    /**
+     * The distinct CatalogIds that have a StatsSource registered under
+     * the specified selector
+     */
+    std::vector<voltdb::CatalogId> getRegisteredCatalogIds(voltdb::StatisticsSelectorType sst);
+
     /**
      * Get statistics for the specified resources
      * @param sst StatisticsSelectorType of the resources
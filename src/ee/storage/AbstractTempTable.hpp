@@ -68,6 +68,7 @@ public:
 
     /** The temp table limits object for this table */
     virtual const TempTableLimits* getTempTableLimits() const = 0;
+    virtual TempTableLimits* getTempTableLimits() = 0;
 
     /** Return a count of tuples in this table */
     virtual int64_t tempTableTupleCount() const { return m_tupleCount; }
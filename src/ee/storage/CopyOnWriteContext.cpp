@@ -20,6 +20,7 @@
 #include "storage/CopyOnWriteIterator.h"
 #include "storage/tableiterator.h"
 #include "common/ExecuteWithMpMemory.h"
+#include "common/ParallelTupleSerializer.h"
 #include "common/TupleOutputStream.h"
 #include "common/FatalException.hpp"
 #include "common/StreamPredicateList.h"
@@ -27,9 +28,21 @@
 #include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <unistd.h>
 
 namespace voltdb {
 
+/**
+ * Leave most of the host to the other sites: use a helper for every eight
+ * cores, up to three.
+ */
+static int defaultSerializationHelperThreads() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return static_cast<int>(std::min(3L, std::max(0L, cores / 8)));
+}
+
+int CopyOnWriteContext::s_serializationHelperThreads = defaultSerializationHelperThreads();
+
 /**
  * Constructor.
  */
@@ -138,6 +151,10 @@ int64_t CopyOnWriteContext::handleStreamMore(TupleOutputStreamProcessor &outputS
     if (outputStreams.empty()) {
         throwFatalException("serializeMore() expects at least one output stream.");
     }
+    if (m_serializer.get() == NULL && s_serializationHelperThreads > 0) {
+        m_serializer.reset(new ParallelTupleSerializer(s_serializationHelperThreads));
+    }
+    outputStreams.setSerializer(m_serializer.get());
     outputStreams.open(getTable(),
                        getMaxTupleLength(),
                        getPartitionId(),
@@ -174,6 +191,13 @@ int64_t CopyOnWriteContext::handleStreamMore(TupleOutputStreamProcessor &outputS
              * May want to delete tuple if processing the actual table.
              */
             if (!m_finishedTableScan) {
+                /*
+                 * Rows may only have been given buffer space so far. Write
+                 * them out before the tuple storage goes away.
+                 */
+                if (tuple.isPendingDelete() || deleteTuple) {
+                    outputStreams.flush();
+                }
                 /*
                  * If this is the table scan, check to see if the tuple is pending
                  * delete and return the tuple if it iscop
@@ -329,6 +353,9 @@ int64_t CopyOnWriteContext::handleStreamMore(TupleOutputStreamProcessor &outputS
     }
 
     m_serializationBatches++;
+    if (m_tuplesRemaining == 0) {
+        m_serializer.reset();
+    }
 
     int64_t retValue = m_tuplesRemaining;
 
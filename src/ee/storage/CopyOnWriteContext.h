@@ -35,6 +35,7 @@ class TempTable;
 class ParsedPredicate;
 class TupleOutputStreamProcessor;
 class PersistentTableSurgeon;
+class ParallelTupleSerializer;
 
 class CopyOnWriteContext : public TableStreamerContext {
 
@@ -89,6 +90,19 @@ public:
      */
     virtual bool notifyTupleDelete(TableTuple &tuple);
 
+    /**
+     * Set how many helper threads each snapshot stream uses to serialize
+     * rows. Zero serializes on the site thread. Applies to streams that
+     * have not started yet.
+     */
+    static void setSerializationHelperThreads(int helperThreads) {
+        s_serializationHelperThreads = helperThreads;
+    }
+
+    static int getSerializationHelperThreads() {
+        return s_serializationHelperThreads;
+    }
+
 private:
 
     /**
@@ -118,6 +132,14 @@ private:
      */
     std::unique_ptr<TupleIterator> m_iterator;
 
+    /**
+     * Helpers that serialize the rows this thread picks out. Created on the
+     * first handleStreamMore() and released when the stream is done.
+     */
+    boost::scoped_ptr<ParallelTupleSerializer> m_serializer;
+
+    static int s_serializationHelperThreads;
+
     TableTuple m_tuple;
 
     bool m_finishedTableScan;
@@ -136,6 +136,12 @@ std::vector<LargeTempTableBlockId>::iterator LargeTempTable::releaseBlock(std::v
     return m_blockIds.erase(it);
 }
 
+void LargeTempTable::prefetchBlocksAfter(std::vector<LargeTempTableBlockId>::iterator it) {
+    assert (it != m_blockIds.end());
+    LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+    lttBlockCache->prefetchBlocks(it + 1, m_blockIds.end());
+}
+
 void LargeTempTable::swapContents(AbstractTempTable* otherTable) {
     assert (dynamic_cast<LargeTempTable*>(otherTable));
     LargeTempTable* otherLargeTable = static_cast<LargeTempTable*>(otherTable);
@@ -512,8 +518,9 @@ void LargeTempTable::sort(const AbstractExecutor::TupleComparer& comparer, int l
     LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
 
     // Let's merge as much as we can, reserving one slot in the block
-    // cache for the output of the merge.
-    const int MERGE_FACTOR = lttBlockCache->maxCacheSizeInBlocks() - 1;
+    // cache for the output of the merge, and room for the blocks the
+    // input runs read ahead.
+    const int MERGE_FACTOR = lttBlockCache->maxCacheSizeInBlocks() - 1 - lttBlockCache->readAheadBlocks();
 
     // Sort each block and create a bunch of 1-block sort runs to be merged below
     std::queue<SortRunPtr> sortRunQueue;
@@ -522,6 +529,7 @@ void LargeTempTable::sort(const AbstractExecutor::TupleComparer& comparer, int l
     while (it != getBlockIds().end()) {
         auto blockId = *it;
         it = disownBlock(it);
+        lttBlockCache->prefetchBlocks(it, getBlockIds().end());
         LargeTempTableBlock* block = lttBlockCache->fetchBlock(blockId);
         sorter.sort(block);
         lttBlockCache->invalidateStoredCopy(block);
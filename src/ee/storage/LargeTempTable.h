@@ -94,6 +94,10 @@ public:
         id. */
     virtual std::vector<LargeTempTableBlockId>::iterator releaseBlock(std::vector<LargeTempTableBlockId>::iterator it);
 
+    /** Asks the block cache to read ahead the blocks following the
+        specified one.  Called by iterators as they reach each block. */
+    virtual void prefetchBlocksAfter(std::vector<LargeTempTableBlockId>::iterator it);
+
     /** Return the number of large temp table blocks used by this
         table */
     size_t allocatedBlockCount() const {
@@ -124,6 +128,9 @@ public:
     virtual const TempTableLimits* getTempTableLimits() const {
         return NULL;
     }
+    virtual TempTableLimits* getTempTableLimits() {
+        return NULL;
+    }
 
     /** Prints useful info about this table */
     virtual std::string debug(const std::string& spacer) const;
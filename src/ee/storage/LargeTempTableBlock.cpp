@@ -15,6 +15,8 @@
  * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "common/LZ4Codec.h"
+#include "common/SerializableEEException.h"
 #include "common/tabletuple.h"
 #include "common/TupleSchema.h"
 
@@ -32,9 +34,25 @@ LargeTempTableBlock::LargeTempTableBlock(LargeTempTableBlockId id, const TupleSc
     , m_isPinned(false)
     , m_isStored(false)
     , m_activeTupleCount(0)
+    , m_isStoredCompressed(false)
+    , m_storedDataSize(BLOCK_SIZE_IN_BYTES)
 {
 }
 
+/**
+ * The header at the start of a compressed block image.  The block's
+ * original address is kept here because the insertion points and the
+ * non-inlined references in the tuples are relative to it, not to the
+ * address of the image.
+ */
+struct CompressedBlockHeader {
+    char* m_origAddress;
+    int64_t m_tupleBytes;
+    int64_t m_poolBytes;
+    int64_t m_compressedTupleBytes;
+    int64_t m_compressedPoolBytes;
+};
+
 bool LargeTempTableBlock::insertTuple(const TableTuple& source) {
     assert (m_tupleInsertionPoint <= m_nonInlinedInsertionPoint);
 
@@ -125,9 +143,56 @@ int64_t LargeTempTableBlock::getAllocatedPoolMemory() const {
     return 0;
 }
 
+size_t LargeTempTableBlock::compressionScratchSize() {
+    // The two regions together never exceed the block size, and each
+    // region's bound adds a little on top of its size.
+    return sizeof(CompressedBlockHeader) + LZ4Codec::compressBound(BLOCK_SIZE_IN_BYTES) + 16;
+}
+
+void LargeTempTableBlock::compressData(char* scratch) {
+    assert(isResident());
+    CompressedBlockHeader header;
+    header.m_origAddress = m_storage.get();
+    header.m_tupleBytes = getAllocatedTupleMemory();
+    header.m_poolBytes = getAllocatedPoolMemory();
+
+    char* out = scratch + sizeof(header);
+    header.m_compressedTupleBytes = LZ4Codec::compress(m_storage.get(), header.m_tupleBytes,
+                                                       out, LZ4Codec::compressBound(header.m_tupleBytes));
+    out += header.m_compressedTupleBytes;
+    header.m_compressedPoolBytes = LZ4Codec::compress(m_nonInlinedInsertionPoint, header.m_poolBytes,
+                                                      out, LZ4Codec::compressBound(header.m_poolBytes));
+    out += header.m_compressedPoolBytes;
+    ::memcpy(scratch, &header, sizeof(header));
+
+    m_storedDataSize = out - scratch;
+    std::unique_ptr<char[]> image(new char[m_storedDataSize]);
+    ::memcpy(image.get(), scratch, m_storedDataSize);
+    m_storage.swap(image);
+    m_isStoredCompressed = true;
+}
+
 void LargeTempTableBlock::setData(char* origAddress,
                                   std::unique_ptr<char[]> storage) {
     assert(m_storage.get() == NULL);
+    if (m_isStoredCompressed) {
+        CompressedBlockHeader header;
+        ::memcpy(&header, storage.get(), sizeof(header));
+        std::unique_ptr<char[]> expanded(new char[BLOCK_SIZE_IN_BYTES]);
+        const char* in = storage.get() + sizeof(header);
+        long tupleBytes = LZ4Codec::decompress(in, header.m_compressedTupleBytes,
+                                               expanded.get(), header.m_tupleBytes);
+        in += header.m_compressedTupleBytes;
+        long poolBytes = LZ4Codec::decompress(in, header.m_compressedPoolBytes,
+                                              expanded.get() + BLOCK_SIZE_IN_BYTES - header.m_poolBytes,
+                                              header.m_poolBytes);
+        if (tupleBytes != header.m_tupleBytes || poolBytes != header.m_poolBytes) {
+            throwSerializableEEException("Large temp table block %jd::%jd failed to decompress",
+                                         (intmax_t)m_id.getSiteId(), (intmax_t)m_id.getBlockCounter());
+        }
+        origAddress = header.m_origAddress;
+        storage.swap(expanded);
+    }
     storage.swap(m_storage);
 
     // Update the insertion points to reflect the relocation
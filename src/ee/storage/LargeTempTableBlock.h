@@ -127,9 +127,34 @@ public:
     std::unique_ptr<char[]> releaseData();
 
     /** Set the storage associated with this block (as when loading
-        from disk) */
+        from disk).  If the block was stored compressed, storage holds
+        the compressed image and is expanded here. */
     void setData(char* origAddress, std::unique_ptr<char[]> storage);
 
+    /** The size of the scratch buffer compressData() needs. */
+    static size_t compressionScratchSize();
+
+    /** Replace this block's storage with an LZ4 compressed image of
+        its tuples and non-inlined data, in preparation for storing
+        it.  The unused middle of the block is left out.  The two
+        regions are compressed separately because they hold very
+        different kinds of data.  scratch must have room for
+        compressionScratchSize() bytes. */
+    void compressData(char* scratch);
+
+    /** The number of bytes of storage a topend should write when
+        storing this block: the compressed image size if
+        compressData() was called, and BLOCK_SIZE_IN_BYTES
+        otherwise. */
+    int64_t storedDataSize() const {
+        return m_storedDataSize;
+    }
+
+    /** Returns true if the copy of this block on disk is compressed. */
+    bool isStoredCompressed() const {
+        return m_isStoredCompressed;
+    }
+
     /** Copy the non-inlined data segment from the given block into
         this one. */
     void copyNonInlinedData(const LargeTempTableBlock& srcBlock);
@@ -166,6 +191,8 @@ public:
 
     void unstore() {
         m_isStored = false;
+        m_isStoredCompressed = false;
+        m_storedDataSize = BLOCK_SIZE_IN_BYTES;
     }
 
     /** Return the number of tuples in this block */
@@ -270,6 +297,12 @@ public:
 
     /** Number of tuples currently in this block */
     int64_t m_activeTupleCount;
+
+    /** True if the stored copy of this block is a compressed image */
+    bool m_isStoredCompressed;
+
+    /** Size of the stored copy of this block */
+    int64_t m_storedDataSize;
 };
 
 template<bool IsConst>
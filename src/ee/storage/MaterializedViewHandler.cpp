@@ -436,6 +436,7 @@ namespace voltdb {
         }
         backups[m_groupByColumnCount] = params[m_groupByColumnCount];
         params[m_groupByColumnCount] = m_existingTuple.getNValue(columnIndex);
+        ec->advanceParameterGeneration();
         // Then we get the executor vectors we need to run:
         vector<AbstractExecutor*> executorList = m_minMaxExecutorVectors[minMaxColumnIndex]->getExecutorList();
         UniqueTempTableResult resultTable = ec->executeExecutors(executorList);
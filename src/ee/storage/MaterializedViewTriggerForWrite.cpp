@@ -365,6 +365,7 @@ NValue MaterializedViewTriggerForWrite::findFallbackValueUsingPlan(const TableTu
     }
     backups[colindex] = params[colindex];
     params[colindex] = oldValue;
+    context->advanceParameterGeneration();
     // executing the stored plan.
     vector<AbstractExecutor*> executorList = m_fallbackExecutorVectors[minMaxAggIdx]->getExecutorList();
     UniqueTempTableResult tbl = context->executeExecutors(executorList, 0);
@@ -17,6 +17,8 @@
 #include "storage/PersistentTableStats.h"
 #include "storage/persistenttable.h"
 #include "common/executorcontext.hpp"
+#include "common/tabletuple.h"
+#include "common/ValueFactory.hpp"
 #include "execution/VoltDBEngine.h"
 #include <vector>
 #include <string>
@@ -24,7 +26,7 @@
 namespace voltdb {
 
 PersistentTableStats::PersistentTableStats(voltdb::PersistentTable* table)
-  : voltdb::TableStats(table)
+  : voltdb::TableStats(table), m_persistentTable(table)
 {
 }
 
@@ -32,4 +34,11 @@ std::vector<std::string> PersistentTableStats::generateStatsColumnNames() {
     std::vector<std::string> columnNames = TableStats::generateStatsColumnNames();
     return columnNames;
 }
+
+void PersistentTableStats::updateStatsTuple(TableTuple *tuple) {
+    TableStats::updateStatsTuple(tuple);
+    // a share of the allocated blocks, not of the tuple slots
+    tuple->setNValue(StatsSource::m_columnName2Index["PERCENT_FRAGMENTED"],
+            ValueFactory::getIntegerValue(m_persistentTable->fragmentationPercent()));
+}
 }
@@ -26,13 +26,19 @@ namespace voltdb {
 class PersistentTable;
 
 /**
- * Further specialization of TableStats that currently adds no extra functionality.
+ * Further specialization of TableStats that reports how much of the
+ * table's allocated block memory compaction could reclaim.
  */
 class PersistentTableStats : public voltdb::TableStats {
   public:
     PersistentTableStats(voltdb::PersistentTable* table);
   protected:
     virtual std::vector<std::string> generateStatsColumnNames();
+
+    virtual void updateStatsTuple(voltdb::TableTuple *tuple);
+
+  private:
+    voltdb::PersistentTable* m_persistentTable;
 };
 
 }
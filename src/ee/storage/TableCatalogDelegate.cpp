@@ -183,6 +183,9 @@ getIndexIdFromMap(TableIndexType type, bool countable, bool isUnique,
     case HASH_TABLE_INDEX:
         retval += "H";
         break;
+    case BTREE_INDEX:
+        retval += "T"; // B is taken
+        break;
     case COVERING_CELL_INDEX:
         retval += "G"; // C is taken
         break;
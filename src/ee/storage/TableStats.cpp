@@ -40,6 +40,7 @@ vector<string> TableStats::generateTableStatsColumnNames() {
     columnNames.push_back("STRING_DATA_MEMORY");
     columnNames.push_back("TUPLE_LIMIT");
     columnNames.push_back("PERCENT_FULL");
+    columnNames.push_back("PERCENT_FRAGMENTED");
     return columnNames;
 }
 
@@ -59,6 +60,7 @@ void TableStats::populateTableStatsSchema(
     types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);inBytes.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);inBytes.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);inBytes.push_back(false);
+    types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);inBytes.push_back(false);
 }
 
 TempTable* TableStats::generateEmptyTableStatsTable() {
@@ -166,6 +168,8 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
         percentage = static_cast<int32_t> (ceil(static_cast<double>(tupleCount) * 100.0 / tupleLimit));
     }
     tuple->setNValue(StatsSource::m_columnName2Index["PERCENT_FULL"],ValueFactory::getIntegerValue(percentage));
+    // Only persistent tables are compacted; PersistentTableStats fills this in.
+    tuple->setNValue(StatsSource::m_columnName2Index["PERCENT_FRAGMENTED"], ValueFactory::getIntegerValue(0));
 }
 
 /**
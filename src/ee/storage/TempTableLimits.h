@@ -46,6 +46,7 @@ public:
 
     int64_t getAllocated() const { return m_currMemoryInBytes; }
     int64_t getPeakMemoryInBytes() const { return m_peakMemoryInBytes; }
+    int64_t getMemoryLimit() const { return m_memoryLimit; }
     void resetPeakMemory() { m_peakMemoryInBytes = m_currMemoryInBytes; }
 
 private:
@@ -18,6 +18,7 @@
 #include "storage/table.h"
 #include <sys/mman.h>
 #include <errno.h>
+#include <new>
 #include "common/ThreadLocalPool.h"
 
 namespace voltdb {
@@ -43,7 +44,11 @@ TupleBlock::TupleBlock(Table *table, TBBucketPtr bucket) :
         throwFatalException("Failed mmap");
     }
 #else
-    m_storage = new char[table->m_tableAllocationSize];
+    m_allocation = ThreadLocalPool::allocateBlock(table->m_tableAllocationSize);
+    if (m_allocation.m_address == NULL) {
+        throw std::bad_alloc();
+    }
+    m_storage = m_allocation.m_address;
 #endif
     tupleBlocksAllocated++;
 }
@@ -56,11 +61,12 @@ TupleBlock::~TupleBlock() {
         throwFatalException("Failed munmap");
     }
 #else
-    delete []m_storage;
+    ThreadLocalPool::freeBlock(m_allocation);
 #endif
 }
 
-std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementListener *listener) {
+std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementListener *listener,
+                                      uint32_t maxTuplesToMove) {
     assert(source != this);
     /*
       std::cout << "Attempting to merge " << static_cast<void*> (this)
@@ -72,7 +78,8 @@ std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementL
 
     uint32_t nextTupleInSourceOffset = source->lastCompactionOffset();
     int sourceTuplesPendingDeleteOnUndoRelease = 0;
-    while (hasFreeTuples() && !source->isEmpty()) {
+    uint32_t tuplesMoved = 0;
+    while (hasFreeTuples() && !source->isEmpty() && tuplesMoved < maxTuplesToMove) {
         TableTuple sourceTupleWithNewValues(table->schema());
         TableTuple destinationTuple(table->schema());
 
@@ -116,6 +123,7 @@ std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementL
         }
 
         source->freeTuple(sourceTupleWithNewValues.address());
+        tuplesMoved++;
     }
     source->lastCompactionOffset(nextTupleInSourceOffset);
 
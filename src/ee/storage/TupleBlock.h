@@ -168,9 +168,11 @@ public:
         return m_bucketIndex;
     }
 
-    /** Merge this block with the given block. Returns the new bucket
-        index for this and the other block. */
-    std::pair<int, int> merge(Table *table, TBPtr source, TupleMovementListener *listener = NULL);
+    /** Merge this block with the given block, moving at most
+        maxTuplesToMove tuples. Returns the new bucket index for this
+        and the other block. */
+    std::pair<int, int> merge(Table *table, TBPtr source, TupleMovementListener *listener = NULL,
+                              uint32_t maxTuplesToMove = UINT32_MAX);
 
     /**
      * Find next free tuple storage address and its tupleblock's bucket index,
@@ -286,6 +288,7 @@ public:
     }
 private:
     char*   m_storage;
+    BlockAllocation m_allocation;
     std::atomic<uint32_t> m_references;
     uint32_t m_tupleLength;
     uint32_t m_tuplesPerBlock;
@@ -140,6 +140,7 @@ PersistentTable::PersistentTable(int partitionColumn,
     , m_blocksWithSpace()
     , m_tableStreamer()
     , m_failedCompactionCount(0)
+    , m_compactionMicrosPerTuple(2.0)
     , m_invisibleTuplesPendingDeleteCount(0)
     , m_surgeon(*this)
     , m_tableForStreamIndexing(NULL)
@@ -1289,6 +1290,61 @@ void PersistentTable::deleteTuple(TableTuple& target, bool fallible) {
 }
 
 
+void PersistentTable::deleteTuples(std::vector<TableTuple>& targets, bool fallible) {
+    // Views are maintained from the state of the table after each single
+    // delete, so they need the tuple by tuple path.
+    if (targets.size() < 2 || !m_views.empty() || !m_viewHandlers.empty() || m_deltaTable != NULL) {
+        BOOST_FOREACH (TableTuple& target, targets) {
+            deleteTuple(target, fallible);
+        }
+        return;
+    }
+
+    UndoQuantum* uq = ExecutorContext::currentUndoQuantum();
+    bool createUndoAction = fallible && (uq != NULL);
+
+    // Write the whole batch to the DR stream first so that nothing has
+    // been changed if an append throws.
+    ExecutorContext* ec = ExecutorContext::getExecutorContext();
+    AbstractDRTupleStream* drStream = getDRTupleStream(ec);
+    if (doDRActions(drStream)) {
+        int64_t lastCommittedSpHandle = ec->lastCommittedSpHandle();
+        int64_t currentSpHandle = ec->currentSpHandle();
+        int64_t currentUniqueId = ec->currentUniqueId();
+        BOOST_FOREACH (TableTuple& target, targets) {
+            assert(target.isActive());
+            size_t drMark = drStream->appendTuple(lastCommittedSpHandle, m_signature, m_partitionColumn, currentSpHandle,
+                                                  currentUniqueId, target, DR_RECORD_DELETE);
+            if (createUndoAction) {
+                uq->registerUndoAction(new (*uq) DRTupleStreamUndoAction(drStream, drMark, rowCostForDRRecord(DR_RECORD_DELETE)));
+            }
+        }
+    }
+
+    BOOST_FOREACH (auto index, m_indexes) {
+        if (!index->deleteEntries(targets)) {
+            throwFatalException(
+                    "Failed to delete tuples in Table: %s Index %s",
+                    m_name.c_str(), index->getName().c_str());
+        }
+    }
+
+    BOOST_FOREACH (TableTuple& target, targets) {
+        assert(target.isActive());
+        assert(&target != &m_tempTuple);
+        if (createUndoAction) {
+            target.setPendingDeleteOnUndoReleaseTrue();
+            ++m_tuplesPinnedByUndo;
+            ++m_invisibleTuplesPendingDeleteCount;
+            UndoReleaseAction* undoAction = new (*uq) PersistentTableUndoDeleteAction(target.address(), &m_surgeon);
+            SynchronizedThreadLock::addUndoAction(isCatalogTableReplicated(), uq, undoAction, this);
+        }
+        else {
+            deleteTupleFinalize(target);
+        }
+    }
+}
+
 /**
  * This entry point is triggered by the successful release of an UndoDeleteAction.
  */
@@ -1607,6 +1663,151 @@ void PersistentTable::processLoadedTuple(TableTuple& tuple,
 
 }
 
+bool PersistentTable::loadTuplesInBulk(SerializeInputBE& serialInput,
+                                       int tupleCount,
+                                       Pool* stringPool,
+                                       ReferenceSerializeOutput* uniqueViolationOutput,
+                                       int32_t& serializedTupleCount,
+                                       size_t& tupleCountPosition,
+                                       bool shouldDRStreamRows,
+                                       bool ignoreTupleLimit) {
+    // Multi-table views read each new tuple through the delta table, and a
+    // load that would hit the row limit has to fail at the same row as before.
+    if (tupleCount < 2 || m_tupleCount != 0 || !m_viewHandlers.empty() ||
+            (!ignoreTupleLimit && tupleCount > m_tupleLimit)) {
+        return false;
+    }
+
+    ExecutorContext* ec = ExecutorContext::getExecutorContext();
+    std::vector<TableTuple> loaded;
+    loaded.reserve(tupleCount);
+    bool nullsChecked = true;
+    try {
+        TableTuple target(m_schema);
+        for (int i = 0; i < tupleCount; ++i) {
+            nextFreeTuple(&target);
+            target.setActiveTrue();
+            target.setDirtyFalse();
+            target.setPendingDeleteFalse();
+            target.setPendingDeleteOnUndoReleaseFalse();
+
+            target.deserializeFrom(serialInput, stringPool);
+            loaded.push_back(target);
+
+            if (hasDRTimestampColumn()) {
+                setDRTimestampForTuple(ec, target, false);
+            }
+            if (!checkNulls(target)) {
+                nullsChecked = false;
+            }
+        }
+    }
+    catch (...) {
+        discardLoadedTuples(loaded, 0);
+        throw;
+    }
+
+    size_t builtIndexes = 0;
+    if (nullsChecked) {
+        TableTuple conflict(m_schema);
+        try {
+            while (builtIndexes < m_indexes.size() &&
+                   m_indexes[builtIndexes]->addEntriesToEmpty(loaded, &conflict)) {
+                ++builtIndexes;
+            }
+        }
+        catch (SQLException& e) {
+            for (size_t ii = 0; ii < builtIndexes; ++ii) {
+                m_indexes[ii]->deleteEntries(loaded);
+            }
+            discardLoadedTuples(loaded, 0);
+            throw;
+        }
+    }
+
+    if (!nullsChecked || builtIndexes < m_indexes.size()) {
+        // Undo the partial build and let processLoadedTuple report the
+        // violations tuple by tuple, in the order they were loaded.
+        for (size_t ii = 0; ii < builtIndexes; ++ii) {
+            m_indexes[ii]->deleteEntries(loaded);
+        }
+        size_t next = 0;
+        try {
+            for (; next < loaded.size(); ++next) {
+                processLoadedTuple(loaded[next], uniqueViolationOutput, serializedTupleCount,
+                                   tupleCountPosition, shouldDRStreamRows, ignoreTupleLimit);
+            }
+        }
+        catch (...) {
+            discardLoadedTuples(loaded, next + 1);
+            throw;
+        }
+        return true;
+    }
+
+    AbstractDRTupleStream* drStream = getDRTupleStream(ec);
+    UndoQuantum* uq = ExecutorContext::currentUndoQuantum();
+    if (doDRActions(drStream) && shouldDRStreamRows) {
+        int64_t lastCommittedSpHandle = ec->lastCommittedSpHandle();
+        int64_t currentSpHandle = ec->currentSpHandle();
+        int64_t currentUniqueId = ec->currentUniqueId();
+        try {
+            BOOST_FOREACH (TableTuple& tuple, loaded) {
+                size_t drMark = drStream->appendTuple(lastCommittedSpHandle, m_signature, m_partitionColumn, currentSpHandle,
+                                                      currentUniqueId, tuple, DR_RECORD_INSERT);
+                if (uq) {
+                    uq->registerUndoAction(new (*uq) DRTupleStreamUndoAction(drStream, drMark, rowCostForDRRecord(DR_RECORD_INSERT)));
+                }
+            }
+        }
+        catch (...) {
+            BOOST_FOREACH (auto index, m_indexes) {
+                index->deleteEntries(loaded);
+            }
+            discardLoadedTuples(loaded, 0);
+            throw;
+        }
+    }
+
+    BOOST_FOREACH (TableTuple& tuple, loaded) {
+        if (m_schema->getUninlinedObjectColumnCount() != 0) {
+            increaseStringMemCount(tuple.getNonInlinedMemorySizeForPersistentTable());
+        }
+        tuple.setInlinedDataIsVolatileFalse();
+        tuple.setNonInlinedDataIsVolatileFalse();
+        if (m_tableStreamer == NULL || !m_tableStreamer->notifyTupleInsert(tuple)) {
+            tuple.setDirtyFalse();
+        }
+        if (uq) {
+            char* tupleData = uq->allocatePooledCopy(tuple.address(), tuple.tupleLength());
+            UndoReleaseAction* undoAction = new (*uq) PersistentTableUndoInsertAction(tupleData, &m_surgeon);
+            SynchronizedThreadLock::addUndoAction(isCatalogTableReplicated(), uq, undoAction);
+        }
+    }
+
+    // Views run only once every tuple can be undone, since one of them
+    // may throw part way through the batch.
+    BOOST_FOREACH (TableTuple& tuple, loaded) {
+        BOOST_FOREACH (auto view, m_views) {
+            view->processTupleInsert(tuple, true);
+        }
+    }
+    return true;
+}
+
+/*
+ * Release the storage of loaded tuples that never made it into the table.
+ */
+void PersistentTable::discardLoadedTuples(std::vector<TableTuple>& tuples, size_t first) {
+    for (size_t ii = first; ii < tuples.size(); ++ii) {
+        // deleteTupleStorage gives back string memory that was never counted.
+        if (m_schema->getUninlinedObjectColumnCount() != 0) {
+            increaseStringMemCount(tuples[ii].getNonInlinedMemorySizeForPersistentTable());
+        }
+        deleteTupleStorage(tuples[ii]);
+    }
+}
+
 /** Prepare table for streaming from serialized data. */
 bool PersistentTable::activateStream(
     TableStreamType streamType,
@@ -1780,7 +1981,7 @@ void PersistentTable::swapTuples(TableTuple& originalTuple,
     }
 }
 
-bool PersistentTable::doCompactionWithinSubset(TBBucketPtrVector* bucketVector) {
+bool PersistentTable::doCompactionWithinSubset(TBBucketPtrVector* bucketVector, int64_t* tupleBudget) {
     /**
      * First find the two best candidate blocks
      */
@@ -1802,6 +2003,9 @@ bool PersistentTable::doCompactionWithinSubset(TBBucketPtrVector* bucketVector)
 
     int fullestBucketChange = NO_NEW_BUCKET_INDEX;
     while (fullest->hasFreeTuples()) {
+        if (tupleBudget != NULL && *tupleBudget <= 0) {
+            break;
+        }
         TBPtr lightest;
         TBBucketI lightestIterator;
         bool foundLightest = false;
@@ -1828,7 +2032,15 @@ bool PersistentTable::doCompactionWithinSubset(TBBucketPtrVector* bucketVector)
             return false;
         }
 
-        std::pair<int, int> bucketChanges = fullest->merge(this, lightest, this);
+        uint32_t maxTuplesToMove = UINT32_MAX;
+        uint32_t activeTuplesBefore = fullest->activeTuples();
+        if (tupleBudget != NULL) {
+            maxTuplesToMove = static_cast<uint32_t>(std::min<int64_t>(*tupleBudget, UINT32_MAX));
+        }
+        std::pair<int, int> bucketChanges = fullest->merge(this, lightest, this, maxTuplesToMove);
+        if (tupleBudget != NULL) {
+            *tupleBudget -= fullest->activeTuples() - activeTuplesBefore;
+        }
         int tempFullestBucketChange = bucketChanges.first;
         if (tempFullestBucketChange != NO_NEW_BUCKET_INDEX) {
             fullestBucketChange = tempFullestBucketChange;
@@ -1868,6 +2080,61 @@ void PersistentTable::doIdleCompaction() {
     }
 }
 
+int64_t PersistentTable::doIncrementalCompaction(int64_t maxTuplesToMove, int64_t pauseBudgetMicros) {
+    // Tuples are moved between blocks at most this many at a time.
+    static const int64_t COMPACTION_SLICE_TUPLES = 256;
+    if (m_tableStreamer.get() != NULL && m_tableStreamer->hasStreamType(TABLE_STREAM_RECOVERY)) {
+        return 0;
+    }
+    boost::posix_time::ptime startTime(boost::posix_time::microsec_clock::universal_time());
+    int64_t tuplesMoved = 0;
+    while (tuplesMoved < maxTuplesToMove && incrementalCompactionPredicate()) {
+        boost::posix_time::ptime sliceStartTime(boost::posix_time::microsec_clock::universal_time());
+        int64_t remainingMicros = pauseBudgetMicros - (sliceStartTime - startTime).total_microseconds();
+        int64_t sliceTuples = static_cast<int64_t>(remainingMicros / m_compactionMicrosPerTuple);
+        sliceTuples = std::min(sliceTuples, std::min(COMPACTION_SLICE_TUPLES, maxTuplesToMove - tuplesMoved));
+        if (sliceTuples <= 0) {
+            break;
+        }
+        int64_t tupleBudget = sliceTuples;
+        if (!m_blocksNotPendingSnapshot.empty()) {
+            doCompactionWithinSubset(&m_blocksNotPendingSnapshotLoad, &tupleBudget);
+        }
+        if (tupleBudget > 0 && !m_blocksPendingSnapshot.empty()) {
+            doCompactionWithinSubset(&m_blocksPendingSnapshotLoad, &tupleBudget);
+        }
+        int64_t sliceTuplesMoved = sliceTuples - tupleBudget;
+        if (sliceTuplesMoved == 0) {
+            // Nothing left that can be merged, e.g. only tuples pending
+            // delete on undo release remain in the sparse blocks.
+            break;
+        }
+        tuplesMoved += sliceTuplesMoved;
+        boost::posix_time::time_duration sliceDuration =
+                boost::posix_time::microsec_clock::universal_time() - sliceStartTime;
+        double sliceMicrosPerTuple = static_cast<double>(sliceDuration.total_microseconds()) / sliceTuplesMoved;
+        m_compactionMicrosPerTuple = std::max(0.01, (m_compactionMicrosPerTuple + sliceMicrosPerTuple) / 2);
+    }
+    return tuplesMoved;
+}
+
+void PersistentTable::notifyQuantumRelease() {
+    if (!compactionPredicate()) {
+        return;
+    }
+    // Replicated tables are only compacted here, while every site is held
+    // for the release, so they still compact in full. Other tables stop
+    // once the pause budget is spent and the engine tick finishes the job.
+    VoltDBEngine* engine = ExecutorContext::getEngine();
+    int64_t pauseBudgetMicros = engine ? engine->getCompactionPauseBudget() : 0;
+    if (isReplicatedTable() || pauseBudgetMicros <= 0) {
+        doForcedCompaction();
+    }
+    else {
+        doIncrementalCompaction(INT64_MAX, pauseBudgetMicros);
+    }
+}
+
 bool PersistentTable::doForcedCompaction() {
     if (m_tableStreamer.get() != NULL && m_tableStreamer->hasStreamType(TABLE_STREAM_RECOVERY)) {
         LogManager::getThreadLogger(LOGGERID_SQL)->log(LOGLEVEL_INFO,
@@ -73,6 +73,7 @@
 
 class CompactionTest_BasicCompaction;
 class CompactionTest_CompactionWithCopyOnWrite;
+class CompactionTest_IncrementalCompaction;
 class CopyOnWriteTest;
 
 namespace catalog {
@@ -206,6 +207,7 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     friend class ::CopyOnWriteTest;
     friend class ::CompactionTest_BasicCompaction;
     friend class ::CompactionTest_CompactionWithCopyOnWrite;
+    friend class ::CompactionTest_IncrementalCompaction;
     friend class CoveringCellIndexTest_TableCompaction;
     friend class MaterializedViewHandler;
     friend class ScopedDeltaTableContext;
@@ -236,11 +238,7 @@ public:
         return m_signature;
     }
 
-    void notifyQuantumRelease() {
-        if (compactionPredicate()) {
-            doForcedCompaction();
-        }
-    }
+    void notifyQuantumRelease();
 
     // Return a table iterator by reference
     TableIterator iterator() {
@@ -275,6 +273,12 @@ public:
     // and migrates tuples and/or adds a materialized view.
     // Constraint checks are bypassed and the change does not make use of "undo" support.
     void deleteTuple(TableTuple& tuple, bool fallible = true);
+    /**
+     * Delete a batch of tuples with the same effect as calling deleteTuple
+     * on each of them in turn. When no views depend on the table, each
+     * index drops the entries of the whole batch at once, in key order.
+     */
+    void deleteTuples(std::vector<TableTuple>& targets, bool fallible = true);
     // TODO: change meaningless bool return type to void (starting in class Table) and migrate callers.
     virtual bool insertTuple(TableTuple& tuple);
     // Optimized version of update that only updates specific indexes.
@@ -427,6 +431,28 @@ public:
 
     void doIdleCompaction();
 
+    /**
+     * Move at most maxTuplesToMove tuples out of the emptiest blocks.
+     * The work is done in slices sized from the measured cost of earlier
+     * slices, and no slice is started that would run past
+     * pauseBudgetMicros. Returns the number of tuples moved.
+     */
+    int64_t doIncrementalCompaction(int64_t maxTuplesToMove, int64_t pauseBudgetMicros);
+
+    /** True when compaction could free at least one block. */
+    bool incrementalCompactionPredicate() const {
+        return m_tuplesPinnedByUndo == 0 && reclaimableBlockCount() > 0;
+    }
+
+    /** The percentage of allocated blocks that compaction could free. */
+    int32_t fragmentationPercent() const {
+        size_t blocks = allocatedBlockCount();
+        if (blocks == 0) {
+            return 0;
+        }
+        return static_cast<int32_t>(reclaimableBlockCount() * 100 / blocks);
+    }
+
     void printBucketInfo();
 
     void increaseStringMemCount(size_t bytes) {
@@ -605,7 +631,15 @@ private:
 
     void nextFreeTuple(TableTuple* tuple);
 
-    bool doCompactionWithinSubset(TBBucketPtrVector* bucketVector);
+    // When tupleBudget is given, stops once that many tuples have been
+    // moved and deducts the tuples moved from it.
+    bool doCompactionWithinSubset(TBBucketPtrVector* bucketVector, int64_t* tupleBudget = NULL);
+
+    size_t reclaimableBlockCount() const {
+        size_t neededBlocks = std::max<size_t>(1, (activeTupleCount() + m_tuplesPerBlock - 1) / m_tuplesPerBlock);
+        size_t blocks = allocatedBlockCount();
+        return blocks > neededBlocks ? blocks - neededBlocks : 0;
+    }
 
     bool doForcedCompaction();  // Returns true if a compaction was performed
 
@@ -665,6 +699,23 @@ private:
                                     bool shouldDRStreamRows = false,
                                     bool ignoreTupleLimit = true);
 
+    /*
+     * Called by Table::loadTuplesForLoadTable. Loads the tuples of an
+     * empty table in one batch: the tuples go straight into the blocks and
+     * every index is built from the whole batch at once. Falls back to
+     * processLoadedTuple for each tuple when the batch breaks a constraint.
+     */
+    virtual bool loadTuplesInBulk(SerializeInputBE& serialInput,
+                                  int tupleCount,
+                                  Pool* stringPool,
+                                  ReferenceSerializeOutput* uniqueViolationOutput,
+                                  int32_t& serializedTupleCount,
+                                  size_t& tupleCountPosition,
+                                  bool shouldDRStreamRows,
+                                  bool ignoreTupleLimit);
+
+    void discardLoadedTuples(std::vector<TableTuple>& tuples, size_t first);
+
     enum LookupType {
         LOOKUP_BY_VALUES,
         LOOKUP_FOR_DR,
@@ -775,6 +826,10 @@ private:
 
     int m_failedCompactionCount;
 
+    // Running estimate of the cost of moving one tuple during incremental
+    // compaction, used to size its slices.
+    double m_compactionMicrosPerTuple;
+
     // This is a testability feature not intended for use in product logic.
     int m_invisibleTuplesPendingDeleteCount;
 
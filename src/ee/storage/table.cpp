@@ -601,16 +601,19 @@ void Table::loadTuplesForLoadTable(SerializeInputBE& serialInput,
         lengthPosition = uniqueViolationOutput->reserveBytes(4);
     }
 
-    for (int i = 0; i < tupleCount; ++i) {
-        nextFreeTuple(&target);
-        target.setActiveTrue();
-        target.setDirtyFalse();
-        target.setPendingDeleteFalse();
-        target.setPendingDeleteOnUndoReleaseFalse();
-
-        target.deserializeFrom(serialInput, stringPool);
-
-        processLoadedTuple(target, uniqueViolationOutput, serializedTupleCount, tupleCountPosition, shouldDRStreamRows, ignoreTupleLimit);
+    if (!loadTuplesInBulk(serialInput, tupleCount, stringPool, uniqueViolationOutput,
+                          serializedTupleCount, tupleCountPosition, shouldDRStreamRows, ignoreTupleLimit)) {
+        for (int i = 0; i < tupleCount; ++i) {
+            nextFreeTuple(&target);
+            target.setActiveTrue();
+            target.setDirtyFalse();
+            target.setPendingDeleteFalse();
+            target.setPendingDeleteOnUndoReleaseFalse();
+
+            target.deserializeFrom(serialInput, stringPool);
+
+            processLoadedTuple(target, uniqueViolationOutput, serializedTupleCount, tupleCountPosition, shouldDRStreamRows, ignoreTupleLimit);
+        }
     }
 
     //If unique constraints are being handled, write the length/size of constraints that occured
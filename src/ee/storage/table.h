@@ -310,6 +310,20 @@ protected:
                                     bool shouldDRStreamRow = false,
                                     bool ignoreTupleLimit = true) { }
 
+    /*
+     * Implemented by persistent table and called by Table::loadTuplesForLoadTable
+     * to load all of the remaining tupleCount tuples in one batch. Returns
+     * false, before reading anything, if they have to be loaded one by one.
+     */
+    virtual bool loadTuplesInBulk(SerializeInputBE& serialInput,
+                                  int tupleCount,
+                                  Pool* stringPool,
+                                  ReferenceSerializeOutput* uniqueViolationOutput,
+                                  int32_t& serializedTupleCount,
+                                  size_t& tupleCountPosition,
+                                  bool shouldDRStreamRows,
+                                  bool ignoreTupleLimit) { return false; }
+
     virtual void swapTuples(TableTuple& sourceTupleWithNewValues, TableTuple& destinationTuple) {
         throwFatalException("Unsupported operation");
     }
@@ -333,6 +347,13 @@ protected:
                                      "May only use releaseBlock with instances of LargeTempTable.");
     }
 
+    // Used by large temp table iterators to announce the blocks after
+    // the one being scanned, so they can be read ahead.
+    virtual void prefetchBlocksAfter(std::vector<LargeTempTableBlockId>::iterator it) {
+        throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                     "May only use prefetchBlocksAfter with instances of LargeTempTable.");
+    }
+
     // Return tuple blocks addresses
     virtual std::vector<uint64_t> getBlockAddresses() const = 0;
 
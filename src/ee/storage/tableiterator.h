@@ -536,6 +536,7 @@ inline bool TableIterator::largeTempNext(TableTuple &out) {
             }
 
             LargeTempTableBlock* block = lttCache->fetchBlock(*blockIdIterator);
+            m_table->prefetchBlocksAfter(blockIdIterator);
             m_dataPtr = block->address();
 
             uint32_t unusedTupleBoundary = block->unusedTupleBoundary();
@@ -54,6 +54,8 @@ TempTable::TempTable()
     : AbstractTempTable(TABLE_BLOCKSIZE)
     , m_data()
     , m_limits(NULL)
+    , m_pipelineConsumer(NULL)
+    , m_pipelinedTupleCount(0)
 {
 }
 
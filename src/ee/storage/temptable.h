@@ -59,6 +59,16 @@ class TableColumn;
 class TableFactory;
 class TableStats;
 
+/**
+ * Receives the tuples inserted into a TempTable that passes them
+ * straight on instead of storing them.  See TempTable::setPipelineConsumer.
+ */
+class TempTableConsumer {
+  public:
+    virtual ~TempTableConsumer() {}
+    virtual void consumeTempTuple(TableTuple &tuple) = 0;
+};
+
 /**
  * Represents a Temporary Table to store temporary result (final
  * result or intermediate result).  Temporary Table has no indexes,
@@ -116,7 +126,22 @@ class TempTable : public AbstractTempTable {
 
     bool isTempTableEmpty() { return m_tupleCount == 0; }
 
-    virtual int64_t tempTableTupleCount() const { return m_tupleCount; }
+    virtual int64_t tempTableTupleCount() const { return m_tupleCount + m_pipelinedTupleCount; }
+
+    virtual int64_t activeTupleCount() const { return m_tupleCount + m_pipelinedTupleCount; }
+
+    /**
+     * Hand every tuple inserted from now on to the consumer instead of
+     * storing it.  The tuples still count towards activeTupleCount(), which
+     * inline LIMITs and the plan node profiler rely on, but the table
+     * iterates as empty.
+     */
+    void setPipelineConsumer(TempTableConsumer* consumer) {
+        assert(m_tupleCount == 0);
+        m_pipelineConsumer = consumer;
+    }
+
+    bool isPipelined() const { return m_pipelineConsumer != NULL; }
 
     // ------------------------------------------------------------------
     // INDEXES
@@ -132,6 +157,9 @@ class TempTable : public AbstractTempTable {
     virtual const TempTableLimits* getTempTableLimits() const {
         return m_limits;
     }
+    virtual TempTableLimits* getTempTableLimits() {
+        return m_limits;
+    }
 
     /**
      * Swap the contents of this table with another TempTable
@@ -169,6 +197,11 @@ class TempTable : public AbstractTempTable {
 
     // ptr to global integer tracking temp table memory allocated per frag
     TempTableLimits* m_limits;
+
+    // Where inserted tuples go instead of m_data, if anywhere, and how
+    // many have gone there since the last deleteAllTempTuples().
+    TempTableConsumer* m_pipelineConsumer;
+    int64_t m_pipelinedTupleCount;
 };
 
 inline void TempTable::insertTempTupleDeepCopy(const TableTuple &source, Pool *pool) {
@@ -190,6 +223,12 @@ inline void TempTable::insertTempTupleDeepCopy(const TableTuple &source, Pool *p
 }
 
 inline void TempTable::insertTempTuple(TableTuple &source) {
+    if (m_pipelineConsumer != NULL) {
+        ++m_pipelinedTupleCount;
+        m_pipelineConsumer->consumeTempTuple(source);
+        return;
+    }
+
     //
     // First get the next free tuple
     // This will either give us one from the free slot list, or
@@ -213,6 +252,7 @@ inline void TempTable::insertTempTuple(TableTuple &source) {
 }
 
 inline void TempTable::deleteAllTempTuples() {
+    m_pipelinedTupleCount = 0;
     if (m_tupleCount == 0) {
         return;
     }
@@ -0,0 +1,125 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLOCKEDBLOOMFILTER_H_
+#define BLOCKEDBLOOMFILTER_H_
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace voltdb {
+
+/**
+ * A split block Bloom filter over 64 bit hash values. Each key sets one bit
+ * in each of the eight 32 bit words of a single 32 byte block, so adding or
+ * testing a key touches one cache line no matter how large the filter is.
+ * With the default sizing of 16 bits per key the false positive rate is
+ * about 0.1%.
+ *
+ * The filter keeps no keys, only bits: mayContain() never returns false for
+ * a hash that was added, and returns true for other hashes only rarely.
+ * Callers are responsible for hashing equal keys to equal hash values.
+ */
+class BlockedBloomFilter {
+public:
+    static const int WORDS_PER_BLOCK = 8;
+    static const int DEFAULT_BITS_PER_KEY = 16;
+
+    BlockedBloomFilter() : m_blockMask(0) { }
+
+    /**
+     * Clear the filter and size it for expectedKeys keys, reusing the
+     * existing allocation when it is big enough.
+     */
+    void reset(size_t expectedKeys, int bitsPerKey = DEFAULT_BITS_PER_KEY)
+    {
+        size_t wantedBlocks = (expectedKeys * bitsPerKey) / (WORDS_PER_BLOCK * 32) + 1;
+        size_t blockCount = 1;
+        while (blockCount < wantedBlocks) {
+            blockCount <<= 1;
+        }
+        m_blockMask = blockCount - 1;
+        m_words.assign(blockCount * WORDS_PER_BLOCK, 0);
+    }
+
+    /** Free the filter's bits. It must be reset before it is used again. */
+    void release()
+    {
+        std::vector<uint32_t>().swap(m_words);
+        m_blockMask = 0;
+    }
+
+    void add(uint64_t hash)
+    {
+        uint32_t* block = &m_words[blockIndex(hash) * WORDS_PER_BLOCK];
+        uint32_t low = static_cast<uint32_t>(hash);
+        for (int i = 0; i < WORDS_PER_BLOCK; ++i) {
+            block[i] |= bitInWord(low, i);
+        }
+    }
+
+    bool mayContain(uint64_t hash) const
+    {
+        const uint32_t* block = &m_words[blockIndex(hash) * WORDS_PER_BLOCK];
+        uint32_t low = static_cast<uint32_t>(hash);
+        uint32_t missing = 0;
+        for (int i = 0; i < WORDS_PER_BLOCK; ++i) {
+            missing |= bitInWord(low, i) & ~block[i];
+        }
+        return missing == 0;
+    }
+
+    size_t sizeInBytes() const { return m_words.size() * sizeof(uint32_t); }
+
+    /**
+     * Finish a hash built with boost::hash_combine or similar, whose low and
+     * high bits are not well distributed.
+     */
+    static uint64_t mix(uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+private:
+    size_t blockIndex(uint64_t hash) const
+    {
+        return static_cast<size_t>(hash >> 32) & m_blockMask;
+    }
+
+    // One bit per word, picked by an odd multiplier per word as in the
+    // Parquet and Impala split block filters.
+    static uint32_t bitInWord(uint32_t low, int word)
+    {
+        static const uint32_t SALT[WORDS_PER_BLOCK] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U };
+        return 1U << ((low * SALT[word]) >> 27);
+    }
+
+    std::vector<uint32_t> m_words;
+    size_t m_blockMask;
+};
+
+}
+
+#endif /* BLOCKEDBLOOMFILTER_H_ */
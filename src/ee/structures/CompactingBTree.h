@@ -0,0 +1,1215 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPACTINGBTREE_H_
+#define COMPACTINGBTREE_H_
+
+#include "CompactingMap.h"
+#include "ContiguousAllocator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+namespace voltdb {
+
+/**
+ * Finds where a key falls within one CompactingBTree node. The default is a
+ * binary search through Compare; key types that can search a packed node
+ * more cheaply specialize this (see indexes/IntsKeySearch.h).
+ */
+template<typename KeyValuePair, typename Compare>
+struct CompactingBTreeNodeSearch {
+    typedef typename KeyValuePair::first_type Key;
+
+    // number of keys less than (or, if upper, not greater than) key
+    static int keySlot(const Compare &comper, const Key *keys, int count, const Key &key, bool upper)
+    {
+        int lo = 0;
+        int hi = count;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            int cmp = comper(keys[mid], key);
+            if (cmp < 0 || (upper && cmp == 0)) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    static int entrySlot(const Compare &comper, const KeyValuePair *entries, int count, const Key &key,
+                         bool upper)
+    {
+        int lo = 0;
+        int hi = count;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            int cmp = comper(entries[mid].getKey(), key);
+            if (cmp < 0 || (upper && cmp == 0)) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+};
+
+/**
+ * A B+tree with the same interface and the same compacting storage
+ * discipline as CompactingMap, so the tree indexes can use either one.
+ *
+ * Entries are packed into fixed size leaf nodes that are chained in key
+ * order, so a range scan walks contiguous arrays instead of chasing one
+ * pointer per key. Inner nodes hold a packed array of separator keys and
+ * their children (plus per-child entry counts when hasRank is set, which
+ * backs rankLower/rankUpper/findRank for countable indexes).
+ *
+ * Leaves and inner nodes each live in their own ContiguousAllocator. As in
+ * CompactingMap, when a node is freed the most recently allocated node is
+ * moved into the hole and the pointers to it are patched up, so memory stays
+ * dense and can shrink.
+ *
+ * Every separator is an exact copy of the smallest key in the subtree to its
+ * right. That keeps separators from outliving the entries they were copied
+ * from, which matters for keys (GenericKey, TupleKey) that point at memory
+ * owned by the indexed tuple.
+ *
+ * Beyond the caveats listed for CompactingMap:
+ * 1. Entries are relocated with memmove/memcpy rather than assignment, so
+ *    the key type must be bitwise relocatable. All the index key types are.
+ * 2. The iterator is a (leaf, slot) pair, so it fits in the same cursor
+ *    storage as a CompactingMap iterator.
+ */
+template<typename KeyValuePair, typename Compare, bool hasRank=false>
+class CompactingBTree {
+    typedef typename KeyValuePair::first_type Key;
+    typedef typename KeyValuePair::second_type Data;
+
+    // Aim for nodes of a few cache lines, but keep a useful fanout for wide keys.
+    static const int NODE_BYTES = 512;
+    static const int MIN_SLOTS = 8;
+    static const int LEAF_SLOTS = (NODE_BYTES / sizeof(KeyValuePair)) > MIN_SLOTS ?
+            (NODE_BYTES / sizeof(KeyValuePair)) : MIN_SLOTS;
+    static const int INNER_SLOTS = (NODE_BYTES / (sizeof(Key) + sizeof(void*))) > MIN_SLOTS ?
+            (NODE_BYTES / (sizeof(Key) + sizeof(void*))) : MIN_SLOTS;
+    static const int MIN_LEAF = LEAF_SLOTS / 2;
+    static const int MIN_INNER = INNER_SLOTS / 2;
+    // how far findFrom walks before it gives up and descends
+    static const int FIND_FROM_STEPS = 8;
+
+    struct InnerNode;
+
+    // Each node has room for one entry more than its capacity so that an
+    // insert can overflow a full node before the node is split.
+    struct LeafNode {
+        InnerNode *parent;
+        LeafNode *prev;
+        LeafNode *next;
+        int32_t used;
+        KeyValuePair kv[LEAF_SLOTS + 1];
+    };
+
+    struct InnerNode {
+        InnerNode *parent;
+        // number of separator keys; there is one more child than that
+        int32_t used;
+        // 1 when the children are leaves
+        int32_t level;
+        Key keys[INNER_SLOTS + 1];
+        void *children[INNER_SLOTS + 2];
+        // Must stay last -- it is not allocated unless hasRank.
+        NodeCount counts[INNER_SLOTS + 2];
+    };
+
+public:
+    class iterator {
+        friend class CompactingBTree<KeyValuePair, Compare, hasRank>;
+    protected:
+        LeafNode *m_leaf;
+        int32_t m_slot;
+        iterator(LeafNode *leaf, int32_t slot) : m_leaf(leaf), m_slot(slot) {}
+    public:
+        iterator() : m_leaf(NULL), m_slot(0) {}
+        iterator(const iterator &iter) : m_leaf(iter.m_leaf), m_slot(iter.m_slot) {}
+        const Key &key() const { return m_leaf->kv[m_slot].getKey(); }
+        const Data &value() const { return m_leaf->kv[m_slot].getValue(); }
+        void setValue(const Data &value) { m_leaf->kv[m_slot].setValue(value); }
+        void moveNext()
+        {
+            if (m_leaf && ++m_slot >= m_leaf->used) {
+                m_leaf = m_leaf->next;
+                m_slot = 0;
+            }
+        }
+        void movePrev()
+        {
+            if (m_leaf && --m_slot < 0) {
+                m_leaf = m_leaf->prev;
+                m_slot = m_leaf ? m_leaf->used - 1 : 0;
+            }
+        }
+        bool isEnd() const { return m_leaf == NULL; }
+        bool equals(const iterator &iter) const {
+            if (isEnd()) {
+                return iter.isEnd();
+            }
+            return m_leaf == iter.m_leaf && m_slot == iter.m_slot;
+        }
+    };
+
+    CompactingBTree(bool unique, Compare comper);
+    ~CompactingBTree();
+
+    bool insert(std::pair<Key, Data> value) { return (insert(value.first, value.second) == NULL); };
+    const Data *insert(const Key &key, const Data &data);
+    bool erase(const Key &key);
+    bool erase(iterator &iter);
+
+    /**
+     * Erase the entry at iter and move iter on to the entry that followed
+     * it, so that a batch erased in key order can walk forward instead of
+     * descending from the root for every key.
+     */
+    void eraseAndMoveNext(iterator &iter);
+
+    /**
+     * Find key by stepping forward a few entries from hint, falling back
+     * to find. Meant for keys visited in ascending order in a map whose
+     * keys are unique.
+     */
+    iterator findFrom(const iterator &hint, const Key &key) const;
+
+    /**
+     * Fill an empty tree with count entries, read from first onwards as
+     * std::pair<Key, Data> in strictly ascending key order. Every insert
+     * lands on the rightmost path, which stays cached throughout.
+     */
+    template<typename Iterator>
+    void buildFromSorted(Iterator first, int64_t count)
+    {
+        assert(m_count == 0);
+        for (int64_t ii = 0; ii < count; ++ii, ++first) {
+            insert(first->first, first->second);
+        }
+    }
+
+    iterator find(const Key &key) const;
+    iterator findRank(int64_t ith) const;
+    int64_t size() const { return m_count; }
+    iterator begin() const { return iterator(m_head, 0); }
+    iterator rbegin() const { return m_tail ? iterator(m_tail, m_tail->used - 1) : iterator(); }
+
+    iterator lowerBound(const Key &key) const;
+    iterator upperBound(const Key &key) const;
+
+    std::pair<iterator, iterator> equalRange(const Key &key) const
+    {
+        return std::pair<iterator, iterator>(lowerBound(key), upperBound(key));
+    }
+
+    size_t bytesAllocated() const
+    {
+        return m_leafAllocator.bytesAllocated() + m_innerAllocator.bytesAllocated();
+    }
+
+    // Must pass a key that already in map, or else return -1
+    int64_t rankLower(const Key& key) const;
+    int64_t rankUpper(const Key& key) const;
+
+    /**
+     * For debugging: verify the B+tree constraints are met. SLOW.
+     */
+    bool verify() const;
+    bool verifyRank() const;
+    /** Do we have a cached last buffer?  This is used in testing. */
+    bool hasCachedLastBuffer() const { return (m_leafAllocator.hasCachedLastBuffer()); }
+
+protected:
+    int64_t m_count;
+    void *m_root;
+    // number of inner levels above the leaves; 0 when the root is a leaf
+    int32_t m_height;
+    LeafNode *m_head;
+    LeafNode *m_tail;
+    ContiguousAllocator m_leafAllocator;
+    ContiguousAllocator m_innerAllocator;
+    bool m_unique;
+    Compare m_comper;
+
+    static int32_t innerAllocationSize()
+    {
+        size_t size = sizeof(InnerNode) - (hasRank ? 0 : sizeof(NodeCount) * (INNER_SLOTS + 2));
+        return static_cast<int32_t>((size + 7) & ~static_cast<size_t>(7));
+    }
+
+    static void copyKey(Key *dest, const Key &src)
+    {
+        // A separator borrows the bytes of a live entry's key -- it must not
+        // take over whatever the key owns, so bypass the assignment operator.
+        ::memcpy(static_cast<void*>(dest), static_cast<const void*>(&src), sizeof(Key));
+    }
+
+    static void moveEntries(KeyValuePair *dest, KeyValuePair *src, int count)
+    {
+        ::memmove(static_cast<void*>(dest), static_cast<void*>(src), sizeof(KeyValuePair) * count);
+    }
+
+    static int childIndex(const InnerNode *parent, const void *child)
+    {
+        int i = 0;
+        while (parent->children[i] != child) {
+            ++i;
+        }
+        assert(i <= parent->used);
+        return i;
+    }
+
+    static void setParent(void *child, int32_t childLevel, InnerNode *parent)
+    {
+        if (childLevel == 0) {
+            static_cast<LeafNode*>(child)->parent = parent;
+        }
+        else {
+            static_cast<InnerNode*>(child)->parent = parent;
+        }
+    }
+
+    static InnerNode *parentOf(void *node, int32_t level)
+    {
+        if (level == 0) {
+            return static_cast<LeafNode*>(node)->parent;
+        }
+        return static_cast<InnerNode*>(node)->parent;
+    }
+
+    // first slot whose key is not less than (or, if upper, is greater than) key
+    int innerSlot(const InnerNode *node, const Key &key, bool upper) const;
+    int leafSlot(const LeafNode *leaf, const Key &key, bool upper) const;
+    int leafSlotWithoutPointer(const LeafNode *leaf, const Key &key) const;
+    LeafNode *descend(const Key &key, bool upper, int64_t *rank) const;
+    iterator makeIterator(LeafNode *leaf, int slot) const
+    {
+        if (slot >= leaf->used) {
+            return iterator(leaf->next, 0);
+        }
+        return iterator(leaf, slot);
+    }
+
+    void addToCounts(void *node, int32_t level, int delta);
+    NodeCount sumCounts(const InnerNode *node) const;
+
+    LeafNode *newLeaf();
+    InnerNode *newInner(int32_t level);
+    void *freeLeaf(LeafNode *x);
+    void *freeInner(InnerNode *x);
+
+    void splitLeaf(LeafNode *leaf);
+    void splitInner(InnerNode *node);
+    void insertIntoParent(void *left, void *right, int32_t childLevel, const Key &separator,
+                          NodeCount leftCount, NodeCount rightCount);
+
+    void eraseAt(LeafNode *leaf, int slot);
+    void refreshSeparator(LeafNode *leaf);
+    void rebalanceLeaf(LeafNode *leaf);
+    void rebalanceInner(InnerNode *node);
+    void collapseRoot();
+
+    int64_t verify(const void *node, int32_t level, const InnerNode *parent, LeafNode *&nextLeaf) const;
+};
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+CompactingBTree<KeyValuePair, Compare, hasRank>::CompactingBTree(bool unique, Compare comper)
+    : m_count(0),
+      m_root(NULL),
+      m_height(0),
+      m_head(NULL),
+      m_tail(NULL),
+      m_leafAllocator(static_cast<int32_t>(sizeof(LeafNode)), 1000),
+      m_innerAllocator(innerAllocationSize(), 100),
+      m_unique(unique),
+      m_comper(comper)
+{ }
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+CompactingBTree<KeyValuePair, Compare, hasRank>::~CompactingBTree()
+{
+    for (LeafNode *leaf = m_head; leaf; leaf = leaf->next) {
+        for (int i = 0; i < leaf->used; ++i) {
+            leaf->kv[i].~KeyValuePair();
+        }
+    }
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+int CompactingBTree<KeyValuePair, Compare, hasRank>::innerSlot(const InnerNode *node, const Key &key,
+                                                               bool upper) const
+{
+    return CompactingBTreeNodeSearch<KeyValuePair, Compare>::keySlot(m_comper, node->keys, node->used,
+                                                                      key, upper);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+int CompactingBTree<KeyValuePair, Compare, hasRank>::leafSlot(const LeafNode *leaf, const Key &key,
+                                                              bool upper) const
+{
+    return CompactingBTreeNodeSearch<KeyValuePair, Compare>::entrySlot(m_comper, leaf->kv, leaf->used,
+                                                                       key, upper);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+int CompactingBTree<KeyValuePair, Compare, hasRank>::leafSlotWithoutPointer(const LeafNode *leaf,
+                                                                            const Key &key) const
+{
+    int lo = 0;
+    int hi = leaf->used;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (m_comper.compareWithoutPointer(leaf->kv[mid].getKey(), key) < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Walk down to the leaf that holds the lower (or upper) bound of key,
+ * optionally summing the counts of the subtrees passed over on the left.
+ */
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingBTree<KeyValuePair, Compare, hasRank>::LeafNode *
+CompactingBTree<KeyValuePair, Compare, hasRank>::descend(const Key &key, bool upper, int64_t *rank) const
+{
+    void *node = m_root;
+    for (int32_t level = m_height; level > 0; --level) {
+        const InnerNode *inner = static_cast<const InnerNode*>(node);
+        int slot = innerSlot(inner, key, upper);
+        if (rank) {
+            for (int i = 0; i < slot; ++i) {
+                *rank += inner->counts[i];
+            }
+        }
+        node = inner->children[slot];
+    }
+    return static_cast<LeafNode*>(node);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingBTree<KeyValuePair, Compare, hasRank>::iterator
+CompactingBTree<KeyValuePair, Compare, hasRank>::lowerBound(const Key &key) const
+{
+    if (m_count == 0) {
+        return iterator();
+    }
+    LeafNode *leaf = descend(key, false, NULL);
+    return makeIterator(leaf, leafSlot(leaf, key, false));
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingBTree<KeyValuePair, Compare, hasRank>::iterator
+CompactingBTree<KeyValuePair, Compare, hasRank>::upperBound(const Key &key) const
+{
+    if (m_count == 0) {
+        return iterator();
+    }
+    Key tmpKey(key);
+    setPointerValue(tmpKey, MAXPOINTER);
+    LeafNode *leaf = descend(tmpKey, true, NULL);
+    return makeIterator(leaf, leafSlot(leaf, tmpKey, true));
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingBTree<KeyValuePair, Compare, hasRank>::iterator
+CompactingBTree<KeyValuePair, Compare, hasRank>::find(const Key &key) const
+{
+    iterator iter = lowerBound(key);
+    if (iter.isEnd() || m_comper(iter.key(), key) != 0) {
+        return iterator();
+    }
+    return iter;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingBTree<KeyValuePair, Compare, hasRank>::iterator
+CompactingBTree<KeyValuePair, Compare, hasRank>::findRank(int64_t ith) const
+{
+    if ((!hasRank) || ith < 1 || ith > m_count) {
+        return iterator();
+    }
+    void *node = m_root;
+    int64_t rk = ith;
+    for (int32_t level = m_height; level > 0; --level) {
+        const InnerNode *inner = static_cast<const InnerNode*>(node);
+        int i = 0;
+        while (rk > inner->counts[i]) {
+            rk -= inner->counts[i];
+            ++i;
+        }
+        node = inner->children[i];
+    }
+    return iterator(static_cast<LeafNode*>(node), static_cast<int32_t>(rk - 1));
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+int64_t CompactingBTree<KeyValuePair, Compare, hasRank>::rankLower(const Key& key) const
+{
+    if (!hasRank) {
+        return -1;
+    }
+    if (find(key).isEnd()) {
+        return -1;
+    }
+    // Same walk as descend(), but only the "data" part of the key counts.
+    int64_t rank = 0;
+    void *node = m_root;
+    for (int32_t level = m_height; level > 0; --level) {
+        const InnerNode *inner = static_cast<const InnerNode*>(node);
+        int slot = 0;
+        while (slot < inner->used && m_comper.compareWithoutPointer(inner->keys[slot], key) < 0) {
+            rank += inner->counts[slot];
+            ++slot;
+        }
+        node = inner->children[slot];
+    }
+    return rank + leafSlotWithoutPointer(static_cast<LeafNode*>(node), key) + 1;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+int64_t CompactingBTree<KeyValuePair, Compare, hasRank>::rankUpper(const Key& key) const
+{
+    if (!hasRank) {
+        return -1;
+    }
+    if (m_unique) {
+        return rankLower(key);
+    }
+    if (find(key).isEnd()) {
+        return -1;
+    }
+    // The rank of the last match is the number of entries before the upper bound.
+    Key tmpKey(key);
+    setPointerValue(tmpKey, MAXPOINTER);
+    int64_t rank = 0;
+    LeafNode *leaf = descend(tmpKey, true, &rank);
+    return rank + leafSlot(leaf, tmpKey, true);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::addToCounts(void *node, int32_t level, int delta)
+{
+    if (!hasRank) {
+        return;
+    }
+    InnerNode *parent = parentOf(node, level);
+    while (parent) {
+        parent->counts[childIndex(parent, node)] += delta;
+        node = parent;
+        parent = parent->parent;
+    }
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+NodeCount CompactingBTree<KeyValuePair, Compare, hasRank>::sumCounts(const InnerNode *node) const
+{
+    NodeCount total = 0;
+    if (hasRank) {
+        for (int i = 0; i <= node->used; ++i) {
+            total += node->counts[i];
+        }
+    }
+    return total;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingBTree<KeyValuePair, Compare, hasRank>::LeafNode *
+CompactingBTree<KeyValuePair, Compare, hasRank>::newLeaf()
+{
+    LeafNode *leaf = static_cast<LeafNode*>(m_leafAllocator.alloc());
+    assert(leaf);
+    leaf->parent = NULL;
+    leaf->prev = NULL;
+    leaf->next = NULL;
+    leaf->used = 0;
+    return leaf;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingBTree<KeyValuePair, Compare, hasRank>::InnerNode *
+CompactingBTree<KeyValuePair, Compare, hasRank>::newInner(int32_t level)
+{
+    InnerNode *node = static_cast<InnerNode*>(m_innerAllocator.alloc());
+    assert(node);
+    node->parent = NULL;
+    node->used = 0;
+    node->level = level;
+    return node;
+}
+
+/**
+ * Release an unlinked leaf whose entries have already been destroyed or
+ * moved elsewhere. The last allocated leaf is moved into the hole; returns
+ * the old address of the moved leaf, or NULL if nothing moved.
+ */
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void *CompactingBTree<KeyValuePair, Compare, hasRank>::freeLeaf(LeafNode *x)
+{
+    LeafNode *last = static_cast<LeafNode*>(m_leafAllocator.last());
+    if (last == x) {
+        m_leafAllocator.trim();
+        return NULL;
+    }
+
+    if (last->parent) {
+        last->parent->children[childIndex(last->parent, last)] = x;
+    }
+    else {
+        assert(m_root == last);
+        m_root = x;
+    }
+    if (last->prev) {
+        last->prev->next = x;
+    }
+    else {
+        m_head = x;
+    }
+    if (last->next) {
+        last->next->prev = x;
+    }
+    else {
+        m_tail = x;
+    }
+
+    x->parent = last->parent;
+    x->prev = last->prev;
+    x->next = last->next;
+    x->used = last->used;
+    moveEntries(x->kv, last->kv, last->used);
+
+    m_leafAllocator.trim();
+    return last;
+}
+
+/**
+ * Release an unlinked inner node. Same contract as freeLeaf().
+ */
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void *CompactingBTree<KeyValuePair, Compare, hasRank>::freeInner(InnerNode *x)
+{
+    InnerNode *last = static_cast<InnerNode*>(m_innerAllocator.last());
+    if (last == x) {
+        m_innerAllocator.trim();
+        return NULL;
+    }
+
+    if (last->parent) {
+        last->parent->children[childIndex(last->parent, last)] = x;
+    }
+    else {
+        assert(m_root == last);
+        m_root = x;
+    }
+    for (int i = 0; i <= last->used; ++i) {
+        setParent(last->children[i], last->level - 1, x);
+    }
+
+    x->parent = last->parent;
+    x->used = last->used;
+    x->level = last->level;
+    ::memcpy(static_cast<void*>(x->keys), static_cast<void*>(last->keys), sizeof(Key) * last->used);
+    ::memcpy(x->children, last->children, sizeof(void*) * (last->used + 1));
+    if (hasRank) {
+        ::memcpy(x->counts, last->counts, sizeof(NodeCount) * (last->used + 1));
+    }
+
+    m_innerAllocator.trim();
+    return last;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+const typename CompactingBTree<KeyValuePair, Compare, hasRank>::Data *
+CompactingBTree<KeyValuePair, Compare, hasRank>::insert(const Key &key, const Data &value)
+{
+    if (m_root == NULL) {
+        m_head = m_tail = newLeaf();
+        m_root = m_head;
+        m_height = 0;
+    }
+
+    // New duplicates go after existing ones, as in CompactingMap.
+    LeafNode *leaf = descend(key, true, NULL);
+    int slot = leafSlot(leaf, key, true);
+
+    if (m_unique) {
+        // The entry just before the insertion point is the greatest one not above key.
+        const KeyValuePair *prior = NULL;
+        if (slot > 0) {
+            prior = &leaf->kv[slot - 1];
+        }
+        else if (leaf->prev) {
+            prior = &leaf->prev->kv[leaf->prev->used - 1];
+        }
+        if (prior && m_comper(prior->getKey(), key) == 0) {
+            return &prior->getValue();
+        }
+    }
+
+    moveEntries(&leaf->kv[slot + 1], &leaf->kv[slot], leaf->used - slot);
+    KeyValuePair *entry = new (&leaf->kv[slot]) KeyValuePair();
+    entry->setKeyValuePair(key, value);
+    ++leaf->used;
+    ++m_count;
+    addToCounts(leaf, 0, 1);
+
+    if (leaf->used > LEAF_SLOTS) {
+        splitLeaf(leaf);
+    }
+    return NULL;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::splitLeaf(LeafNode *leaf)
+{
+    LeafNode *right = newLeaf();
+    int keep = leaf->used / 2;
+    right->used = leaf->used - keep;
+    moveEntries(right->kv, &leaf->kv[keep], right->used);
+    leaf->used = keep;
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (leaf->next) {
+        leaf->next->prev = right;
+    }
+    else {
+        m_tail = right;
+    }
+    leaf->next = right;
+
+    insertIntoParent(leaf, right, 0, right->kv[0].getKey(), leaf->used, right->used);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::splitInner(InnerNode *node)
+{
+    InnerNode *right = newInner(node->level);
+    int mid = node->used / 2;
+    right->used = node->used - mid - 1;
+    ::memcpy(static_cast<void*>(right->keys), static_cast<void*>(&node->keys[mid + 1]),
+             sizeof(Key) * right->used);
+    ::memcpy(right->children, &node->children[mid + 1], sizeof(void*) * (right->used + 1));
+    if (hasRank) {
+        ::memcpy(right->counts, &node->counts[mid + 1], sizeof(NodeCount) * (right->used + 1));
+    }
+    for (int i = 0; i <= right->used; ++i) {
+        setParent(right->children[i], right->level - 1, right);
+    }
+    node->used = mid;
+
+    // keys[mid] is no longer part of node, but its bytes are still intact.
+    insertIntoParent(node, right, node->level, node->keys[mid], sumCounts(node), sumCounts(right));
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::insertIntoParent(void *left, void *right,
+                                                                       int32_t childLevel,
+                                                                       const Key &separator,
+                                                                       NodeCount leftCount,
+                                                                       NodeCount rightCount)
+{
+    InnerNode *parent = parentOf(left, childLevel);
+    if (parent == NULL) {
+        InnerNode *root = newInner(childLevel + 1);
+        root->used = 1;
+        copyKey(&root->keys[0], separator);
+        root->children[0] = left;
+        root->children[1] = right;
+        if (hasRank) {
+            root->counts[0] = leftCount;
+            root->counts[1] = rightCount;
+        }
+        setParent(left, childLevel, root);
+        setParent(right, childLevel, root);
+        m_root = root;
+        ++m_height;
+        return;
+    }
+
+    int i = childIndex(parent, left);
+    ::memmove(static_cast<void*>(&parent->keys[i + 1]), static_cast<void*>(&parent->keys[i]),
+              sizeof(Key) * (parent->used - i));
+    ::memmove(&parent->children[i + 2], &parent->children[i + 1], sizeof(void*) * (parent->used - i));
+    copyKey(&parent->keys[i], separator);
+    parent->children[i + 1] = right;
+    if (hasRank) {
+        ::memmove(&parent->counts[i + 2], &parent->counts[i + 1], sizeof(NodeCount) * (parent->used - i));
+        parent->counts[i] = leftCount;
+        parent->counts[i + 1] = rightCount;
+    }
+    setParent(right, childLevel, parent);
+    ++parent->used;
+
+    if (parent->used > INNER_SLOTS) {
+        splitInner(parent);
+    }
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+bool CompactingBTree<KeyValuePair, Compare, hasRank>::erase(const Key &key)
+{
+    iterator iter = find(key);
+    if (iter.isEnd()) {
+        return false;
+    }
+    eraseAt(iter.m_leaf, iter.m_slot);
+    return true;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+bool CompactingBTree<KeyValuePair, Compare, hasRank>::erase(iterator &iter)
+{
+    assert(!iter.isEnd());
+    eraseAt(iter.m_leaf, iter.m_slot);
+    return true;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::eraseAndMoveNext(iterator &iter)
+{
+    assert(!iter.isEnd());
+    LeafNode *leaf = iter.m_leaf;
+    int slot = iter.m_slot;
+    if (leaf == m_root || leaf->used > MIN_LEAF) {
+        // No rebalancing, so the following entry just shifts into slot.
+        eraseAt(leaf, slot);
+        iter = (m_root == NULL) ? iterator() : makeIterator(leaf, slot);
+        return;
+    }
+    // Rebalancing moves entries between leaves, so find the following
+    // entry again by its key.
+    iterator next(iter);
+    next.moveNext();
+    if (next.isEnd()) {
+        eraseAt(leaf, slot);
+        iter = iterator();
+        return;
+    }
+    Key nextKey(next.key());
+    eraseAt(leaf, slot);
+    iter = lowerBound(nextKey);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingBTree<KeyValuePair, Compare, hasRank>::iterator
+CompactingBTree<KeyValuePair, Compare, hasRank>::findFrom(const iterator &hint, const Key &key) const
+{
+    iterator iter(hint);
+    for (int ii = 0; ii < FIND_FROM_STEPS && !iter.isEnd(); ++ii) {
+        int cmp = m_comper(iter.key(), key);
+        if (cmp == 0) {
+            return iter;
+        }
+        if (cmp > 0) {
+            break;
+        }
+        iter.moveNext();
+    }
+    return find(key);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::eraseAt(LeafNode *leaf, int slot)
+{
+    leaf->kv[slot].~KeyValuePair();
+    --leaf->used;
+    moveEntries(&leaf->kv[slot], &leaf->kv[slot + 1], leaf->used - slot);
+    --m_count;
+    addToCounts(leaf, 0, -1);
+
+    if (leaf == m_root) {
+        if (leaf->used == 0) {
+            freeLeaf(leaf);
+            m_root = NULL;
+            m_head = m_tail = NULL;
+        }
+        return;
+    }
+    if (slot == 0) {
+        refreshSeparator(leaf);
+    }
+    if (leaf->used < MIN_LEAF) {
+        rebalanceLeaf(leaf);
+    }
+}
+
+/**
+ * The first key of leaf changed; update the one separator that copies it.
+ */
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::refreshSeparator(LeafNode *leaf)
+{
+    assert(leaf->used > 0);
+    void *node = leaf;
+    InnerNode *parent = leaf->parent;
+    while (parent) {
+        int i = childIndex(parent, node);
+        if (i > 0) {
+            copyKey(&parent->keys[i - 1], leaf->kv[0].getKey());
+            return;
+        }
+        node = parent;
+        parent = parent->parent;
+    }
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::rebalanceLeaf(LeafNode *leaf)
+{
+    InnerNode *parent = leaf->parent;
+    int i = childIndex(parent, leaf);
+
+    // Borrow from a sibling that can spare an entry.
+    if (i > 0) {
+        LeafNode *left = static_cast<LeafNode*>(parent->children[i - 1]);
+        if (left->used > MIN_LEAF) {
+            moveEntries(&leaf->kv[1], &leaf->kv[0], leaf->used);
+            moveEntries(&leaf->kv[0], &left->kv[left->used - 1], 1);
+            --left->used;
+            ++leaf->used;
+            copyKey(&parent->keys[i - 1], leaf->kv[0].getKey());
+            if (hasRank) {
+                --parent->counts[i - 1];
+                ++parent->counts[i];
+            }
+            return;
+        }
+    }
+    if (i < parent->used) {
+        LeafNode *right = static_cast<LeafNode*>(parent->children[i + 1]);
+        if (right->used > MIN_LEAF) {
+            moveEntries(&leaf->kv[leaf->used], &right->kv[0], 1);
+            --right->used;
+            moveEntries(&right->kv[0], &right->kv[1], right->used);
+            ++leaf->used;
+            copyKey(&parent->keys[i], right->kv[0].getKey());
+            if (hasRank) {
+                ++parent->counts[i];
+                --parent->counts[i + 1];
+            }
+            return;
+        }
+    }
+
+    // Otherwise merge with a sibling; the left one of the pair survives.
+    int sep = (i > 0) ? i - 1 : i;
+    LeafNode *left = static_cast<LeafNode*>(parent->children[sep]);
+    LeafNode *right = static_cast<LeafNode*>(parent->children[sep + 1]);
+    moveEntries(&left->kv[left->used], right->kv, right->used);
+    left->used += right->used;
+    left->next = right->next;
+    if (right->next) {
+        right->next->prev = left;
+    }
+    else {
+        m_tail = left;
+    }
+
+    ::memmove(static_cast<void*>(&parent->keys[sep]), static_cast<void*>(&parent->keys[sep + 1]),
+              sizeof(Key) * (parent->used - sep - 1));
+    ::memmove(&parent->children[sep + 1], &parent->children[sep + 2], sizeof(void*) * (parent->used - sep - 1));
+    if (hasRank) {
+        parent->counts[sep] += parent->counts[sep + 1];
+        ::memmove(&parent->counts[sep + 1], &parent->counts[sep + 2], sizeof(NodeCount) * (parent->used - sep - 1));
+    }
+    --parent->used;
+
+    freeLeaf(right);
+
+    if (parent->parent == NULL) {
+        if (parent->used == 0) {
+            collapseRoot();
+        }
+    }
+    else if (parent->used < MIN_INNER) {
+        rebalanceInner(parent);
+    }
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::rebalanceInner(InnerNode *node)
+{
+    while (node->parent && node->used < MIN_INNER) {
+        InnerNode *parent = node->parent;
+        int i = childIndex(parent, node);
+        const int32_t childLevel = node->level - 1;
+
+        // Borrow by rotating a child through the parent.
+        if (i > 0) {
+            InnerNode *left = static_cast<InnerNode*>(parent->children[i - 1]);
+            if (left->used > MIN_INNER) {
+                ::memmove(static_cast<void*>(&node->keys[1]), static_cast<void*>(&node->keys[0]),
+                          sizeof(Key) * node->used);
+                ::memmove(&node->children[1], &node->children[0], sizeof(void*) * (node->used + 1));
+                ::memcpy(static_cast<void*>(&node->keys[0]), static_cast<void*>(&parent->keys[i - 1]),
+                         sizeof(Key));
+                node->children[0] = left->children[left->used];
+                setParent(node->children[0], childLevel, node);
+                ::memcpy(static_cast<void*>(&parent->keys[i - 1]), static_cast<void*>(&left->keys[left->used - 1]),
+                         sizeof(Key));
+                if (hasRank) {
+                    NodeCount moved = left->counts[left->used];
+                    ::memmove(&node->counts[1], &node->counts[0], sizeof(NodeCount) * (node->used + 1));
+                    node->counts[0] = moved;
+                    parent->counts[i - 1] -= moved;
+                    parent->counts[i] += moved;
+                }
+                --left->used;
+                ++node->used;
+                return;
+            }
+        }
+        if (i < parent->used) {
+            InnerNode *right = static_cast<InnerNode*>(parent->children[i + 1]);
+            if (right->used > MIN_INNER) {
+                ::memcpy(static_cast<void*>(&node->keys[node->used]), static_cast<void*>(&parent->keys[i]),
+                         sizeof(Key));
+                node->children[node->used + 1] = right->children[0];
+                setParent(right->children[0], childLevel, node);
+                ::memcpy(static_cast<void*>(&parent->keys[i]), static_cast<void*>(&right->keys[0]),
+                         sizeof(Key));
+                if (hasRank) {
+                    NodeCount moved = right->counts[0];
+                    node->counts[node->used + 1] = moved;
+                    ::memmove(&right->counts[0], &right->counts[1], sizeof(NodeCount) * right->used);
+                    parent->counts[i] += moved;
+                    parent->counts[i + 1] -= moved;
+                }
+                ::memmove(static_cast<void*>(&right->keys[0]), static_cast<void*>(&right->keys[1]),
+                          sizeof(Key) * (right->used - 1));
+                ::memmove(&right->children[0], &right->children[1], sizeof(void*) * right->used);
+                --right->used;
+                ++node->used;
+                return;
+            }
+        }
+
+        // Merge with a sibling, pulling the separator down between them.
+        int sep = (i > 0) ? i - 1 : i;
+        InnerNode *left = static_cast<InnerNode*>(parent->children[sep]);
+        InnerNode *right = static_cast<InnerNode*>(parent->children[sep + 1]);
+        ::memcpy(static_cast<void*>(&left->keys[left->used]), static_cast<void*>(&parent->keys[sep]),
+                 sizeof(Key));
+        ::memcpy(static_cast<void*>(&left->keys[left->used + 1]), static_cast<void*>(right->keys),
+                 sizeof(Key) * right->used);
+        ::memcpy(&left->children[left->used + 1], right->children, sizeof(void*) * (right->used + 1));
+        if (hasRank) {
+            ::memcpy(&left->counts[left->used + 1], right->counts, sizeof(NodeCount) * (right->used + 1));
+        }
+        for (int j = 0; j <= right->used; ++j) {
+            setParent(right->children[j], childLevel, left);
+        }
+        left->used += right->used + 1;
+
+        ::memmove(static_cast<void*>(&parent->keys[sep]), static_cast<void*>(&parent->keys[sep + 1]),
+                  sizeof(Key) * (parent->used - sep - 1));
+        ::memmove(&parent->children[sep + 1], &parent->children[sep + 2], sizeof(void*) * (parent->used - sep - 1));
+        if (hasRank) {
+            parent->counts[sep] += parent->counts[sep + 1];
+            ::memmove(&parent->counts[sep + 1], &parent->counts[sep + 2],
+                      sizeof(NodeCount) * (parent->used - sep - 1));
+        }
+        --parent->used;
+
+        // Freeing may move the parent itself into the freed slot.
+        if (freeInner(right) == parent) {
+            parent = right;
+        }
+        if (parent->parent == NULL) {
+            if (parent->used == 0) {
+                collapseRoot();
+            }
+            return;
+        }
+        node = parent;
+    }
+}
+
+/**
+ * The root is an inner node with a single child; make that child the root.
+ */
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingBTree<KeyValuePair, Compare, hasRank>::collapseRoot()
+{
+    InnerNode *root = static_cast<InnerNode*>(m_root);
+    assert(root->used == 0);
+    void *child = root->children[0];
+    setParent(child, root->level - 1, NULL);
+    m_root = child;
+    --m_height;
+    freeInner(root);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+int64_t CompactingBTree<KeyValuePair, Compare, hasRank>::verify(const void *node, int32_t level,
+                                                                const InnerNode *parent,
+                                                                LeafNode *&nextLeaf) const
+{
+    if (level == 0) {
+        const LeafNode *leaf = static_cast<const LeafNode*>(node);
+        if (leaf != nextLeaf) {
+            printf("leaf chain out of order\n");
+            return -1;
+        }
+        if (leaf->parent != parent) {
+            printf("bad leaf parent\n");
+            return -1;
+        }
+        if (parent && (leaf->used < MIN_LEAF || leaf->used > LEAF_SLOTS)) {
+            printf("leaf holds %d entries\n", leaf->used);
+            return -1;
+        }
+        for (int i = 1; i < leaf->used; ++i) {
+            int cmp = m_comper(leaf->kv[i - 1].getKey(), leaf->kv[i].getKey());
+            if (cmp > 0 || (m_unique && cmp == 0)) {
+                printf("leaf entries out of order\n");
+                return -1;
+            }
+        }
+        if (leaf->next && leaf->next->prev != leaf) {
+            printf("bad leaf prev link\n");
+            return -1;
+        }
+        nextLeaf = leaf->next;
+        return leaf->used;
+    }
+
+    const InnerNode *inner = static_cast<const InnerNode*>(node);
+    if (inner->parent != parent || inner->level != level) {
+        printf("bad inner node parent or level\n");
+        return -1;
+    }
+    if (parent && (inner->used < MIN_INNER || inner->used > INNER_SLOTS)) {
+        printf("inner node holds %d keys\n", inner->used);
+        return -1;
+    }
+    int64_t total = 0;
+    for (int i = 0; i <= inner->used; ++i) {
+        const void *child = inner->children[i];
+        if (i > 0) {
+            // the separator must match the first entry under its child
+            const LeafNode *first = nextLeaf;
+            if (first == NULL || m_comper(inner->keys[i - 1], first->kv[0].getKey()) != 0) {
+                printf("separator does not match its subtree\n");
+                return -1;
+            }
+        }
+        int64_t ct = verify(child, level - 1, inner, nextLeaf);
+        if (ct < 0) {
+            return -1;
+        }
+        if (hasRank && ct != inner->counts[i]) {
+            printf("subtree count %ld, expected %ld\n", (long)inner->counts[i], (long)ct);
+            return -1;
+        }
+        total += ct;
+    }
+    return total;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+bool CompactingBTree<KeyValuePair, Compare, hasRank>::verify() const
+{
+    if (m_root == NULL) {
+        return m_count == 0 && m_head == NULL && m_tail == NULL && m_height == 0 &&
+               m_leafAllocator.count() == 0 && m_innerAllocator.count() == 0;
+    }
+    if (m_head == NULL || m_head->prev != NULL || m_tail == NULL || m_tail->next != NULL) {
+        return false;
+    }
+    LeafNode *nextLeaf = m_head;
+    if (verify(m_root, m_height, NULL, nextLeaf) != m_count) {
+        return false;
+    }
+    if (nextLeaf != NULL) {
+        return false;
+    }
+    // every allocated node must be in the tree
+    int64_t leaves = 0;
+    for (LeafNode *leaf = m_head; leaf; leaf = leaf->next) {
+        ++leaves;
+    }
+    if (leaves != m_leafAllocator.count()) {
+        return false;
+    }
+    if (m_height == 0 && m_innerAllocator.count() != 0) {
+        return false;
+    }
+    return true;
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+bool CompactingBTree<KeyValuePair, Compare, hasRank>::verifyRank() const
+{
+    if (!hasRank) {
+        return true;
+    }
+
+    iterator it = begin();
+    for (int64_t i = 1; i <= m_count; i++, it.moveNext()) {
+        if (!findRank(i).equals(it)) {
+            printf("findRank(%ld) is not the %ldth entry\n", (long)i, (long)i);
+            return false;
+        }
+        const Key &k = it.key();
+
+        // entries that match k ahead of and behind this one
+        int64_t before = 0;
+        iterator prev = it;
+        for (prev.movePrev(); !prev.isEnd() && m_comper.compareWithoutPointer(prev.key(), k) == 0; prev.movePrev()) {
+            ++before;
+        }
+        int64_t rkasc = rankLower(k);
+        if (rkasc != i - before) {
+            printf("false: rankLower expected %ld, but got %ld\n", (long)(i - before), (long)rkasc);
+            return false;
+        }
+
+        if (!m_unique) {
+            int64_t after = 0;
+            iterator next = it;
+            for (next.moveNext(); !next.isEnd() && m_comper.compareWithoutPointer(next.key(), k) == 0; next.moveNext()) {
+                ++after;
+            }
+            int64_t rkUpper = rankUpper(k);
+            if (rkUpper != i + after) {
+                printf("false: rankUpper expected %ld, but got %ld\n", (long)(i + after), (long)rkUpper);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace voltdb
+
+#endif // COMPACTINGBTREE_H_
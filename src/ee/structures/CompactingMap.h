@@ -202,6 +202,28 @@ public:
     bool erase(const Key &key);
     bool erase(iterator &iter);
 
+    /**
+     * Erase the entry at iter and move iter on to the entry that followed
+     * it, so that a batch erased in key order can walk forward instead of
+     * descending from the root for every key.
+     */
+    void eraseAndMoveNext(iterator &iter);
+
+    /**
+     * Find key by stepping forward a few entries from hint, falling back
+     * to find. Meant for keys visited in ascending order in a map whose
+     * keys are unique.
+     */
+    iterator findFrom(const iterator &hint, const Key &key) const;
+
+    /**
+     * Fill an empty map with count entries, read from first onwards as
+     * std::pair<Key, Data> in strictly ascending key order. The tree is
+     * built balanced from the bottom up instead of one insert at a time.
+     */
+    template<typename Iterator>
+    void buildFromSorted(Iterator first, int64_t count);
+
     iterator find(const Key &key) const { return iterator(this, lookup(key)); }
     iterator findRank(int64_t ith) const { return iterator(this, lookupRank(ith)); }
     int64_t size() const { return m_count; }
@@ -239,8 +261,11 @@ public:
     bool hasCachedLastBuffer() const { return (m_allocator.hasCachedLastBuffer()); }
 
 protected:
+    // how far findFrom walks before it gives up and descends
+    static const int FIND_FROM_STEPS = 8;
+
     // main internal functions
-    void erase(TreeNode *z);
+    TreeNode *erase(TreeNode *z);
     TreeNode *lookup(const Key &key) const;
     TreeNode *lookupRank(int64_t ith) const;
 
@@ -260,6 +285,8 @@ protected:
     void insertFixup(TreeNode *z);
     void deleteFixup(TreeNode *x);
     void fragmentFixup(TreeNode *x);
+    template<typename Iterator>
+    TreeNode *buildSubtree(int level, int redLevel, int64_t lo, int64_t hi, Iterator &next);
 
     // debugging and testing methods
     bool isReachableNode(const TreeNode* start, const TreeNode *dest) const;
@@ -310,6 +337,82 @@ bool CompactingMap<KeyValuePair, Compare, hasRank>::erase(iterator &iter)
     return true;
 }
 
+template<typename KeyValuePair, typename Compare, bool hasRank>
+void CompactingMap<KeyValuePair, Compare, hasRank>::eraseAndMoveNext(iterator &iter)
+{
+    assert(iter.m_node != &NIL);
+    iter.m_node = erase(iter.m_node);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+typename CompactingMap<KeyValuePair, Compare, hasRank>::iterator
+CompactingMap<KeyValuePair, Compare, hasRank>::findFrom(const iterator &hint, const Key &key) const
+{
+    iterator iter(hint);
+    for (int ii = 0; ii < FIND_FROM_STEPS && !iter.isEnd(); ++ii) {
+        int cmp = m_comper(iter.key(), key);
+        if (cmp == 0) {
+            return iter;
+        }
+        if (cmp > 0) {
+            break;
+        }
+        iter.moveNext();
+    }
+    return find(key);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+template<typename Iterator>
+void CompactingMap<KeyValuePair, Compare, hasRank>::buildFromSorted(Iterator first, int64_t count)
+{
+    assert(m_count == 0);
+    if (count == 0) {
+        return;
+    }
+    // All the levels above the last one are full, so colouring the nodes of
+    // the (possibly partial) last level red and all the others black gives
+    // every path the same black height.
+    int redLevel = 0;
+    for (int64_t m = count - 1; m >= 0; m = m / 2 - 1) {
+        ++redLevel;
+    }
+    m_root = buildSubtree(0, redLevel, 0, count - 1, first);
+    m_root->color = BLACK;
+    m_count = count;
+    assert(m_allocator.count() == m_count);
+}
+
+template<typename KeyValuePair, typename Compare, bool hasRank>
+template<typename Iterator>
+typename CompactingMap<KeyValuePair, Compare, hasRank>::TreeNode *
+CompactingMap<KeyValuePair, Compare, hasRank>::buildSubtree(int level, int redLevel,
+                                                            int64_t lo, int64_t hi, Iterator &next)
+{
+    if (hi < lo) {
+        return &NIL;
+    }
+    int64_t mid = lo + (hi - lo) / 2;
+    // Build in key order so that the nodes are also laid out in key order.
+    TreeNode *left = buildSubtree(level + 1, redLevel, lo, mid - 1, next);
+    TreeNode *z = new (m_allocator) TreeNode(&NIL, &NIL);
+    z->kv.setKeyValuePair(next->first, next->second);
+    ++next;
+    z->color = (level == redLevel) ? RED : BLACK;
+    z->left = left;
+    if (left != &NIL) {
+        left->parent = z;
+    }
+    z->right = buildSubtree(level + 1, redLevel, mid + 1, hi, next);
+    if (z->right != &NIL) {
+        z->right->parent = z;
+    }
+    if (hasRank) {
+        updateSubct(z);
+    }
+    return z;
+}
+
 template<typename KeyValuePair, typename Compare, bool hasRank>
 const typename CompactingMap<KeyValuePair, Compare, hasRank>::Data *
 CompactingMap<KeyValuePair, Compare, hasRank>::insert(const Key &key, const Data &value)
@@ -430,11 +533,15 @@ CompactingMap<KeyValuePair, Compare, hasRank>::equalRange(const Key &key) const
 }
 
 template<typename KeyValuePair, typename Compare, bool hasRank>
-void CompactingMap<KeyValuePair, Compare, hasRank>::erase(TreeNode *z)
+typename CompactingMap<KeyValuePair, Compare, hasRank>::TreeNode*
+CompactingMap<KeyValuePair, Compare, hasRank>::erase(TreeNode *z)
 {
     TreeNode *y;
+    // the node that will hold the entry following z's
+    TreeNode *next;
     if ((z->left == &NIL) || (z->right == &NIL)) {
         y = z;
+        next = successor(z);
     }
     else {
         // Deleting a parent with two children is too complicated.
@@ -443,6 +550,7 @@ void CompactingMap<KeyValuePair, Compare, hasRank>::erase(TreeNode *z)
         // z assumes y's content so that
         // y can be deleted in z's place.
         z->kv = y->kv;
+        next = z;
     }
 
     TreeNode *x;
@@ -481,7 +589,11 @@ void CompactingMap<KeyValuePair, Compare, hasRank>::erase(TreeNode *z)
 
     // Fix up the contiguous allocation --
     // move a node to fill a hole.
+    if (next == m_allocator.last()) {
+        next = y;
+    }
     fragmentFixup(y);
+    return next;
 }
 
 template<typename KeyValuePair, typename Compare, bool hasRank>
@@ -19,6 +19,7 @@
 
 #include "common/ThreadLocalPool.h"
 
+#include <new>
 
 using namespace voltdb;
 
@@ -30,14 +31,19 @@ ContiguousAllocator::ContiguousAllocator(int32_t allocSize, int32_t chunkSize)
       m_blockCount(0),
       m_cachedBuffer(0) {}
 
+void ContiguousAllocator::freeBuffer(Buffer *buf) {
+    ThreadLocalPool::freeBlock(ThreadLocalPool::unpackBlockAllocation(
+            reinterpret_cast<char*>(buf), buf->allocation));
+}
+
 ContiguousAllocator::~ContiguousAllocator() {
     while (m_tail) {
         Buffer *buf = m_tail->prev;
-        free(m_tail);
+        freeBuffer(m_tail);
         m_tail = buf;
     }
     if (m_cachedBuffer != NULL) {
-        free(m_cachedBuffer);
+        freeBuffer(m_cachedBuffer);
     }
 }
 
@@ -49,16 +55,22 @@ void *ContiguousAllocator::alloc() {
 
     // if a new block is needed...
     if (blockOffset == 0) {
-        void *memory;
+        Buffer *buf;
         if (m_cachedBuffer != NULL) {
-            memory = static_cast<void *>(m_cachedBuffer);
+            buf = m_cachedBuffer;
             m_cachedBuffer = NULL;
         } else {
-            memory = static_cast<void *>(malloc(sizeof(Buffer) + m_allocationSize * m_numberAllocationsPerBlock));
+            // Large buffers are placed according to the thread's allocation policy.
+            BlockAllocation allocation = ThreadLocalPool::allocateBlock(
+                    sizeof(Buffer) + m_allocationSize * m_numberAllocationsPerBlock);
+            if (allocation.m_address == NULL) {
+                m_count--;
+                throw std::bad_alloc();
+            }
+            buf = reinterpret_cast<Buffer*>(allocation.m_address);
+            buf->allocation = ThreadLocalPool::packBlockAllocation(allocation);
         }
 
-        Buffer *buf = reinterpret_cast<Buffer*>(memory);
-
         // for debugging
         //memset(buf, 0, sizeof(sizeof(Buffer) + m_allocSize * m_chunkSize));
 
@@ -100,7 +112,7 @@ void ContiguousAllocator::trim() {
         if (m_blockCount == 0) {
             m_cachedBuffer = m_tail;
         } else {
-            free(m_tail);
+            freeBuffer(m_tail);
         }
         m_tail = buf;
     }
@@ -19,6 +19,7 @@
 #define CONTIGUOUSALLOCATOR_H_
 
 #include <cstdlib>
+#include <stdint.h>
 #include "common/debuglog.h"
 
 namespace voltdb {
@@ -51,6 +52,8 @@ class ContiguousAllocator {
      */
     struct Buffer {
         Buffer *prev;
+        // How the buffer was allocated, packed by ThreadLocalPool
+        uint64_t allocation;
         char data[0];
     };
     /** This is the total number of allocations in use in all blocks. */
@@ -74,6 +77,8 @@ class ContiguousAllocator {
      */
     Buffer *m_cachedBuffer;
 
+    static void freeBuffer(Buffer *buf);
+
 public:
 
     /**
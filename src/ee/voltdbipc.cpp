@@ -719,8 +719,8 @@ int8_t VoltDBIPC::toggleProfiler(struct ipc_command *cmd) {
         std::cout << "toggleProfiler: toggle=" << ntohl(cs->toggle) << std::endl;
     }
 
-    // actually, the engine doesn't implement this now.
-    // m_engine->ProfilerStart();
+    // The engine has no gperftools hook here, only the plan node profiler.
+    m_engine->setPlanNodeProfiling((ntohl(cs->toggle) & PROFILER_TOGGLE_PLAN_NODES) != 0);
     return kErrorCode_Success;
 }
 
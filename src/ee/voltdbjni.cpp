@@ -52,6 +52,7 @@
  * @{
 */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <signal.h>
@@ -269,7 +270,9 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeIniti
     jint defaultDrBufferSize,
     jlong tempTableMemory,
     jboolean createDrReplicatedStream,
-    jint compactionThreshold)
+    jint compactionThreshold,
+    jint compactionPauseBudgetMicros,
+    jint hugePages)
 {
     VOLT_DEBUG("nativeInitialize() start");
     VoltDBEngine *engine = castToEngine(enginePtr);
@@ -297,7 +300,9 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeIniti
                            defaultDrBufferSize,
                            tempTableMemory,
                            createDrReplicatedStream,
-                           static_cast<int32_t>(compactionThreshold));
+                           static_cast<int32_t>(compactionThreshold),
+                           static_cast<int64_t>(compactionPauseBudgetMicros),
+                           static_cast<AllocationPolicy::HugePages>(hugePages));
         VOLT_DEBUG("initialize succeeded");
         return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
     }
@@ -860,27 +865,29 @@ Java_org_voltdb_jni_ExecutionEngine_nativeGetStats(JNIEnv *env, jobject obj,
 
 /**
  * Turns on or off profiler.
+ * @param toggle ProfilerToggleBits to turn on; the profilers for the others are turned off.
  * @returns 0 on success.
  */
 SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeToggleProfiler
 (JNIEnv *env, jobject obj, jlong engine_ptr, jint toggle)
 {
     VOLT_DEBUG("nativeToggleProfiler in C++ called");
-// set on build command line via build.py
-#ifdef PROFILE_ENABLED
     VoltDBEngine *engine = castToEngine(engine_ptr);
     updateJNILogProxy(engine); //JNIEnv pointer can change between calls, must be updated
     if (engine) {
-        if (toggle) {
+        engine->setPlanNodeProfiling((toggle & PROFILER_TOGGLE_PLAN_NODES) != 0);
+// set on build command line via build.py
+#ifdef PROFILE_ENABLED
+        if (toggle & PROFILER_TOGGLE_GPERFTOOLS) {
             ProfilerStart("/tmp/gprof.prof");
         }
         else {
             ProfilerStop();
             ProfilerFlush();
         }
+#endif
         return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
     }
-#endif
     return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
 }
 
@@ -1258,6 +1265,26 @@ SHAREDLIB_JNIEXPORT jlong JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeGetT
     return ThreadLocalPool::getPoolAllocationSize();
 }
 
+/*
+ * Class:     org_voltdb_jni_ExecutionEngine
+ * Method:    nativeGetNumaNodeStats
+ * Signature: ()[J
+ */
+SHAREDLIB_JNIEXPORT jlongArray JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeGetNumaNodeStats
+  (JNIEnv *env, jclass) {
+    // Allocated and huge page bytes for each node, then for the unbound buffers.
+    int32_t nodeCount = std::min(ThreadLocalPool::getNumaNodeCount(), ThreadLocalPool::MAX_NUMA_NODES);
+    std::vector<jlong> data;
+    for (int32_t node = 0; node <= nodeCount; ++node) {
+        NumaNodeStats stats = ThreadLocalPool::getNumaNodeStats(node < nodeCount ? node : -1);
+        data.push_back(stats.m_allocatedBytes);
+        data.push_back(stats.m_hugePageBytes);
+    }
+    jlongArray retval = env->NewLongArray(static_cast<jsize>(data.size()));
+    env->SetLongArrayRegion(retval, 0, static_cast<jsize>(data.size()), &data[0]);
+    return retval;
+}
+
 /*
  * Class:     org_voltdb_jni_ExecutionEngine
  * Method:    nativeGetRSS
@@ -36,6 +36,8 @@ public class MemoryStats extends StatsSource {
         long pooledMem = 0;
     }
     Map<Long, PartitionMemRow> m_memoryStats = new TreeMap<Long, PartitionMemRow>();
+    // Process wide, as returned by ExecutionEngine.getNumaNodeStats()
+    long[] m_numaNodeStats = new long[0];
 
     public MemoryStats() {
         super(false);
@@ -82,6 +84,8 @@ public class MemoryStats extends StatsSource {
         columns.add(new VoltTable.ColumnInfo("POOLEDMEMORY", VoltType.BIGINT));
         columns.add(new VoltTable.ColumnInfo("PHYSICALMEMORY", VoltType.BIGINT));
         columns.add(new VoltTable.ColumnInfo("JAVAMAXHEAP", VoltType.INTEGER));
+        columns.add(new VoltTable.ColumnInfo("HUGEPAGEMEMORY", VoltType.BIGINT));
+        columns.add(new VoltTable.ColumnInfo("NUMANODEMEMORY", VoltType.STRING));
     }
 
     @Override
@@ -119,6 +123,24 @@ public class MemoryStats extends StatsSource {
         //in kb to make math simpler with other mem values.
         rowValues[columnNameToIndex.get("PHYSICALMEMORY")] = PlatformProperties.getPlatformProperties().ramInMegabytes * 1024;
         rowValues[columnNameToIndex.get("JAVAMAXHEAP")] = Runtime.getRuntime().maxMemory() / 1024;
+        // EE buffers in huge pages, and the EE buffers on each NUMA node as
+        // "node:kb" pairs, both in kb like the other EE memory values.
+        long hugePageMem = 0;
+        StringBuilder numaNodeMem = new StringBuilder();
+        for (int i = 0; i + 1 < m_numaNodeStats.length; i += 2) {
+            hugePageMem += m_numaNodeStats[i + 1];
+            boolean unbound = i + 2 == m_numaNodeStats.length;
+            if (unbound && m_numaNodeStats[i] == 0) {
+                continue;
+            }
+            if (numaNodeMem.length() > 0) {
+                numaNodeMem.append(',');
+            }
+            numaNodeMem.append(unbound ? "unbound" : String.valueOf(i / 2))
+                       .append(':').append(m_numaNodeStats[i] / 1024);
+        }
+        rowValues[columnNameToIndex.get("HUGEPAGEMEMORY")] = hugePageMem / 1024;
+        rowValues[columnNameToIndex.get("NUMANODEMEMORY")] = numaNodeMem.toString();
         super.updateStatsRow(rowKey, rowValues);
     }
 
@@ -138,4 +160,8 @@ public class MemoryStats extends StatsSource {
         pmr.pooledMem = pooledMemory;
         m_memoryStats.put(siteId, pmr);
     }
+
+    public synchronized void eeUpdateNumaStats(long[] numaNodeStats) {
+        m_numaNodeStats = numaNodeStats;
+    }
 }
@@ -48,5 +48,6 @@ public class TableStats extends SiteStatsSource {
         columns.add(new ColumnInfo("STRING_DATA_MEMORY", VoltType.BIGINT));
         columns.add(new ColumnInfo("TUPLE_LIMIT", VoltType.INTEGER));
         columns.add(new ColumnInfo("PERCENT_FULL", VoltType.INTEGER));
+        columns.add(new ColumnInfo("PERCENT_FRAGMENTED", VoltType.INTEGER));
     }
 }
@@ -1741,8 +1741,11 @@ public class DDLCompiler {
         // - Covering cell index (geo index for CONTAINS predicates)
         // - HASH index (set in HSQL because "hash" is in the name of the
         //   constraint or the index
+        // - BTREE index, a tree index with wide nodes (set in HSQL because
+        //   "btree" is in the name of the constraint or the index)
         // - TREE index, which is the default
         boolean isHashIndex = node.attributes.get("ishashindex").equals("true");
+        boolean isBTreeIndex = "true".equals(node.attributes.get("isbtreeindex"));
         if (has_geo_col) {
             index.setType(IndexType.COVERING_CELL_INDEX.getValue());
         }
@@ -1759,6 +1762,10 @@ public class DDLCompiler {
             }
             index.setType(IndexType.HASH_TABLE.getValue());
         }
+        else if (isBTreeIndex) {
+            index.setType(IndexType.BTREE.getValue());
+            index.setCountable(true);
+        }
         else {
             index.setType(IndexType.BALANCED_TREE.getValue());
             index.setCountable(true);
@@ -1368,6 +1368,7 @@ public class Site implements Runnable, SiteProcedureConnection, SiteSnapshotConn
                                             indexMem,
                                             stringMem,
                                             m_ee.getThreadLocalPoolAllocations());
+                m_memStats.eeUpdateNumaStats(m_ee.getNumaNodeStats());
             }
         }
     }
@@ -726,6 +726,13 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
 
     public abstract long getThreadLocalPoolAllocations();
 
+    /**
+     * Bytes of the EE's large buffers on each NUMA node of this host, and how many of them
+     * are in huge pages: elements 2n and 2n+1 are for node n, and the last pair is for the
+     * buffers not bound to any node. Empty when the EE does not report them.
+     */
+    public abstract long[] getNumaNodeStats();
+
     public abstract byte[] loadTable(
         int tableId, VoltTable table, long txnId, long spHandle,
         long lastCommittedSpHandle, long uniqueId, boolean returnUniqueViolations, boolean shouldDRStream,
@@ -905,7 +912,9 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
             int defaultDrBufferSize,
             long tempTableMemory,
             boolean createDrReplicatedStream,
-            int compactionThreshold);
+            int compactionThreshold,
+            int compactionPauseBudgetMicros,
+            int hugePages);
 
     /**
      * Sets (or re-sets) all the shared direct byte buffers in the EE.
@@ -1054,6 +1063,11 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
      */
     protected static native long nativeGetThreadLocalPoolAllocations();
 
+    /**
+     * Retrieve the process wide per NUMA node buffer totals, see {@link #getNumaNodeStats()}
+     */
+    protected static native long[] nativeGetNumaNodeStats();
+
     /**
      * @param nextUndoToken The undo token to associate with future work
      * @return true for success false for failure
@@ -1762,6 +1762,12 @@ public class ExecutionEngineIPC extends ExecutionEngine {
         }
     }
 
+    @Override
+    public long[] getNumaNodeStats() {
+        // The buffers belong to the EE process, which does not report them.
+        return new long[0];
+    }
+
     @Override
     public byte[] executeTask(TaskType taskType, ByteBuffer task) {
         m_data.clear();
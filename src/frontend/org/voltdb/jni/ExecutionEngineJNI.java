@@ -20,6 +20,7 @@ package org.voltdb.jni;
 import java.io.IOException;
 import java.lang.reflect.InvocationTargetException;
 import java.nio.ByteBuffer;
+import java.util.Arrays;
 import java.util.List;
 
 import org.voltcore.logging.VoltLogger;
@@ -71,6 +72,22 @@ public class ExecutionEngineJNI extends ExecutionEngine {
      */
     public static final int EE_COMPACTION_THRESHOLD;
 
+    /*
+     * How long, in microseconds, each once-a-second tick may spend moving tuples out of
+     * the emptiest blocks of fragmented tables. 0 disables incremental compaction.
+     */
+    public static final int EE_COMPACTION_PAUSE_BUDGET_MICROS;
+
+    /*
+     * Whether the EE backs its tuple blocks and large pool buffers with huge pages: "none",
+     * "transparent" (advise the kernel to use transparent huge pages) or "explicit" (map them
+     * from the hugetlbfs reserve, falling back to normal pages when the reserve runs out).
+     */
+    public static final int EE_HUGE_PAGES;
+
+    // In the order of AllocationPolicy::HugePages in the EE.
+    private static final List<String> HUGE_PAGE_MODES = Arrays.asList("none", "transparent", "explicit");
+
     /** java.util.logging logger. */
     private static final VoltLogger LOG = new VoltLogger("HOST");
 
@@ -85,6 +102,15 @@ public class ExecutionEngineJNI extends ExecutionEngine {
         if (EE_COMPACTION_THRESHOLD < 0 || EE_COMPACTION_THRESHOLD > 99) {
             VoltDB.crashLocalVoltDB("EE_COMPACTION_THRESHOLD " + EE_COMPACTION_THRESHOLD + " is not valid, must be between 0 and 99", false, null);
         }
+        EE_COMPACTION_PAUSE_BUDGET_MICROS = Integer.getInteger("EE_COMPACTION_PAUSE_BUDGET_MICROS", 1000);
+        if (EE_COMPACTION_PAUSE_BUDGET_MICROS < 0) {
+            VoltDB.crashLocalVoltDB("EE_COMPACTION_PAUSE_BUDGET_MICROS " + EE_COMPACTION_PAUSE_BUDGET_MICROS + " is not valid, must not be negative", false, null);
+        }
+        String hugePages = System.getProperty("EE_HUGE_PAGES", "none");
+        EE_HUGE_PAGES = HUGE_PAGE_MODES.indexOf(hugePages.toLowerCase());
+        if (EE_HUGE_PAGES < 0) {
+            VoltDB.crashLocalVoltDB("EE_HUGE_PAGES " + hugePages + " is not valid, must be one of " + HUGE_PAGE_MODES, false, null);
+        }
         HOST_TRACE_ENABLED = LOG.isTraceEnabled();
     }
 
@@ -184,7 +210,9 @@ public class ExecutionEngineJNI extends ExecutionEngine {
                     defaultDrBufferSize,
                     tempTableMemory * 1024 * 1024,
                     isLowestSiteId,
-                    EE_COMPACTION_THRESHOLD);
+                    EE_COMPACTION_THRESHOLD,
+                    EE_COMPACTION_PAUSE_BUDGET_MICROS,
+                    EE_HUGE_PAGES);
         checkErrorCode(errorCode);
 
         setupPsetBuffer(smallBufferSize);
@@ -749,6 +777,11 @@ public class ExecutionEngineJNI extends ExecutionEngine {
         return nativeGetThreadLocalPoolAllocations();
     }
 
+    @Override
+    public long[] getNumaNodeStats() {
+        return nativeGetNumaNodeStats();
+    }
+
     /*
      * Instead of using the reusable output buffer to get results for the next batch,
      * use this buffer allocated by the EE. This is for one time use.
@@ -236,6 +236,11 @@ public class MockExecutionEngine extends ExecutionEngine {
         return 0L;
     }
 
+    @Override
+    public long[] getNumaNodeStats() {
+        return new long[0];
+    }
+
     @Override
     public byte[] executeTask(TaskType taskType, ByteBuffer task) {
         throw new UnsupportedOperationException();
@@ -111,8 +111,8 @@ public class ScanDeterminizer {
             if (index.getUnique() == false) {
                 continue;
             }
-            // skip hash indexes
-            else if (index.getType() != IndexType.BALANCED_TREE.getValue()) {
+            // skip hash and geo indexes
+            else if ( ! IndexType.isScannable(index.getType())) {
                 continue;
             }
             // skip partial indexes
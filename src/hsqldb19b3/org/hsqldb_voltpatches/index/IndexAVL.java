@@ -1688,6 +1688,10 @@ public class IndexAVL implements Index {
         return false;
     }
 
+    private static boolean isNameRequestingBTreeIndex(String name) {
+        return name.toLowerCase().contains("btree");
+    }
+
     /**
      * VoltDB added method to get a non-catalog-dependent
      * representation of this HSQLDB object.
@@ -1727,6 +1731,7 @@ public class IndexAVL implements Index {
         String hsqlIndexName = getName().name;
         String voltdbIndexName = null;
         boolean isHashIndex = false;
+        boolean isBTreeIndex = false;
 
         if (indexConstraintMapping.containsKey(hsqlIndexName)) {
             // This is an index backing a constraint.
@@ -1741,6 +1746,7 @@ public class IndexAVL implements Index {
 
             if (!isAutoName) {
                 isHashIndex = isNameRequestingHashIndex(hsqlConstraintName);
+                isBTreeIndex = isNameRequestingBTreeIndex(hsqlConstraintName);
                 voltdbIndexName = HSQLInterface.AUTO_GEN_NAMED_CONSTRAINT_IDX + hsqlConstraintName;
             }
             else {
@@ -1779,11 +1785,13 @@ public class IndexAVL implements Index {
         else {
             // This is an index created via CREATE INDEX
             isHashIndex = isNameRequestingHashIndex(hsqlIndexName);
+            isBTreeIndex = isNameRequestingBTreeIndex(hsqlIndexName);
             voltdbIndexName = hsqlIndexName;
         }
 
         index.attributes.put("name", voltdbIndexName);
         index.attributes.put("ishashindex", isHashIndex ? "true" : "false");
+        index.attributes.put("isbtreeindex", isBTreeIndex ? "true" : "false");
 
         index.attributes.put("assumeunique", isAssumeUnique() ? "true" : "false");
         index.attributes.put("unique", isUnique() ? "true" : "false");
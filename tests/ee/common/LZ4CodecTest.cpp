@@ -0,0 +1,110 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+
+#include "common/LZ4Codec.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace voltdb;
+
+class LZ4CodecTest : public Test {
+public:
+    // Compress and decompress input, returning true if it comes back unchanged.
+    bool roundTrip(const std::string& input, size_t* compressedSize = NULL) {
+        std::vector<char> compressed(LZ4Codec::compressBound(input.size()));
+        size_t size = LZ4Codec::compress(input.data(), input.size(), compressed.data(), compressed.size());
+        if (size == 0) {
+            return false;
+        }
+        if (compressedSize != NULL) {
+            *compressedSize = size;
+        }
+        std::vector<char> output(input.size() + 1);
+        long outputSize = LZ4Codec::decompress(compressed.data(), size, output.data(), input.size());
+        return outputSize == static_cast<long>(input.size())
+            && std::string(output.data(), outputSize) == input;
+    }
+};
+
+TEST_F(LZ4CodecTest, RoundTrip) {
+    ASSERT_TRUE(roundTrip(""));
+    ASSERT_TRUE(roundTrip("a"));
+    ASSERT_TRUE(roundTrip("abcdefghijkl"));
+    ASSERT_TRUE(roundTrip("abcdefghijklm"));
+
+    size_t compressedSize;
+    std::string repetitive;
+    for (int i = 0; i < 100000; ++i) {
+        repetitive += "row " + std::to_string(i % 100) + ";";
+    }
+    ASSERT_TRUE(roundTrip(repetitive, &compressedSize));
+    ASSERT_TRUE(compressedSize * 10 < repetitive.size());
+
+    std::string run(1 << 20, 'z');
+    ASSERT_TRUE(roundTrip(run, &compressedSize));
+    ASSERT_TRUE(compressedSize < 5000);
+
+    // Random bytes do not compress, but must still fit in the bound.
+    std::string random(1 << 20, '\0');
+    srand(42);
+    for (size_t i = 0; i < random.size(); ++i) {
+        random[i] = static_cast<char>(rand());
+    }
+    ASSERT_TRUE(roundTrip(random, &compressedSize));
+    ASSERT_TRUE(compressedSize <= LZ4Codec::compressBound(random.size()));
+}
+
+TEST_F(LZ4CodecTest, DecompressReferenceBlock) {
+    // One literal and a five byte match one byte back, then five
+    // literals, as any LZ4 block encoder could write them.
+    const char block[] = { 0x11, 'a', 0x01, 0x00, 0x50, 'b', 'b', 'b', 'b', 'b' };
+    char output[32];
+    long size = LZ4Codec::decompress(block, sizeof(block), output, sizeof(output));
+    ASSERT_EQ(11, size);
+    ASSERT_EQ(std::string("aaaaaabbbbb"), std::string(output, size));
+}
+
+TEST_F(LZ4CodecTest, RejectMalformedInput) {
+    char output[32];
+    // A match reaching back before the start of the output.
+    const char badOffset[] = { 0x11, 'a', 0x02, 0x00, 0x00 };
+    ASSERT_EQ(-1, LZ4Codec::decompress(badOffset, sizeof(badOffset), output, sizeof(output)));
+    // A literal run longer than the input.
+    const char truncated[] = { 0x50, 'a', 'b' };
+    ASSERT_EQ(-1, LZ4Codec::decompress(truncated, sizeof(truncated), output, sizeof(output)));
+    // Output larger than the destination.
+    std::string run(1000, 'x');
+    std::vector<char> compressed(LZ4Codec::compressBound(run.size()));
+    size_t size = LZ4Codec::compress(run.data(), run.size(), compressed.data(), compressed.size());
+    ASSERT_EQ(-1, LZ4Codec::decompress(compressed.data(), size, output, sizeof(output)));
+    // Compressing into too small a buffer fails cleanly.
+    ASSERT_TRUE(LZ4Codec::compress(run.data(), run.size(), output, 4) == 0);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -173,6 +173,98 @@ TEST_F(PerFragmentStatsTest, TestPerFragmentStatsBuffer) {
     delete[] planfragmentIds;
 }
 
+TEST_F(PerFragmentStatsTest, TestPlanNodeProfile) {
+    initialize(catalogPayload);
+    fragmentId_t insertPlanId = 100;
+    fragmentId_t selectPlanId = 200;
+    m_topend->addPlan(insertPlanId, anInsertPlan);
+    m_topend->addPlan(selectPlanId, aSelectPlan);
+    fragmentId_t planfragmentIds[4] = { insertPlanId, insertPlanId, insertPlanId, selectPlanId };
+
+    // Profiling is off by default, so nothing is recorded.
+    initParamsBuffer();
+    addParameters(1, 2.3, "string");
+    addParameters(1, 4.5, "string");
+    addParameters(1, 6.7, "string");
+    addParameters(1, 4.0, "str%%");
+    voltdb::ReferenceSerializeInputBE params(m_parameter_buffer.get(), m_smallBufferSize);
+    m_engine->resetPerFragmentStatsOutputBuffer();
+    ASSERT_EQ(0, m_engine->executePlanFragments(4, planfragmentIds, NULL, params, 1000, 1000, 1000, 1000, 1, false));
+    ASSERT_TRUE(m_engine->getStatsManager().getRegisteredCatalogIds(
+            voltdb::STATISTICS_SELECTOR_TYPE_PLANNODE).empty());
+
+    m_engine->setPlanNodeProfiling(true);
+    initParamsBuffer();
+    addParameters(2, 2.3, "string");
+    addParameters(2, 4.5, "string");
+    addParameters(2, 6.7, "string");
+    addParameters(2, 4.0, "str%%");
+    voltdb::ReferenceSerializeInputBE params2(m_parameter_buffer.get(), m_smallBufferSize);
+    m_engine->resetPerFragmentStatsOutputBuffer();
+    ASSERT_EQ(0, m_engine->executePlanFragments(4, planfragmentIds, NULL, params2, 1001, 1001, 1001, 1001, 2, false));
+    m_engine->setPlanNodeProfiling(false);
+
+    ASSERT_EQ(1, m_engine->getStats(voltdb::STATISTICS_SELECTOR_TYPE_PLANNODE, NULL, 0, false, 0));
+    // Every plan node of every fragment is registered under its own id.
+    std::vector<voltdb::CatalogId> allSources = m_engine->getStatsManager().getRegisteredCatalogIds(
+            voltdb::STATISTICS_SELECTOR_TYPE_PLANNODE);
+    ASSERT_EQ(4, allSources.size());
+    voltdb::TempTable* stats = m_engine->getStatsManager().getStats(
+            voltdb::STATISTICS_SELECTOR_TYPE_PLANNODE, 0, 0, allSources, false, 0);
+    ASSERT_EQ(4, stats->activeTupleCount());
+
+    int fragmentCol = stats->columnIndex("PLAN_FRAGMENT_ID");
+    int nodeTypeCol = stats->columnIndex("PLAN_NODE_TYPE");
+    int invocationsCol = stats->columnIndex("INVOCATIONS");
+    int elapsedCol = stats->columnIndex("ELAPSED_NANOS");
+    int tuplesInCol = stats->columnIndex("TUPLES_IN");
+    int tuplesOutCol = stats->columnIndex("TUPLES_OUT");
+    int indexProbesCol = stats->columnIndex("INDEX_PROBES");
+    int nodesSeen = 0;
+    voltdb::TableTuple tuple(stats->schema());
+    voltdb::TableIterator iter = stats->iterator();
+    while (iter.next(tuple)) {
+        int64_t fragmentId = voltdb::ValuePeeker::peekBigInt(tuple.getNValue(fragmentCol));
+        int32_t length = 0;
+        const char* data = voltdb::ValuePeeker::peekObject(tuple.getNValue(nodeTypeCol), &length);
+        std::string nodeType(data, length);
+        int64_t invocations = voltdb::ValuePeeker::peekBigInt(tuple.getNValue(invocationsCol));
+        int64_t tuplesIn = voltdb::ValuePeeker::peekBigInt(tuple.getNValue(tuplesInCol));
+        int64_t tuplesOut = voltdb::ValuePeeker::peekBigInt(tuple.getNValue(tuplesOutCol));
+        ASSERT_TRUE(voltdb::ValuePeeker::peekBigInt(tuple.getNValue(elapsedCol)) > 0);
+        ASSERT_EQ(0, voltdb::ValuePeeker::peekBigInt(tuple.getNValue(indexProbesCol)));
+        if (fragmentId == insertPlanId) {
+            ASSERT_EQ(3, invocations);
+            if (nodeType == "INSERT") {
+                // one materialized row in, one modified tuple count out, per insert
+                ASSERT_EQ(3, tuplesIn);
+                ASSERT_EQ(3, tuplesOut);
+            }
+            else {
+                ASSERT_EQ("MATERIALIZE", nodeType);
+                ASSERT_EQ(3, tuplesOut);
+            }
+        }
+        else {
+            ASSERT_EQ(selectPlanId, fragmentId);
+            ASSERT_EQ(1, invocations);
+            if (nodeType == "SEQSCAN") {
+                // Six rows scanned, the two new ones with b >= 4.0 returned.
+                // A leaf's tuples in is what it reported to the progress
+                // monitor, which includes the rows it emitted.
+                ASSERT_TRUE(tuplesIn >= 6);
+                ASSERT_EQ(2, tuplesOut);
+            }
+            else {
+                ASSERT_EQ("SEND", nodeType);
+                ASSERT_EQ(2, tuplesIn);
+            }
+        }
+        ++nodesSeen;
+    }
+    ASSERT_EQ(4, nodesSeen);
+}
+
 int main() {
      return TestSuite::globalInstance()->runAll();
 }
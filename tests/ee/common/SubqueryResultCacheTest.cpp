@@ -0,0 +1,229 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+
+#include "common/SubqueryResultCache.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "storage/temptable.h"
+#include "storage/TempTableLimits.h"
+
+#include "test_utils/Tools.hpp"
+#include "test_utils/UniqueEngine.hpp"
+
+using namespace voltdb;
+
+class SubqueryResultCacheTest : public Test {
+public:
+    ~SubqueryResultCacheTest() {
+        voltdb::globalDestroyOncePerProcess();
+    }
+
+protected:
+    static TempTable* buildOutputTable(TempTableLimits* limits) {
+        TupleSchema* schema = Tools::buildSchema(VALUE_TYPE_BIGINT,
+                                                 std::make_pair(VALUE_TYPE_VARCHAR, 256));
+        std::vector<std::string> columnNames{"id", "name"};
+        return TableFactory::buildTempTable("OUTPUT", schema, columnNames, limits);
+    }
+
+    // Stands in for an execution of the subquery with the given parameter.
+    static void fillOutputTable(TempTable* table, int64_t param, int rowCount) {
+        table->deleteAllTempTuples();
+        TableTuple& tuple = table->tempTuple();
+        for (int i = 0; i < rowCount; ++i) {
+            Tools::setTupleValues(&tuple, param * 1000 + i, "row for " + std::to_string(param));
+            table->insertTempTuple(tuple);
+        }
+    }
+
+    static std::vector<NValue> params(int64_t param) {
+        return std::vector<NValue>(1, ValueFactory::getBigIntValue(param));
+    }
+
+    static std::string nameOf(const TableTuple& tuple) {
+        int32_t length;
+        const char* name = ValuePeeker::peekObject_withoutNull(tuple.getNValue(1), &length);
+        return std::string(name, length);
+    }
+
+    static bool holdsRowsFor(TempTable* table, int64_t param, int rowCount) {
+        if (table->activeTupleCount() != rowCount) {
+            return false;
+        }
+        TableTuple tuple(table->schema());
+        TableIterator iterator = table->iterator();
+        int i = 0;
+        while (iterator.next(tuple)) {
+            if (ValuePeeker::peekBigInt(tuple.getNValue(0)) != param * 1000 + i ||
+                nameOf(tuple) != "row for " + std::to_string(param)) {
+                return false;
+            }
+            ++i;
+        }
+        return true;
+    }
+};
+
+TEST_F(SubqueryResultCacheTest, RestoresEarlierResults)
+{
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    TempTableLimits limits;
+    std::unique_ptr<TempTable> output(buildOutputTable(&limits));
+    SubqueryResultCache cache;
+
+    // Outer rows arrive out of correlation key order: 1, 2, 3, 1, 3, 2.
+    for (int64_t param = 1; param <= 3; ++param) {
+        ASSERT_FALSE(cache.restore(params(param), output.get()));
+        fillOutputTable(output.get(), param, static_cast<int>(param));
+        ASSERT_TRUE(cache.store(params(param), output.get()));
+    }
+    EXPECT_EQ(3, cache.entryCount());
+    EXPECT_EQ(limits.getMemoryLimit() / SubqueryResultCache::MEMORY_LIMIT_DIVISOR, cache.memoryCap());
+
+    int64_t revisits[] = { 1, 3, 2 };
+    for (int i = 0; i < 3; ++i) {
+        // Overwrite the output as the last execution would have left it.
+        fillOutputTable(output.get(), 99, 5);
+        ASSERT_TRUE(cache.restore(params(revisits[i]), output.get()));
+        ASSERT_TRUE(holdsRowsFor(output.get(), revisits[i], static_cast<int>(revisits[i])));
+    }
+    EXPECT_EQ(3, cache.entryCount());
+}
+
+TEST_F(SubqueryResultCacheTest, CopiesNonInlinedValues)
+{
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    std::unique_ptr<TempTable> output(buildOutputTable(NULL));
+    SubqueryResultCache cache;
+
+    fillOutputTable(output.get(), 7, 3);
+    ASSERT_TRUE(cache.store(params(7), output.get()));
+    // The cached rows must not depend on the output table's storage.
+    fillOutputTable(output.get(), 8, 3);
+    ASSERT_TRUE(cache.restore(params(7), output.get()));
+    ASSERT_TRUE(holdsRowsFor(output.get(), 7, 3));
+
+    // Unhashable parameter types are never cached.
+    std::vector<NValue> booleanParams(1, ValueFactory::getBooleanValue(true));
+    EXPECT_FALSE(cache.store(booleanParams, output.get()));
+    EXPECT_EQ(SubqueryResultCache::DEFAULT_MEMORY_CAP, cache.memoryCap());
+}
+
+TEST_F(SubqueryResultCacheTest, EvictsLeastRecentlyUsed)
+{
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    TempTableLimits limits;
+    std::unique_ptr<TempTable> output(buildOutputTable(&limits));
+    // A cap that fits a few of the 10-row results below.
+    SubqueryResultCache cache(4000);
+
+    fillOutputTable(output.get(), 0, 10);
+    ASSERT_TRUE(cache.store(params(0), output.get()));
+    int64_t entryBytes = cache.allocated();
+    ASSERT_TRUE(entryBytes > 0);
+    size_t capacity = static_cast<size_t>(cache.memoryCap() / entryBytes);
+    ASSERT_TRUE(capacity >= 2);
+
+    for (int64_t param = 1; param <= static_cast<int64_t>(capacity); ++param) {
+        // Keep the first result in use so that it is not the one evicted.
+        ASSERT_TRUE(cache.restore(params(0), output.get()));
+        fillOutputTable(output.get(), param, 10);
+        ASSERT_TRUE(cache.store(params(param), output.get()));
+        ASSERT_TRUE(cache.allocated() <= cache.memoryCap());
+    }
+    // One more result was stored than fits, so one was evicted.
+    EXPECT_EQ(capacity, cache.entryCount());
+    // Result 1 was the least recently used.
+    EXPECT_FALSE(cache.restore(params(1), output.get()));
+    EXPECT_TRUE(cache.restore(params(0), output.get()));
+    EXPECT_TRUE(holdsRowsFor(output.get(), 0, 10));
+
+    // A result bigger than the whole cap is not cached.
+    fillOutputTable(output.get(), 100, static_cast<int>(capacity + 1) * 10);
+    EXPECT_FALSE(cache.store(params(100), output.get()));
+
+    cache.clear();
+    EXPECT_EQ(0, cache.entryCount());
+    EXPECT_EQ(0, cache.allocated());
+}
+
+TEST_F(SubqueryResultCacheTest, ChargesTempTableLimits)
+{
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    TempTableLimits limits;
+    std::unique_ptr<TempTable> output(buildOutputTable(&limits));
+    int64_t tableBytes;
+    {
+        SubqueryResultCache cache(4000);
+        int evictions = 0;
+        for (int64_t param = 0; evictions < 2; ++param) {
+            fillOutputTable(output.get(), param, 10);
+            int64_t before = limits.getAllocated();
+            int64_t cached = cache.allocated();
+            size_t entries = cache.entryCount();
+            ASSERT_TRUE(cache.store(params(param), output.get()));
+            // Evicted results give their memory back.
+            EXPECT_EQ(before + cache.allocated() - cached, limits.getAllocated());
+            if (cache.entryCount() <= entries) {
+                ++evictions;
+            }
+        }
+
+        int64_t before = limits.getAllocated();
+        int64_t cached = cache.allocated();
+        ASSERT_TRUE(cached > 0);
+        cache.clear();
+        EXPECT_EQ(before - cached, limits.getAllocated());
+
+        fillOutputTable(output.get(), 0, 10);
+        tableBytes = limits.getAllocated();
+        ASSERT_TRUE(cache.store(params(0), output.get()));
+        EXPECT_EQ(tableBytes + cache.allocated(), limits.getAllocated());
+    }
+    // So does a cache that goes away.
+    EXPECT_EQ(tableBytes, limits.getAllocated());
+
+    // A result that fits under the cap but not in what is left of the
+    // temp table memory limit is not cached.
+    TempTableLimits tightLimits(tableBytes + 100);
+    std::unique_ptr<TempTable> tightOutput(buildOutputTable(&tightLimits));
+    fillOutputTable(tightOutput.get(), 0, 10);
+    ASSERT_EQ(tableBytes, tightLimits.getAllocated());
+    SubqueryResultCache tightCache(4000);
+    EXPECT_FALSE(tightCache.store(params(0), tightOutput.get()));
+    EXPECT_EQ(0, tightCache.entryCount());
+    EXPECT_EQ(tableBytes, tightLimits.getAllocated());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -50,7 +50,9 @@
  */
 
 #include "harness.h"
+#include "common/ThreadLocalPool.h"
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 using namespace std;
@@ -67,6 +69,17 @@ class ThreadLocalPoolTest : public Test {
 public:
     ThreadLocalPoolTest() {};
 
+    void expectPackedRoundTrip(const voltdb::BlockAllocation& block)
+    {
+        voltdb::BlockAllocation unpacked = voltdb::ThreadLocalPool::unpackBlockAllocation(
+                block.m_address, voltdb::ThreadLocalPool::packBlockAllocation(block));
+        EXPECT_EQ(block.m_address, unpacked.m_address);
+        EXPECT_EQ(block.m_bytes, unpacked.m_bytes);
+        EXPECT_EQ(block.m_mappedBytes, unpacked.m_mappedBytes);
+        EXPECT_EQ(block.m_numaNode, unpacked.m_numaNode);
+        EXPECT_EQ(block.m_hugePages, unpacked.m_hugePages);
+    }
+
     void validateDeltas(int input, int testcase,
                         int byte_increment, int percent_increment)
     {
@@ -159,6 +172,85 @@ TEST_F(ThreadLocalPoolTest, AllocationSizingRandom)
     }
 }
 
+TEST_F(ThreadLocalPoolTest, DefaultPolicyUsesHeap)
+{
+    ASSERT_TRUE(voltdb::ThreadLocalPool::getAllocationPolicy().isDefault());
+    int64_t unboundBefore = voltdb::ThreadLocalPool::getNumaNodeStats(-1).m_allocatedBytes;
+    voltdb::BlockAllocation block =
+            voltdb::ThreadLocalPool::allocateBlock(voltdb::ThreadLocalPool::HUGE_PAGE_SIZE);
+    ASSERT_TRUE(block.m_address != NULL);
+    ASSERT_EQ(0, block.m_mappedBytes);
+    ASSERT_EQ(-1, block.m_numaNode);
+    ASSERT_FALSE(block.m_hugePages);
+    ASSERT_EQ(unboundBefore + static_cast<int64_t>(voltdb::ThreadLocalPool::HUGE_PAGE_SIZE),
+              voltdb::ThreadLocalPool::getNumaNodeStats(-1).m_allocatedBytes);
+    expectPackedRoundTrip(block);
+    voltdb::ThreadLocalPool::freeBlock(block);
+    ASSERT_EQ(unboundBefore, voltdb::ThreadLocalPool::getNumaNodeStats(-1).m_allocatedBytes);
+    ASSERT_TRUE(voltdb::ThreadLocalPool::getNumaNodeCount() >= 1);
+}
+
+TEST_F(ThreadLocalPoolTest, PlacedBlocks)
+{
+    int32_t node = voltdb::ThreadLocalPool::getCurrentNumaNode();
+    if (node < 0) {
+        node = 0;
+    }
+    const std::size_t hugePage = voltdb::ThreadLocalPool::HUGE_PAGE_SIZE;
+    voltdb::AllocationPolicy::HugePages modes[] = { voltdb::AllocationPolicy::HUGE_PAGES_NONE,
+                                                    voltdb::AllocationPolicy::HUGE_PAGES_TRANSPARENT,
+                                                    voltdb::AllocationPolicy::HUGE_PAGES_EXPLICIT };
+    for (int i = 0; i < 3; ++i) {
+        voltdb::ThreadLocalPool::setAllocationPolicy(voltdb::AllocationPolicy(node, modes[i]));
+
+        // Small buffers are left to the heap.
+        voltdb::BlockAllocation small = voltdb::ThreadLocalPool::allocateBlock(4096);
+        ASSERT_TRUE(small.m_address != NULL);
+        ASSERT_EQ(0, small.m_mappedBytes);
+        voltdb::ThreadLocalPool::freeBlock(small);
+
+        int64_t nodeBefore = voltdb::ThreadLocalPool::getNumaNodeStats(node).m_allocatedBytes;
+        int64_t unboundBefore = voltdb::ThreadLocalPool::getNumaNodeStats(-1).m_allocatedBytes;
+        voltdb::BlockAllocation block = voltdb::ThreadLocalPool::allocateBlock(hugePage);
+        ASSERT_TRUE(block.m_address != NULL);
+        ASSERT_EQ(hugePage, block.m_mappedBytes);
+        // The binding may be refused (e.g. inside a container) but the
+        // buffer is then counted as unbound.
+        ASSERT_TRUE(block.m_numaNode == node || block.m_numaNode == -1);
+        if (block.m_numaNode == node) {
+            ASSERT_EQ(nodeBefore + static_cast<int64_t>(hugePage),
+                      voltdb::ThreadLocalPool::getNumaNodeStats(node).m_allocatedBytes);
+        }
+        else {
+            ASSERT_EQ(unboundBefore + static_cast<int64_t>(hugePage),
+                      voltdb::ThreadLocalPool::getNumaNodeStats(-1).m_allocatedBytes);
+        }
+        if (modes[i] == voltdb::AllocationPolicy::HUGE_PAGES_NONE) {
+            ASSERT_FALSE(block.m_hugePages);
+        }
+        if (modes[i] == voltdb::AllocationPolicy::HUGE_PAGES_TRANSPARENT) {
+            ASSERT_EQ(0, reinterpret_cast<uintptr_t>(block.m_address) % hugePage);
+        }
+        ::memset(block.m_address, 0x5a, hugePage);
+        ASSERT_EQ(0x5a, block.m_address[hugePage - 1]);
+        expectPackedRoundTrip(block);
+        voltdb::ThreadLocalPool::freeBlock(block);
+        ASSERT_EQ(nodeBefore, voltdb::ThreadLocalPool::getNumaNodeStats(node).m_allocatedBytes);
+        ASSERT_EQ(unboundBefore, voltdb::ThreadLocalPool::getNumaNodeStats(-1).m_allocatedBytes);
+
+        // A buffer just past a huge page would waste most of a second
+        // one, so it gets normal pages.
+        block = voltdb::ThreadLocalPool::allocateBlock(hugePage + 64);
+        ASSERT_TRUE(block.m_address != NULL);
+        ASSERT_FALSE(block.m_hugePages);
+        ASSERT_TRUE(block.m_mappedBytes < 2 * hugePage);
+        expectPackedRoundTrip(block);
+        voltdb::ThreadLocalPool::freeBlock(block);
+    }
+    voltdb::ThreadLocalPool::setAllocationPolicy(voltdb::AllocationPolicy());
+    ASSERT_EQ(0, voltdb::ThreadLocalPool::getNumaNodeStats(voltdb::ThreadLocalPool::MAX_NUMA_NODES).m_allocatedBytes);
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
@@ -0,0 +1,208 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Reports how NValue's DECIMAL operators and DecimalSum compare with the
+ * ttmath computations they used for every operand before they had a
+ * native 128-bit path.  nvalue_test checks that both agree; this only
+ * times them.
+ *
+ * It does nothing unless given a number of passes over the operands,
+ * e.g. "decimal_benchmark 200".
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "boost/foreach.hpp"
+
+#include "harness.h"
+#include "common/NValue.hpp"
+#include "common/ThreadLocalPool.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+
+using namespace voltdb;
+
+static const int64_t scale = 1000000000000;
+static int passes = 0;
+
+class DecimalBenchmark : public Test {
+    ThreadLocalPool m_pool;
+};
+
+namespace {
+
+bool decimalOutOfRange(const TTInt& value) {
+    static const TTInt maxDecimal("99999999999999999999999999999999999999");
+    static const TTInt minDecimal("-99999999999999999999999999999999999999");
+    return value > maxDecimal || value < minDecimal;
+}
+
+/*
+ * The ttmath computations that NValue's DECIMAL operators used for every
+ * operand before they had a native 128-bit path.  Each returns false where
+ * the operator must throw.
+ */
+bool referenceDecimalSum(const TTInt& lhs, const TTInt& rhs, TTInt& result) {
+    result = lhs;
+    return result.Add(rhs) == 0 && ! decimalOutOfRange(result);
+}
+
+bool referenceDecimalDifference(const TTInt& lhs, const TTInt& rhs, TTInt& result) {
+    result = lhs;
+    return result.Sub(rhs) == 0 && ! decimalOutOfRange(result);
+}
+
+bool referenceDecimalProduct(const TTInt& lhs, const TTInt& rhs, TTInt& result) {
+    TTLInt calc;
+    calc.FromInt(lhs);
+    calc *= rhs;
+    calc /= scale;
+    return result.FromInt(calc) == 0 && ! decimalOutOfRange(result);
+}
+
+bool referenceDecimalQuotient(const TTInt& lhs, const TTInt& rhs, TTInt& result) {
+    TTLInt calc;
+    calc.FromInt(lhs);
+    calc *= scale;
+    if (calc.Div(rhs)) {
+        return false;
+    }
+    return result.FromInt(calc) == 0 && ! decimalOutOfRange(result);
+}
+
+/**
+ * Deterministic DECIMAL operands of mixed sign and magnitude: from a few
+ * cents up to values whose products need ttmath's 256-bit intermediates.
+ */
+std::vector<NValue> decimalOperands(int count) {
+    static const char* const wholeParts[] = {
+        "0", "1", "12", "987", "43210", "3141592", "271828182845",
+        "99999999999999", "12345678901234567890", "99999999999999999999999999"
+    };
+    static const size_t wholePartCount = sizeof(wholeParts) / sizeof(wholeParts[0]);
+    std::vector<NValue> operands;
+    uint64_t seed = 0x5DEECE66DULL;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::ostringstream text;
+        if (seed & 1) {
+            text << "-";
+        }
+        text << wholeParts[(seed >> 8) % wholePartCount] << "." << ((seed >> 20) % 1000000000000ULL);
+        operands.push_back(ValueFactory::getDecimalValueFromString(text.str()));
+    }
+    return operands;
+}
+
+int64_t nanosBetween(std::chrono::high_resolution_clock::time_point start,
+                     std::chrono::high_resolution_clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+}
+
+TEST_F(DecimalBenchmark, Arithmetic)
+{
+    std::vector<NValue> operands;
+    std::vector<NValue> all = decimalOperands(2000);
+    BOOST_FOREACH (const NValue& operand, all) {
+        if (ValuePeeker::peekDecimal(operand) < TTInt(scale) * 100000000 &&
+                ValuePeeker::peekDecimal(operand) > TTInt(scale) * -100000000 &&
+                ! ValuePeeker::peekDecimal(operand).IsZero()) {
+            operands.push_back(operand);
+        }
+    }
+    ASSERT_TRUE(operands.size() > 100);
+
+    typedef NValue (NValue::*Operator)(const NValue&) const;
+    typedef bool (*Reference)(const TTInt&, const TTInt&, TTInt&);
+    const char* const names[] = { "add", "subtract", "multiply", "divide" };
+    Operator operators[] = { &NValue::op_add, &NValue::op_subtract, &NValue::op_multiply, &NValue::op_divide };
+    Reference references[] = { &referenceDecimalSum, &referenceDecimalDifference,
+                               &referenceDecimalProduct, &referenceDecimalQuotient };
+
+    for (int op = 0; op < 4; ++op) {
+        TTInt check(0);
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t i = 1; i < operands.size(); ++i) {
+                TTInt result;
+                references[op](ValuePeeker::peekDecimal(operands[i - 1]),
+                               ValuePeeker::peekDecimal(operands[i]), result);
+                check += result;
+            }
+        }
+        std::chrono::high_resolution_clock::time_point middle = std::chrono::high_resolution_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t i = 1; i < operands.size(); ++i) {
+                check -= ValuePeeker::peekDecimal((operands[i - 1].*operators[op])(operands[i]));
+            }
+        }
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+        ASSERT_TRUE(check.IsZero());
+
+        double ops = static_cast<double>(passes) * static_cast<double>(operands.size() - 1);
+        double ttmathNanos = static_cast<double>(nanosBetween(start, middle)) / ops;
+        double operatorNanos = static_cast<double>(nanosBetween(middle, end)) / ops;
+        std::cout << "DECIMAL " << names[op] << ": ttmath " << ttmathNanos
+                  << " ns/op, op_" << names[op] << " " << operatorNanos << " ns/op" << std::endl;
+    }
+
+    NValue::DecimalSum sum;
+    NValue total = ValueFactory::getDecimalValueFromString("0");
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        BOOST_FOREACH (const NValue& operand, operands) {
+            total = total.op_add(operand);
+        }
+    }
+    std::chrono::high_resolution_clock::time_point middle = std::chrono::high_resolution_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        BOOST_FOREACH (const NValue& operand, operands) {
+            sum.add(operand);
+        }
+    }
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    ASSERT_EQ(0, sum.value().compare(total));
+    double adds = static_cast<double>(passes) * static_cast<double>(operands.size());
+    std::cout << "DECIMAL SUM: op_add " << static_cast<double>(nanosBetween(start, middle)) / adds
+              << " ns/row, DecimalSum " << static_cast<double>(nanosBetween(middle, end)) / adds
+              << " ns/row" << std::endl;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc <= 1 || *argv[1] == '-') {
+        printf("To run the benchmark, execute %s with a number of passes over the operands.\n",
+               argv[0]);
+        return 0;
+    }
+    passes = std::atoi(argv[1]);
+    return TestSuite::globalInstance()->runAll();
+}
@@ -32,8 +32,12 @@
 #include "expressions/constantvalueexpression.h"
 
 #include <cfloat>
+#include <iostream>
 #include <limits>
+#include <sstream>
+#include <vector>
 
+#include "boost/foreach.hpp"
 #include "boost/scoped_ptr.hpp"
 
 using namespace std;
@@ -1950,6 +1954,176 @@ TEST_F(NValueTest, DecimalQuotients) {
    }
 }
 
+namespace {
+
+bool decimalOutOfRange(const TTInt& value) {
+    static const TTInt maxDecimal("99999999999999999999999999999999999999");
+    static const TTInt minDecimal("-99999999999999999999999999999999999999");
+    return value > maxDecimal || value < minDecimal;
+}
+
+/*
+ * The ttmath computations that NValue's DECIMAL operators used for every
+ * operand before they had a native 128-bit path.  Each returns false where
+ * the operator must throw.
+ */
+bool referenceDecimalSum(const TTInt& lhs, const TTInt& rhs, TTInt& result) {
+    result = lhs;
+    return result.Add(rhs) == 0 && ! decimalOutOfRange(result);
+}
+
+bool referenceDecimalDifference(const TTInt& lhs, const TTInt& rhs, TTInt& result) {
+    result = lhs;
+    return result.Sub(rhs) == 0 && ! decimalOutOfRange(result);
+}
+
+bool referenceDecimalProduct(const TTInt& lhs, const TTInt& rhs, TTInt& result) {
+    TTLInt calc;
+    calc.FromInt(lhs);
+    calc *= rhs;
+    calc /= scale;
+    return result.FromInt(calc) == 0 && ! decimalOutOfRange(result);
+}
+
+bool referenceDecimalQuotient(const TTInt& lhs, const TTInt& rhs, TTInt& result) {
+    TTLInt calc;
+    calc.FromInt(lhs);
+    calc *= scale;
+    if (calc.Div(rhs)) {
+        return false;
+    }
+    return result.FromInt(calc) == 0 && ! decimalOutOfRange(result);
+}
+
+/**
+ * Deterministic DECIMAL operands of mixed sign and magnitude: from a few
+ * cents up to values whose products need ttmath's 256-bit intermediates.
+ */
+std::vector<NValue> decimalOperands(int count) {
+    static const char* const wholeParts[] = {
+        "0", "1", "12", "987", "43210", "3141592", "271828182845",
+        "99999999999999", "12345678901234567890", "99999999999999999999999999"
+    };
+    static const size_t wholePartCount = sizeof(wholeParts) / sizeof(wholeParts[0]);
+    std::vector<NValue> operands;
+    uint64_t seed = 0x5DEECE66DULL;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::ostringstream text;
+        if (seed & 1) {
+            text << "-";
+        }
+        text << wholeParts[(seed >> 8) % wholePartCount] << "." << ((seed >> 20) % 1000000000000ULL);
+        operands.push_back(ValueFactory::getDecimalValueFromString(text.str()));
+    }
+    return operands;
+}
+
+/** Apply an NValue operator, returning false if it throws. */
+template<typename Op>
+bool applyDecimalOperator(Op op, const NValue& lhs, const NValue& rhs, TTInt& result) {
+    try {
+        result = ValuePeeker::peekDecimal((lhs.*op)(rhs));
+    }
+    catch (const SQLException&) {
+        return false;
+    }
+    return true;
+}
+
+}
+
+TEST_F(NValueTest, DecimalArithmeticMatchesTTMath)
+{
+    std::vector<NValue> operands = decimalOperands(400);
+    // Some exact edges of the DECIMAL range and of the native fast path.
+    operands.push_back(ValueFactory::getDecimalValueFromString("99999999999999999999999999.999999999999"));
+    operands.push_back(ValueFactory::getDecimalValueFromString("-99999999999999999999999999.999999999999"));
+    operands.push_back(ValueFactory::getDecimalValueFromString("0"));
+    operands.push_back(ValueFactory::getDecimalValueFromString("0.000000000001"));
+    operands.push_back(ValueFactory::getDecimalValueFromString("-0.000000000001"));
+    operands.push_back(ValueFactory::getDecimalValueFromString("170141183.460469231731"));
+
+    int64_t checked = 0;
+    int64_t outOfRange = 0;
+    for (size_t i = 0; i < operands.size(); ++i) {
+        for (size_t j = 0; j < operands.size(); j += 7) {
+            const NValue& lhs = operands[i];
+            const NValue& rhs = operands[j];
+            const TTInt& lhsDecimal = ValuePeeker::peekDecimal(lhs);
+            const TTInt& rhsDecimal = ValuePeeker::peekDecimal(rhs);
+            TTInt expected;
+            TTInt actual;
+
+            bool expectedOk = referenceDecimalSum(lhsDecimal, rhsDecimal, expected);
+            ASSERT_EQ(expectedOk, applyDecimalOperator(&NValue::op_add, lhs, rhs, actual));
+            if (expectedOk) {
+                ASSERT_EQ(expected, actual);
+            }
+
+            expectedOk = referenceDecimalDifference(lhsDecimal, rhsDecimal, expected);
+            ASSERT_EQ(expectedOk, applyDecimalOperator(&NValue::op_subtract, lhs, rhs, actual));
+            if (expectedOk) {
+                ASSERT_EQ(expected, actual);
+            }
+
+            expectedOk = referenceDecimalProduct(lhsDecimal, rhsDecimal, expected);
+            ASSERT_EQ(expectedOk, applyDecimalOperator(&NValue::op_multiply, lhs, rhs, actual));
+            if (expectedOk) {
+                ASSERT_EQ(expected, actual);
+            }
+            else {
+                ++outOfRange;
+            }
+
+            expectedOk = referenceDecimalQuotient(lhsDecimal, rhsDecimal, expected);
+            ASSERT_EQ(expectedOk, applyDecimalOperator(&NValue::op_divide, lhs, rhs, actual));
+            if (expectedOk) {
+                ASSERT_EQ(expected, actual);
+            }
+            checked += 4;
+        }
+    }
+    // Both the fast path and the ttmath fallback were exercised.
+    ASSERT_TRUE(outOfRange > 0);
+    ASSERT_TRUE(outOfRange * 4 < checked);
+}
+
+TEST_F(NValueTest, DecimalSumAccumulator)
+{
+    std::vector<NValue> operands = decimalOperands(1000);
+    NValue::DecimalSum sum;
+    NValue expected = ValueFactory::getDecimalValueFromString("0");
+    int64_t added = 0;
+    BOOST_FOREACH (const NValue& operand, operands) {
+        TTInt next;
+        if ( ! referenceDecimalSum(ValuePeeker::peekDecimal(expected),
+                                   ValuePeeker::peekDecimal(operand), next)) {
+            // The running total would leave the DECIMAL range.
+            bool caughtException = false;
+            try {
+                sum.add(operand);
+            }
+            catch (const SQLException&) {
+                caughtException = true;
+            }
+            ASSERT_TRUE(caughtException);
+            continue;
+        }
+        sum.add(operand);
+        expected = expected.op_add(operand);
+        ASSERT_EQ(0, sum.value().compare(expected));
+        ++added;
+    }
+    ASSERT_TRUE(added > 0);
+
+    sum.reset();
+    ASSERT_EQ(0, sum.value().compare(ValueFactory::getDecimalValueFromString("0")));
+    sum.add(ValueFactory::getDecimalValueFromString("-12.5"));
+    sum.add(ValueFactory::getDecimalValueFromString("0.000000000001"));
+    ASSERT_EQ("-12.499999999999", ValuePeeker::peekDecimalString(sum.value()));
+}
+
 TEST_F(NValueTest, SerializeToExport)
 {
     // test basic nvalue elt serialization. Note that
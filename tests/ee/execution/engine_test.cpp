@@ -67,6 +67,7 @@
 
 #include <cstdlib>
 #include <ctime>
+#include <set>
 #include <unistd.h>
 #include <boost/shared_ptr.hpp>
 
@@ -588,6 +589,340 @@ TEST_F(ExecutionEngineTest, Execute_PlanFragmentInfo) {
     }
 }
 
+namespace {
+// SELECT R.R_CUSTOMERID, D.D_CUSTOMERID
+//   FROM R_CUSTOMER R, D_CUSTOMER D WHERE D.D_CUSTOMERID = R.R_CUSTOMERID;
+// as a nested loop index join that probes the primary key of D_CUSTOMER.
+std::string nestLoopIndexPlan =
+        "{\n"
+        "    \"EXECUTE_LIST\": [3, 2, 1],\n"
+        "    \"PLAN_NODES\": [\n"
+        "        {\n"
+        "            \"CHILDREN_IDS\": [2],\n"
+        "            \"ID\": 1,\n"
+        "            \"PLAN_NODE_TYPE\": \"SEND\"\n"
+        "        },\n"
+        "        {\n"
+        "            \"CHILDREN_IDS\": [3],\n"
+        "            \"ID\": 2,\n"
+        "            \"INLINE_NODES\": [{\n"
+        "                \"ID\": 4,\n"
+        "                \"INLINE_NODES\": [{\n"
+        "                    \"ID\": 6,\n"
+        "                    \"OUTPUT_SCHEMA\": [{\n"
+        "                        \"COLUMN_NAME\": \"D_CUSTOMERID\",\n"
+        "                        \"EXPRESSION\": {\n"
+        "                            \"COLUMN_IDX\": 0,\n"
+        "                            \"TYPE\": 32,\n"
+        "                            \"VALUE_TYPE\": 5\n"
+        "                        }\n"
+        "                    }],\n"
+        "                    \"PLAN_NODE_TYPE\": \"PROJECTION\"\n"
+        "                }],\n"
+        "                \"LOOKUP_TYPE\": \"EQ\",\n"
+        "                \"PLAN_NODE_TYPE\": \"INDEXSCAN\",\n"
+        "                \"SEARCHKEY_EXPRESSIONS\": [{\n"
+        "                    \"COLUMN_IDX\": 0,\n"
+        "                    \"TYPE\": 32,\n"
+        "                    \"VALUE_TYPE\": 5\n"
+        "                }],\n"
+        "                \"COMPARE_NOTDISTINCT\": [false],\n"
+        "                \"SORT_DIRECTION\": \"INVALID\",\n"
+        "                \"TARGET_INDEX_NAME\": \"VOLTDB_AUTOGEN_IDX_PK_D_CUSTOMER_D_CUSTOMERID\",\n"
+        "                \"TARGET_TABLE_ALIAS\": \"D_CUSTOMER\",\n"
+        "                \"TARGET_TABLE_NAME\": \"D_CUSTOMER\"\n"
+        "            }],\n"
+        "            \"JOIN_TYPE\": \"INNER\",\n"
+        "            \"OUTPUT_SCHEMA\": [\n"
+        "                {\n"
+        "                    \"COLUMN_NAME\": \"R_CUSTOMERID\",\n"
+        "                    \"EXPRESSION\": {\n"
+        "                        \"COLUMN_IDX\": 0,\n"
+        "                        \"TYPE\": 32,\n"
+        "                        \"VALUE_TYPE\": 5\n"
+        "                    }\n"
+        "                },\n"
+        "                {\n"
+        "                    \"COLUMN_NAME\": \"D_CUSTOMERID\",\n"
+        "                    \"EXPRESSION\": {\n"
+        "                        \"COLUMN_IDX\": 0,\n"
+        "                        \"TABLE_IDX\": 1,\n"
+        "                        \"TYPE\": 32,\n"
+        "                        \"VALUE_TYPE\": 5\n"
+        "                    }\n"
+        "                }\n"
+        "            ],\n"
+        "            \"PLAN_NODE_TYPE\": \"NESTLOOPINDEX\"\n"
+        "        },\n"
+        "        {\n"
+        "            \"ID\": 3,\n"
+        "            \"INLINE_NODES\": [{\n"
+        "                \"ID\": 5,\n"
+        "                \"OUTPUT_SCHEMA\": [{\n"
+        "                    \"COLUMN_NAME\": \"R_CUSTOMERID\",\n"
+        "                    \"EXPRESSION\": {\n"
+        "                        \"COLUMN_IDX\": 0,\n"
+        "                        \"TYPE\": 32,\n"
+        "                        \"VALUE_TYPE\": 5\n"
+        "                    }\n"
+        "                }],\n"
+        "                \"PLAN_NODE_TYPE\": \"PROJECTION\"\n"
+        "            }],\n"
+        "            \"OUTPUT_SCHEMA\": [{\n"
+        "                \"COLUMN_NAME\": \"R_CUSTOMERID\",\n"
+        "                \"EXPRESSION\": {\n"
+        "                    \"COLUMN_IDX\": 0,\n"
+        "                    \"TYPE\": 32,\n"
+        "                    \"VALUE_TYPE\": 5\n"
+        "                }\n"
+        "            }],\n"
+        "            \"PLAN_NODE_TYPE\": \"SEQSCAN\",\n"
+        "            \"TARGET_TABLE_ALIAS\": \"R_CUSTOMER\",\n"
+        "            \"TARGET_TABLE_NAME\": \"R_CUSTOMER\"\n"
+        "        }\n"
+        "    ]\n"
+        "}\n";
+
+// SELECT R_CUSTOMERID, R_CUSTOMERID + R_CUSTOMERID FROM R_CUSTOMER LIMIT 10 OFFSET 5;
+// with the projection and limit as separate plan nodes, so that both can
+// be pipelined.
+std::string projectionLimitPlan =
+        "{\n"
+        "    \"EXECUTE_LIST\": [4, 3, 2, 1],\n"
+        "    \"PLAN_NODES\": [\n"
+        "        {\n"
+        "            \"CHILDREN_IDS\": [2],\n"
+        "            \"ID\": 1,\n"
+        "            \"PLAN_NODE_TYPE\": \"SEND\"\n"
+        "        },\n"
+        "        {\n"
+        "            \"CHILDREN_IDS\": [3],\n"
+        "            \"ID\": 2,\n"
+        "            \"LIMIT\": 10,\n"
+        "            \"OFFSET\": 5,\n"
+        "            \"PLAN_NODE_TYPE\": \"LIMIT\"\n"
+        "        },\n"
+        "        {\n"
+        "            \"CHILDREN_IDS\": [4],\n"
+        "            \"ID\": 3,\n"
+        "            \"OUTPUT_SCHEMA\": [\n"
+        "                {\n"
+        "                    \"COLUMN_NAME\": \"R_CUSTOMERID\",\n"
+        "                    \"EXPRESSION\": {\n"
+        "                        \"COLUMN_IDX\": 0,\n"
+        "                        \"TYPE\": 32,\n"
+        "                        \"VALUE_TYPE\": 5\n"
+        "                    }\n"
+        "                },\n"
+        "                {\n"
+        "                    \"COLUMN_NAME\": \"TWICE\",\n"
+        "                    \"EXPRESSION\": {\n"
+        "                        \"LEFT\": {\n"
+        "                            \"COLUMN_IDX\": 0,\n"
+        "                            \"TYPE\": 32,\n"
+        "                            \"VALUE_TYPE\": 5\n"
+        "                        },\n"
+        "                        \"RIGHT\": {\n"
+        "                            \"COLUMN_IDX\": 0,\n"
+        "                            \"TYPE\": 32,\n"
+        "                            \"VALUE_TYPE\": 5\n"
+        "                        },\n"
+        "                        \"TYPE\": 1,\n"
+        "                        \"VALUE_TYPE\": 6\n"
+        "                    }\n"
+        "                }\n"
+        "            ],\n"
+        "            \"PLAN_NODE_TYPE\": \"PROJECTION\"\n"
+        "        },\n"
+        "        {\n"
+        "            \"ID\": 4,\n"
+        "            \"INLINE_NODES\": [{\n"
+        "                \"ID\": 5,\n"
+        "                \"OUTPUT_SCHEMA\": [{\n"
+        "                    \"COLUMN_NAME\": \"R_CUSTOMERID\",\n"
+        "                    \"EXPRESSION\": {\n"
+        "                        \"COLUMN_IDX\": 0,\n"
+        "                        \"TYPE\": 32,\n"
+        "                        \"VALUE_TYPE\": 5\n"
+        "                    }\n"
+        "                }],\n"
+        "                \"PLAN_NODE_TYPE\": \"PROJECTION\"\n"
+        "            }],\n"
+        "            \"OUTPUT_SCHEMA\": [{\n"
+        "                \"COLUMN_NAME\": \"R_CUSTOMERID\",\n"
+        "                \"EXPRESSION\": {\n"
+        "                    \"COLUMN_IDX\": 0,\n"
+        "                    \"TYPE\": 32,\n"
+        "                    \"VALUE_TYPE\": 5\n"
+        "                }\n"
+        "            }],\n"
+        "            \"PLAN_NODE_TYPE\": \"SEQSCAN\",\n"
+        "            \"TARGET_TABLE_ALIAS\": \"R_CUSTOMER\",\n"
+        "            \"TARGET_TABLE_NAME\": \"R_CUSTOMER\"\n"
+        "        }\n"
+        "    ]\n"
+        "}\n";
+
+bool addCustomers(voltdb::Table* table, int32_t firstId, int32_t step, int count) {
+    for (int i = 0; i < count; i++) {
+        voltdb::TableTuple &tuple = table->tempTuple();
+        voltdb::tableutil::setRandomTupleValues(table, &tuple);
+        tuple.setNValue(0, voltdb::ValueFactory::getIntegerValue(firstId + i * step));
+        if ( ! table->insertTuple(tuple)) {
+            return false;
+        }
+        tuple.freeObjectColumns();
+    }
+    return true;
+}
+
+std::set<int32_t> customerIds(voltdb::Table* table) {
+    std::set<int32_t> ids;
+    voltdb::TableTuple tuple(table->schema());
+    voltdb::TableIterator iter = table->iterator();
+    while (iter.next(tuple)) {
+        ids.insert(voltdb::ValuePeeker::peekInteger(tuple.getNValue(0)));
+    }
+    return ids;
+}
+}
+
+/*
+ * A nested loop index join where most outer rows have no match builds a
+ * Bloom filter over the inner keys part way through, and must still find
+ * every match.
+ */
+TEST_F(ExecutionEngineTest, NestLoopIndexBloomFilter) {
+    initialize(catalog_string, random_seed);
+    // One in four outer customers has a match.
+    ASSERT_TRUE(addCustomers(m_partitioned_customer_table, 1000000, 4, 1000));
+    {
+        voltdb::ScopedReplicatedResourceLock replicatedResourceLock;
+        voltdb::SynchronizedThreadLock::assumeMpMemoryContext();
+        ASSERT_TRUE(addCustomers(m_replicated_customer_table, 1000000, 1, 4000));
+        voltdb::SynchronizedThreadLock::assumeLocalSiteContext();
+    }
+    std::set<int32_t> innerIds = customerIds(m_partitioned_customer_table);
+    std::set<int32_t> outerIds = customerIds(m_replicated_customer_table);
+    int64_t expectedMatches = 0;
+    for (std::set<int32_t>::const_iterator it = outerIds.begin(); it != outerIds.end(); ++it) {
+        if (innerIds.count(*it) != 0) {
+            ++expectedMatches;
+        }
+    }
+    ASSERT_TRUE(expectedMatches >= 1000);
+
+    m_topend->addPlan(300, nestLoopIndexPlan);
+    fragmentId_t fragmentId = 300;
+    memset(m_parameter_buffer.get(), 0, 4 * 1024);
+    voltdb::ReferenceSerializeInputBE emptyParams(m_parameter_buffer.get(), 4 * 1024);
+    m_engine->setPlanNodeProfiling(true);
+    ASSERT_EQ(0, m_engine->executePlanFragments(1, &fragmentId, NULL, emptyParams, 1000, 1000, 1000, 1000, 1, false));
+    m_engine->setPlanNodeProfiling(false);
+
+    boost::scoped_ptr<voltdb::TempTable> result(
+            voltdb::loadTableFrom(m_result_buffer.get(), m_engine->getResultsSize()));
+    ASSERT_TRUE(result != NULL);
+    voltdb::TableTuple tuple(result->schema());
+    voltdb::TableIterator iter = result->iterator();
+    int64_t matches = 0;
+    while (iter.next(tuple)) {
+        int32_t outerId = voltdb::ValuePeeker::peekInteger(tuple.getNValue(0));
+        ASSERT_EQ(outerId, voltdb::ValuePeeker::peekInteger(tuple.getNValue(1)));
+        ASSERT_TRUE(innerIds.count(outerId) != 0);
+        ++matches;
+    }
+    ASSERT_EQ(expectedMatches, matches);
+
+    // The probes after the sampled ones went through the filter, and it
+    // turned most of them away.
+    voltdb::TempTable* stats = m_engine->getStatsManager().getStats(
+            voltdb::STATISTICS_SELECTOR_TYPE_PLANNODE, 0, 0,
+            m_engine->getStatsManager().getRegisteredCatalogIds(voltdb::STATISTICS_SELECTOR_TYPE_PLANNODE),
+            false, 0);
+    int64_t filterHits = -1;
+    int64_t filterMisses = -1;
+    int64_t indexProbes = -1;
+    voltdb::TableTuple statsTuple(stats->schema());
+    voltdb::TableIterator statsIter = stats->iterator();
+    while (statsIter.next(statsTuple)) {
+        if (voltdb::ValuePeeker::peekInteger(statsTuple.getNValue(stats->columnIndex("PLAN_NODE_ID"))) == 2) {
+            filterHits = voltdb::ValuePeeker::peekBigInt(statsTuple.getNValue(stats->columnIndex("BLOOM_FILTER_HITS")));
+            filterMisses = voltdb::ValuePeeker::peekBigInt(statsTuple.getNValue(stats->columnIndex("BLOOM_FILTER_MISSES")));
+            indexProbes = voltdb::ValuePeeker::peekBigInt(statsTuple.getNValue(stats->columnIndex("INDEX_PROBES")));
+        }
+    }
+    int64_t outerRows = static_cast<int64_t>(outerIds.size());
+    ASSERT_EQ(outerRows - 1024, filterHits + filterMisses);
+    ASSERT_TRUE(filterMisses > filterHits);
+    ASSERT_EQ(outerRows - filterMisses, indexProbes);
+}
+
+/*
+ * A scan feeding a projection feeding a limit runs as one pipeline: the
+ * projection and the limit see every row the scan produces, but neither
+ * one's input is ever stored.
+ */
+TEST_F(ExecutionEngineTest, PipelinedProjectionAndLimit) {
+    initialize(catalog_string, random_seed);
+    {
+        voltdb::ScopedReplicatedResourceLock replicatedResourceLock;
+        voltdb::SynchronizedThreadLock::assumeMpMemoryContext();
+        ASSERT_TRUE(addCustomers(m_replicated_customer_table, 1000000, 1, 4000));
+        voltdb::SynchronizedThreadLock::assumeLocalSiteContext();
+    }
+    std::set<int32_t> ids = customerIds(m_replicated_customer_table);
+
+    m_topend->addPlan(301, projectionLimitPlan);
+    fragmentId_t fragmentId = 301;
+    memset(m_parameter_buffer.get(), 0, 4 * 1024);
+    voltdb::ReferenceSerializeInputBE emptyParams(m_parameter_buffer.get(), 4 * 1024);
+    m_engine->setPlanNodeProfiling(true);
+    // Run it twice to check that the pipeline starts over cleanly.
+    for (int run = 0; run < 2; ++run) {
+        m_engine->resetReusedResultOutputBuffer();
+        ASSERT_EQ(0, m_engine->executePlanFragments(1, &fragmentId, NULL, emptyParams, 1000, 1000, 1000, 1000, 1, false));
+
+        boost::scoped_ptr<voltdb::TempTable> result(
+                voltdb::loadTableFrom(m_result_buffer.get(), m_engine->getResultsSize()));
+        ASSERT_TRUE(result != NULL);
+        voltdb::TableTuple tuple(result->schema());
+        voltdb::TableIterator iter = result->iterator();
+        std::set<int32_t> seen;
+        while (iter.next(tuple)) {
+            int32_t id = voltdb::ValuePeeker::peekInteger(tuple.getNValue(0));
+            ASSERT_EQ(2 * static_cast<int64_t>(id), voltdb::ValuePeeker::peekBigInt(tuple.getNValue(1)));
+            ASSERT_TRUE(ids.count(id) != 0);
+            seen.insert(id);
+        }
+        ASSERT_EQ(10, seen.size());
+    }
+    m_engine->setPlanNodeProfiling(false);
+
+    voltdb::TempTable* stats = m_engine->getStatsManager().getStats(
+            voltdb::STATISTICS_SELECTOR_TYPE_PLANNODE, 0, 0,
+            m_engine->getStatsManager().getRegisteredCatalogIds(voltdb::STATISTICS_SELECTOR_TYPE_PLANNODE),
+            false, 0);
+    int nodesChecked = 0;
+    voltdb::TableTuple statsTuple(stats->schema());
+    voltdb::TableIterator statsIter = stats->iterator();
+    while (statsIter.next(statsTuple)) {
+        if (voltdb::ValuePeeker::peekBigInt(statsTuple.getNValue(stats->columnIndex("PLAN_FRAGMENT_ID"))) != 301) {
+            continue;
+        }
+        int32_t planNodeId = voltdb::ValuePeeker::peekInteger(statsTuple.getNValue(stats->columnIndex("PLAN_NODE_ID")));
+        int64_t tuplesIn = voltdb::ValuePeeker::peekBigInt(statsTuple.getNValue(stats->columnIndex("TUPLES_IN")));
+        int64_t tempTableBytes = voltdb::ValuePeeker::peekBigInt(statsTuple.getNValue(stats->columnIndex("TEMP_TABLE_BYTES")));
+        if (planNodeId == 2 || planNodeId == 3) {
+            // The rows arrived while the scan ran; finishing allocates nothing.
+            ASSERT_EQ(2 * static_cast<int64_t>(ids.size()), tuplesIn);
+            ASSERT_EQ(0, tempTableBytes);
+            ++nodesChecked;
+        }
+    }
+    ASSERT_EQ(2, nodesChecked);
+}
+
 int main() {
      return TestSuite::globalInstance()->runAll();
 }
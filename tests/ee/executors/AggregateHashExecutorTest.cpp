@@ -0,0 +1,168 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/optional.hpp>
+
+#include "harness.h"
+
+#include "test_utils/EmployeesCatalog.hpp"
+#include "test_utils/LargeTempTableTopend.hpp"
+#include "test_utils/Tools.hpp"
+#include "test_utils/TupleComparingTest.hpp"
+#include "test_utils/UniqueEngine.hpp"
+
+#include "common/LargeTempTableBlockCache.h"
+#include "common/tabletuple.h"
+#include "common/ValuePeeker.hpp"
+#include "execution/ExecutorVector.h"
+#include "storage/AbstractTempTable.hpp"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+
+using namespace voltdb;
+
+class AggregateHashExecutorTest : public TupleComparingTest {
+};
+
+namespace {
+
+// This JSON is hopefully similar to what the planner would produce for
+//
+//   SELECT <groupByColumn>, COUNT(*), MAX(EMP_ID) FROM EMPLOYEES GROUP BY <groupByColumn>;
+//
+// in a large query.
+std::string hashAggregatePlan(const std::string& groupByColumn, int groupByIdx, int groupByType) {
+    std::ostringstream oss;
+    oss << "{\"PLAN_NODES\":["
+        << "{\"ID\":1,\"PLAN_NODE_TYPE\":\"HASHAGGREGATE\",\"CHILDREN_IDS\":[2],"
+        << "\"OUTPUT_SCHEMA\":[" << columnJson(groupByColumn, groupByType, groupByIdx, 0) << ","
+        << columnJson("C1", 6, 1, 0) << ","
+        << columnJson("C2", 5, 2, 0) << "],"
+        << "\"AGGREGATE_COLUMNS\":["
+        << "{\"AGGREGATE_TYPE\":\"AGGREGATE_COUNT_STAR\",\"AGGREGATE_DISTINCT\":0,"
+        << "\"AGGREGATE_OUTPUT_COLUMN\":1},"
+        << "{\"AGGREGATE_TYPE\":\"AGGREGATE_MAX\",\"AGGREGATE_DISTINCT\":0,"
+        << "\"AGGREGATE_OUTPUT_COLUMN\":2,"
+        << "\"AGGREGATE_EXPRESSION\":{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":1}}],"
+        << "\"GROUPBY_EXPRESSIONS\":[{\"TYPE\":32,\"VALUE_TYPE\":" << groupByType << ",";
+    if (groupByType == 9) {
+        oss << "\"VALUE_SIZE\":20,";
+    }
+    oss << "\"COLUMN_IDX\":" << groupByIdx << "}]"
+        << "},"
+        << seqScanJson(2, "E")
+        << "],"
+        << "\"EXECUTE_LIST\":[2,1],"
+        << "\"IS_LARGE_QUERY\":true"
+        << "}";
+    return oss.str();
+}
+
+} // end anonymous namespace
+
+// With many more groups than fit in the memory budget, the input of
+// the groups that do not fit is spilled to large temp tables and
+// aggregated in later passes.
+TEST_F(AggregateHashExecutorTest, largeQuerySpills) {
+    std::unique_ptr<Topend> topend{new LargeTempTableTopend()};
+    // Room for eight blocks in the LTT block cache, and a memory budget
+    // of half that for the groups.
+    int64_t tempTableMemoryLimitInBytes = 64 * 1024 * 1024;
+    UniqueEngine engine = UniqueEngineBuilder()
+        .setTopend(std::move(topend))
+        .setTempTableMemoryLimit(tempTableMemoryLimitInBytes)
+        .build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+
+    // Every manager has two employees.
+    const int numEmployees = 1000000;
+    std::vector<InRow> rows;
+    for (int i = 0; i < numEmployees; ++i) {
+        std::ostringstream oss;
+        oss << "emp " << i;
+        rows.push_back(InRow{oss.str(), i, i / 2});
+    }
+    insertEmployees(engine->getTableByName("EMPLOYEES"), rows);
+
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), hashAggregatePlan("MANAGER_ID", 2, 5), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    ASSERT_EQ("LargeTempTable", result->tableType());
+    ASSERT_EQ(numEmployees / 2, result->activeTupleCount());
+
+    {
+        // The iterator pins a block of the result, so it must be gone
+        // before the result is released.
+        std::vector<bool> seen(numEmployees / 2, false);
+        TableTuple iterTuple{result->schema()};
+        TableIterator iter = result->iterator();
+        while (iter.next(iterTuple)) {
+            int managerId = ValuePeeker::peekInteger(iterTuple.getNValue(0));
+            ASSERT_FALSE(seen[managerId]);
+            seen[managerId] = true;
+            ASSERT_EQ(2, ValuePeeker::peekBigInt(iterTuple.getNValue(1)));
+            ASSERT_EQ(managerId * 2 + 1, ValuePeeker::peekInteger(iterTuple.getNValue(2)));
+        }
+    }
+
+    // Group on a string, whose spilled values live in large temp table blocks.
+    // The result belongs to the executor vector that is about to be replaced.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), hashAggregatePlan("LAST_NAME", 0, 9), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    ASSERT_EQ(numEmployees, result->activeTupleCount());
+
+    {
+        std::vector<bool> seen(numEmployees, false);
+        TableTuple iterTuple{result->schema()};
+        TableIterator iter = result->iterator();
+        while (iter.next(iterTuple)) {
+            int empId = ValuePeeker::peekInteger(iterTuple.getNValue(2));
+            ASSERT_FALSE(seen[empId]);
+            seen[empId] = true;
+            std::ostringstream oss;
+            oss << "emp " << empId;
+            int32_t length;
+            const char* name = ValuePeeker::peekObject_withoutNull(iterTuple.getNValue(0), &length);
+            ASSERT_EQ(oss.str(), std::string(name, length));
+            ASSERT_EQ(1, ValuePeeker::peekBigInt(iterTuple.getNValue(1)));
+        }
+    }
+    result.reset();
+
+    LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+    ASSERT_EQ(0, lttBlockCache->numPinnedEntries());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
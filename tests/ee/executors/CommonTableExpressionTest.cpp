@@ -30,6 +30,7 @@
 
 #include "harness.h"
 
+#include "test_utils/EmployeesCatalog.hpp"
 #include "test_utils/Tools.hpp"
 #include "test_utils/TupleComparingTest.hpp"
 #include "test_utils/UniqueEngine.hpp"
@@ -51,115 +52,6 @@ using namespace voltdb;
 class CommonTableExpressionTest : public TupleComparingTest {
 };
 
-// Catalog for the following DDL:
-//
-// CREATE TABLE EMPLOYEES (
-//     LAST_NAME VARCHAR(20) NOT NULL,
-//     EMP_ID INTEGER NOT NULL,
-//     MANAGER_ID INTEGER
-// );
-// PARTITION TABLE EMPLOYEES ON LAST_NAME;
-
-const std::string catalogPayload =
-    "add / clusters cluster\n"
-    "set /clusters#cluster localepoch 1199145600\n"
-    "set $PREV securityEnabled false\n"
-    "set $PREV httpdportno -1\n"
-    "set $PREV jsonapi true\n"
-    "set $PREV networkpartition false\n"
-    "set $PREV heartbeatTimeout 90\n"
-    "set $PREV useddlschema false\n"
-    "set $PREV drConsumerEnabled false\n"
-    "set $PREV drProducerEnabled true\n"
-    "set $PREV drRole \"master\"\n"
-    "set $PREV drClusterId 0\n"
-    "set $PREV drProducerPort 5555\n"
-    "set $PREV drMasterHost \"\"\n"
-    "set $PREV drFlushInterval 1000\n"
-    "set $PREV preferredSource 0\n"
-    "add /clusters#cluster databases database\n"
-    "set /clusters#cluster/databases#database schema \"qgRUNDM1MjQ1NDE1NDQ1MjA1NDQxNDI0QwEMWDQ1NEQ1MDRDNEY1OTQ1NDU1MzIwMjgyARIwMTUzNTQ1RjRFNDE0RAEsJDU2NDE1MjQzNDgBCDwyODMyMzAyOTIwNEU0RjU0AQgkNTU0QzRDMkMyMAlYEDVGNDk0ARoIOTRFAXwUNDc0NTUyASpKMgAIRDQxBWwFJF46ABAyOTNCCmrPAAA0AWEQNDk1NjQBcABGEYcENTAF/QA4/t0A/t0Adt0AUkkBCEM0NQXOIVWKRwEZ6kKvAQgxMzAJAlK1ARQwMjkzQgo=\"\n"
-    "set $PREV isActiveActiveDRed false\n"
-    "set $PREV securityprovider \"hash\"\n"
-    "add /clusters#cluster/databases#database groups administrator\n"
-    "set /clusters#cluster/databases#database/groups#administrator admin true\n"
-    "set $PREV defaultproc true\n"
-    "set $PREV defaultprocread true\n"
-    "set $PREV sql true\n"
-    "set $PREV sqlread true\n"
-    "set $PREV allproc true\n"
-    "add /clusters#cluster/databases#database groups user\n"
-    "set /clusters#cluster/databases#database/groups#user admin false\n"
-    "set $PREV defaultproc true\n"
-    "set $PREV defaultprocread true\n"
-    "set $PREV sql true\n"
-    "set $PREV sqlread true\n"
-    "set $PREV allproc true\n"
-    "add /clusters#cluster/databases#database tables EMPLOYEES\n"
-    "set /clusters#cluster/databases#database/tables#EMPLOYEES isreplicated false\n"
-    "set $PREV partitioncolumn /clusters#cluster/databases#database/tables#EMPLOYEES/columns#LAST_NAME\n"
-    "set $PREV estimatedtuplecount 0\n"
-    "set $PREV materializer null\n"
-    "set $PREV signature \"EMPLOYEES|vii\"\n"
-    "set $PREV tuplelimit 2147483647\n"
-    "set $PREV isDRed false\n"
-    "add /clusters#cluster/databases#database/tables#EMPLOYEES columns EMP_ID\n"
-    "set /clusters#cluster/databases#database/tables#EMPLOYEES/columns#EMP_ID index 1\n"
-    "set $PREV type 5\n"
-    "set $PREV size 4\n"
-    "set $PREV nullable false\n"
-    "set $PREV name \"EMP_ID\"\n"
-    "set $PREV defaultvalue null\n"
-    "set $PREV defaulttype 0\n"
-    "set $PREV aggregatetype 0\n"
-    "set $PREV matviewsource null\n"
-    "set $PREV matview null\n"
-    "set $PREV inbytes false\n"
-    "add /clusters#cluster/databases#database/tables#EMPLOYEES columns LAST_NAME\n"
-    "set /clusters#cluster/databases#database/tables#EMPLOYEES/columns#LAST_NAME index 0\n"
-    "set $PREV type 9\n"
-    "set $PREV size 20\n"
-    "set $PREV nullable false\n"
-    "set $PREV name \"LAST_NAME\"\n"
-    "set $PREV defaultvalue null\n"
-    "set $PREV defaulttype 0\n"
-    "set $PREV aggregatetype 0\n"
-    "set $PREV matviewsource null\n"
-    "set $PREV matview null\n"
-    "set $PREV inbytes false\n"
-    "add /clusters#cluster/databases#database/tables#EMPLOYEES columns MANAGER_ID\n"
-    "set /clusters#cluster/databases#database/tables#EMPLOYEES/columns#MANAGER_ID index 2\n"
-    "set $PREV type 5\n"
-    "set $PREV size 4\n"
-    "set $PREV nullable true\n"
-    "set $PREV name \"MANAGER_ID\"\n"
-    "set $PREV defaultvalue null\n"
-    "set $PREV defaulttype 0\n"
-    "set $PREV aggregatetype 0\n"
-    "set $PREV matviewsource null\n"
-    "set $PREV matview null\n"
-    "set $PREV inbytes false\n"
-    "add /clusters#cluster/databases#database snapshotSchedule default\n"
-    "set /clusters#cluster/databases#database/snapshotSchedule#default enabled false\n"
-    "set $PREV frequencyUnit \"h\"\n"
-    "set $PREV frequencyValue 24\n"
-    "set $PREV retain 2\n"
-    "set $PREV prefix \"AUTOSNAP\"\n"
-    "add /clusters#cluster deployment deployment\n"
-    "set /clusters#cluster/deployment#deployment kfactor 0\n"
-    "add /clusters#cluster/deployment#deployment systemsettings systemsettings\n"
-    "set /clusters#cluster/deployment#deployment/systemsettings#systemsettings temptablemaxsize 100\n"
-    "set $PREV snapshotpriority 6\n"
-    "set $PREV elasticduration 50\n"
-    "set $PREV elasticthroughput 2\n"
-    "set $PREV querytimeout 10000\n"
-    "add /clusters#cluster logconfig log\n"
-    "set /clusters#cluster/logconfig#log enabled false\n"
-    "set $PREV synchronous false\n"
-    "set $PREV fsyncInterval 200\n"
-    "set $PREV maxTxns 2147483647\n"
-    "set $PREV logSize 1024\n";
-
 // This JSON is hopefully similar to what the planner will produce for
 // the following SQL:
 //
@@ -0,0 +1,284 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/optional.hpp>
+
+#include "harness.h"
+
+#include "test_utils/EmployeesCatalog.hpp"
+#include "test_utils/LargeTempTableTopend.hpp"
+#include "test_utils/Tools.hpp"
+#include "test_utils/TupleComparingTest.hpp"
+#include "test_utils/UniqueEngine.hpp"
+
+#include "common/tabletuple.h"
+#include "common/ValuePeeker.hpp"
+#include "execution/ExecutorVector.h"
+#include "executors/abstractexecutor.h"
+#include "plannodes/hashjoinnode.h"
+#include "storage/AbstractTempTable.hpp"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+
+using namespace voltdb;
+
+class HashJoinExecutorTest : public TupleComparingTest {
+};
+
+namespace {
+
+// This JSON is hopefully similar to what the planner would produce for
+//
+//   SELECT * FROM EMPLOYEES E JOIN EMPLOYEES M ON E.MANAGER_ID = M.EMP_ID;
+//
+// with a hash join between E (outer) and M (inner).  SEMI and ANTI
+// joins produce only the columns of E.
+std::string hashJoinPlan(const std::string& joinType, bool isLargeQuery) {
+    bool outerColumnsOnly = (joinType == "SEMI" || joinType == "ANTI");
+    std::ostringstream oss;
+    oss << "{\"PLAN_NODES\":["
+        << "{\"ID\":1,\"PLAN_NODE_TYPE\":\"HASHJOIN\",\"CHILDREN_IDS\":[2,3],"
+        << "\"OUTPUT_SCHEMA\":[" << employeeColumnsJson(0, 0);
+    if (! outerColumnsOnly) {
+        oss << "," << employeeColumnsJson(3, 0);
+    }
+    oss << "],"
+        << "\"JOIN_TYPE\":\"" << joinType << "\","
+        << "\"PRE_JOIN_PREDICATE\":null,"
+        << "\"JOIN_PREDICATE\":null,"
+        << "\"WHERE_PREDICATE\":null,"
+        << "\"OUTER_HASH_EXPRESSIONS\":[{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":2}],"
+        << "\"INNER_HASH_EXPRESSIONS\":[{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":1,\"TABLE_IDX\":1}]"
+        << "},"
+        << seqScanJson(2, "E") << ","
+        << seqScanJson(3, "M")
+        << "],"
+        << "\"EXECUTE_LIST\":[2,3,1],"
+        << "\"IS_LARGE_QUERY\":" << (isLargeQuery ? "true" : "false")
+        << "}";
+    return oss.str();
+}
+
+const std::vector<InRow> employees{
+    InRow{"King",      100, boost::none},
+    InRow{"Cambrault", 148, 100},
+    InRow{"Bates",     172, 148},
+    InRow{"De Haan",   102, 100},
+    InRow{"Hunold",    103, 102},
+    InRow{"Ghost",     200, 999}
+};
+
+} // end anonymous namespace
+
+TEST_F(HashJoinExecutorTest, verifyPlan) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), hashJoinPlan("INNER", false), 0);
+    ASSERT_NE(NULL, ev.get());
+
+    auto execList = ev->getExecutorList(0);
+    ASSERT_EQ(3, execList.size());
+
+    HashJoinPlanNode* joinNode = dynamic_cast<HashJoinPlanNode*>(execList[2]->getPlanNode());
+    ASSERT_NE(NULL, joinNode);
+    ASSERT_EQ(PLAN_NODE_TYPE_HASHJOIN, joinNode->getPlanNodeType());
+    ASSERT_EQ(JOIN_TYPE_INNER, joinNode->getJoinType());
+    ASSERT_EQ(1, joinNode->getOuterHashExpressions().size());
+    ASSERT_EQ(1, joinNode->getInnerHashExpressions().size());
+    ASSERT_NE(std::string::npos, joinNode->debugInfo("").find("Inner Hash Expressions"));
+
+    ev = ExecutorVector::fromJsonPlan(engine.get(), hashJoinPlan("ANTI", false), 0);
+    joinNode = dynamic_cast<HashJoinPlanNode*>(ev->getExecutorList(0)[2]->getPlanNode());
+    ASSERT_NE(NULL, joinNode);
+    ASSERT_EQ(JOIN_TYPE_ANTI, joinNode->getJoinType());
+}
+
+TEST_F(HashJoinExecutorTest, innerAndLeft) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+    insertEmployees(engine->getTableByName("EMPLOYEES"), employees);
+
+    typedef std::tuple<std::string, int, boost::optional<int>,
+                       boost::optional<std::string>, boost::optional<int>, boost::optional<int>> OutRow;
+
+    // Outer tuples are produced in scan order, and each has at most one match.
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), hashJoinPlan("INNER", false), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    std::vector<OutRow> expectedInner{
+        OutRow{"Cambrault", 148, 100, std::string("King"),      100, boost::none},
+        OutRow{"Bates",     172, 148, std::string("Cambrault"), 148, 100},
+        OutRow{"De Haan",   102, 100, std::string("King"),      100, boost::none},
+        OutRow{"Hunold",    103, 102, std::string("De Haan"),   102, 100}
+    };
+    ASSERT_EQ(expectedInner.size(), result->activeTupleCount());
+    int i = 0;
+    TableTuple iterTuple{result->schema()};
+    TableIterator iter = result->iterator();
+    while (iter.next(iterTuple)) {
+        ASSERT_TUPLES_EQ(expectedInner[i], iterTuple);
+        ++i;
+    }
+
+    // The result belongs to the executor vector that is about to be replaced.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), hashJoinPlan("LEFT", false), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    std::vector<OutRow> expectedLeft{
+        OutRow{"King",      100, boost::none, boost::none,            boost::none, boost::none},
+        OutRow{"Cambrault", 148, 100,         std::string("King"),      100,         boost::none},
+        OutRow{"Bates",     172, 148,         std::string("Cambrault"), 148,         100},
+        OutRow{"De Haan",   102, 100,         std::string("King"),      100,         boost::none},
+        OutRow{"Hunold",    103, 102,         std::string("De Haan"),   102,         100},
+        OutRow{"Ghost",     200, 999,         boost::none,            boost::none, boost::none}
+    };
+    ASSERT_EQ(expectedLeft.size(), result->activeTupleCount());
+    i = 0;
+    iterTuple = TableTuple(result->schema());
+    iter = result->iterator();
+    while (iter.next(iterTuple)) {
+        ASSERT_TUPLES_EQ(expectedLeft[i], iterTuple);
+        ++i;
+    }
+}
+
+TEST_F(HashJoinExecutorTest, semiAndAnti) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+    insertEmployees(engine->getTableByName("EMPLOYEES"), employees);
+
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), hashJoinPlan("SEMI", false), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    std::vector<InRow> expectedSemi{
+        InRow{"Cambrault", 148, 100},
+        InRow{"Bates",     172, 148},
+        InRow{"De Haan",   102, 100},
+        InRow{"Hunold",    103, 102}
+    };
+    ASSERT_EQ(expectedSemi.size(), result->activeTupleCount());
+    int i = 0;
+    TableTuple iterTuple{result->schema()};
+    TableIterator iter = result->iterator();
+    while (iter.next(iterTuple)) {
+        ASSERT_TUPLES_EQ(expectedSemi[i], iterTuple);
+        ++i;
+    }
+
+    // A NULL manager id never matches, so King is in the anti join.
+    // The result belongs to the executor vector that is about to be replaced.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), hashJoinPlan("ANTI", false), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    std::vector<InRow> expectedAnti{
+        InRow{"King",  100, boost::none},
+        InRow{"Ghost", 200, 999}
+    };
+    ASSERT_EQ(expectedAnti.size(), result->activeTupleCount());
+    i = 0;
+    iterTuple = TableTuple(result->schema());
+    iter = result->iterator();
+    while (iter.next(iterTuple)) {
+        ASSERT_TUPLES_EQ(expectedAnti[i], iterTuple);
+        ++i;
+    }
+}
+
+// In a large query the inner input is a large temp table, so both
+// inputs are partitioned before being joined.
+TEST_F(HashJoinExecutorTest, largeQueryPartitions) {
+    std::unique_ptr<Topend> topend{new LargeTempTableTopend()};
+    // Room for eight blocks in the LTT block cache
+    int64_t tempTableMemoryLimitInBytes = 64 * 1024 * 1024;
+    UniqueEngine engine = UniqueEngineBuilder()
+        .setTopend(std::move(topend))
+        .setTempTableMemoryLimit(tempTableMemoryLimitInBytes)
+        .build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+
+    // Employee i reports to employee i / 10; the last few report to nobody.
+    const int numEmployees = 3000;
+    const int numOrphans = 10;
+    std::vector<InRow> rows;
+    rows.push_back(InRow{"emp 0", 0, boost::none});
+    for (int i = 1; i < numEmployees + numOrphans; ++i) {
+        std::ostringstream oss;
+        oss << "emp " << i;
+        int manager = i < numEmployees ? i / 10 : numEmployees * 2;
+        rows.push_back(InRow{oss.str(), i, manager});
+    }
+    insertEmployees(engine->getTableByName("EMPLOYEES"), rows);
+
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), hashJoinPlan("INNER", true), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    ASSERT_EQ("LargeTempTable", result->tableType());
+    ASSERT_EQ(numEmployees - 1, result->activeTupleCount());
+
+    {
+        // The iterator pins a block of the result, so it must be gone
+        // before the result is released.
+        std::set<int> seen;
+        TableTuple iterTuple{result->schema()};
+        TableIterator iter = result->iterator();
+        while (iter.next(iterTuple)) {
+            int empId = ValuePeeker::peekInteger(iterTuple.getNValue(1));
+            int managerId = ValuePeeker::peekInteger(iterTuple.getNValue(2));
+            ASSERT_EQ(empId / 10, managerId);
+            ASSERT_EQ(managerId, ValuePeeker::peekInteger(iterTuple.getNValue(4)));
+            ASSERT_TRUE(seen.insert(empId).second);
+        }
+    }
+
+    // The result belongs to the executor vector that is about to be replaced.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), hashJoinPlan("ANTI", true), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    ASSERT_EQ(numOrphans + 1, result->activeTupleCount());
+    result.reset();
+
+    LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+    ASSERT_EQ(0, lttBlockCache->numPinnedEntries());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
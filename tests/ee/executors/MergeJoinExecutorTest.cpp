@@ -0,0 +1,286 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/optional.hpp>
+
+#include "harness.h"
+
+#include "test_utils/EmployeesCatalog.hpp"
+#include "test_utils/Tools.hpp"
+#include "test_utils/TupleComparingTest.hpp"
+#include "test_utils/UniqueEngine.hpp"
+
+#include "common/tabletuple.h"
+#include "execution/ExecutorVector.h"
+#include "executors/abstractexecutor.h"
+#include "plannodes/mergejoinnode.h"
+#include "storage/AbstractTempTable.hpp"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+
+using namespace voltdb;
+
+class MergeJoinExecutorTest : public TupleComparingTest {
+protected:
+    // Verifies the rows of a result, in order
+    template<typename Row>
+    void assertResult(const std::vector<Row>& expected, const UniqueTempTableResult& result) {
+        ASSERT_NE(NULL, result.get());
+        ASSERT_EQ(expected.size(), result->activeTupleCount());
+        int i = 0;
+        TableTuple iterTuple{result->schema()};
+        TableIterator iter = result->iterator();
+        while (iter.next(iterTuple)) {
+            ASSERT_TUPLES_EQ(expected[i], iterTuple);
+            ++i;
+        }
+    }
+};
+
+namespace {
+
+std::string orderByJson(int id, int childId, int keyIdx, const std::string& direction) {
+    std::ostringstream oss;
+    oss << "{\"ID\":" << id << ",\"PLAN_NODE_TYPE\":\"ORDERBY\",\"CHILDREN_IDS\":[" << childId << "],"
+        << "\"SORT_COLUMNS\":["
+        << "{\"SORT_EXPRESSION\":{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":" << keyIdx << "},"
+        << "\"SORT_DIRECTION\":\"" << direction << "\"},"
+        << "{\"SORT_EXPRESSION\":{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":1},"
+        << "\"SORT_DIRECTION\":\"" << direction << "\"}]}";
+    return oss.str();
+}
+
+// This JSON is hopefully similar to what the planner would produce for
+//
+//   SELECT * FROM EMPLOYEES E JOIN EMPLOYEES M ON E.MANAGER_ID = M.<innerKey>;
+//
+// with a merge join between E (outer) and M (inner), each sorted on its
+// key and then on EMP_ID.  SEMI and ANTI joins produce only the columns
+// of E.
+std::string mergeJoinPlan(const std::string& joinType, const std::string& direction,
+                          int innerKeyIdx = 1) {
+    bool outerColumnsOnly = (joinType == "SEMI" || joinType == "ANTI");
+    std::ostringstream oss;
+    oss << "{\"PLAN_NODES\":["
+        << "{\"ID\":1,\"PLAN_NODE_TYPE\":\"MERGEJOIN\",\"CHILDREN_IDS\":[2,4],"
+        << "\"OUTPUT_SCHEMA\":[" << employeeColumnsJson(0, 0);
+    if (! outerColumnsOnly) {
+        oss << "," << employeeColumnsJson(3, 0);
+    }
+    oss << "],"
+        << "\"JOIN_TYPE\":\"" << joinType << "\","
+        << "\"PRE_JOIN_PREDICATE\":null,"
+        << "\"JOIN_PREDICATE\":null,"
+        << "\"WHERE_PREDICATE\":null,"
+        << "\"OUTER_KEY_EXPRESSIONS\":[{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":2}],"
+        << "\"INNER_KEY_EXPRESSIONS\":[{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":"
+        << innerKeyIdx << ",\"TABLE_IDX\":1}],"
+        << "\"SORT_DIRECTION\":\"" << direction << "\""
+        << "},"
+        << orderByJson(2, 3, 2, direction) << ","
+        << seqScanJson(3, "E") << ","
+        << orderByJson(4, 5, innerKeyIdx, direction) << ","
+        << seqScanJson(5, "M")
+        << "],"
+        << "\"EXECUTE_LIST\":[3,2,5,4,1],"
+        << "\"IS_LARGE_QUERY\":false"
+        << "}";
+    return oss.str();
+}
+
+const std::vector<InRow> employees{
+    InRow{"King",      100, boost::none},
+    InRow{"Cambrault", 148, 100},
+    InRow{"Bates",     172, 148},
+    InRow{"De Haan",   102, 100},
+    InRow{"Hunold",    103, 102},
+    InRow{"Ghost",     200, 999}
+};
+
+} // end anonymous namespace
+
+typedef std::tuple<boost::optional<std::string>, boost::optional<int>, boost::optional<int>,
+                   boost::optional<std::string>, boost::optional<int>, boost::optional<int>> OutRow;
+
+TEST_F(MergeJoinExecutorTest, verifyPlan) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("FULL", "DESC"), 0);
+    ASSERT_NE(NULL, ev.get());
+
+    auto execList = ev->getExecutorList(0);
+    ASSERT_EQ(5, execList.size());
+
+    MergeJoinPlanNode* joinNode = dynamic_cast<MergeJoinPlanNode*>(execList[4]->getPlanNode());
+    ASSERT_NE(NULL, joinNode);
+    ASSERT_EQ(PLAN_NODE_TYPE_MERGEJOIN, joinNode->getPlanNodeType());
+    ASSERT_EQ(JOIN_TYPE_FULL, joinNode->getJoinType());
+    ASSERT_EQ(SORT_DIRECTION_TYPE_DESC, joinNode->getSortDirection());
+    ASSERT_EQ(1, joinNode->getOuterKeyExpressions().size());
+    ASSERT_EQ(1, joinNode->getInnerKeyExpressions().size());
+    ASSERT_NE(std::string::npos, joinNode->debugInfo("").find("Inner Key Expressions"));
+}
+
+TEST_F(MergeJoinExecutorTest, outerJoins) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+    insertEmployees(engine->getTableByName("EMPLOYEES"), employees);
+
+    // Output follows the key order; King and De Haan both have two reports.
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("INNER", "ASC"), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    std::vector<OutRow> expectedInner{
+        OutRow{std::string("De Haan"),   102, 100, std::string("King"),      100, boost::none},
+        OutRow{std::string("Cambrault"), 148, 100, std::string("King"),      100, boost::none},
+        OutRow{std::string("Hunold"),    103, 102, std::string("De Haan"),   102, 100},
+        OutRow{std::string("Bates"),     172, 148, std::string("Cambrault"), 148, 100}
+    };
+    assertResult(expectedInner, result);
+
+    // The result belongs to the executor vector that is about to be replaced.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("LEFT", "ASC"), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    std::vector<OutRow> expectedLeft{
+        OutRow{std::string("King"),      100, boost::none, boost::none, boost::none, boost::none},
+        OutRow{std::string("De Haan"),   102, 100, std::string("King"),      100, boost::none},
+        OutRow{std::string("Cambrault"), 148, 100, std::string("King"),      100, boost::none},
+        OutRow{std::string("Hunold"),    103, 102, std::string("De Haan"),   102, 100},
+        OutRow{std::string("Bates"),     172, 148, std::string("Cambrault"), 148, 100},
+        OutRow{std::string("Ghost"),     200, 999, boost::none, boost::none, boost::none}
+    };
+    assertResult(expectedLeft, result);
+
+    // Unmatched inner tuples are produced where the merge passes them.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("FULL", "ASC"), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    std::vector<OutRow> expectedFull{
+        OutRow{std::string("King"),      100, boost::none, boost::none, boost::none, boost::none},
+        OutRow{std::string("De Haan"),   102, 100, std::string("King"),      100, boost::none},
+        OutRow{std::string("Cambrault"), 148, 100, std::string("King"),      100, boost::none},
+        OutRow{std::string("Hunold"),    103, 102, std::string("De Haan"),   102, 100},
+        OutRow{boost::none, boost::none, boost::none, std::string("Hunold"), 103, 102},
+        OutRow{std::string("Bates"),     172, 148, std::string("Cambrault"), 148, 100},
+        OutRow{boost::none, boost::none, boost::none, std::string("Bates"),  172, 148},
+        OutRow{boost::none, boost::none, boost::none, std::string("Ghost"),  200, 999},
+        OutRow{std::string("Ghost"),     200, 999, boost::none, boost::none, boost::none}
+    };
+    assertResult(expectedFull, result);
+}
+
+TEST_F(MergeJoinExecutorTest, semiAndAnti) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+    insertEmployees(engine->getTableByName("EMPLOYEES"), employees);
+
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("SEMI", "ASC"), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    std::vector<InRow> expectedSemi{
+        InRow{"De Haan",   102, 100},
+        InRow{"Cambrault", 148, 100},
+        InRow{"Hunold",    103, 102},
+        InRow{"Bates",     172, 148}
+    };
+    assertResult(expectedSemi, result);
+
+    // A NULL manager id never matches, so King is in the anti join.
+    // The result belongs to the executor vector that is about to be replaced.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("ANTI", "ASC"), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    std::vector<InRow> expectedAnti{
+        InRow{"King",  100, boost::none},
+        InRow{"Ghost", 200, 999}
+    };
+    assertResult(expectedAnti, result);
+}
+
+TEST_F(MergeJoinExecutorTest, descending) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+    insertEmployees(engine->getTableByName("EMPLOYEES"), employees);
+
+    // NULL keys sort last when descending.
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("FULL", "DESC"), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    std::vector<OutRow> expectedFull{
+        OutRow{std::string("Ghost"),     200, 999, boost::none, boost::none, boost::none},
+        OutRow{boost::none, boost::none, boost::none, std::string("Ghost"),  200, 999},
+        OutRow{boost::none, boost::none, boost::none, std::string("Bates"),  172, 148},
+        OutRow{std::string("Bates"),     172, 148, std::string("Cambrault"), 148, 100},
+        OutRow{boost::none, boost::none, boost::none, std::string("Hunold"), 103, 102},
+        OutRow{std::string("Hunold"),    103, 102, std::string("De Haan"),   102, 100},
+        OutRow{std::string("Cambrault"), 148, 100, std::string("King"),      100, boost::none},
+        OutRow{std::string("De Haan"),   102, 100, std::string("King"),      100, boost::none},
+        OutRow{std::string("King"),      100, boost::none, boost::none, boost::none, boost::none}
+    };
+    assertResult(expectedFull, result);
+}
+
+// Joining on MANAGER_ID on both sides puts duplicate keys on both sides.
+TEST_F(MergeJoinExecutorTest, duplicatesOnBothSides) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+    insertEmployees(engine->getTableByName("EMPLOYEES"), employees);
+
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("INNER", "ASC", 2), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    std::vector<OutRow> expectedInner{
+        OutRow{std::string("De Haan"),   102, 100, std::string("De Haan"),   102, 100},
+        OutRow{std::string("De Haan"),   102, 100, std::string("Cambrault"), 148, 100},
+        OutRow{std::string("Cambrault"), 148, 100, std::string("De Haan"),   102, 100},
+        OutRow{std::string("Cambrault"), 148, 100, std::string("Cambrault"), 148, 100},
+        OutRow{std::string("Hunold"),    103, 102, std::string("Hunold"),    103, 102},
+        OutRow{std::string("Bates"),     172, 148, std::string("Bates"),     172, 148},
+        OutRow{std::string("Ghost"),     200, 999, std::string("Ghost"),     200, 999}
+    };
+    assertResult(expectedInner, result);
+
+    // King has a NULL key on both sides, so neither copy matches.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), mergeJoinPlan("FULL", "ASC", 2), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    ASSERT_EQ(expectedInner.size() + 2, result->activeTupleCount());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
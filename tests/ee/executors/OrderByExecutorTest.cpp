@@ -0,0 +1,158 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/optional.hpp>
+
+#include "harness.h"
+
+#include "test_utils/EmployeesCatalog.hpp"
+#include "test_utils/LargeTempTableTopend.hpp"
+#include "test_utils/Tools.hpp"
+#include "test_utils/TupleComparingTest.hpp"
+#include "test_utils/UniqueEngine.hpp"
+
+#include "common/LargeTempTableBlockCache.h"
+#include "common/tabletuple.h"
+#include "common/ValuePeeker.hpp"
+#include "execution/ExecutorVector.h"
+#include "storage/AbstractTempTable.hpp"
+#include "storage/LargeTempTable.h"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+
+using namespace voltdb;
+
+class OrderByExecutorTest : public TupleComparingTest {
+};
+
+namespace {
+
+// This JSON is hopefully similar to what the planner would produce for
+//
+//   SELECT * FROM EMPLOYEES ORDER BY EMP_ID DESC LIMIT <limit> OFFSET <offset>;
+//
+// in a large query.  A negative limit means there is no LIMIT clause.
+std::string orderByPlan(int limit, int offset) {
+    std::ostringstream oss;
+    oss << "{\"PLAN_NODES\":["
+        << "{\"ID\":1,\"PLAN_NODE_TYPE\":\"ORDERBY\",\"CHILDREN_IDS\":[2],";
+    if (limit >= 0) {
+        oss << "\"INLINE_NODES\":[{\"ID\":11,\"PLAN_NODE_TYPE\":\"LIMIT\","
+            << "\"LIMIT\":" << limit << ",\"OFFSET\":" << offset << "}],";
+    }
+    oss << "\"SORT_COLUMNS\":["
+        << "{\"SORT_EXPRESSION\":{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":1},"
+        << "\"SORT_DIRECTION\":\"DESC\"}]"
+        << "},"
+        << seqScanJson(2, "E")
+        << "],"
+        << "\"EXECUTE_LIST\":[2,1],"
+        << "\"IS_LARGE_QUERY\":true"
+        << "}";
+    return oss.str();
+}
+
+} // end anonymous namespace
+
+// Sorting in a large query spills sorted runs of blocks and merges them.
+// The block cache holds only three blocks, so the runs are merged in
+// more than one pass.
+TEST_F(OrderByExecutorTest, largeQuerySort) {
+    std::unique_ptr<Topend> topend{new LargeTempTableTopend()};
+    int64_t tempTableMemoryLimitInBytes = 24 * 1024 * 1024;
+    UniqueEngine engine = UniqueEngineBuilder()
+        .setTopend(std::move(topend))
+        .setTempTableMemoryLimit(tempTableMemoryLimitInBytes)
+        .build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+
+    // Insert the employee ids in a scrambled order.
+    const int numEmployees = 1000000;
+    std::vector<InRow> rows;
+    for (int i = 0; i < numEmployees; ++i) {
+        int empId = static_cast<int>((i * 7919LL) % numEmployees);
+        std::ostringstream oss;
+        oss << "emp " << empId;
+        rows.push_back(InRow{oss.str(), empId, empId / 10});
+    }
+    insertEmployees(engine->getTableByName("EMPLOYEES"), rows);
+
+    auto ev = ExecutorVector::fromJsonPlan(engine.get(), orderByPlan(-1, 0), 0);
+    UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    ASSERT_EQ("LargeTempTable", result->tableType());
+    ASSERT_EQ(numEmployees, result->activeTupleCount());
+    ASSERT_TRUE(dynamic_cast<LargeTempTable*>(result.get())->allocatedBlockCount() > 2);
+
+    {
+        // The iterator pins a block of the result, so it must be gone
+        // before the result is released.
+        int expectedId = numEmployees - 1;
+        TableTuple iterTuple{result->schema()};
+        TableIterator iter = result->iterator();
+        while (iter.next(iterTuple)) {
+            ASSERT_EQ(expectedId, ValuePeeker::peekInteger(iterTuple.getNValue(1)));
+            ASSERT_EQ(expectedId / 10, ValuePeeker::peekInteger(iterTuple.getNValue(2)));
+            --expectedId;
+        }
+        ASSERT_EQ(-1, expectedId);
+    }
+
+    // The result belongs to the executor vector that is about to be replaced.
+    result.reset();
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    ev = ExecutorVector::fromJsonPlan(engine.get(), orderByPlan(5, 10), 0);
+    result = engine->executePlanFragment(ev.get(), NULL);
+    ASSERT_NE(NULL, result.get());
+    std::vector<InRow> expected;
+    for (int empId = numEmployees - 11; empId > numEmployees - 16; --empId) {
+        std::ostringstream oss;
+        oss << "emp " << empId;
+        expected.push_back(InRow{oss.str(), empId, empId / 10});
+    }
+    ASSERT_EQ(expected.size(), result->activeTupleCount());
+    {
+        int i = 0;
+        TableTuple iterTuple{result->schema()};
+        TableIterator iter = result->iterator();
+        while (iter.next(iterTuple)) {
+            ASSERT_TUPLES_EQ(expected[i], iterTuple);
+            ++i;
+        }
+    }
+    result.reset();
+
+    LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+    ASSERT_EQ(0, lttBlockCache->numPinnedEntries());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,165 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/optional.hpp>
+
+#include "harness.h"
+
+#include "test_utils/EmployeesCatalog.hpp"
+#include "test_utils/Tools.hpp"
+#include "test_utils/TupleComparingTest.hpp"
+#include "test_utils/UniqueEngine.hpp"
+
+#include "common/tabletuple.h"
+#include "common/ValuePeeker.hpp"
+#include "execution/ExecutorVector.h"
+#include "executors/abstractexecutor.h"
+#include "plannodes/seqscannode.h"
+#include "storage/AbstractTempTable.hpp"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+
+using namespace voltdb;
+
+class SeqScanExecutorTest : public TupleComparingTest {
+};
+
+namespace {
+
+std::string intConstantJson(int value) {
+    std::ostringstream oss;
+    oss << "{\"TYPE\":30,\"VALUE_TYPE\":5,\"ISNULL\":false,\"VALUE\":" << value << "}";
+    return oss.str();
+}
+
+std::string comparisonJson(int type, const std::string& left, const std::string& right) {
+    return "{\"TYPE\":" + std::to_string(type) + ",\"VALUE_TYPE\":23,"
+        + "\"LEFT\":" + left + ",\"RIGHT\":" + right + "}";
+}
+
+// This JSON is hopefully similar to what the planner would produce for
+//
+//   SELECT * FROM EMPLOYEES
+//   WHERE MANAGER_ID > 2 AND (EMP_ID < 4000 OR MANAGER_ID IS NULL)
+//   LIMIT ? OFFSET ?;
+//
+// with the predicate evaluated in batches if isBatched is true.
+std::string seqScanPlan(bool isBatched, int limit, int offset) {
+    std::string managerId = "{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":2}";
+    std::string empId = "{\"TYPE\":32,\"VALUE_TYPE\":5,\"COLUMN_IDX\":1}";
+    std::string predicate =
+        "{\"TYPE\":20,\"VALUE_TYPE\":23,"
+        "\"LEFT\":" + comparisonJson(13, managerId, intConstantJson(2)) + ","
+        "\"RIGHT\":{\"TYPE\":21,\"VALUE_TYPE\":23,"
+        "\"LEFT\":" + comparisonJson(12, empId, intConstantJson(4000)) + ","
+        "\"RIGHT\":{\"TYPE\":9,\"VALUE_TYPE\":23,\"LEFT\":" + managerId + "}}}";
+    std::ostringstream oss;
+    oss << "{\"PLAN_NODES\":["
+        << "{\"ID\":1,\"PLAN_NODE_TYPE\":\"SEQSCAN\","
+        << "\"INLINE_NODES\":["
+        << "{\"ID\":2,\"PLAN_NODE_TYPE\":\"PROJECTION\","
+        << "\"OUTPUT_SCHEMA\":[" << employeeColumnsJson(0, 0) << "]}";
+    if (limit >= 0) {
+        oss << ",{\"ID\":3,\"PLAN_NODE_TYPE\":\"LIMIT\",\"LIMIT\":" << limit
+            << ",\"OFFSET\":" << offset << "}";
+    }
+    oss << "],"
+        << "\"PREDICATE\":" << predicate << ","
+        << "\"BATCHED\":" << (isBatched ? "true" : "false") << ","
+        << "\"TARGET_TABLE_NAME\":\"EMPLOYEES\",\"TARGET_TABLE_ALIAS\":\"EMPLOYEES\"}"
+        << "],"
+        << "\"EXECUTE_LIST\":[1],"
+        << "\"IS_LARGE_QUERY\":false"
+        << "}";
+    return oss.str();
+}
+
+// Rows "E0" .. "E<numRows-1>", with a NULL MANAGER_ID on every 11th row.
+std::vector<InRow> numberedEmployees(int numRows) {
+    std::vector<InRow> rows;
+    for (int i = 0; i < numRows; ++i) {
+        boost::optional<int> managerId;
+        if (i % 11 != 0) {
+            managerId = i % 7;
+        }
+        rows.push_back(InRow{"E" + std::to_string(i), i, managerId});
+    }
+    return rows;
+}
+
+// Run the scan and return the EMP_IDs it produced, in order.
+std::vector<int> runScan(VoltDBEngine* engine, bool isBatched, int limit, int offset) {
+    auto ev = ExecutorVector::fromJsonPlan(engine, seqScanPlan(isBatched, limit, offset), 0);
+    SeqScanPlanNode* scanNode = dynamic_cast<SeqScanPlanNode*>(ev->getExecutorList(0)[0]->getPlanNode());
+    assert(scanNode != NULL && scanNode->isBatched() == isBatched);
+
+    std::vector<int> empIds;
+    {
+        UniqueTempTableResult result = engine->executePlanFragment(ev.get(), NULL);
+        TableTuple iterTuple{result->schema()};
+        TableIterator iter = result->iterator();
+        while (iter.next(iterTuple)) {
+            empIds.push_back(ValuePeeker::peekInteger(iterTuple.getNValue(1)));
+        }
+    }
+    ExecutorContext::getExecutorContext()->cleanupAllExecutors();
+    return empIds;
+}
+
+} // end anonymous namespace
+
+TEST_F(SeqScanExecutorTest, batchedPredicate) {
+    UniqueEngine engine = UniqueEngineBuilder().build();
+    bool success = engine->loadCatalog(0, catalogPayload);
+    ASSERT_TRUE(success);
+    // Enough rows for several batches, and a partial batch at the end
+    insertEmployees(engine->getTableByName("EMPLOYEES"), numberedEmployees(5000));
+
+    std::vector<int> expected = runScan(engine.get(), false, -1, 0);
+    ASSERT_TRUE(expected.size() > 1000);
+    ASSERT_TRUE(expected.size() < 5000);
+    ASSERT_EQ(expected, runScan(engine.get(), true, -1, 0));
+
+    // Limit and offset are applied to the tuples the batches select
+    std::vector<int> limited = runScan(engine.get(), true, 500, 1200);
+    ASSERT_EQ(500, limited.size());
+    ASSERT_EQ(runScan(engine.get(), false, 500, 1200), limited);
+    for (int i = 0; i < 500; ++i) {
+        ASSERT_EQ(expected[1200 + i], limited[i]);
+    }
+
+    // Small limits are met by batches smaller than a full one
+    ASSERT_EQ(std::vector<int>(1, expected[0]), runScan(engine.get(), true, 1, 0));
+    ASSERT_EQ(runScan(engine.get(), false, 3, 5), runScan(engine.get(), true, 3, 5));
+    ASSERT_TRUE(runScan(engine.get(), true, 0, 0).empty());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
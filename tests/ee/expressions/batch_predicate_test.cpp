@@ -0,0 +1,338 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "harness.h"
+
+#include "common/NValue.hpp"
+#include "common/tabletuple.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "expressions/batchpredicate.h"
+#include "expressions/comparisonexpression.h"
+#include "expressions/conjunctionexpression.h"
+#include "expressions/constantvalueexpression.h"
+#include "expressions/operatorexpression.h"
+#include "expressions/parametervalueexpression.h"
+#include "expressions/tuplevalueexpression.h"
+
+using namespace voltdb;
+
+namespace {
+
+enum {
+    COL_TINYINT = 0,
+    COL_SMALLINT,
+    COL_INTEGER,
+    COL_BIGINT,
+    COL_TIMESTAMP,
+    COL_DOUBLE,
+    COL_DOUBLE2,
+    COL_VARCHAR,
+    NUM_COLUMNS
+};
+
+const int NUM_ROWS = 2500;
+
+}
+
+/**
+ * Check that batch evaluation of a predicate selects exactly the
+ * tuples for which AbstractExpression::eval is true, including for
+ * NULLs, NaN and mixed integer and double comparisons.
+ */
+class BatchPredicateTest : public Test {
+public:
+    BatchPredicateTest()
+        : m_schema(NULL)
+        , m_tupleLength(0)
+    {
+        std::vector<ValueType> types;
+        std::vector<int32_t> sizes;
+        types.push_back(VALUE_TYPE_TINYINT);   sizes.push_back(1);
+        types.push_back(VALUE_TYPE_SMALLINT);  sizes.push_back(2);
+        types.push_back(VALUE_TYPE_INTEGER);   sizes.push_back(4);
+        types.push_back(VALUE_TYPE_BIGINT);    sizes.push_back(8);
+        types.push_back(VALUE_TYPE_TIMESTAMP); sizes.push_back(8);
+        types.push_back(VALUE_TYPE_DOUBLE);    sizes.push_back(8);
+        types.push_back(VALUE_TYPE_DOUBLE);    sizes.push_back(8);
+        types.push_back(VALUE_TYPE_VARCHAR);   sizes.push_back(16);
+        std::vector<bool> allowNull(types.size(), true);
+        m_schema = TupleSchema::createTupleSchemaForTest(types, sizes, allowNull);
+        m_tupleLength = m_schema->tupleLength() + TUPLE_HEADER_SIZE;
+
+        const double doubles[] = { 0.0, -0.0, 1.0, -1.0, 2.5, 3.0,
+                                   std::numeric_limits<double>::quiet_NaN(),
+                                   std::numeric_limits<double>::infinity(),
+                                   -1.0e300 };
+        const int numDoubles = sizeof(doubles) / sizeof(doubles[0]);
+
+        srand(4711);
+        m_storage.reset(new char[m_tupleLength * NUM_ROWS]);
+        ::memset(m_storage.get(), 0, m_tupleLength * NUM_ROWS);
+        for (int i = 0; i < NUM_ROWS; ++i) {
+            char* address = m_storage.get() + i * m_tupleLength;
+            m_addresses.push_back(address);
+            TableTuple tuple(address, m_schema);
+            for (int col = 0; col < COL_VARCHAR; ++col) {
+                if (rand() % 10 == 0) {
+                    tuple.setNValue(col, NValue::getNullValue(m_schema->columnType(col)));
+                    continue;
+                }
+                int small = rand() % 7 - 3;
+                switch (col) {
+                case COL_TINYINT:
+                    tuple.setNValue(col, ValueFactory::getTinyIntValue(static_cast<int8_t>(small)));
+                    break;
+                case COL_SMALLINT:
+                    tuple.setNValue(col, ValueFactory::getSmallIntValue(static_cast<int16_t>(small)));
+                    break;
+                case COL_INTEGER:
+                    tuple.setNValue(col, ValueFactory::getIntegerValue(small));
+                    break;
+                case COL_BIGINT:
+                    tuple.setNValue(col, ValueFactory::getBigIntValue(small * 1000000000000LL));
+                    break;
+                case COL_TIMESTAMP:
+                    tuple.setNValue(col, ValueFactory::getTimestampValue(small));
+                    break;
+                default:
+                    tuple.setNValue(col, ValueFactory::getDoubleValue(doubles[rand() % numDoubles]));
+                    break;
+                }
+            }
+            tuple.setNValue(COL_VARCHAR, NValue::getNullValue(VALUE_TYPE_VARCHAR));
+        }
+    }
+
+    ~BatchPredicateTest()
+    {
+        TupleSchema::freeTupleSchema(m_schema);
+    }
+
+    static AbstractExpression* column(int col)
+    {
+        return new TupleValueExpression(0, col);
+    }
+
+    static AbstractExpression* constant(const NValue& value)
+    {
+        return new ConstantValueExpression(value);
+    }
+
+    template <class OP>
+    static AbstractExpression* comparison(ExpressionType type,
+                                          AbstractExpression* left,
+                                          AbstractExpression* right)
+    {
+        return new ComparisonExpression<OP>(type, left, right);
+    }
+
+    static AbstractExpression* conjunction(ExpressionType type,
+                                           AbstractExpression* left,
+                                           AbstractExpression* right)
+    {
+        if (type == EXPRESSION_TYPE_CONJUNCTION_AND) {
+            return new ConjunctionExpression<ConjunctionAnd>(type, left, right);
+        }
+        return new ConjunctionExpression<ConjunctionOr>(type, left, right);
+    }
+
+    /**
+     * Compile and bind the predicate, then check that it selects the
+     * same tuples as the predicate's own eval, a batch at a time.
+     */
+    void checkBatchEval(AbstractExpression* expr)
+    {
+        boost::scoped_ptr<AbstractExpression> predicate(expr);
+        boost::scoped_ptr<BatchPredicate> batch(BatchPredicate::compile(predicate.get(), m_schema));
+        ASSERT_TRUE(batch != NULL);
+        ASSERT_TRUE(batch->bind());
+
+        char selected[BatchPredicate::BATCH_SIZE];
+        int numSelected = 0;
+        for (int start = 0; start < NUM_ROWS; start += BatchPredicate::BATCH_SIZE) {
+            int count = std::min(NUM_ROWS - start, static_cast<int>(BatchPredicate::BATCH_SIZE));
+            batch->eval(&m_addresses[start], count, selected);
+            for (int i = 0; i < count; ++i) {
+                TableTuple tuple(m_addresses[start + i], m_schema);
+                bool expected = predicate->eval(&tuple, NULL).isTrue();
+                ASSERT_EQ(expected, selected[i] != 0);
+                numSelected += expected;
+            }
+        }
+        // Make sure the data actually exercises the predicate.
+        ASSERT_TRUE(numSelected > 0);
+        ASSERT_TRUE(numSelected < NUM_ROWS);
+    }
+
+protected:
+    TupleSchema* m_schema;
+    int m_tupleLength;
+    boost::scoped_array<char> m_storage;
+    std::vector<char*> m_addresses;
+};
+
+TEST_F(BatchPredicateTest, ColumnToConstant) {
+    checkBatchEval(comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                     column(COL_INTEGER), constant(ValueFactory::getIntegerValue(1))));
+    checkBatchEval(comparison<CmpNe>(EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+                                     column(COL_TINYINT), constant(ValueFactory::getBigIntValue(0))));
+    checkBatchEval(comparison<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                     column(COL_SMALLINT), constant(ValueFactory::getSmallIntValue(-1))));
+    checkBatchEval(comparison<CmpGt>(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                     column(COL_BIGINT), constant(ValueFactory::getIntegerValue(5))));
+    checkBatchEval(comparison<CmpLte>(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                      column(COL_TIMESTAMP), constant(ValueFactory::getTimestampValue(2))));
+    checkBatchEval(comparison<CmpGte>(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                                      column(COL_DOUBLE), constant(ValueFactory::getDoubleValue(1.0))));
+    // Constant on the left
+    checkBatchEval(comparison<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                     constant(ValueFactory::getIntegerValue(0)), column(COL_INTEGER)));
+    checkBatchEval(comparison<CmpGte>(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                                      constant(ValueFactory::getDoubleValue(0.0)), column(COL_DOUBLE)));
+}
+
+TEST_F(BatchPredicateTest, DoubleSemantics) {
+    // Integer columns compared to doubles are compared as doubles
+    checkBatchEval(comparison<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                     column(COL_INTEGER), constant(ValueFactory::getDoubleValue(0.5))));
+    checkBatchEval(comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                     column(COL_DOUBLE), constant(ValueFactory::getIntegerValue(3))));
+    // -0.0 equals 0.0
+    checkBatchEval(comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                     column(COL_DOUBLE), constant(ValueFactory::getDoubleValue(-0.0))));
+    // NaN equals NaN and sorts below everything else
+    checkBatchEval(comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                     column(COL_DOUBLE),
+                                     constant(ValueFactory::getDoubleValue(std::numeric_limits<double>::quiet_NaN()))));
+    checkBatchEval(comparison<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                     column(COL_DOUBLE),
+                                     constant(ValueFactory::getDoubleValue(-1.0e300))));
+    checkBatchEval(comparison<CmpGt>(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                     column(COL_DOUBLE), column(COL_DOUBLE2)));
+}
+
+TEST_F(BatchPredicateTest, ColumnToColumn) {
+    checkBatchEval(comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                     column(COL_TINYINT), column(COL_INTEGER)));
+    checkBatchEval(comparison<CmpLte>(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                      column(COL_SMALLINT), column(COL_BIGINT)));
+    checkBatchEval(comparison<CmpNe>(EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+                                     column(COL_INTEGER), column(COL_DOUBLE)));
+}
+
+TEST_F(BatchPredicateTest, ConjunctionsAndIsNull) {
+    checkBatchEval(new OperatorIsNullExpression(column(COL_SMALLINT)));
+    checkBatchEval(new OperatorIsNullExpression(column(COL_DOUBLE)));
+    checkBatchEval(conjunction(EXPRESSION_TYPE_CONJUNCTION_AND,
+                               comparison<CmpGt>(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                                 column(COL_INTEGER), constant(ValueFactory::getIntegerValue(-2))),
+                               comparison<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                                 column(COL_DOUBLE), column(COL_DOUBLE2))));
+    checkBatchEval(conjunction(EXPRESSION_TYPE_CONJUNCTION_OR,
+                               new OperatorIsNullExpression(column(COL_BIGINT)),
+                               conjunction(EXPRESSION_TYPE_CONJUNCTION_AND,
+                                           comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                                             column(COL_TINYINT), column(COL_SMALLINT)),
+                                           comparison<CmpNe>(EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+                                                             column(COL_TIMESTAMP),
+                                                             constant(ValueFactory::getTimestampValue(0))))));
+}
+
+TEST_F(BatchPredicateTest, Parameters) {
+    NValue param = ValueFactory::getBigIntValue(1);
+    boost::scoped_ptr<AbstractExpression> predicate(
+            comparison<CmpGte>(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                               column(COL_INTEGER), new ParameterValueExpression(0, &param)));
+    boost::scoped_ptr<BatchPredicate> batch(BatchPredicate::compile(predicate.get(), m_schema));
+    ASSERT_TRUE(batch != NULL);
+
+    char selected[BatchPredicate::BATCH_SIZE];
+    const int count = BatchPredicate::BATCH_SIZE;
+
+    // The parameter is re-read each time the predicate is bound.
+    NValue values[] = { ValueFactory::getBigIntValue(1),
+                        ValueFactory::getDoubleValue(-1.5),
+                        NValue::getNullValue(VALUE_TYPE_INTEGER) };
+    for (int v = 0; v < 3; ++v) {
+        param = values[v];
+        ASSERT_TRUE(batch->bind());
+        batch->eval(&m_addresses[0], count, selected);
+        for (int i = 0; i < count; ++i) {
+            TableTuple tuple(m_addresses[i], m_schema);
+            ASSERT_EQ(predicate->eval(&tuple, NULL).isTrue(), selected[i] != 0);
+        }
+    }
+
+    // A parameter type the kernels don't handle falls back to eval.
+    param = ValueFactory::getDecimalValueFromString("1.5");
+    ASSERT_FALSE(batch->bind());
+}
+
+TEST_F(BatchPredicateTest, Unsupported) {
+    // String columns
+    boost::scoped_ptr<AbstractExpression> stringPredicate(new OperatorIsNullExpression(column(COL_VARCHAR)));
+    ASSERT_TRUE(BatchPredicate::compile(stringPredicate.get(), m_schema) == NULL);
+
+    // NOT, since a NULL comparison is false rather than unknown
+    boost::scoped_ptr<AbstractExpression> notPredicate(
+            new OperatorNotExpression(comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                                        column(COL_INTEGER),
+                                                        constant(ValueFactory::getIntegerValue(1)))));
+    ASSERT_TRUE(BatchPredicate::compile(notPredicate.get(), m_schema) == NULL);
+
+    // Any unsupported part of a conjunction
+    boost::scoped_ptr<AbstractExpression> mixedPredicate(
+            conjunction(EXPRESSION_TYPE_CONJUNCTION_AND,
+                        comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                          column(COL_INTEGER), constant(ValueFactory::getIntegerValue(1))),
+                        new OperatorIsNullExpression(column(COL_VARCHAR))));
+    ASSERT_TRUE(BatchPredicate::compile(mixedPredicate.get(), m_schema) == NULL);
+
+    // A TIMESTAMP compared with another type is left to NValue
+    boost::scoped_ptr<AbstractExpression> timestampColumns(
+            comparison<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                              column(COL_TIMESTAMP), column(COL_BIGINT)));
+    ASSERT_TRUE(BatchPredicate::compile(timestampColumns.get(), m_schema) == NULL);
+
+    NValue param = ValueFactory::getTimestampValue(1);
+    boost::scoped_ptr<AbstractExpression> timestampParam(
+            comparison<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                              column(COL_INTEGER), new ParameterValueExpression(0, &param)));
+    boost::scoped_ptr<BatchPredicate> batch(BatchPredicate::compile(timestampParam.get(), m_schema));
+    ASSERT_TRUE(batch != NULL);
+    ASSERT_FALSE(batch->bind());
+    param = ValueFactory::getIntegerValue(1);
+    ASSERT_TRUE(batch->bind());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
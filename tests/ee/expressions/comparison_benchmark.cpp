@@ -0,0 +1,214 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures how many rows per second common predicate shapes evaluate,
+ * comparing the generic ComparisonExpression with the specialized
+ * expressions ExpressionUtil::comparisonFactory builds for them, and
+ * checks that both select the same rows.
+ *
+ * It does nothing unless given a row count and a number of repetitions,
+ * e.g. "comparison_benchmark 1000000 20".
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+#include <vector>
+
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "harness.h"
+
+#include "common/NValue.hpp"
+#include "common/PlannerDomValue.h"
+#include "common/tabletuple.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "expressions/comparisonexpression.h"
+#include "expressions/conjunctionexpression.h"
+#include "expressions/constantvalueexpression.h"
+#include "expressions/expressionutil.h"
+#include "expressions/parametervalueexpression.h"
+#include "expressions/tuplevalueexpression.h"
+
+using namespace voltdb;
+
+namespace {
+
+int numRows = 0;
+int repetitions = 0;
+
+int64_t getMicrosNow() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+AbstractExpression* column(int col, ValueType type) {
+    AbstractExpression* tve = new TupleValueExpression(0, col);
+    tve->setValueType(type);
+    return tve;
+}
+
+AbstractExpression* constant(int64_t value) {
+    return new ConstantValueExpression(ValueFactory::getBigIntValue(value));
+}
+
+}
+
+class ComparisonBenchmark : public Test {
+public:
+    ComparisonBenchmark()
+        : m_schema(NULL)
+        , m_param(ValueFactory::getIntegerValue(500))
+        , m_domRoot("{}")
+    {
+        std::vector<ValueType> types;
+        std::vector<int32_t> sizes;
+        types.push_back(VALUE_TYPE_INTEGER); sizes.push_back(4);
+        types.push_back(VALUE_TYPE_BIGINT);  sizes.push_back(8);
+        std::vector<bool> allowNull(types.size(), true);
+        m_schema = TupleSchema::createTupleSchemaForTest(types, sizes, allowNull);
+
+        int tupleLength = m_schema->tupleLength() + TUPLE_HEADER_SIZE;
+        m_storage.reset(new char[tupleLength * numRows]);
+        srand(1234);
+        for (int i = 0; i < numRows; ++i) {
+            TableTuple tuple(m_storage.get() + i * tupleLength, m_schema);
+            tuple.setNValue(0, (i % 50 == 0) ? NValue::getNullValue(VALUE_TYPE_INTEGER)
+                                             : ValueFactory::getIntegerValue(rand() % 1000));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(rand() % 1000));
+            m_tuples.push_back(tuple);
+        }
+    }
+
+    ~ComparisonBenchmark()
+    {
+        TupleSchema::freeTupleSchema(m_schema);
+    }
+
+    AbstractExpression* specialized(ExpressionType type, AbstractExpression* left, AbstractExpression* right)
+    {
+        return ExpressionUtil::comparisonFactory(m_domRoot.rootObject(), type, left, right);
+    }
+
+    AbstractExpression* parameter()
+    {
+        return new ParameterValueExpression(0, &m_param);
+    }
+
+    /** Evaluate the predicate over every row, and return the rows per second. */
+    double rowsPerSecond(const AbstractExpression* predicate, int& selected)
+    {
+        int64_t start = getMicrosNow();
+        for (int r = 0; r < repetitions; ++r) {
+            selected = 0;
+            for (int i = 0; i < numRows; ++i) {
+                selected += predicate->eval(&m_tuples[i], NULL).isTrue();
+            }
+        }
+        int64_t elapsed = std::max(getMicrosNow() - start, static_cast<int64_t>(1));
+        return static_cast<double>(numRows) * repetitions * 1000000.0 / static_cast<double>(elapsed);
+    }
+
+    /** Time both versions of a predicate and check they agree. */
+    void compare(const std::string& shape, AbstractExpression* generic, AbstractExpression* special)
+    {
+        boost::scoped_ptr<AbstractExpression> genericPredicate(generic);
+        boost::scoped_ptr<AbstractExpression> specialPredicate(special);
+        int genericSelected = 0;
+        int specialSelected = 0;
+        double before = rowsPerSecond(genericPredicate.get(), genericSelected);
+        double after = rowsPerSecond(specialPredicate.get(), specialSelected);
+        std::cout << shape << ": generic " << static_cast<int64_t>(before)
+                  << " rows/sec, specialized " << static_cast<int64_t>(after)
+                  << " rows/sec (" << after / before << "x)" << std::endl;
+        ASSERT_EQ(genericSelected, specialSelected);
+    }
+
+protected:
+    TupleSchema* m_schema;
+    boost::scoped_array<char> m_storage;
+    std::vector<TableTuple> m_tuples;
+    NValue m_param;
+    PlannerDomRoot m_domRoot;
+};
+
+TEST_F(ComparisonBenchmark, ColumnComparedToConstant) {
+    compare("INT_COL < 300",
+            new ComparisonExpression<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                            column(0, VALUE_TYPE_INTEGER), constant(300)),
+            specialized(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                        column(0, VALUE_TYPE_INTEGER), constant(300)));
+    compare("BIGINT_COL = 7",
+            new ComparisonExpression<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                            column(1, VALUE_TYPE_BIGINT), constant(7)),
+            specialized(EXPRESSION_TYPE_COMPARE_EQUAL,
+                        column(1, VALUE_TYPE_BIGINT), constant(7)));
+}
+
+TEST_F(ComparisonBenchmark, ColumnComparedToParameter) {
+    compare("INT_COL >= ?",
+            new ComparisonExpression<CmpGte>(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                                             column(0, VALUE_TYPE_INTEGER), parameter()),
+            specialized(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                        column(0, VALUE_TYPE_INTEGER), parameter()));
+    // A parameter that is not an integer takes the generic path.
+    m_param = ValueFactory::getDoubleValue(499.5);
+    compare("INT_COL >= ? (DOUBLE)",
+            new ComparisonExpression<CmpGte>(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                                             column(0, VALUE_TYPE_INTEGER), parameter()),
+            specialized(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                        column(0, VALUE_TYPE_INTEGER), parameter()));
+}
+
+TEST_F(ComparisonBenchmark, Between) {
+    // The planner turns BETWEEN into a conjunction of two comparisons.
+    compare("BIGINT_COL BETWEEN 100 AND 200",
+            new ConjunctionExpression<ConjunctionAnd>(
+                    EXPRESSION_TYPE_CONJUNCTION_AND,
+                    new ComparisonExpression<CmpGte>(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                                                     column(1, VALUE_TYPE_BIGINT), constant(100)),
+                    new ComparisonExpression<CmpLte>(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                                     column(1, VALUE_TYPE_BIGINT), constant(200))),
+            ExpressionUtil::conjunctionFactory(
+                    EXPRESSION_TYPE_CONJUNCTION_AND,
+                    specialized(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                                column(1, VALUE_TYPE_BIGINT), constant(100)),
+                    specialized(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                column(1, VALUE_TYPE_BIGINT), constant(200))));
+}
+
+int main(int argc, char *argv[]) {
+    if (argc <= 2 || *argv[1] == '-') {
+        printf("To run the benchmark, execute %s with a row count and a number of repetitions.\n",
+               argv[0]);
+        return 0;
+    }
+    numRows = std::atoi(argv[1]);
+    repetitions = std::atoi(argv[2]);
+    return TestSuite::globalInstance()->runAll();
+}
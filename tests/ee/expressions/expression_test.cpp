@@ -55,13 +55,18 @@
 #include <time.h>
 #include <queue>
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "harness.h"
 #include "jsoncpp/jsoncpp.h"
 
 #include "expressions/abstractexpression.h"
 #include "expressions/expressions.h"
+#include "expressions/expressionutil.h"
+#include "common/executorcontext.hpp"
+#include "common/ThreadLocalPool.h"
 #include "common/types.h"
+#include "common/ValueFactory.hpp"
 #include "common/ValuePeeker.hpp"
 #include "common/PlannerDomValue.h"
 
@@ -499,6 +504,236 @@ TEST_F(ExpressionTest, Timestamp) {
 
 }
 
+/*
+ * LikeExpression must agree with NValue::like for every pattern, whether
+ * it takes a fast path or not.
+ */
+TEST_F(ExpressionTest, LikeWithInvariantPattern) {
+    ThreadLocalPool threadLocalPool;
+    Pool tempStringPool;
+    ExecutorContext context(0, 0, NULL, NULL, &tempStringPool, (VoltDBEngine*)NULL, "", 0, NULL, NULL, 0);
+    const char* patterns[] = {
+        "", "%", "%%", "abc", "abc%", "%abc", "%abc%", "a_c", "a%c", "%b%c%",
+        "abc%%", "%%abc", "_", "%_", "贾%", "%贾", "%贾贾%", "%aab%"
+    };
+    const char* values[] = {
+        "", "a", "abc", "abcd", "xabc", "xabcx", "ababc", "aabab", "aab",
+        "ab", "xxabxabcxx", "贾", "贾贾", "x贾贾y", "贾abc"
+    };
+    const size_t patternCount = sizeof(patterns) / sizeof(patterns[0]);
+    const size_t valueCount = sizeof(values) / sizeof(values[0]);
+
+    std::string literal;
+    ASSERT_EQ(LikeExpression::PATTERN_PREFIX, LikeExpression::classify("abc%", 4, literal));
+    ASSERT_EQ(std::string("abc"), literal);
+    ASSERT_EQ(LikeExpression::PATTERN_SUFFIX, LikeExpression::classify("%abc", 4, literal));
+    ASSERT_EQ(LikeExpression::PATTERN_CONTAINS, LikeExpression::classify("%abc%", 5, literal));
+    ASSERT_EQ(LikeExpression::PATTERN_EXACT, LikeExpression::classify("abc", 3, literal));
+    ASSERT_EQ(LikeExpression::PATTERN_ANY, LikeExpression::classify("%", 1, literal));
+    ASSERT_EQ(LikeExpression::PATTERN_GENERAL, LikeExpression::classify("a_c", 3, literal));
+    ASSERT_EQ(LikeExpression::PATTERN_GENERAL, LikeExpression::classify("abc%%", 5, literal));
+
+    NValue value;
+    NValue param;
+    PlannerDomRoot emptyRoot("{}");
+    for (size_t p = 0; p < patternCount; ++p) {
+        NValue pattern = ValueFactory::getStringValue(patterns[p]);
+        boost::scoped_ptr<AbstractExpression> constantLike(
+                ExpressionUtil::comparisonFactory(emptyRoot.rootObject(), EXPRESSION_TYPE_COMPARE_LIKE,
+                                                  new ParameterValueExpression(0, &value),
+                                                  new ConstantValueExpression(pattern)));
+        boost::scoped_ptr<AbstractExpression> parameterLike(
+                ExpressionUtil::comparisonFactory(emptyRoot.rootObject(), EXPRESSION_TYPE_COMPARE_LIKE,
+                                                  new ParameterValueExpression(0, &value),
+                                                  new ParameterValueExpression(1, &param)));
+        ASSERT_TRUE(dynamic_cast<LikeExpression*>(constantLike.get()) != NULL);
+        ASSERT_TRUE(dynamic_cast<LikeExpression*>(parameterLike.get()) != NULL);
+        for (size_t v = 0; v < valueCount; ++v) {
+            value = ValueFactory::getTempStringValue(values[v], strlen(values[v]));
+            // Walk the parameter through every pattern, so that the
+            // expression has to notice it change.
+            for (size_t q = 0; q < patternCount; ++q) {
+                param = ValueFactory::getTempStringValue(patterns[q], strlen(patterns[q]));
+                ASSERT_EQ(value.like(param).isTrue(), parameterLike->eval(NULL, NULL).isTrue());
+            }
+            bool expected = value.like(pattern).isTrue();
+            if (expected != constantLike->eval(NULL, NULL).isTrue()) {
+                cout << "'" << values[v] << "' LIKE '" << patterns[p] << "'" << endl;
+            }
+            ASSERT_EQ(expected, constantLike->eval(NULL, NULL).isTrue());
+        }
+        value = NValue::getNullValue(VALUE_TYPE_VARCHAR);
+        ASSERT_TRUE(constantLike->eval(NULL, NULL).isNull());
+    }
+}
+
+/*
+ * The comparisons comparisonFactory specializes for integer columns must
+ * give the same TRUE, FALSE and NULL results as comparing the NValues.
+ */
+TEST_F(ExpressionTest, ColumnComparisonMatchesGeneric) {
+    std::vector<ValueType> types;
+    std::vector<int32_t> sizes;
+    types.push_back(VALUE_TYPE_TINYINT); sizes.push_back(1);
+    types.push_back(VALUE_TYPE_INTEGER); sizes.push_back(4);
+    types.push_back(VALUE_TYPE_BIGINT);  sizes.push_back(8);
+    std::vector<bool> allowNull(types.size(), true);
+    TupleSchema* schema = TupleSchema::createTupleSchemaForTest(types, sizes, allowNull);
+    const int numRows = 200;
+    const int tupleLength = schema->tupleLength() + TUPLE_HEADER_SIZE;
+    boost::scoped_array<char> storage(new char[tupleLength * numRows]);
+    std::vector<TableTuple> tuples;
+    for (int i = 0; i < numRows; ++i) {
+        TableTuple tuple(storage.get() + i * tupleLength, schema);
+        for (int col = 0; col < types.size(); ++col) {
+            tuple.setNValue(col, (i % 17 == col) ? NValue::getNullValue(types[col])
+                                                 : ValueFactory::getTinyIntValue(static_cast<int8_t>(i % 11 - 5))
+                                                       .castAs(types[col]));
+        }
+        tuples.push_back(tuple);
+    }
+
+    const ExpressionType comparisons[] = {
+        EXPRESSION_TYPE_COMPARE_EQUAL, EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+        EXPRESSION_TYPE_COMPARE_LESSTHAN, EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+        EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO, EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO
+    };
+    // The last parameters are not integers, so they take the generic path.
+    const NValue params[] = {
+        ValueFactory::getBigIntValue(2), ValueFactory::getIntegerValue(-3),
+        ValueFactory::getDoubleValue(0.5), NValue::getNullValue(VALUE_TYPE_BIGINT)
+    };
+    PlannerDomRoot emptyRoot("{}");
+    NValue param;
+    for (int c = 0; c < sizeof(comparisons) / sizeof(comparisons[0]); ++c) {
+        for (int col = 0; col < types.size(); ++col) {
+            for (int p = 0; p < sizeof(params) / sizeof(params[0]); ++p) {
+                param = params[p];
+                TupleValueExpression* constantColumn = new TupleValueExpression(0, col);
+                TupleValueExpression* parameterColumn = new TupleValueExpression(0, col);
+                constantColumn->setValueType(types[col]);
+                parameterColumn->setValueType(types[col]);
+                boost::scoped_ptr<AbstractExpression> constant(
+                        ExpressionUtil::comparisonFactory(emptyRoot.rootObject(), comparisons[c],
+                                                          constantColumn,
+                                                          new ConstantValueExpression(params[p])));
+                boost::scoped_ptr<AbstractExpression> parameter(
+                        ExpressionUtil::comparisonFactory(emptyRoot.rootObject(), comparisons[c],
+                                                          parameterColumn,
+                                                          new ParameterValueExpression(0, &param)));
+                for (int i = 0; i < numRows; ++i) {
+                    NValue left = tuples[i].getNValue(col);
+                    NValue expected;
+                    if (left.isNull() || params[p].isNull()) {
+                        expected = NValue::getNullValue(VALUE_TYPE_BOOLEAN);
+                    }
+                    else {
+                        int cmp = left.compare(params[p]);
+                        bool result = false;
+                        switch (comparisons[c]) {
+                        case EXPRESSION_TYPE_COMPARE_EQUAL: result = cmp == 0; break;
+                        case EXPRESSION_TYPE_COMPARE_NOTEQUAL: result = cmp != 0; break;
+                        case EXPRESSION_TYPE_COMPARE_LESSTHAN: result = cmp < 0; break;
+                        case EXPRESSION_TYPE_COMPARE_GREATERTHAN: result = cmp > 0; break;
+                        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO: result = cmp <= 0; break;
+                        default: result = cmp >= 0; break;
+                        }
+                        expected = result ? NValue::getTrue() : NValue::getFalse();
+                    }
+                    NValue fromConstant = constant->eval(&tuples[i], NULL);
+                    NValue fromParameter = parameter->eval(&tuples[i], NULL);
+                    ASSERT_EQ(expected.isNull(), fromConstant.isNull());
+                    ASSERT_EQ(expected.isNull(), fromParameter.isNull());
+                    ASSERT_EQ(expected.isTrue(), fromConstant.isTrue());
+                    ASSERT_EQ(expected.isTrue(), fromParameter.isTrue());
+                }
+            }
+        }
+    }
+    TupleSchema::freeTupleSchema(schema);
+}
+
+/*
+ * The hashed InListExpression must give the same TRUE, FALSE and NULL
+ * results as ComparisonExpression scanning the list, and follow an array
+ * parameter from one execution to the next.
+ */
+TEST_F(ExpressionTest, InListMatchesGeneric) {
+    ThreadLocalPool threadLocalPool;
+    Pool tempStringPool;
+    ExecutorContext context(0, 0, NULL, NULL, &tempStringPool, (VoltDBEngine*)NULL, "", 0, NULL, NULL, 0);
+    PlannerDomRoot emptyRoot("{}");
+
+    std::vector<NValue> rows;
+    for (int i = 0; i < 300; ++i) {
+        rows.push_back(i % 50 == 0 ? NValue::getNullValue(VALUE_TYPE_BIGINT)
+                                   : ValueFactory::getBigIntValue(i % 150));
+    }
+    NValue value;
+    for (int withNull = 0; withNull < 2; ++withNull) {
+        for (int count = 10; count <= 100; count *= 10) {
+            // Every other element is a value some row holds.
+            std::vector<AbstractExpression*>* genericElements = new std::vector<AbstractExpression*>();
+            std::vector<AbstractExpression*>* hashedElements = new std::vector<AbstractExpression*>();
+            for (int i = 0; i < count; ++i) {
+                NValue element = (withNull && i == count / 2) ? NValue::getNullValue(VALUE_TYPE_BIGINT)
+                                                              : ValueFactory::getBigIntValue(i % 2 == 0 ? i : 1000 + i);
+                genericElements->push_back(new ConstantValueExpression(element));
+                hashedElements->push_back(new ConstantValueExpression(element));
+            }
+            boost::scoped_ptr<AbstractExpression> generic(
+                    new ComparisonExpression<CmpIn>(EXPRESSION_TYPE_COMPARE_IN,
+                                                    new ParameterValueExpression(0, &value),
+                                                    ExpressionUtil::vectorFactory(VALUE_TYPE_BIGINT, genericElements)));
+            boost::scoped_ptr<AbstractExpression> hashed(
+                    ExpressionUtil::comparisonFactory(emptyRoot.rootObject(), EXPRESSION_TYPE_COMPARE_IN,
+                                                      new ParameterValueExpression(0, &value),
+                                                      ExpressionUtil::vectorFactory(VALUE_TYPE_BIGINT, hashedElements)));
+            ASSERT_TRUE(dynamic_cast<InListExpression*>(hashed.get()) != NULL);
+            for (int i = 0; i < rows.size(); ++i) {
+                value = rows[i];
+                NValue expected = generic->eval(NULL, NULL);
+                NValue actual = hashed->eval(NULL, NULL);
+                ASSERT_EQ(expected.isNull(), actual.isNull());
+                ASSERT_EQ(expected.isTrue(), actual.isTrue());
+            }
+        }
+    }
+
+    std::vector<NValue> elements;
+    for (int i = 0; i < 100; ++i) {
+        elements.push_back(ValueFactory::getBigIntValue(i * 2));
+    }
+    NValue param = ValueFactory::getArrayValueFromSizeAndType(elements.size(), VALUE_TYPE_BIGINT);
+    param.setArrayElements(elements);
+    NValue original = param;
+    boost::scoped_ptr<AbstractExpression> predicate(
+            ExpressionUtil::comparisonFactory(emptyRoot.rootObject(), EXPRESSION_TYPE_COMPARE_IN,
+                                              new ParameterValueExpression(0, &value),
+                                              new ParameterValueExpression(1, &param)));
+    ASSERT_TRUE(dynamic_cast<InListExpression*>(predicate.get()) != NULL);
+    value = ValueFactory::getBigIntValue(42);
+    EXPECT_TRUE(predicate->eval(NULL, NULL).isTrue());
+
+    // The set follows the parameter from one execution to the next.
+    std::vector<NValue> single(1, ValueFactory::getBigIntValue(43));
+    NValue other = ValueFactory::getArrayValueFromSizeAndType(1, VALUE_TYPE_BIGINT);
+    other.setArrayElements(single);
+    param = other;
+    context.advanceParameterGeneration();
+    EXPECT_TRUE(predicate->eval(NULL, NULL).isFalse());
+    value = ValueFactory::getBigIntValue(43);
+    EXPECT_TRUE(predicate->eval(NULL, NULL).isTrue());
+
+    // A NULL parameter is left to ComparisonExpression, which returns NULL.
+    param = NValue::getNullValue(VALUE_TYPE_BIGINT);
+    context.advanceParameterGeneration();
+    EXPECT_TRUE(predicate->eval(NULL, NULL).isNull());
+
+    other.free();
+    original.free();
+}
+
 int main() {
      return TestSuite::globalInstance()->runAll();
 }
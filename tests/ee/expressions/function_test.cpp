@@ -66,6 +66,7 @@
 #include "expressions/expressions.h"
 #include "expressions/expressionutil.h"
 #include "expressions/functionexpression.h"
+#include "expressions/regexpcache.h"
 #include "expressions/constantvalueexpression.h"
 
 using namespace voltdb;
@@ -753,6 +754,172 @@ TEST_F(FunctionTest, RegularExpressionMatch) {
     ASSERT_EQ(testBinary(FUNC_VOLT_REGEXP_POSITION, testUTF8String, "[a-z]家", 0), 0);
 }
 
+TEST_F(FunctionTest, RegularExpressionCache) {
+    RegexpCache::clear();
+    std::string testString("TEST reGexp_poSiTion123456Test");
+    int errorCode = 0;
+    const char* pattern = "[a-z](\\d+)[a-z]";
+    const RegexpCache::Entry* first = RegexpCache::lookup(pattern, strlen(pattern), PCRE2_UTF, errorCode);
+    ASSERT_TRUE(first != NULL);
+    // The same text with other options compiles to another pattern.
+    const RegexpCache::Entry* caseless =
+        RegexpCache::lookup(pattern, strlen(pattern), PCRE2_UTF | PCRE2_CASELESS, errorCode);
+    ASSERT_TRUE(caseless != NULL);
+    ASSERT_TRUE(caseless != first);
+    ASSERT_EQ(first, RegexpCache::lookup(pattern, strlen(pattern), PCRE2_UTF, errorCode));
+    ASSERT_EQ(2, RegexpCache::size());
+
+    // Rows that share a pattern all see the same answers.
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(testBinary(FUNC_VOLT_REGEXP_POSITION, testString, std::string("[a-z](\\d+)[a-z]"), 0), 0);
+        ASSERT_EQ(testTernary(FUNC_VOLT_REGEXP_POSITION, testString, std::string("[a-z](\\d+)[a-z]"), "i", 20), 0);
+    }
+    ASSERT_EQ(2, RegexpCache::size());
+
+    // Patterns that do not compile are not kept.
+    ASSERT_TRUE(RegexpCache::lookup("[a-z](a]", 8, PCRE2_UTF, errorCode) == NULL);
+    ASSERT_EQ(2, RegexpCache::size());
+
+    // The least recently used patterns make way for new ones.
+    for (size_t i = 0; i < RegexpCache::CAPACITY; ++i) {
+        std::ostringstream oss;
+        oss << "x{" << i << "}";
+        std::string distinct = oss.str();
+        ASSERT_TRUE(RegexpCache::lookup(distinct.c_str(), distinct.size(), PCRE2_UTF, errorCode) != NULL);
+        if (i == 0) {
+            ASSERT_EQ(first, RegexpCache::lookup(pattern, strlen(pattern), PCRE2_UTF, errorCode));
+        }
+    }
+    ASSERT_EQ(RegexpCache::CAPACITY, RegexpCache::size());
+    ASSERT_EQ(first, RegexpCache::lookup(pattern, strlen(pattern), PCRE2_UTF, errorCode));
+    RegexpCache::clear();
+    ASSERT_EQ(0, RegexpCache::size());
+}
+
+static NValue jsonField(const std::string& doc, const std::string& path) {
+    std::vector<NValue> arguments;
+    arguments.push_back(ValueFactory::getTempStringValue(doc));
+    arguments.push_back(ValueFactory::getTempStringValue(path));
+    return NValue::call<FUNC_VOLT_FIELD>(arguments);
+}
+
+/** Compare FIELD with a walk over the jsoncpp DOM of the document. */
+static bool jsonFieldMatchesDom(const std::string& doc, const std::string& path) {
+    JsonDocumentCache::clear();
+    JsonDocument dom(doc.c_str(), static_cast<int32_t>(doc.size()));
+    std::string expected;
+    bool found = dom.get(path.c_str(), static_cast<int32_t>(path.size()), expected);
+    NValue result = jsonField(doc, path);
+    bool matches = (found != result.isNull());
+    if (matches && found) {
+        int32_t length;
+        const char* chars = ValuePeeker::peekObject_withoutNull(result, &length);
+        matches = expected.substr(0, expected.size() - 1) == std::string(chars, length);
+    }
+    if ( ! matches) {
+        std::cout << "FIELD(" << doc << ", '" << path << "') differs from the DOM" << std::endl;
+    }
+    return matches;
+}
+
+TEST_F(FunctionTest, JsonFieldSinglePass) {
+    const char* docs[] = {
+        "{\"a\":\"x\",\"b\":{\"c\":[1,2,{\"d\":\"deep\"}]},\"n\":null,\"t\":true,\"f\":false,"
+            "\"z\":-0,\"big\":18446744073709551615,\"huge\":18446744073709551616,"
+            "\"neg\":-9223372036854775808,\"r\":1.50,\"e\":1e2,\"s\":\"\\u00e9\\\"q\\u0000z\"}",
+        "{\"a\":{\"b\":1},\"a\":{\"c\":2}}",
+        "{\"a\":[1,{\"b\":\"first\"}],\"a\":[{\"b\":\"second\"}]}",
+        "[1,\"two\",[3],{\"four\":4},null]",
+        "{\"\":{\"\":[true,false]}}",
+        "\"just a string\"",
+        "null",
+        "{\"a\":\"x\"} // trailing comment"
+    };
+    const char* paths[] = {
+        "a", "b.c[2].d", "b.c[-1]", "b.c[-1].d", "b.c[1]", "b.c[5]", "b", "b.c", "n", "t", "f",
+        "z", "big", "huge", "neg", "r", "e", "s", "a.b", "a.c", "a[0].b", "a[-1].b",
+        "[0]", "[1]", "[-1]", "[3].four", ".", "..[1]", "missing", "b.c.d"
+    };
+    for (size_t d = 0; d < sizeof(docs) / sizeof(docs[0]); ++d) {
+        for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); ++p) {
+            ASSERT_TRUE(jsonFieldMatchesDom(docs[d], paths[p]));
+        }
+    }
+
+    // Strings, integers and booleans never need the DOM.
+    std::string value;
+    std::string doc(docs[0]);
+    ASSERT_EQ(JsonPath::JSON_PATH_FOUND,
+              JsonPath::extract(doc.c_str(), static_cast<int32_t>(doc.size()),
+                                JsonPath::resolve("b.c[2].d", 8), value));
+    ASSERT_EQ(std::string("deep"), value);
+    ASSERT_EQ(JsonPath::JSON_PATH_FOUND,
+              JsonPath::extract(doc.c_str(), static_cast<int32_t>(doc.size()),
+                                JsonPath::resolve("z", 1), value));
+    ASSERT_EQ(std::string("0"), value);
+    ASSERT_EQ(JsonPath::JSON_PATH_MISSING,
+              JsonPath::extract(doc.c_str(), static_cast<int32_t>(doc.size()),
+                                JsonPath::resolve("n", 1), value));
+    ASSERT_EQ(JsonPath::JSON_PATH_UNDECIDED,
+              JsonPath::extract(doc.c_str(), static_cast<int32_t>(doc.size()),
+                                JsonPath::resolve("r", 1), value));
+
+    // A document that isn't JSON is reported ahead of a bad path.
+    try {
+        jsonField("{\"a\":", "[x");
+        FAIL("expected an invalid JSON error");
+    }
+    catch (const SQLException& e) {
+        ASSERT_TRUE(e.message().find("Invalid JSON path") == std::string::npos);
+    }
+    try {
+        jsonField("{\"a\":1}", "[x");
+        FAIL("expected an invalid path error");
+    }
+    catch (const SQLException& e) {
+        ASSERT_TRUE(e.message().find("Invalid JSON path") != std::string::npos);
+    }
+}
+
+TEST_F(FunctionTest, JsonArrayFunctions) {
+    const char* docs[] = { "[1,\"two\",[3],{\"b\":1,\"a\":2},null]", "[]", "{\"a\":[1]}", "7" };
+    for (size_t d = 0; d < sizeof(docs) / sizeof(docs[0]); ++d) {
+        std::string doc(docs[d]);
+        JsonDocumentCache::clear();
+        const Json::Value& root = JsonDocumentCache::parse(doc.c_str(), static_cast<int32_t>(doc.size()));
+        NValue length = ValueFactory::getTempStringValue(doc).callUnary<FUNC_VOLT_ARRAY_LENGTH>();
+        ASSERT_EQ(root.isArray(), ! length.isNull());
+        if (root.isArray()) {
+            ASSERT_EQ(static_cast<int32_t>(root.size()), ValuePeeker::peekInteger(length));
+        }
+        for (int32_t index = -1; index < 6; ++index) {
+            std::vector<NValue> arguments;
+            arguments.push_back(ValueFactory::getTempStringValue(doc));
+            arguments.push_back(ValueFactory::getIntegerValue(index));
+            NValue element = NValue::call<FUNC_VOLT_ARRAY_ELEMENT>(arguments);
+            std::ostringstream path;
+            path << "[" << index << "]";
+            if (index < 0 || ! root.isArray()) {
+                ASSERT_TRUE(element.isNull());
+            }
+            else {
+                ASSERT_TRUE(jsonFieldMatchesDom(doc, path.str()));
+                NValue field = jsonField(doc, path.str());
+                ASSERT_EQ(field.isNull(), element.isNull());
+                if ( ! field.isNull()) {
+                    ASSERT_EQ(0, field.compare(element));
+                }
+            }
+        }
+    }
+
+    // Functions over the same document of a row share one parse.
+    std::string doc(docs[0]);
+    JsonDocumentCache::clear();
+    const Json::Value* first = &JsonDocumentCache::parse(doc.c_str(), static_cast<int32_t>(doc.size()));
+    ASSERT_EQ(first, &JsonDocumentCache::parse(doc.c_str(), static_cast<int32_t>(doc.size())));
+}
+
 static NValue timestampFromString(const std::string& dateString) {
     return ValueFactory::getTimestampValue(NValue::parseTimestampString(dateString));
 }
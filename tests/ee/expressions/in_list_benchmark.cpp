@@ -0,0 +1,261 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures how many rows per second IN-list predicates evaluate, comparing
+ * the generic ComparisonExpression, which scans the list for every row,
+ * with the hashed InListExpression ExpressionUtil::comparisonFactory builds
+ * for lists of constants and parameters, and checks that both return the
+ * same TRUE, FALSE and NULL results.
+ *
+ * It does nothing unless given a row count and a number of repetitions,
+ * e.g. "in_list_benchmark 100000 5".
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <sys/time.h>
+#include <vector>
+
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "harness.h"
+
+#include "common/NValue.hpp"
+#include "common/PlannerDomValue.h"
+#include "common/tabletuple.h"
+#include "common/ThreadLocalPool.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "expressions/comparisonexpression.h"
+#include "expressions/constantvalueexpression.h"
+#include "expressions/expressionutil.h"
+#include "expressions/inlistexpression.h"
+#include "expressions/tuplevalueexpression.h"
+
+using namespace voltdb;
+
+namespace {
+
+int numRows = 0;
+int repetitions = 0;
+
+int64_t getMicrosNow() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+AbstractExpression* column(int col, ValueType type) {
+    AbstractExpression* tve = new TupleValueExpression(0, col);
+    tve->setValueType(type);
+    return tve;
+}
+
+std::string keyString(int64_t key) {
+    std::ostringstream oss;
+    oss << "key" << key;
+    return oss.str();
+}
+
+/** The values the rows hold are spread over twice the largest list size. */
+const int64_t VALUE_RANGE = 20000;
+
+struct Evaluation {
+    Evaluation() : trues(0), nulls(0) { }
+    int trues;
+    int nulls;
+};
+
+}
+
+class InListBenchmark : public Test {
+public:
+    InListBenchmark()
+        : m_threadLocalPool()
+        , m_schema(NULL)
+        , m_domRoot("{}")
+    {
+        std::vector<ValueType> types;
+        std::vector<int32_t> sizes;
+        types.push_back(VALUE_TYPE_BIGINT);  sizes.push_back(8);
+        types.push_back(VALUE_TYPE_VARCHAR); sizes.push_back(16);
+        std::vector<bool> allowNull(types.size(), true);
+        m_schema = TupleSchema::createTupleSchemaForTest(types, sizes, allowNull);
+
+        int tupleLength = m_schema->tupleLength() + TUPLE_HEADER_SIZE;
+        m_storage.reset(new char[tupleLength * numRows]);
+        srand(1234);
+        for (int i = 0; i < numRows; ++i) {
+            TableTuple tuple(m_storage.get() + i * tupleLength, m_schema);
+            int64_t key = rand() % VALUE_RANGE;
+            if (i % 50 == 0) {
+                tuple.setNValue(0, NValue::getNullValue(VALUE_TYPE_BIGINT));
+                tuple.setNValue(1, NValue::getNullValue(VALUE_TYPE_VARCHAR));
+            }
+            else {
+                tuple.setNValue(0, ValueFactory::getBigIntValue(key));
+                NValue text = ValueFactory::getStringValue(keyString(key));
+                tuple.setNValue(1, text);
+                text.free();
+            }
+            m_tuples.push_back(tuple);
+        }
+    }
+
+    ~InListBenchmark()
+    {
+        TupleSchema::freeTupleSchema(m_schema);
+    }
+
+    /** Build a list of count constants, every other one a value some row holds. */
+    std::vector<AbstractExpression*>* constants(int count, ValueType type, bool withNull)
+    {
+        std::vector<AbstractExpression*>* elements = new std::vector<AbstractExpression*>();
+        for (int i = 0; i < count; ++i) {
+            int64_t key = (i % 2 == 0) ? i : VALUE_RANGE + i;
+            if (withNull && i == count / 2) {
+                elements->push_back(new ConstantValueExpression(NValue::getNullValue(type)));
+            }
+            else if (type == VALUE_TYPE_VARCHAR) {
+                elements->push_back(new ConstantValueExpression(ValueFactory::getStringValue(keyString(key))));
+            }
+            else {
+                elements->push_back(new ConstantValueExpression(ValueFactory::getBigIntValue(key)));
+            }
+        }
+        return elements;
+    }
+
+    AbstractExpression* list(int count, ValueType type, bool withNull)
+    {
+        return ExpressionUtil::vectorFactory(type, constants(count, type, withNull));
+    }
+
+    AbstractExpression* generic(AbstractExpression* left, AbstractExpression* right)
+    {
+        return new ComparisonExpression<CmpIn>(EXPRESSION_TYPE_COMPARE_IN, left, right);
+    }
+
+    AbstractExpression* specialized(AbstractExpression* left, AbstractExpression* right)
+    {
+        AbstractExpression* result =
+            ExpressionUtil::comparisonFactory(m_domRoot.rootObject(), EXPRESSION_TYPE_COMPARE_IN, left, right);
+        EXPECT_TRUE(dynamic_cast<InListExpression*>(result) != NULL);
+        return result;
+    }
+
+    /** Evaluate the predicate over every row, and return the rows per second. */
+    double rowsPerSecond(const AbstractExpression* predicate, Evaluation& evaluation)
+    {
+        int64_t start = getMicrosNow();
+        for (int r = 0; r < repetitions; ++r) {
+            evaluation = Evaluation();
+            for (int i = 0; i < numRows; ++i) {
+                NValue result = predicate->eval(&m_tuples[i], NULL);
+                if (result.isNull()) {
+                    ++evaluation.nulls;
+                }
+                else if (result.isTrue()) {
+                    ++evaluation.trues;
+                }
+            }
+        }
+        int64_t elapsed = std::max(getMicrosNow() - start, static_cast<int64_t>(1));
+        return static_cast<double>(numRows) * repetitions * 1000000.0 / static_cast<double>(elapsed);
+    }
+
+    /** Time both versions of a predicate and check they agree. */
+    void compare(const std::string& shape, AbstractExpression* genericPredicate, AbstractExpression* specialPredicate)
+    {
+        boost::scoped_ptr<AbstractExpression> genericOwner(genericPredicate);
+        boost::scoped_ptr<AbstractExpression> specialOwner(specialPredicate);
+        Evaluation genericResult;
+        Evaluation specialResult;
+        double before = rowsPerSecond(genericPredicate, genericResult);
+        double after = rowsPerSecond(specialPredicate, specialResult);
+        std::cout << shape << ": generic " << static_cast<int64_t>(before)
+                  << " rows/sec, hashed " << static_cast<int64_t>(after)
+                  << " rows/sec (" << after / before << "x)" << std::endl;
+        ASSERT_TRUE(genericResult.trues > 0);
+        ASSERT_EQ(genericResult.trues, specialResult.trues);
+        ASSERT_EQ(genericResult.nulls, specialResult.nulls);
+    }
+
+    void compareIntegers(int count, bool withNull)
+    {
+        std::ostringstream shape;
+        shape << "BIGINT_COL IN (" << count << " constants" << (withNull ? ", NULL" : "") << ")";
+        compare(shape.str(),
+                generic(column(0, VALUE_TYPE_BIGINT), list(count, VALUE_TYPE_BIGINT, withNull)),
+                specialized(column(0, VALUE_TYPE_BIGINT), list(count, VALUE_TYPE_BIGINT, withNull)));
+    }
+
+    void compareStrings(int count)
+    {
+        std::ostringstream shape;
+        shape << "VARCHAR_COL IN (" << count << " constants)";
+        compare(shape.str(),
+                generic(column(1, VALUE_TYPE_VARCHAR), list(count, VALUE_TYPE_VARCHAR, false)),
+                specialized(column(1, VALUE_TYPE_VARCHAR), list(count, VALUE_TYPE_VARCHAR, false)));
+    }
+
+protected:
+    ThreadLocalPool m_threadLocalPool;
+    TupleSchema* m_schema;
+    boost::scoped_array<char> m_storage;
+    std::vector<TableTuple> m_tuples;
+    PlannerDomRoot m_domRoot;
+};
+
+TEST_F(InListBenchmark, IntegerConstants) {
+    compareIntegers(10, false);
+    compareIntegers(100, false);
+    compareIntegers(10000, false);
+}
+
+TEST_F(InListBenchmark, StringConstants) {
+    compareStrings(10);
+    compareStrings(100);
+    compareStrings(10000);
+}
+
+TEST_F(InListBenchmark, NullElement) {
+    // A NULL in the list never matches; rows that match nothing else stay FALSE.
+    compareIntegers(100, true);
+    compareIntegers(10000, true);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc <= 2 || *argv[1] == '-') {
+        printf("To run the benchmark, execute %s with a row count and a number of repetitions.\n",
+               argv[0]);
+        return 0;
+    }
+    numRows = std::atoi(argv[1]);
+    repetitions = std::atoi(argv[2]);
+    return TestSuite::globalInstance()->runAll();
+}
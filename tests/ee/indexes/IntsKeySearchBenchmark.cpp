@@ -0,0 +1,329 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures the IntsKey paths used by tree index lookups and checks that
+ * the fast versions agree with the straightforward ones:
+ *  - packing key values a word at a time against the old byte at a time loop
+ *  - point lookups in B+trees of one word keys, against binary search
+ * index_key_test checks the node search itself for every instruction set.
+ *
+ * It does nothing unless given an entry count and a lookup count, e.g.
+ * "IntsKeySearchBenchmark 1000000 10000000".
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+#include <vector>
+
+#include "harness.h"
+
+#include "indexes/IntsKeySearch.h"
+#include "indexes/indexkey.h"
+#include "structures/CompactingBTree.h"
+
+using namespace voltdb;
+
+namespace {
+
+int numEntries = 0;
+int numLookups = 0;
+
+int64_t getMicrosNow() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+uint64_t randomWord() {
+    return (static_cast<uint64_t>(rand()) << 62) ^ (static_cast<uint64_t>(rand()) << 31) ^ rand();
+}
+
+const char* levelName(IntsKeySearch::Level level) {
+    switch (level) {
+    case IntsKeySearch::AVX2:
+        return "AVX2";
+    case IntsKeySearch::SSE42:
+        return "SSE4.2";
+    default:
+        return "scalar";
+    }
+}
+
+// How IntsKey packed values before it shifted whole values into place.
+template <typename keyValueType, std::size_t keySize>
+void insertBytewise(IntsKey<keySize> &key, int &keyOffset, int &intraKeyOffset, uint64_t keyValue) {
+    for (int ii = static_cast<int>(sizeof(keyValueType)) - 1; ii >= 0; ii--) {
+        key.data[keyOffset] |= (0xFF & (keyValue >> (ii * 8))) << (intraKeyOffset * 8);
+        intraKeyOffset--;
+        if (intraKeyOffset < 0) {
+            intraKeyOffset = static_cast<int>(sizeof(uint64_t) - 1);
+            keyOffset++;
+        }
+    }
+}
+
+// Packs one value per column, dispatching on the column width like IntsKey::setFromTuple.
+template <bool bytewise>
+IntsKey<2> packKey(const std::vector<int> &widths, const uint64_t *values) {
+    IntsKey<2> key;
+    key.data[0] = key.data[1] = 0;
+    int keyOffset = 0;
+    int intraKeyOffset = static_cast<int>(sizeof(uint64_t) - 1);
+    for (size_t ii = 0; ii < widths.size(); ++ii) {
+        switch (widths[ii]) {
+        case 8:
+            if (bytewise) {
+                insertBytewise<uint64_t>(key, keyOffset, intraKeyOffset, values[ii]);
+            }
+            else {
+                key.insertKeyValue<uint64_t>(keyOffset, intraKeyOffset, values[ii]);
+            }
+            break;
+        case 4:
+            if (bytewise) {
+                insertBytewise<uint32_t>(key, keyOffset, intraKeyOffset, values[ii] & 0xFFFFFFFF);
+            }
+            else {
+                key.insertKeyValue<uint32_t>(keyOffset, intraKeyOffset, values[ii] & 0xFFFFFFFF);
+            }
+            break;
+        case 2:
+            if (bytewise) {
+                insertBytewise<uint16_t>(key, keyOffset, intraKeyOffset, values[ii] & 0xFFFF);
+            }
+            else {
+                key.insertKeyValue<uint16_t>(keyOffset, intraKeyOffset, values[ii] & 0xFFFF);
+            }
+            break;
+        default:
+            if (bytewise) {
+                insertBytewise<uint8_t>(key, keyOffset, intraKeyOffset, values[ii] & 0xFF);
+            }
+            else {
+                key.insertKeyValue<uint8_t>(keyOffset, intraKeyOffset, values[ii] & 0xFF);
+            }
+            break;
+        }
+    }
+    return key;
+}
+
+// Same as IntsComparator<1>, but takes CompactingBTree's default binary search.
+struct BinarySearchIntsComparator : public IntsComparator<1> {
+    BinarySearchIntsComparator() : IntsComparator<1>(NULL) {}
+};
+
+struct BinarySearchPointerComparator : public ComparatorWithPointer<IntsKey<1> > {
+    BinarySearchPointerComparator() : ComparatorWithPointer<IntsKey<1> >(NULL) {}
+};
+
+typedef NormalKeyValuePair<IntsKey<1>, const void*> UniqueEntry;
+typedef PointerKeyValuePair<IntsKey<1>, const void*> MultiEntry;
+
+IntsKey<1> intsKey(uint64_t word) {
+    IntsKey<1> key;
+    key.data[0] = word;
+    return key;
+}
+
+KeyWithPointer<IntsKey<1> > pointerKey(uint64_t word, uint64_t pointer) {
+    KeyWithPointer<IntsKey<1> > key;
+    key.data[0] = word;
+    key.setValue(reinterpret_cast<const void*>(pointer));
+    return key;
+}
+
+// A unique index point lookup.
+struct FindKey {
+    template <typename Tree>
+    bool operator()(const Tree &tree, uint64_t word) const {
+        return !tree.find(intsKey(word)).isEnd();
+    }
+};
+
+// A non-unique index point lookup, which starts at the key's first entry.
+struct FindFirstEntry {
+    template <typename Tree>
+    bool operator()(const Tree &tree, uint64_t word) const {
+        typename Tree::iterator iter = tree.lowerBound(pointerKey(word, 0));
+        return !iter.isEnd() && iter.key().data[0] == word;
+    }
+};
+
+}
+
+class IntsKeySearchBenchmark : public Test {
+public:
+    IntsKeySearchBenchmark()
+    {
+        srand(1234);
+        for (int i = 0; i < numEntries; ++i) {
+            m_words.push_back(randomWord());
+        }
+        for (int i = 0; i < numLookups; ++i) {
+            m_lookups.push_back(m_words[rand() % numEntries]);
+        }
+    }
+
+    ~IntsKeySearchBenchmark()
+    {
+        IntsKeySearch::setLevel(IntsKeySearch::supportedLevel());
+    }
+
+    std::vector<IntsKeySearch::Level> levels()
+    {
+        std::vector<IntsKeySearch::Level> result;
+        for (int level = IntsKeySearch::SCALAR; level <= IntsKeySearch::supportedLevel(); ++level) {
+            result.push_back(static_cast<IntsKeySearch::Level>(level));
+        }
+        return result;
+    }
+
+    /** Look up every probe in a tree filled from m_words, and return the lookups per second. */
+    template <typename Tree, typename Lookup>
+    double lookupsPerSecond(const Tree &tree, Lookup lookup, int &found)
+    {
+        int64_t start = getMicrosNow();
+        found = 0;
+        for (int i = 0; i < numLookups; ++i) {
+            found += lookup(tree, m_lookups[i]);
+        }
+        int64_t elapsed = std::max(getMicrosNow() - start, static_cast<int64_t>(1));
+        return static_cast<double>(numLookups) * 1000000.0 / static_cast<double>(elapsed);
+    }
+
+    template <typename Tree, typename BinaryTree, typename Lookup>
+    void compareLookups(const std::string &shape, const Tree &tree, const BinaryTree &binaryTree, Lookup lookup)
+    {
+        int expected = 0;
+        double before = lookupsPerSecond(binaryTree, lookup, expected);
+        std::cout << shape << ": binary search " << static_cast<int64_t>(before) << " lookups/sec";
+        std::vector<IntsKeySearch::Level> all = levels();
+        for (size_t i = 0; i < all.size(); ++i) {
+            IntsKeySearch::setLevel(all[i]);
+            int found = 0;
+            double after = lookupsPerSecond(tree, lookup, found);
+            std::cout << ", " << levelName(all[i]) << " " << static_cast<int64_t>(after)
+                      << " (" << after / before << "x)";
+            ASSERT_EQ(expected, found);
+        }
+        std::cout << std::endl;
+        ASSERT_EQ(numLookups, expected);
+    }
+
+protected:
+    std::vector<uint64_t> m_words;
+    std::vector<uint64_t> m_lookups;
+};
+
+TEST_F(IntsKeySearchBenchmark, PackKeys) {
+    // An INTEGER, a SMALLINT, a BIGINT and a TINYINT: 15 bytes that straddle two words.
+    std::vector<int> widths;
+    widths.push_back(4);
+    widths.push_back(2);
+    widths.push_back(8);
+    widths.push_back(1);
+    const int repetitions = std::max(numLookups / 10, 1);
+
+    uint64_t checksum[2] = { 0, 0 };
+    int64_t start = getMicrosNow();
+    for (int r = 0; r < repetitions; ++r) {
+        for (int i = 0; i < 10; ++i) {
+            IntsKey<2> key = packKey<true>(widths, &m_words[i * widths.size()]);
+            checksum[0] += key.data[0];
+            checksum[1] += key.data[1];
+        }
+    }
+    int64_t bytewise = std::max(getMicrosNow() - start, static_cast<int64_t>(1));
+
+    uint64_t wordChecksum[2] = { 0, 0 };
+    start = getMicrosNow();
+    for (int r = 0; r < repetitions; ++r) {
+        for (int i = 0; i < 10; ++i) {
+            IntsKey<2> key = packKey<false>(widths, &m_words[i * widths.size()]);
+            wordChecksum[0] += key.data[0];
+            wordChecksum[1] += key.data[1];
+        }
+    }
+    int64_t wordwise = std::max(getMicrosNow() - start, static_cast<int64_t>(1));
+
+    std::cout << "pack 4 column key: bytewise " << bytewise << " us, wordwise " << wordwise << " us" << std::endl;
+    ASSERT_EQ(checksum[0], wordChecksum[0]);
+    ASSERT_EQ(checksum[1], wordChecksum[1]);
+
+    for (int i = 0; i < 10; ++i) {
+        const uint64_t *values = &m_words[i * widths.size()];
+        IntsKey<2> key = packKey<false>(widths, values);
+        int keyOffset = 0;
+        int intraKeyOffset = static_cast<int>(sizeof(uint64_t) - 1);
+        ASSERT_EQ(values[0] & 0xFFFFFFFF, key.extractKeyValue<uint32_t>(keyOffset, intraKeyOffset));
+        ASSERT_EQ(values[1] & 0xFFFF, key.extractKeyValue<uint16_t>(keyOffset, intraKeyOffset));
+        ASSERT_EQ(values[2], key.extractKeyValue<uint64_t>(keyOffset, intraKeyOffset));
+        ASSERT_EQ(values[3] & 0xFF, key.extractKeyValue<uint8_t>(keyOffset, intraKeyOffset));
+    }
+}
+
+TEST_F(IntsKeySearchBenchmark, UniqueTreeLookups) {
+    CompactingBTree<UniqueEntry, IntsComparator<1> > tree(true, IntsComparator<1>(NULL));
+    CompactingBTree<UniqueEntry, BinarySearchIntsComparator> binaryTree(true, BinarySearchIntsComparator());
+    for (int i = 0; i < numEntries; ++i) {
+        tree.insert(intsKey(m_words[i]), NULL);
+        binaryTree.insert(intsKey(m_words[i]), NULL);
+    }
+    compareLookups("unique BIGINT key", tree, binaryTree, FindKey());
+}
+
+TEST_F(IntsKeySearchBenchmark, MultiTreeLookups) {
+    // Few distinct keys, so lookups also order entries by tuple address.
+    for (int i = 0; i < numEntries; ++i) {
+        m_words[i] %= 1000;
+    }
+    for (int i = 0; i < numLookups; ++i) {
+        m_lookups[i] = m_words[rand() % numEntries];
+    }
+    CompactingBTree<MultiEntry, ComparatorWithPointer<IntsKey<1> > >
+        tree(false, ComparatorWithPointer<IntsKey<1> >(NULL));
+    CompactingBTree<MultiEntry, BinarySearchPointerComparator> binaryTree(false, BinarySearchPointerComparator());
+    for (int i = 0; i < numEntries; ++i) {
+        // entries carry the address of their tuple as both the last key component and the value
+        const uint64_t address = 64 * (i + 1);
+        tree.insert(pointerKey(m_words[i], address), reinterpret_cast<const void*>(address));
+        binaryTree.insert(pointerKey(m_words[i], address), reinterpret_cast<const void*>(address));
+    }
+    compareLookups("non-unique BIGINT key", tree, binaryTree, FindFirstEntry());
+}
+
+int main(int argc, char *argv[]) {
+    if (argc <= 2 || *argv[1] == '-') {
+        printf("To run the benchmark, execute %s with an entry count and a lookup count.\n",
+               argv[0]);
+        return 0;
+    }
+    numEntries = std::atoi(argv[1]);
+    numLookups = std::atoi(argv[2]);
+    return TestSuite::globalInstance()->runAll();
+}
@@ -21,8 +21,13 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
 #include "harness.h"
 #include "indexes/indexkey.h"
+#include "indexes/IntsKeySearch.h"
 #include "common/NValue.hpp"
 #include "common/ValueFactory.hpp"
 #include "common/TupleSchema.h"
@@ -31,6 +36,14 @@
 
 using namespace voltdb;
 
+namespace {
+
+uint64_t randomWord() {
+    return (static_cast<uint64_t>(rand()) << 62) ^ (static_cast<uint64_t>(rand()) << 31) ^ rand();
+}
+
+}
+
 class IndexKeyTest : public Test {
     public:
         IndexKeyTest() {}
@@ -443,6 +456,68 @@ TEST_F(IndexKeyTest, Int64Packing2Int32sWithSecondNull) {
     voltdb::TupleSchema::freeTupleSchema(keySchema);
 }
 
+/*
+ * IntsKeySearch must count the node entries below a key the same way with
+ * every instruction set the machine supports.
+ */
+TEST_F(IndexKeyTest, IntsKeySearchCountBelow) {
+    // Nodes hold a few dozen sorted entries; cover every tail length and
+    // words on both sides of the sign bit.
+    std::vector<IntsKeySearch::Level> all;
+    for (int level = IntsKeySearch::SCALAR; level <= IntsKeySearch::supportedLevel(); ++level) {
+        all.push_back(static_cast<IntsKeySearch::Level>(level));
+    }
+    srand(1234);
+    std::vector<uint64_t> randomWords;
+    for (int i = 0; i < 40; ++i) {
+        randomWords.push_back(randomWord());
+    }
+    for (int count = 0; count <= 40; ++count) {
+        std::vector<uint64_t> words(randomWords.begin(), randomWords.begin() + count);
+        for (int i = 0; i < count; i += 3) {
+            words[i] = words[0];
+        }
+        std::sort(words.begin(), words.end());
+        std::vector<uint64_t> entries;
+        std::vector<uint64_t> pairs;
+        for (int i = 0; i < count; ++i) {
+            entries.push_back(words[i]);
+            entries.push_back(randomWord());
+            pairs.push_back(words[i]);
+            pairs.push_back(i);
+        }
+        std::vector<uint64_t> probes(words);
+        probes.push_back(0);
+        probes.push_back(~static_cast<uint64_t>(0));
+        probes.push_back(static_cast<uint64_t>(1) << 63);
+        probes.push_back(randomWord());
+        for (size_t p = 0; p < probes.size(); ++p) {
+            for (int upper = 0; upper < 2; ++upper) {
+                int expected = static_cast<int>(upper ?
+                        std::upper_bound(words.begin(), words.end(), probes[p]) - words.begin() :
+                        std::lower_bound(words.begin(), words.end(), probes[p]) - words.begin());
+                for (size_t l = 0; l < all.size(); ++l) {
+                    IntsKeySearch::setLevel(all[l]);
+                    ASSERT_EQ(expected, IntsKeySearch::countBelow(&words[0], 1, count, probes[p], upper));
+                    ASSERT_EQ(expected, IntsKeySearch::countBelow(&entries[0], 2, count, probes[p], upper));
+                    // pairs on the probe's key are ordered by their second word, 0..count-1
+                    for (uint64_t pointer = 0; pointer <= static_cast<uint64_t>(count); pointer += 7) {
+                        int expectedPairs = 0;
+                        for (int i = 0; i < count; ++i) {
+                            expectedPairs += pairs[2 * i] < probes[p] ||
+                                (pairs[2 * i] == probes[p] && (pairs[2 * i + 1] < pointer ||
+                                                               (upper && pairs[2 * i + 1] == pointer)));
+                        }
+                        ASSERT_EQ(expectedPairs,
+                                  IntsKeySearch::countPairsBelow(&pairs[0], count, probes[p], pointer, upper));
+                    }
+                }
+            }
+        }
+    }
+    IntsKeySearch::setLevel(IntsKeySearch::supportedLevel());
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
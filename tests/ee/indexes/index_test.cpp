@@ -60,6 +60,7 @@
 #include "common/SerializableEEException.h"
 #include "common/SynchronizedThreadLock.h"
 #include "common/tabletuple.h"
+#include "common/ValuePeeker.hpp"
 #include "storage/table.h"
 #include "storage/temptable.h"
 #include "storage/persistenttable.h"
@@ -1117,6 +1118,91 @@ TEST_F(IndexTest, ReentrantHashMultiple) {
     delete[] searchkey.address();
 }
 
+/**
+ * A countable non-unique index backed by the B+tree, with enough duplicates
+ * per key to span many leaves.
+ */
+TEST_F(IndexTest, BTreeMultiple) {
+    vector<int> ixb_column_indices;
+    vector<ValueType> ixb_column_types;
+    ixb_column_indices.push_back(2);
+    ixb_column_types.push_back(VALUE_TYPE_BIGINT);
+    init("ixb",
+         BTREE_INDEX,
+         ixb_column_indices,
+         ixb_column_types,
+         false);
+
+    TableIndex* index = table->index("ixb");
+    EXPECT_TRUE(index != NULL);
+    EXPECT_EQ(NUM_OF_TUPLES, index->getSize());
+    IndexCursor indexCursor(index->getTupleSchema());
+
+    vector<ValueType> keyColumnTypes(1, VALUE_TYPE_BIGINT);
+    vector<int32_t> keyColumnLengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    vector<bool> keyColumnAllowNull(1, true);
+    TupleSchema* keySchema =
+        TupleSchema::createTupleSchemaForTest(keyColumnTypes,
+                                       keyColumnLengths,
+                                       keyColumnAllowNull);
+    TableTuple searchkey(keySchema);
+    searchkey.move(new char[searchkey.tupleLength()]);
+
+    // column 2 is i % 3 for i in [1, 1000]: 333 zeros, 334 ones, 333 twos
+    searchkey.setNValue(0, ValueFactory::getBigIntValue(1));
+    EXPECT_TRUE(index->moveToKey(&searchkey, indexCursor));
+    vector<TableTuple> ones;
+    TableTuple tuple(table->schema());
+    while ( ! (tuple = index->nextValueAtKey(indexCursor)).isNullTuple()) {
+        EXPECT_TRUE(ValueFactory::getBigIntValue(1).op_equals(tuple.getNValue(2)).isTrue());
+        ones.push_back(tuple);
+    }
+    EXPECT_EQ(334, ones.size());
+    EXPECT_EQ(334, index->getCounterGET(&searchkey, false, indexCursor));
+    EXPECT_EQ(667, index->getCounterLET(&searchkey, true, indexCursor));
+
+    // forward and backward scans see every entry in key order
+    int64_t prior = -1;
+    int count = 0;
+    index->moveToEnd(true, indexCursor);
+    while ( ! (tuple = index->nextValue(indexCursor)).isNullTuple()) {
+        int64_t key = ValuePeeker::peekBigInt(tuple.getNValue(2));
+        EXPECT_TRUE(key >= prior);
+        prior = key;
+        ++count;
+    }
+    EXPECT_EQ(NUM_OF_TUPLES, count);
+    count = 0;
+    index->moveToEnd(false, indexCursor);
+    while ( ! (tuple = index->nextValue(indexCursor)).isNullTuple()) {
+        int64_t key = ValuePeeker::peekBigInt(tuple.getNValue(2));
+        EXPECT_TRUE(key <= prior);
+        prior = key;
+        ++count;
+    }
+    EXPECT_EQ(NUM_OF_TUPLES, count);
+
+    // drop the middle key; its neighbours must stay reachable
+    for (int i = 0; i < ones.size(); ++i) {
+        EXPECT_TRUE(index->deleteEntry(&ones[i]));
+    }
+    EXPECT_EQ(NUM_OF_TUPLES - 334, index->getSize());
+    EXPECT_FALSE(index->moveToKey(&searchkey, indexCursor));
+    index->moveToKeyOrGreater(&searchkey, indexCursor);
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
+    EXPECT_TRUE(ValueFactory::getBigIntValue(2).op_equals(tuple.getNValue(2)).isTrue());
+    searchkey.setNValue(0, ValueFactory::getBigIntValue(2));
+    EXPECT_EQ(334, index->getCounterGET(&searchkey, false, indexCursor));
+
+    // put them back so the table and its indexes agree again on teardown
+    for (int i = 0; i < ones.size(); ++i) {
+        index->addEntry(&ones[i], NULL);
+    }
+    EXPECT_EQ(NUM_OF_TUPLES, index->getSize());
+
+    TupleSchema::freeTupleSchema(keySchema);
+    delete[] searchkey.address();
+}
 
 int main()
 {
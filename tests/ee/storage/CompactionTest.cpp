@@ -609,6 +609,64 @@ TEST_F(CompactionTest, TestENG897) {
     m_table->doIdleCompaction();
     //m_table->printBucketInfo();
 }
+
+TEST_F(CompactionTest, IncrementalCompaction) {
+    initTable();
+    int tupleCount = 32263 * 5;
+    addRandomUniqueTuples(m_table, tupleCount);
+    ASSERT_EQ(5, m_table->m_data.size());
+    ASSERT_EQ(0, m_table->fragmentationPercent());
+    ASSERT_FALSE(m_table->incrementalCompactionPredicate());
+
+    voltdb::TableIndex *pkeyIndex = m_table->primaryKeyIndex();
+    TableTuple key(pkeyIndex->getKeySchema());
+    boost::scoped_array<char> backingStore(new char[pkeyIndex->getKeySchema()->tupleLength()]);
+    key.moveNoHeader(backingStore.get());
+
+    IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+
+    for (int ii = 0; ii < tupleCount; ii += 2) {
+        key.setNValue(0, ValueFactory::getIntegerValue(ii));
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
+        m_table->deleteTuple(tuple, true);
+    }
+
+    // Half of every block is free, so two of the five blocks could go.
+    ASSERT_EQ(5, m_table->m_data.size());
+    ASSERT_EQ(40, m_table->fragmentationPercent());
+    ASSERT_TRUE(m_table->incrementalCompactionPredicate());
+
+    // Each call stays within its tuple budget and does nothing once its
+    // pause budget is spent.
+    ASSERT_EQ(1000, m_table->doIncrementalCompaction(1000, 1000000));
+    ASSERT_EQ(0, m_table->doIncrementalCompaction(1000, 0));
+
+    int calls = 0;
+    while (m_table->doIncrementalCompaction(10000, 1000000) > 0) {
+        calls++;
+    }
+    ASSERT_TRUE(calls > 1);
+    ASSERT_FALSE(m_table->incrementalCompactionPredicate());
+    ASSERT_EQ(3, m_table->m_data.size());
+    ASSERT_EQ(0, m_table->fragmentationPercent());
+
+    int found = 0;
+    TableIterator iter = m_table->iterator();
+    TableTuple tuple(m_table->schema());
+    while (iter.next(tuple)) {
+        int32_t pkey = ValuePeeker::peekAsInteger(tuple.getNValue(0));
+        ASSERT_EQ(1, pkey % 2);
+        key.setNValue(0, ValueFactory::getIntegerValue(pkey));
+        for (int ii = 0; ii < 4; ii++) {
+            ASSERT_TRUE(m_table->m_indexes[ii]->moveToKey(&key, indexCursor));
+            TableTuple indexTuple = m_table->m_indexes[ii]->nextValueAtKey(indexCursor);
+            ASSERT_EQ(indexTuple.address(), tuple.address());
+        }
+        found++;
+    }
+    ASSERT_EQ(tupleCount / 2, found);
+}
 #endif
 int main() {
     return TestSuite::globalInstance()->runAll();
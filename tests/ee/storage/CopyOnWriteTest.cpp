@@ -35,6 +35,7 @@
 #include "expressions/expressions.h"
 #include "indexes/tableindex.h"
 #include "indexes/tableindexfactory.h"
+#include "storage/CopyOnWriteContext.h"
 #include "storage/CopyOnWriteIterator.h"
 #include "storage/DRTupleStream.h"
 #include "storage/ElasticContext.h"
@@ -1428,6 +1429,72 @@ TEST_F(CopyOnWriteTest, BigTestUndoEverything) {
 /**
  * Exercise the multi-COW.
  */
+/**
+ * Snapshot the same table with and without serialization helper threads.
+ * The streams must be byte for byte the same, and a helper assisted snapshot
+ * taken while the table changes must still see exactly the original tuples.
+ */
+TEST_F(CopyOnWriteTest, ParallelSerialization) {
+    initTable(1, 0);
+    int tupleCount = TUPLE_COUNT;
+    addRandomUniqueTuples(m_table, tupleCount);
+    const int savedHelperThreads = CopyOnWriteContext::getSerializationHelperThreads();
+
+    char config[4];
+    ::memset(config, 0, 4);
+    char serializationBuffer[BUFFER_SIZE];
+    std::string streamed[2];
+    const int helperThreads[2] = { 0, 3 };
+    for (int run = 0; run < 2; run++) {
+        CopyOnWriteContext::setSerializationHelperThreads(helperThreads[run]);
+        ReferenceSerializeInputBE input(config, 4);
+        m_table->activateStream(TABLE_STREAM_SNAPSHOT, 0, m_tableId, input);
+        while (true) {
+            TupleOutputStreamProcessor outputStreams(serializationBuffer, sizeof(serializationBuffer));
+            std::vector<int> retPositions;
+            m_table->streamMore(outputStreams, TABLE_STREAM_SNAPSHOT, retPositions);
+            const size_t serialized = outputStreams.at(0).position();
+            if (serialized == 0) {
+                break;
+            }
+            streamed[run].append(serializationBuffer, serialized);
+        }
+    }
+    ASSERT_TRUE(streamed[0].size() > BUFFER_SIZE);
+    ASSERT_TRUE(streamed[0] == streamed[1]);
+
+    T_ValueSet originalTuples;
+    getTableValueSet(originalTuples);
+    ReferenceSerializeInputBE input(config, 4);
+    m_table->activateStream(TABLE_STREAM_SNAPSHOT, 0, m_tableId, input);
+    T_ValueSet COWTuples;
+    while (true) {
+        TupleOutputStreamProcessor outputStreams(serializationBuffer, sizeof(serializationBuffer));
+        std::vector<int> retPositions;
+        m_table->streamMore(outputStreams, TABLE_STREAM_SNAPSHOT, retPositions);
+        const size_t serialized = outputStreams.at(0).position();
+        if (serialized == 0) {
+            break;
+        }
+        for (size_t ii = sizeof(int32_t)*3; // skip partition id, row count, and first tuple length
+             ii + sizeof(int64_t) <= serialized;
+             ii += m_tupleWidth + sizeof(int32_t)) {
+            int32_t values[2];
+            values[0] = ntohl(*reinterpret_cast<const int32_t*>(&serializationBuffer[ii]));
+            values[1] = ntohl(*reinterpret_cast<const int32_t*>(&serializationBuffer[ii + 4]));
+            void *valuesVoid = reinterpret_cast<void*>(values);
+            const int64_t *values64 = reinterpret_cast<const int64_t*>(valuesVoid);
+            ASSERT_TRUE(COWTuples.insert(*values64).second);
+        }
+        for (int jj = 0; jj < NUM_MUTATIONS; jj++) {
+            doRandomTableMutation(m_table);
+        }
+    }
+    CopyOnWriteContext::setSerializationHelperThreads(savedHelperThreads);
+
+    checkTuples(tupleCount + (m_tuplesInserted - m_tuplesDeleted), originalTuples, COWTuples);
+}
+
 TEST_F(CopyOnWriteTest, MultiStream) {
 
     // Constants
@@ -353,6 +353,35 @@ TEST_F(LargeTempTableSortTest, sortLargeTempTable) {
     std::cout << "          ";
 }
 
+TEST_F(LargeTempTableSortTest, sortWithPrefetch) {
+    // With room for eight blocks, two are read ahead and the merge
+    // takes five runs at a time, so 13 blocks need two passes.
+    UniqueEngineBuilder builder;
+    builder.setTopend(std::unique_ptr<LargeTempTableTopend>(new LargeTempTableTopend(true)));
+    builder.setTempTableMemoryLimit(8 * LargeTempTableBlock::BLOCK_SIZE_IN_BYTES);
+    UniqueEngine engine = builder.build();
+
+    LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+    ASSERT_EQ(2, lttBlockCache->readAheadBlocks());
+
+    TupleValueExpression tve{0, 0}; // table 0, field 0
+    std::vector<AbstractExpression*> keys{&tve};
+    std::vector<SortDirectionType> dirs{SORT_DIRECTION_TYPE_ASC};
+    AbstractExecutor::TupleComparer comparer{keys, dirs};
+
+    auto ltt = createAndFillLargeTempTable(64, 4096, 13);
+    int rowsBefore = ltt->activeTupleCount();
+    ltt->sort(comparer, -1, 0);
+
+    ASSERT_EQ(rowsBefore, ltt->activeTupleCount());
+    ASSERT_TRUE(verifySortedTable(comparer, ltt.get()));
+    ASSERT_TRUE(lttBlockCache->prefetchesIssued() > 0);
+    ASSERT_TRUE(lttBlockCache->allocatedMemory() <= lttBlockCache->maxCacheSizeInBytes());
+
+    ltt->deleteAllTempTuples();
+    ASSERT_EQ(0, lttBlockCache->allocatedMemory());
+}
+
 namespace {
 
 // limit, offset
@@ -417,7 +417,7 @@ TEST_F(LargeTempTableTest, OverflowCache) {
     ASSERT_EQ(0, lttBlockCache->totalBlockCount());
     ASSERT_EQ(0, lttBlockCache->allocatedMemory());
 
-    LargeTempTableTopend* theTopend = dynamic_cast<LargeTempTableTopend*>(ExecutorContext::getExecutorContext()->getTopend());
+    LargeTempTableTopend* theTopend = dynamic_cast<LargeTempTableTopend*>(ExecutorContext::getPhysicalTopend());
     ASSERT_EQ(0, theTopend->storedBlockCount());
 }
 
@@ -598,6 +598,127 @@ TEST_F(LargeTempTableTest, iteratorDeletingAsWeGo) {
     ASSERT_FALSE(tblIt.next(iterTuple));
 }
 
+TEST_F(LargeTempTableTest, CompressedSpill) {
+    typedef std::tuple<int64_t, std::string> StdTuple;
+    std::vector<std::string> names{"id", "str"};
+
+    // Store the same table with and without block compression.
+    for (int compress = 1; compress >= 0; --compress) {
+        std::unique_ptr<Topend> topend{new LargeTempTableTopend()};
+        // Leave room for two blocks, so a four block table has to spill.
+        UniqueEngine engine = UniqueEngineBuilder()
+            .setTopend(std::move(topend))
+            .setTempTableMemoryLimit(16 * 1024 * 1024)
+            .build();
+        LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+        LargeTempTableTopend* theTopend =
+            dynamic_cast<LargeTempTableTopend*>(ExecutorContext::getPhysicalTopend());
+        lttBlockCache->setBlockCompression(compress == 1);
+
+        TupleSchema* schema = Tools::buildSchema<StdTuple>();
+        auto ltt = makeUniqueTable(TableFactory::buildLargeTempTable("ltmp", schema, names));
+        TableTuple tupleForInsert = ltt->tempTuple();
+
+        // About 2000 of these fit in a block.
+        const int NUM_TUPLES = 8000;
+        for (int i = 0; i < NUM_TUPLES; ++i) {
+            StdTuple stdTuple{i, std::string(4096, static_cast<char>('a' + i % 26))};
+            Tools::initTuple(&tupleForInsert, stdTuple);
+            ltt->insertTuple(tupleForInsert);
+        }
+        ltt->finishInserts();
+
+        ASSERT_EQ(4, lttBlockCache->totalBlockCount());
+        ASSERT_TRUE(lttBlockCache->storedBlockCount() >= 2);
+        ASSERT_EQ(theTopend->storedBytes(), lttBlockCache->spilledBytes());
+        if (compress) {
+            // Runs of one character compress extremely well.
+            ASSERT_TRUE(lttBlockCache->spilledBytes() * 20 < lttBlockCache->spilledRawBytes());
+            ASSERT_TRUE(lttBlockCache->compressionRatio() > 20.0);
+        }
+        else {
+            ASSERT_EQ(0, lttBlockCache->spilledBytesSaved());
+        }
+
+        // Reading the table back loads the stored blocks.
+        {
+            TableIterator iter = ltt->iterator();
+            TableTuple iterTuple(ltt->schema());
+            int i = 0;
+            while (iter.next(iterTuple)) {
+                StdTuple expected{i, std::string(4096, static_cast<char>('a' + i % 26))};
+                ASSERT_TUPLES_EQ(expected, iterTuple);
+                ++i;
+            }
+            ASSERT_EQ(NUM_TUPLES, i);
+        }
+        // This topend can't prefetch, so the loads were plain misses.
+        ASSERT_EQ(0, lttBlockCache->prefetchesIssued());
+        ASSERT_EQ(0, lttBlockCache->prefetchStalls());
+
+        ltt->deleteAllTempTuples();
+        ASSERT_EQ(0, lttBlockCache->totalBlockCount());
+        ASSERT_EQ(0, theTopend->storedBlockCount());
+    }
+}
+
+TEST_F(LargeTempTableTest, PrefetchScan) {
+    typedef std::tuple<int64_t, std::string> StdTuple;
+    std::vector<std::string> names{"id", "str"};
+
+    std::unique_ptr<Topend> topend{new LargeTempTableTopend(true)};
+    // Room for eight blocks, so two will be read ahead.
+    UniqueEngine engine = UniqueEngineBuilder()
+        .setTopend(std::move(topend))
+        .setTempTableMemoryLimit(64 * 1024 * 1024)
+        .build();
+    LargeTempTableBlockCache* lttBlockCache = ExecutorContext::getExecutorContext()->lttBlockCache();
+    LargeTempTableTopend* theTopend =
+        dynamic_cast<LargeTempTableTopend*>(ExecutorContext::getPhysicalTopend());
+    ASSERT_EQ(2, lttBlockCache->readAheadBlocks());
+
+    TupleSchema* schema = Tools::buildSchema<StdTuple>();
+    auto ltt = makeUniqueTable(TableFactory::buildLargeTempTable("ltmp", schema, names));
+    TableTuple tupleForInsert = ltt->tempTuple();
+
+    // About 2000 of these fit in a block, so this is 12 blocks.
+    const int NUM_TUPLES = 24000;
+    for (int i = 0; i < NUM_TUPLES; ++i) {
+        StdTuple stdTuple{i, std::string(4096, static_cast<char>('a' + i % 26))};
+        Tools::initTuple(&tupleForInsert, stdTuple);
+        ltt->insertTuple(tupleForInsert);
+    }
+    ltt->finishInserts();
+    ASSERT_EQ(12, lttBlockCache->totalBlockCount());
+
+    // Blocks loaded by a scan are already stored, so they can be
+    // dropped to make room for reading ahead.  Scan twice so that
+    // read-ahead also replaces blocks loaded by an earlier scan.
+    for (int pass = 0; pass < 2; ++pass) {
+        TableIterator iter = ltt->iterator();
+        TableTuple iterTuple(ltt->schema());
+        int i = 0;
+        while (iter.next(iterTuple)) {
+            StdTuple expected{i, std::string(4096, static_cast<char>('a' + i % 26))};
+            ASSERT_TUPLES_EQ(expected, iterTuple);
+            ++i;
+        }
+        ASSERT_EQ(NUM_TUPLES, i);
+        ASSERT_TRUE(lttBlockCache->allocatedMemory() <= lttBlockCache->maxCacheSizeInBytes());
+    }
+
+    // Every fetch of a block that was not resident was either served
+    // by a finished prefetch or waited for a read.
+    ASSERT_TRUE(lttBlockCache->prefetchesIssued() > 0);
+    ASSERT_TRUE(lttBlockCache->prefetchHits() > 0);
+    ASSERT_TRUE(theTopend->blocksRead() >= lttBlockCache->prefetchHits() + lttBlockCache->prefetchStalls());
+
+    ltt->deleteAllTempTuples();
+    ASSERT_EQ(0, lttBlockCache->totalBlockCount());
+    ASSERT_EQ(0, lttBlockCache->allocatedMemory());
+    ASSERT_EQ(0, theTopend->storedBlockCount());
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
@@ -0,0 +1,225 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures how many rows per second loadTable restores into a table with
+ * tree and hash indexes, tuple by tuple and in bulk into an empty table.
+ * It does nothing unless given the number of rows to restore, e.g.
+ * "LoadTableBenchmark 200000".
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+#include "boost/foreach.hpp"
+
+#include "harness.h"
+
+#include "common/executorcontext.hpp"
+#include "common/serializeio.h"
+#include "common/tabletuple.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "execution/VoltDBEngine.h"
+#include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
+#include "storage/persistenttable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace voltdb;
+
+namespace {
+
+int restoreRows = 0;
+
+int64_t getMicrosNow() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+}
+
+class LoadTableBenchmark : public Test {
+public:
+    LoadTableBenchmark()
+        : m_undoToken(0)
+    {
+        m_engine = new VoltDBEngine();
+        int partitionCount = 1;
+        m_engine->initialize(1, 1, 0, partitionCount, 0, "", 0, 1024, DEFAULT_TEMP_TABLE_MEMORY, true);
+        partitionCount = htonl(partitionCount);
+        m_engine->updateHashinator((char*)&partitionCount, NULL, 0);
+        *reinterpret_cast<int64_t*>(m_signature) = 42;
+    }
+
+    ~LoadTableBenchmark()
+    {
+        BOOST_FOREACH (PersistentTable* table, m_tables) {
+            delete table;
+        }
+        delete m_engine;
+        voltdb::globalDestroyOncePerProcess();
+    }
+
+    /**
+     * A table keyed on its first column, with a tree and a hash unique
+     * index on the key and a tree multimap index on the second column.
+     */
+    PersistentTable* createTable()
+    {
+        std::vector<ValueType> types;
+        std::vector<int32_t> sizes;
+        std::vector<bool> allowNull;
+        std::vector<std::string> names;
+        types.push_back(VALUE_TYPE_INTEGER); sizes.push_back(4);   allowNull.push_back(false);
+        types.push_back(VALUE_TYPE_BIGINT);  sizes.push_back(8);   allowNull.push_back(true);
+        types.push_back(VALUE_TYPE_VARCHAR); sizes.push_back(100); allowNull.push_back(true);
+        names.push_back("ID");
+        names.push_back("VAL");
+        names.push_back("NAME");
+        TupleSchema* schema = TupleSchema::createTupleSchemaForTest(types, sizes, allowNull);
+
+        PersistentTable* table = dynamic_cast<PersistentTable*>(
+                TableFactory::getPersistentTable(0, "RESTORED", schema, names, m_signature));
+        m_tables.push_back(table);
+
+        std::vector<int> keyColumns(1, 0);
+        std::vector<int> valueColumns(1, 1);
+        TableIndex* pkey = TableIndexFactory::getInstance(
+                TableIndexScheme("PKEY_TREE", BALANCED_TREE_INDEX, keyColumns,
+                                 TableIndex::simplyIndexColumns(), true, true, schema));
+        table->addIndex(pkey);
+        table->setPrimaryKeyIndex(pkey);
+        table->addIndex(TableIndexFactory::getInstance(
+                TableIndexScheme("PKEY_HASH", HASH_TABLE_INDEX, keyColumns,
+                                 TableIndex::simplyIndexColumns(), true, false, schema)));
+        table->addIndex(TableIndexFactory::getInstance(
+                TableIndexScheme("VAL_TREE", BALANCED_TREE_INDEX, valueColumns,
+                                 TableIndex::simplyIndexColumns(), false, true, schema)));
+        return table;
+    }
+
+    /** Serialize rows with the given keys in the format loadTable receives. */
+    void serializeRows(PersistentTable* table, const std::vector<int32_t>& keys, CopySerializeOutput& out)
+    {
+        table->serializeColumnHeaderTo(out);
+        out.writeInt(static_cast<int32_t>(keys.size()));
+        TableTuple tuple = table->tempTuple();
+        BOOST_FOREACH (int32_t key, keys) {
+            tuple.setNValue(0, ValueFactory::getIntegerValue(key));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(key % 1000));
+            NValue name = ValueFactory::getStringValue("row name padded out past the inline limit");
+            tuple.setNValue(2, name);
+            tuple.serializeTo(out);
+            name.free();
+        }
+    }
+
+    /** Load a serialized buffer in its own undo quantum, and return the rows per second. */
+    double load(PersistentTable* table, CopySerializeOutput& data)
+    {
+        m_engine->setUndoToken(++m_undoToken);
+        ExecutorContext::getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0, 0, 0, false);
+        ReferenceSerializeInputBE input(data.data(), data.size());
+        int64_t start = getMicrosNow();
+        table->loadTuplesForLoadTable(input, NULL, NULL, false, false);
+        int64_t elapsed = std::max(getMicrosNow() - start, static_cast<int64_t>(1));
+        m_engine->releaseUndoToken(m_undoToken);
+        return static_cast<double>(table->activeTupleCount()) * 1000000.0 / static_cast<double>(elapsed);
+    }
+
+    /** Every tuple is reachable through every index, and the tree indexes are in order. */
+    void checkIndexes(PersistentTable* table)
+    {
+        BOOST_FOREACH (TableIndex* index, table->allIndexes()) {
+            ASSERT_EQ(table->activeTupleCount(), index->getSize());
+        }
+        TableIndex* pkey = table->primaryKeyIndex();
+        IndexCursor cursor(pkey->getTupleSchema());
+        TableTuple key(pkey->getKeySchema());
+        std::vector<char> keyStorage(pkey->getKeySchema()->tupleLength());
+        key.moveNoHeader(&keyStorage[0]);
+        TableIterator iter = table->iterator();
+        TableTuple tuple(table->schema());
+        while (iter.next(tuple)) {
+            key.setNValue(0, tuple.getNValue(0));
+            ASSERT_TRUE(pkey->moveToKey(&key, cursor));
+            ASSERT_EQ(tuple.address(), pkey->nextValueAtKey(cursor).address());
+        }
+    }
+
+protected:
+    VoltDBEngine* m_engine;
+    std::vector<PersistentTable*> m_tables;
+    char m_signature[20];
+    int64_t m_undoToken;
+};
+
+TEST_F(LoadTableBenchmark, RestoreIntoEmptyTable) {
+    std::vector<int32_t> keys;
+    srand(1234);
+    for (int i = 0; i < restoreRows; ++i) {
+        keys.push_back(i);
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+
+    // A table that already has a row takes the tuple by tuple path.
+    PersistentTable* incremental = createTable();
+    CopySerializeOutput first;
+    serializeRows(incremental, std::vector<int32_t>(1, -1), first);
+    load(incremental, first);
+    ASSERT_EQ(1, incremental->activeTupleCount());
+
+    CopySerializeOutput data;
+    serializeRows(incremental, keys, data);
+    double before = load(incremental, data);
+    ASSERT_EQ(restoreRows + 1, incremental->activeTupleCount());
+    checkIndexes(incremental);
+
+    PersistentTable* bulk = createTable();
+    double after = load(bulk, data);
+    ASSERT_EQ(restoreRows, bulk->activeTupleCount());
+    checkIndexes(bulk);
+
+    std::cout << restoreRows << " rows: tuple by tuple " << static_cast<int64_t>(before)
+              << " rows/sec, bulk " << static_cast<int64_t>(after)
+              << " rows/sec (" << after / before << "x)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc <= 1 || *argv[1] == '-') {
+        printf("To run the benchmark, execute %s with the number of rows to restore.\n",
+               argv[0]);
+        return 0;
+    }
+    restoreRows = std::atoi(argv[1]);
+    return TestSuite::globalInstance()->runAll();
+}
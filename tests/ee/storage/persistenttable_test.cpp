@@ -28,11 +28,14 @@
 #include "test_utils/Tools.hpp"
 #include "test_utils/TupleComparingTest.hpp"
 
+#include "common/serializeio.h"
+#include "common/SQLException.h"
 #include "common/SynchronizedThreadLock.h"
 #include "common/tabletuple.h"
 #include "common/TupleSchemaBuilder.h"
 #include "common/types.h"
 #include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
 
 #include "execution/VoltDBEngine.h"
 
@@ -109,6 +112,11 @@ protected:
         m_engine->setUndoToken(m_undoToken);
     }
 
+    // Commit without opening the next undo quantum, as between transactions.
+    void commitLast() {
+        m_engine->releaseUndoToken(m_undoToken);
+    }
+
     static const std::string& catalogPayload() {
         static const std::string payload(
             "add / clusters cluster\n"
@@ -217,6 +225,83 @@ protected:
         return payload;
     }
 
+    // Adds a single-table view of T to catalogPayload():
+    //
+    // CREATE VIEW V (CNT, TOTAL) AS SELECT COUNT(*), SUM(PK) FROM T;
+    static const std::string& viewCatalogPayload() {
+        static const std::string payload(
+            "add /clusters#cluster/databases#database tables V\n"
+            "set /clusters#cluster/databases#database/tables#V isreplicated false\n"
+            "set $PREV partitioncolumn null\n"
+            "set $PREV estimatedtuplecount 0\n"
+            "set $PREV materializer /clusters#cluster/databases#database/tables#T\n"
+            "set $PREV signature \"V|bb\"\n"
+            "set $PREV tuplelimit 2147483647\n"
+            "set $PREV isDRed false\n"
+            "add /clusters#cluster/databases#database/tables#V columns CNT\n"
+            "set /clusters#cluster/databases#database/tables#V/columns#CNT index 0\n"
+            "set $PREV type 6\n"
+            "set $PREV size 8\n"
+            "set $PREV nullable false\n"
+            "set $PREV name \"CNT\"\n"
+            "set $PREV defaultvalue null\n"
+            "set $PREV defaulttype 0\n"
+            "set $PREV matview null\n"
+            "set $PREV aggregatetype 41\n"
+            "set $PREV matviewsource null\n"
+            "set $PREV inbytes false\n"
+            "add /clusters#cluster/databases#database/tables#V columns TOTAL\n"
+            "set /clusters#cluster/databases#database/tables#V/columns#TOTAL index 1\n"
+            "set $PREV type 6\n"
+            "set $PREV size 8\n"
+            "set $PREV nullable true\n"
+            "set $PREV name \"TOTAL\"\n"
+            "set $PREV defaultvalue null\n"
+            "set $PREV defaulttype 0\n"
+            "set $PREV matview null\n"
+            "set $PREV aggregatetype 42\n"
+            "set $PREV matviewsource /clusters#cluster/databases#database/tables#T/columns#PK\n"
+            "set $PREV inbytes false\n"
+            "add /clusters#cluster/databases#database/tables#T views V\n"
+            "set /clusters#cluster/databases#database/tables#T/views#V dest /clusters#cluster/databases#database/tables#V\n"
+            "set $PREV predicate \"\"\n"
+            "set $PREV groupbyExpressionsJson \"\"\n"
+            "set $PREV aggregationExpressionsJson \"\"\n"
+            "set $PREV isSafeWithNonemptySources true\n"
+            "");
+        return payload;
+    }
+
+    /** Serialize rows of T with the given keys in the format loadTable receives. */
+    static void serializeRows(PersistentTable* table, const std::vector<int64_t>& keys,
+                              CopySerializeOutput& out) {
+        // Load table input also carries the hidden DR timestamp column.
+        const TupleSchema* schema = table->schema();
+        const int columnCount = schema->columnCount() + schema->hiddenColumnCount();
+        out.writeInt(-1);   // header size, not read
+        out.writeByte(-128);
+        out.writeShort(static_cast<int16_t>(columnCount));
+        for (int i = 0; i < schema->columnCount(); ++i) {
+            out.writeByte(static_cast<int8_t>(schema->columnType(i)));
+        }
+        for (int i = 0; i < schema->hiddenColumnCount(); ++i) {
+            out.writeByte(static_cast<int8_t>(schema->getHiddenColumnInfo(i)->getVoltType()));
+        }
+        for (int i = 0; i < columnCount; ++i) {
+            out.writeTextString(i < schema->columnCount() ? table->columnName(i) : "DR_TIMESTAMP");
+        }
+        out.writeInt(static_cast<int32_t>(keys.size()));
+        TableTuple tuple = table->tempTuple();
+        BOOST_FOREACH (int64_t key, keys) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(key));
+            tuple.setNValue(1, ValueFactory::getNullStringValue());
+            for (int i = 0; i < schema->hiddenColumnCount(); ++i) {
+                tuple.setHiddenNValue(i, ValueFactory::getBigIntValue(0));
+            }
+            tuple.serializeTo(out, true);
+        }
+    }
+
     void validateCounts(size_t nIndexes, PersistentTable* table, PersistentTable* dupTable,
                         size_t nTuples, size_t nDupTuples) {
         validateCounts(table, nTuples, nIndexes);
@@ -794,6 +879,207 @@ TEST_F(PersistentTableTest, SwapTablesTest) {
     rollback();
 }
 
+TEST_F(PersistentTableTest, DeleteTuplesInBatch) {
+    VoltDBEngine* engine = getEngine();
+    engine->loadCatalog(0, catalogPayload());
+    PersistentTable* table = engine->getTableDelegate("T")->getPersistentTable();
+    const int tupleCount = 1000;
+
+    beginWork();
+    TableTuple& tuple = table->tempTuple();
+    for (int i = 0; i < tupleCount; ++i) {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+        tuple.setNValue(1, ValueFactory::getNullStringValue());
+        table->insertTuple(tuple);
+    }
+    commit();
+
+    // Hand over every even key in table order, not key order.
+    std::vector<TableTuple> targets;
+    TableIterator iterator = table->iterator();
+    TableTuple iterTuple(table->schema());
+    while (iterator.next(iterTuple)) {
+        if (ValuePeeker::peekBigInt(iterTuple.getNValue(0)) % 2 == 0) {
+            targets.push_back(iterTuple);
+        }
+    }
+    ASSERT_EQ(tupleCount / 2, static_cast<int>(targets.size()));
+
+    // Undoing a batch restores every index entry.
+    beginWork();
+    table->deleteTuples(targets, true);
+    ASSERT_EQ(tupleCount / 2, table->primaryKeyIndex()->getSize());
+    rollback();
+    validateCounts(table, tupleCount, 1);
+
+    beginWork();
+    table->deleteTuples(targets, true);
+    commit();
+    validateCounts(table, tupleCount / 2, 1);
+
+    TableIndex* pkeyIndex = table->primaryKeyIndex();
+    StandAloneTupleStorage keyStorage(pkeyIndex->getKeySchema());
+    TableTuple key = keyStorage.tuple();
+    IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+    for (int i = 0; i < tupleCount; ++i) {
+        key.setNValue(0, ValueFactory::getBigIntValue(i));
+        ASSERT_EQ(i % 2 == 1, pkeyIndex->moveToKey(&key, indexCursor));
+    }
+}
+
+TEST_F(PersistentTableTest, BulkLoadReportsDuplicateKeys) {
+    VoltDBEngine* engine = getEngine();
+    engine->loadCatalog(0, catalogPayload());
+    PersistentTable* table = engine->getTableDelegate("T")->getPersistentTable();
+    std::vector<int64_t> keys;
+    for (int64_t i = 0; i < 1000; ++i) {
+        keys.push_back(i);
+    }
+    keys.push_back(500);
+    keys.push_back(1000);
+    CopySerializeOutput data;
+    serializeRows(table, keys, data);
+
+    beginWork();
+    char buffer[4096];
+    ReferenceSerializeOutput violations(buffer, sizeof(buffer));
+    ReferenceSerializeInputBE input(data.data(), data.size());
+    table->loadTuplesForLoadTable(input, NULL, &violations, false, false);
+    commit();
+
+    // The duplicate is reported and every other row is loaded.
+    ReferenceSerializeInputBE reported(buffer, violations.position());
+    ASSERT_TRUE(reported.readInt() > 0);
+    validateCounts(table, 1001, 1);
+}
+
+TEST_F(PersistentTableTest, BulkLoadUndone) {
+    VoltDBEngine* engine = getEngine();
+    engine->loadCatalog(0, catalogPayload());
+    PersistentTable* table = engine->getTableDelegate("T")->getPersistentTable();
+    std::vector<int64_t> keys;
+    for (int64_t i = 0; i < 1000; ++i) {
+        keys.push_back(999 - i);
+    }
+    CopySerializeOutput data;
+    serializeRows(table, keys, data);
+
+    beginWork();
+    ReferenceSerializeInputBE input(data.data(), data.size());
+    table->loadTuplesForLoadTable(input, NULL, NULL, false, false);
+    validateCounts(table, 1000, 1);
+    rollback();
+    validateCounts(table, 0, 1);
+}
+
+TEST_F(PersistentTableTest, BulkLoadUndoneWhenViewThrows) {
+    VoltDBEngine* engine = getEngine();
+    engine->loadCatalog(0, catalogPayload() + viewCatalogPayload());
+    PersistentTable* table = engine->getTableDelegate("T")->getPersistentTable();
+    PersistentTable* view = engine->getTableDelegate("V")->getPersistentTable();
+    ASSERT_NE(NULL, table);
+    ASSERT_NE(NULL, view);
+    ASSERT_EQ(1, table->views().size());
+
+    // SUM(PK) overflows at the third row, after the view has taken in
+    // the first two and before it sees the last one.
+    std::vector<int64_t> keys{1, 2, INT64_MAX - 1, 4};
+    CopySerializeOutput data;
+    serializeRows(table, keys, data);
+
+    beginWork();
+    ReferenceSerializeInputBE input(data.data(), data.size());
+    bool threw = false;
+    try {
+        table->loadTuplesForLoadTable(input, NULL, NULL, false, false);
+    }
+    catch (const SQLException&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    rollback();
+
+    // Every row, including the one the view never saw, is undone.
+    validateCounts(table, 0, 1);
+    TableTuple viewRow(view->schema());
+    TableIterator viewIterator = view->iterator();
+    ASSERT_TRUE(viewIterator.next(viewRow));
+    EXPECT_EQ(0, ValuePeeker::peekBigInt(viewRow.getNValue(0)));
+    EXPECT_TRUE(viewRow.getNValue(1).isNull());
+
+    // The table takes the same load once the overflowing row is gone.
+    keys[2] = 3;
+    CopySerializeOutput retry;
+    serializeRows(table, keys, retry);
+    beginWork();
+    ReferenceSerializeInputBE retryInput(retry.data(), retry.size());
+    table->loadTuplesForLoadTable(retryInput, NULL, NULL, false, false);
+    commit();
+
+    validateCounts(table, keys.size(), 1);
+    viewIterator = view->iterator();
+    ASSERT_TRUE(viewIterator.next(viewRow));
+    EXPECT_EQ(static_cast<int64_t>(keys.size()), ValuePeeker::peekBigInt(viewRow.getNValue(0)));
+    EXPECT_EQ(10, ValuePeeker::peekBigInt(viewRow.getNValue(1)));
+}
+
+TEST_F(PersistentTableTest, NoTickCompactionWhileQuantumOpen) {
+    VoltDBEngine* engine = getEngine();
+    engine->loadCatalog(0, catalogPayload());
+    PersistentTable* table = engine->getTableDelegate("T")->getPersistentTable();
+
+    // Fill five blocks, then free every other tuple: two blocks could be
+    // reclaimed, but too few slots are free to compact at release.
+    beginWork();
+    TableTuple& tuple = table->tempTuple();
+    int64_t tupleCount = 0;
+    while (table->allocatedBlockCount() < 5 || table->activeTupleCount() < table->allocatedTupleCount()) {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(tupleCount++));
+        tuple.setNValue(1, ValueFactory::getNullStringValue());
+        table->insertTuple(tuple);
+    }
+    commit();
+    ASSERT_EQ(5, table->allocatedBlockCount());
+
+    std::vector<TableTuple> targets;
+    TableIterator iterator = table->iterator();
+    TableTuple iterTuple(table->schema());
+    while (iterator.next(iterTuple)) {
+        if (ValuePeeker::peekBigInt(iterTuple.getNValue(0)) % 2 == 0) {
+            targets.push_back(iterTuple);
+        }
+    }
+    beginWork();
+    table->deleteTuples(targets, true);
+    commit();
+    ASSERT_TRUE(table->incrementalCompactionPredicate());
+    int32_t fragmentation = table->fragmentationPercent();
+
+    // The open quantum's undo action holds the inserted tuple's address,
+    // so the tick must leave every tuple where it is.
+    beginWork();
+    tuple.setNValue(0, ValueFactory::getBigIntValue(tupleCount));
+    tuple.setNValue(1, ValueFactory::getNullStringValue());
+    table->insertTuple(tuple);
+    engine->tick(0, 0);
+    ASSERT_EQ(fragmentation, table->fragmentationPercent());
+    ASSERT_EQ(0, engine->doIncrementalCompaction());
+    rollback();
+    validateCounts(table, tupleCount / 2, 1);
+
+    TableIndex* pkeyIndex = table->primaryKeyIndex();
+    StandAloneTupleStorage keyStorage(pkeyIndex->getKeySchema());
+    TableTuple key = keyStorage.tuple();
+    IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+    key.setNValue(0, ValueFactory::getBigIntValue(tupleCount));
+    ASSERT_FALSE(pkeyIndex->moveToKey(&key, indexCursor));
+
+    // Once the last quantum is released the tick compacts again.
+    commitLast();
+    ASSERT_TRUE(engine->doIncrementalCompaction() > 0);
+    validateCounts(table, tupleCount / 2, 1);
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
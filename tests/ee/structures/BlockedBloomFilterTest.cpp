@@ -0,0 +1,108 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "structures/BlockedBloomFilter.h"
+
+#include <cstddef>
+
+using namespace voltdb;
+
+class BlockedBloomFilterTest : public Test {
+};
+
+static uint64_t hashOf(int64_t value)
+{
+    std::size_t seed = 0;
+    ValueFactory::getBigIntValue(value).hashCombine(seed);
+    return BlockedBloomFilter::mix(seed);
+}
+
+TEST_F(BlockedBloomFilterTest, NoFalseNegatives)
+{
+    const int64_t KEYS = 100000;
+    BlockedBloomFilter filter;
+    filter.reset(KEYS);
+    for (int64_t i = 0; i < KEYS; i++) {
+        filter.add(hashOf(i * 7));
+    }
+    for (int64_t i = 0; i < KEYS; i++) {
+        ASSERT_TRUE(filter.mayContain(hashOf(i * 7)));
+    }
+}
+
+TEST_F(BlockedBloomFilterTest, FalsePositiveRate)
+{
+    const int64_t KEYS = 100000;
+    BlockedBloomFilter filter;
+    filter.reset(KEYS);
+    for (int64_t i = 0; i < KEYS; i++) {
+        filter.add(hashOf(i * 2));
+    }
+    int64_t falsePositives = 0;
+    for (int64_t i = 0; i < KEYS; i++) {
+        if (filter.mayContain(hashOf(i * 2 + 1))) {
+            ++falsePositives;
+        }
+    }
+    // About 0.1% is expected at 16 bits per key; allow some slack.
+    EXPECT_LT(falsePositives, KEYS / 200);
+}
+
+TEST_F(BlockedBloomFilterTest, ResetClears)
+{
+    BlockedBloomFilter filter;
+    filter.reset(1000);
+    for (int64_t i = 0; i < 1000; i++) {
+        filter.add(hashOf(i));
+    }
+    size_t bytes = filter.sizeInBytes();
+    filter.reset(1000);
+    EXPECT_EQ(bytes, filter.sizeInBytes());
+    int64_t found = 0;
+    for (int64_t i = 0; i < 1000; i++) {
+        if (filter.mayContain(hashOf(i))) {
+            ++found;
+        }
+    }
+    EXPECT_EQ(0, found);
+
+    // Sizes are rounded up to a power of two number of 32 byte blocks
+    filter.reset(0);
+    EXPECT_EQ(32, filter.sizeInBytes());
+    filter.reset(1000);
+    EXPECT_EQ(2048, filter.sizeInBytes());
+
+    filter.release();
+    EXPECT_EQ(0, filter.sizeInBytes());
+    filter.reset(1000);
+    filter.add(hashOf(7));
+    EXPECT_TRUE(filter.mayContain(hashOf(7)));
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,369 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <map>
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <climits>
+#include "harness.h"
+#include "structures/CompactingBTree.h"
+#include "common/FixUnusedAssertHack.h"
+
+using namespace voltdb;
+using namespace std;
+
+class IntComparator {
+public:
+    inline int operator()(const int &lhs, const int &rhs) const {
+        if (lhs > rhs) return 1;
+        else if (lhs < rhs) return -1;
+        else return 0;
+    }
+
+    int compareWithoutPointer(const int &lhs, const int &rhs) const {
+        return operator()(lhs, rhs);
+    }
+};
+
+/**
+ * Stand-in for KeyWithPointer: a key made unique by a tie-breaking "pointer".
+ */
+struct PtrKey {
+    int key;
+    int ptr;
+    PtrKey() : key(0), ptr(0) {}
+    PtrKey(int k, int p) : key(k), ptr(p) {}
+};
+
+inline void setPointerValue(PtrKey &k, const void *v) { k.ptr = INT_MAX; }
+
+class PtrKeyComparator {
+public:
+    inline int operator()(const PtrKey &lhs, const PtrKey &rhs) const {
+        int cmp = compareWithoutPointer(lhs, rhs);
+        if (cmp != 0) return cmp;
+        if (lhs.ptr > rhs.ptr) return 1;
+        else if (lhs.ptr < rhs.ptr) return -1;
+        else return 0;
+    }
+
+    int compareWithoutPointer(const PtrKey &lhs, const PtrKey &rhs) const {
+        if (lhs.key > rhs.key) return 1;
+        else if (lhs.key < rhs.key) return -1;
+        else return 0;
+    }
+};
+
+typedef CompactingBTree<NormalKeyValuePair<int, int>, IntComparator, true> IntTree;
+typedef CompactingBTree<NormalKeyValuePair<PtrKey, int>, PtrKeyComparator, true> PtrTree;
+
+class CompactingBTreeTest : public Test {
+public:
+    CompactingBTreeTest() {
+    }
+
+    ~CompactingBTreeTest() {
+    }
+};
+
+TEST_F(CompactingBTreeTest, Trivial) {
+    IntTree m(true, IntComparator());
+    ASSERT_TRUE(m.verify());
+    ASSERT_TRUE(m.begin().isEnd());
+    ASSERT_TRUE(m.rbegin().isEnd());
+    ASSERT_TRUE(m.lowerBound(1).isEnd());
+
+    ASSERT_TRUE(m.insert(std::pair<int,int>(2,20)));
+    ASSERT_TRUE(m.insert(std::pair<int,int>(1,10)));
+    ASSERT_TRUE(m.insert(std::pair<int,int>(3,30)));
+    const int *conflict = m.insert(2, 21);
+    ASSERT_TRUE(conflict != NULL);
+    ASSERT_EQ(20, *conflict);
+    ASSERT_EQ(3, m.size());
+    ASSERT_TRUE(m.verify());
+    ASSERT_TRUE(m.verifyRank());
+
+    IntTree::iterator iter = m.begin();
+    for (int i = 1; i <= 3; i++, iter.moveNext()) {
+        ASSERT_EQ(i, iter.key());
+        ASSERT_EQ(i * 10, iter.value());
+    }
+    ASSERT_TRUE(iter.isEnd());
+    ASSERT_EQ(3, m.rbegin().key());
+
+    // Duplicates in a non-unique tree keep their insertion order.
+    IntTree m2(false, IntComparator());
+    for (int i = 0; i < 500; i++) {
+        ASSERT_TRUE(m2.insert(std::pair<int,int>(i % 2, i)));
+    }
+    ASSERT_TRUE(m2.verify());
+    ASSERT_TRUE(m2.verifyRank());
+    iter = m2.find(1);
+    for (int i = 1; i < 500; i += 2, iter.moveNext()) {
+        ASSERT_EQ(1, iter.key());
+        ASSERT_EQ(i, iter.value());
+    }
+    ASSERT_TRUE(iter.isEnd());
+    ASSERT_EQ(1, m2.rankLower(0));
+    ASSERT_EQ(250, m2.rankUpper(0));
+    ASSERT_EQ(251, m2.rankLower(1));
+    ASSERT_EQ(500, m2.rankUpper(1));
+    ASSERT_EQ(-1, m2.rankLower(2));
+}
+
+TEST_F(CompactingBTreeTest, RandomUnique) {
+    const int ITERATIONS = 200000;
+    const int BIGGEST_VAL = 20000;
+
+    std::map<int,int> stl;
+    IntTree volt(true, IntComparator());
+
+    srand(0);
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        if ((i % 10000) == 0) {
+            ASSERT_TRUE(volt.verify());
+            ASSERT_EQ((int64_t)stl.size(), volt.size());
+        }
+        if ((i % 50000) == 0) {
+            ASSERT_TRUE(volt.verifyRank());
+        }
+
+        // Lean towards inserts for the first half and erases for the second
+        // so the tree grows a few levels and then shrinks back.
+        bool insert = (rand() % 100) < ((i < ITERATIONS / 2) ? 70 : 30);
+        int val = rand() % BIGGEST_VAL;
+        std::map<int,int>::iterator stli = stl.find(val);
+        IntTree::iterator volti = volt.find(val);
+        ASSERT_EQ(stli == stl.end(), volti.isEnd());
+
+        if (insert) {
+            bool success = volt.insert(std::pair<int,int>(val, i));
+            ASSERT_EQ(stli == stl.end(), success);
+            if (success) {
+                stl.insert(std::pair<int,int>(val, i));
+            }
+        }
+        else if (stli == stl.end()) {
+            ASSERT_FALSE(volt.erase(val));
+        }
+        else {
+            ASSERT_EQ(stli->second, volti.value());
+            // alternate between the two ways to erase
+            if (i % 2) {
+                ASSERT_TRUE(volt.erase(val));
+            }
+            else {
+                ASSERT_TRUE(volt.erase(volti));
+            }
+            stl.erase(stli);
+        }
+
+        // Bounds for a random probe
+        val = rand() % BIGGEST_VAL;
+        stli = stl.lower_bound(val);
+        volti = volt.lowerBound(val);
+        ASSERT_EQ(stli == stl.end(), volti.isEnd());
+        if (stli != stl.end()) {
+            ASSERT_EQ(stli->first, volti.key());
+        }
+        stli = stl.upper_bound(val);
+        volti = volt.upperBound(val);
+        ASSERT_EQ(stli == stl.end(), volti.isEnd());
+        if (stli != stl.end()) {
+            ASSERT_EQ(stli->first, volti.key());
+        }
+    }
+
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(volt.verifyRank());
+
+    // Walk both ways
+    std::map<int,int>::iterator stli = stl.begin();
+    IntTree::iterator volti = volt.begin();
+    for (; stli != stl.end(); stli++, volti.moveNext()) {
+        ASSERT_EQ(stli->first, volti.key());
+    }
+    ASSERT_TRUE(volti.isEnd());
+    std::map<int,int>::reverse_iterator rstli = stl.rbegin();
+    volti = volt.rbegin();
+    for (; rstli != stl.rend(); rstli++, volti.movePrev()) {
+        ASSERT_EQ(rstli->first, volti.key());
+    }
+    ASSERT_TRUE(volti.isEnd());
+}
+
+TEST_F(CompactingBTreeTest, RandomMulti) {
+    const int ITERATIONS = 100000;
+    const int BIGGEST_VAL = 300;
+
+    std::set<std::pair<int,int> > stl;
+    PtrTree volt(false, PtrKeyComparator());
+
+    srand(1);
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        if ((i % 10000) == 0) {
+            ASSERT_TRUE(volt.verify());
+            ASSERT_TRUE(volt.verifyRank());
+            ASSERT_EQ((int64_t)stl.size(), volt.size());
+        }
+
+        int val = rand() % BIGGEST_VAL;
+        if ((rand() % 100) < ((i < ITERATIONS / 2) ? 70 : 30)) {
+            ASSERT_TRUE(volt.insert(std::pair<PtrKey,int>(PtrKey(val, i), i)));
+            stl.insert(std::pair<int,int>(val, i));
+            continue;
+        }
+
+        // Erase the first entry for val, if any.
+        std::set<std::pair<int,int> >::iterator stli = stl.lower_bound(std::pair<int,int>(val, INT_MIN));
+        PtrTree::iterator volti = volt.lowerBound(PtrKey(val, INT_MIN));
+        ASSERT_EQ(stli == stl.end(), volti.isEnd());
+        if (stli == stl.end()) {
+            continue;
+        }
+        ASSERT_EQ(stli->first, volti.key().key);
+        ASSERT_EQ(stli->second, volti.key().ptr);
+        if (stli->first != val) {
+            continue;
+        }
+
+        // Everything with this key lies in [lowerBound, upperBound).
+        PtrTree::iterator end = volt.upperBound(PtrKey(val, 0));
+        int matches = 0;
+        for (PtrTree::iterator it = volti; !it.equals(end); it.moveNext()) {
+            ASSERT_EQ(val, it.key().key);
+            matches++;
+        }
+        ASSERT_TRUE(matches > 0);
+        ASSERT_EQ(volt.rankLower(volti.key()) + matches - 1, volt.rankUpper(volti.key()));
+
+        ASSERT_TRUE(volt.erase(volti));
+        stl.erase(stli);
+    }
+
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(volt.verifyRank());
+    std::set<std::pair<int,int> >::iterator stli = stl.begin();
+    PtrTree::iterator volti = volt.begin();
+    for (int64_t rank = 1; stli != stl.end(); stli++, volti.moveNext(), rank++) {
+        ASSERT_EQ(stli->first, volti.key().key);
+        ASSERT_EQ(stli->second, volti.key().ptr);
+        ASSERT_TRUE(volt.findRank(rank).equals(volti));
+    }
+    ASSERT_TRUE(volti.isEnd());
+}
+
+TEST_F(CompactingBTreeTest, Compaction) {
+    const int COUNT = 100000;
+    IntTree volt(true, IntComparator());
+
+    for (int i = 0; i < COUNT; i++) {
+        ASSERT_TRUE(volt.insert(std::pair<int,int>(i, i)));
+    }
+    ASSERT_TRUE(volt.verify());
+    size_t full = volt.bytesAllocated();
+
+    // Keep a handful of keys from the middle; nodes freed along the way
+    // are back-filled so the allocation shrinks with the data.
+    for (int i = 0; i < COUNT; i++) {
+        if (i < COUNT / 2 || i >= COUNT / 2 + 100) {
+            ASSERT_TRUE(volt.erase(i));
+        }
+    }
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(volt.verifyRank());
+    ASSERT_EQ(100, volt.size());
+    ASSERT_TRUE(volt.bytesAllocated() < full / 2);
+    ASSERT_EQ(COUNT / 2, volt.begin().key());
+    ASSERT_EQ(COUNT / 2 + 99, volt.rbegin().key());
+
+    for (int i = COUNT / 2; i < COUNT / 2 + 100; i++) {
+        ASSERT_TRUE(volt.erase(i));
+    }
+    ASSERT_EQ(0, volt.size());
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(volt.begin().isEnd());
+
+    ASSERT_TRUE(volt.insert(std::pair<int,int>(7, 7)));
+    ASSERT_TRUE(volt.verify());
+    ASSERT_EQ(7, volt.begin().key());
+}
+
+TEST_F(CompactingBTreeTest, SortedBatchErase) {
+    const int COUNT = 20000;
+    IntTree volt(true, IntComparator());
+    std::set<int> stl;
+
+    srand(0);
+    std::vector<int> order;
+    for (int i = 0; i < COUNT; i++) {
+        order.push_back(i);
+    }
+    for (int i = COUNT - 1; i > 0; i--) {
+        std::swap(order[i], order[rand() % (i + 1)]);
+    }
+    for (int i = 0; i < COUNT; i++) {
+        ASSERT_TRUE(volt.insert(std::pair<int,int>(order[i], order[i])));
+        stl.insert(order[i]);
+    }
+
+    // Erase runs of neighbours and scattered keys, ascending, each found
+    // from the entry the previous erase left the cursor on.
+    IntTree::iterator cursor;
+    for (int i = 0; i < COUNT; i++) {
+        if (rand() % 3 == 0) {
+            continue;
+        }
+        IntTree::iterator iter = volt.findFrom(cursor, i);
+        ASSERT_FALSE(iter.isEnd());
+        ASSERT_EQ(i, iter.key());
+        volt.eraseAndMoveNext(iter);
+        stl.erase(i);
+        std::set<int>::const_iterator next = stl.upper_bound(i);
+        if (next == stl.end()) {
+            ASSERT_TRUE(iter.isEnd());
+        }
+        else {
+            ASSERT_FALSE(iter.isEnd());
+            ASSERT_EQ(*next, iter.key());
+        }
+        cursor = iter;
+    }
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(volt.verifyRank());
+    ASSERT_EQ(static_cast<int64_t>(stl.size()), volt.size());
+    IntTree::iterator iter = volt.begin();
+    for (std::set<int>::const_iterator stli = stl.begin(); stli != stl.end(); ++stli) {
+        ASSERT_EQ(*stli, iter.key());
+        iter.moveNext();
+    }
+    ASSERT_TRUE(iter.isEnd());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
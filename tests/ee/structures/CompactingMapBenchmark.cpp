@@ -32,6 +32,7 @@
 
 #include "harness.h"
 #include "structures/CompactingMap.h"
+#include "structures/CompactingBTree.h"
 #include "structures/CompactingHashTable.h"
 
 using namespace voltdb;
@@ -63,6 +64,7 @@ int64_t getMicrosNow () {
 #define PRINT_FREQUENCY 100
 #define WARM_UP 50
 #define MAXSCALE 10000000
+#define RANGE_SCAN_LENGTH 100
 
 int VEC[MAXSCALE] = {};
 
@@ -79,6 +81,7 @@ int* getRandomValues(int size, int max) {
 #define VoltHash 2
 #define STLMap 3
 #define BoostUnorderedMap 4
+#define VoltBTree 5
 std::string mapCategoryToString(int mapCategory) {
     switch(mapCategory) {
     case VoltMap:
@@ -89,6 +92,8 @@ std::string mapCategoryToString(int mapCategory) {
         return "STLMap";
     case BoostUnorderedMap:
         return "BoostUnorderedMap";
+    case VoltBTree:
+        return "VoltBTree";
     default:
         return "invalid";
     }
@@ -135,7 +140,8 @@ private:
 
 void resultPrinter(std::string name, int scale,
         BenchmarkRecorder benVoltMap, BenchmarkRecorder benStl,
-        BenchmarkRecorder benBoost, BenchmarkRecorder benVoltHash) {
+        BenchmarkRecorder benBoost, BenchmarkRecorder benVoltHash,
+        BenchmarkRecorder benVoltBTree) {
     std::cout << "Benchmark: " << name << ", scale size " << scale << "\n";
 
     std::vector<BenchmarkRecorder> result;
@@ -143,6 +149,7 @@ void resultPrinter(std::string name, int scale,
     result.push_back(benStl);
     result.push_back(benBoost);
     result.push_back(benVoltHash);
+    result.push_back(benVoltBTree);
 
     for (int i = 0; i < result.size(); i++) {
         BenchmarkRecorder ben = result[i];
@@ -168,7 +175,10 @@ void BenchmarkRun(
         bool runVoltMap,
         bool runStlMap,
         bool runBoostMap,
-        bool runVoltHash) {
+        bool runVoltHash,
+        bool runRangeScan,
+        bool runVoltBTree,
+        bool runSortedDelete) {
     int BIGGEST_VAL = DATA_SCALE;
     int ITERATIONS = DATA_SCALE / 10; // for 10% LOOK UP and DELETE
 
@@ -185,6 +195,9 @@ void BenchmarkRun(
             "runStlMap = %s\n"
             "runBoostMap = %s\n"
             "runVoltHash = %s\n"
+            "runRangeScan = %s\n"
+            "runVoltBTree = %s\n"
+            "runSortedDelete = %s\n"
             "=============\n",
             DATA_SCALE,
             SLEEP_IN_SECONDS,
@@ -196,7 +209,10 @@ void BenchmarkRun(
             interpret(runVoltMap),
             interpret(runStlMap),
             interpret(runBoostMap),
-            interpret(runVoltHash)
+            interpret(runVoltHash),
+            interpret(runRangeScan),
+            interpret(runVoltBTree),
+            interpret(runSortedDelete)
     );
 
     string str;
@@ -209,12 +225,14 @@ void BenchmarkRun(
 
     boost::unordered_multimap<int, int> boostMap;
     voltdb::CompactingHashTable<int,int> voltHash(false);
+    voltdb::CompactingBTree<NormalKeyValuePair<int, int>, IntComparator, false> voltBTree(false, IntComparator());
 
     // Iterators
     voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator, false>::iterator iter_volt_map;
     std::multimap<int, int>::const_iterator iter_stl;
     boost::unordered_multimap<int,int>::iterator iter_boost_map;
     voltdb::CompactingHashTable<int,int>::iterator iter_volt_hash;
+    voltdb::CompactingBTree<NormalKeyValuePair<int, int>, IntComparator, false>::iterator iter_volt_btree;
 
     //
     // INSERT the data
@@ -224,6 +242,7 @@ void BenchmarkRun(
 
     {
         BenchmarkRecorder benVoltMap(VoltMap), benStl(STLMap), benBoost(BoostUnorderedMap), benVoltHash(VoltHash);
+        BenchmarkRecorder benVoltBTree(VoltBTree);
         if (runVoltMap) {
             benVoltMap.start();
             for (int i = 0; i < DATA_SCALE; i++) {
@@ -260,7 +279,16 @@ void BenchmarkRun(
             benVoltHash.stop();
         }
 
-        resultPrinter("INSERT", DATA_SCALE, benVoltMap, benStl, benBoost, benVoltHash);
+        if (runVoltBTree) {
+            benVoltBTree.start();
+            for (int i = 0; i < DATA_SCALE; i++) {
+                int val = input[i];
+                voltBTree.insert(std::pair<int,int>(val, val));
+            }
+            benVoltBTree.stop();
+        }
+
+        resultPrinter("INSERT", DATA_SCALE, benVoltMap, benStl, benBoost, benVoltHash, benVoltBTree);
     }
 
     //
@@ -268,6 +296,7 @@ void BenchmarkRun(
     //
     if (runScan) {
         BenchmarkRecorder benVoltMap(VoltMap), benStl(STLMap), benBoost(BoostUnorderedMap), benVoltHash(VoltHash);
+        BenchmarkRecorder benVoltBTree(VoltBTree);
 
         printf("Preparing to run SCAN benchmark in %d seconds...\n", SLEEP_IN_SECONDS);
         sleep(SLEEP_IN_SECONDS);
@@ -280,6 +309,7 @@ void BenchmarkRun(
             if (i == WARM_UP) {
                 benVoltMap.reset();
                 benStl.reset();
+                benVoltBTree.reset();
                 printf("Finish warm up...\n");
             }
 
@@ -300,8 +330,17 @@ void BenchmarkRun(
                 }
                 benStl.stop();
             }
+
+            if (runVoltBTree) {
+                iter_volt_btree = voltBTree.begin();
+                benVoltBTree.start();
+                while(! iter_volt_btree.isEnd()) {
+                    iter_volt_btree.moveNext();
+                }
+                benVoltBTree.stop();
+            }
         }
-        resultPrinter("SCAN", DATA_SCALE, benVoltMap, benStl, benBoost, benVoltHash);
+        resultPrinter("SCAN", DATA_SCALE, benVoltMap, benStl, benBoost, benVoltHash, benVoltBTree);
     }
 
     //
@@ -309,6 +348,7 @@ void BenchmarkRun(
     //
     if (runScanNoEndCheck) {
         BenchmarkRecorder benVoltMap(VoltMap), benStl(STLMap), benBoost(BoostUnorderedMap), benVoltHash(VoltHash);
+        BenchmarkRecorder benVoltBTree(VoltBTree);
         printf("Preparing to run Scan benchmark without END() function call in %d seconds...\n", SLEEP_IN_SECONDS);
         sleep(SLEEP_IN_SECONDS);
 
@@ -317,6 +357,7 @@ void BenchmarkRun(
             if (i == WARM_UP) {
                 benVoltMap.reset();
                 benStl.reset();
+                benVoltBTree.reset();
                 printf("Finish warm up...\n");
             }
 
@@ -338,8 +379,17 @@ void BenchmarkRun(
                 }
                 benStl.stop();
             }
+
+            if (runVoltBTree) {
+                iter_volt_btree = voltBTree.begin();
+                benVoltBTree.start();
+                for (int i = 0; i < DATA_SCALE; i++) {
+                    iter_volt_btree.moveNext();
+                }
+                benVoltBTree.stop();
+            }
         }
-        resultPrinter("SCAN without END() factor", DATA_SCALE, benVoltMap, benStl, benBoost, benVoltHash);
+        resultPrinter("SCAN without END() factor", DATA_SCALE, benVoltMap, benStl, benBoost, benVoltHash, benVoltBTree);
     }
 
 
@@ -348,6 +398,7 @@ void BenchmarkRun(
     //
     if (runLookup) {
         BenchmarkRecorder benVoltMap(VoltMap), benStl(STLMap), benBoost(BoostUnorderedMap), benVoltHash(VoltHash);
+        BenchmarkRecorder benVoltBTree(VoltBTree);
         int* keys = getRandomValues(ITERATIONS, BIGGEST_VAL);
 
         printf("Preparing to run LOOKUP benchmark in %d seconds...\n", SLEEP_IN_SECONDS);
@@ -360,6 +411,7 @@ void BenchmarkRun(
                 benStl.reset();
                 benBoost.reset();
                 benVoltHash.reset();
+                benVoltBTree.reset();
                 printf("Finish warm up...\n");
             }
 
@@ -381,6 +433,15 @@ void BenchmarkRun(
                 benStl.stop();
             }
 
+            if (runVoltBTree) {
+                benVoltBTree.start();
+                for (int i = 0; i< ITERATIONS; i++) {
+                    int val = keys[i];
+                    iter_volt_btree = voltBTree.find(val);
+                }
+                benVoltBTree.stop();
+            }
+
             if (runBoostMap) {
                 benBoost.start();
                 for (int i = 0; i < DATA_SCALE; i++) {
@@ -399,7 +460,63 @@ void BenchmarkRun(
                 benVoltHash.stop();
             }
         }
-        resultPrinter("LOOKUP", ITERATIONS, benVoltMap, benStl, benBoost, benVoltHash);
+        resultPrinter("LOOKUP", ITERATIONS, benVoltMap, benStl, benBoost, benVoltHash, benVoltBTree);
+    }
+
+    //
+    // RANGE SCAN: position on a random key, then walk a short run of entries
+    //
+    if (runRangeScan) {
+        BenchmarkRecorder benVoltMap(VoltMap), benStl(STLMap), benBoost(BoostUnorderedMap), benVoltHash(VoltHash);
+        BenchmarkRecorder benVoltBTree(VoltBTree);
+        int* keys = getRandomValues(ITERATIONS, BIGGEST_VAL);
+
+        printf("Preparing to run RANGE SCAN benchmark in %d seconds...\n", SLEEP_IN_SECONDS);
+        sleep(SLEEP_IN_SECONDS);
+
+        for (int i = 0; i < READ_OPS_REPEAT; i++) {
+            // clean up
+            if (i == WARM_UP) {
+                benVoltMap.reset();
+                benStl.reset();
+                benVoltBTree.reset();
+                printf("Finish warm up...\n");
+            }
+
+            if (runVoltMap) {
+                benVoltMap.start();
+                for (int i = 0; i< ITERATIONS; i++) {
+                    iter_volt_map = voltMap.lowerBound(keys[i]);
+                    for (int j = 0; j < RANGE_SCAN_LENGTH && ! iter_volt_map.isEnd(); j++) {
+                        iter_volt_map.moveNext();
+                    }
+                }
+                benVoltMap.stop();
+            }
+
+            if (runStlMap) {
+                benStl.start();
+                for (int i = 0; i< ITERATIONS; i++) {
+                    iter_stl = stlMap.lower_bound(keys[i]);
+                    for (int j = 0; j < RANGE_SCAN_LENGTH && iter_stl != stlMap.end(); j++) {
+                        iter_stl++;
+                    }
+                }
+                benStl.stop();
+            }
+
+            if (runVoltBTree) {
+                benVoltBTree.start();
+                for (int i = 0; i< ITERATIONS; i++) {
+                    iter_volt_btree = voltBTree.lowerBound(keys[i]);
+                    for (int j = 0; j < RANGE_SCAN_LENGTH && ! iter_volt_btree.isEnd(); j++) {
+                        iter_volt_btree.moveNext();
+                    }
+                }
+                benVoltBTree.stop();
+            }
+        }
+        resultPrinter("RANGE SCAN", ITERATIONS, benVoltMap, benStl, benBoost, benVoltHash, benVoltBTree);
     }
 
     //
@@ -407,6 +524,7 @@ void BenchmarkRun(
     //
     if (runDelete) {
         BenchmarkRecorder benVoltMap(VoltMap), benStl(STLMap), benBoost(BoostUnorderedMap), benVoltHash(VoltHash);
+        BenchmarkRecorder benVoltBTree(VoltBTree);
         int* deletes = getRandomValues(ITERATIONS, BIGGEST_VAL);
         printf("Preparing to run DELETE benchmark in %d seconds...\n", SLEEP_IN_SECONDS);
         sleep(SLEEP_IN_SECONDS);
@@ -447,7 +565,91 @@ void BenchmarkRun(
             benVoltHash.stop();
         }
 
-        resultPrinter("DELETE", ITERATIONS, benVoltMap, benStl, benBoost, benVoltHash);
+        if (runVoltBTree) {
+            benVoltBTree.start();
+            for (int i = 0; i< ITERATIONS; i++) {
+                int val = deletes[i];
+                voltBTree.erase(val);
+            }
+            benVoltBTree.stop();
+        }
+
+        resultPrinter("DELETE", ITERATIONS, benVoltMap, benStl, benBoost, benVoltHash, benVoltBTree);
+    }
+
+    //
+    // SORTED DELETE: half of the keys of a unique map, erased in ascending
+    // order one lookup at a time, then by walking a cursor forward.
+    //
+    if (runSortedDelete) {
+        typedef voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator, false> UniqueVoltMap;
+        typedef voltdb::CompactingBTree<NormalKeyValuePair<int, int>, IntComparator, false> UniqueVoltBTree;
+        BenchmarkRecorder benVoltMap(VoltMap), benStl(STLMap), benBoost(BoostUnorderedMap), benVoltHash(VoltHash);
+        BenchmarkRecorder benVoltBTree(VoltBTree);
+        BenchmarkRecorder benVoltMapCursor(VoltMap), benVoltBTreeCursor(VoltBTree);
+
+        std::vector<int> order(DATA_SCALE);
+        for (int i = 0; i < DATA_SCALE; i++) {
+            order[i] = i;
+        }
+        std::random_shuffle(order.begin(), order.end());
+        std::vector<int> batch;
+        for (int i = 0; i < DATA_SCALE; i++) {
+            if (rand() % 2 == 0) {
+                batch.push_back(i);
+            }
+        }
+        printf("Preparing to run SORTED DELETE benchmark in %d seconds...\n", SLEEP_IN_SECONDS);
+        sleep(SLEEP_IN_SECONDS);
+
+        if (runVoltMap) {
+            UniqueVoltMap byKey(true, IntComparator()), byCursor(true, IntComparator());
+            for (int i = 0; i < DATA_SCALE; i++) {
+                byKey.insert(std::pair<int,int>(order[i], order[i]));
+                byCursor.insert(std::pair<int,int>(order[i], order[i]));
+            }
+            benVoltMap.start();
+            for (int i = 0; i < batch.size(); i++) {
+                byKey.erase(batch[i]);
+            }
+            benVoltMap.stop();
+
+            benVoltMapCursor.start();
+            UniqueVoltMap::iterator cursor;
+            for (int i = 0; i < batch.size(); i++) {
+                UniqueVoltMap::iterator iter = byCursor.findFrom(cursor, batch[i]);
+                byCursor.eraseAndMoveNext(iter);
+                cursor = iter;
+            }
+            benVoltMapCursor.stop();
+        }
+
+        if (runVoltBTree) {
+            UniqueVoltBTree byKey(true, IntComparator()), byCursor(true, IntComparator());
+            for (int i = 0; i < DATA_SCALE; i++) {
+                byKey.insert(std::pair<int,int>(order[i], order[i]));
+                byCursor.insert(std::pair<int,int>(order[i], order[i]));
+            }
+            benVoltBTree.start();
+            for (int i = 0; i < batch.size(); i++) {
+                byKey.erase(batch[i]);
+            }
+            benVoltBTree.stop();
+
+            benVoltBTreeCursor.start();
+            UniqueVoltBTree::iterator cursor;
+            for (int i = 0; i < batch.size(); i++) {
+                UniqueVoltBTree::iterator iter = byCursor.findFrom(cursor, batch[i]);
+                byCursor.eraseAndMoveNext(iter);
+                cursor = iter;
+            }
+            benVoltBTreeCursor.stop();
+        }
+
+        resultPrinter("SORTED DELETE BY KEY", static_cast<int>(batch.size()),
+                      benVoltMap, benStl, benBoost, benVoltHash, benVoltBTree);
+        resultPrinter("SORTED DELETE BY CURSOR", static_cast<int>(batch.size()),
+                      benVoltMapCursor, benStl, benBoost, benVoltHash, benVoltBTreeCursor);
     }
 
     // still holds the data before the destructor gets called
@@ -474,9 +676,15 @@ void BenchmarkRunWrapper(int DATA_SCALE, int SLEEP_IN_SECONDS, int READON_OPS_RE
     if (len > ++i) runBoostMap = params.at(i);
     if (len > ++i) runVoltHash = params.at(i);
 
+    bool runRangeScan=false, runVoltBTree=false, runSortedDelete=false;
+    if (len > ++i) runRangeScan = params.at(i);
+    if (len > ++i) runVoltBTree = params.at(i);
+    if (len > ++i) runSortedDelete = params.at(i);
+
     BenchmarkRun(DATA_SCALE, SLEEP_IN_SECONDS, READON_OPS_REPEAT,
             runScan, runScanNoEndCheck, runLookup, runDelete,
-            runVoltMap, runStlMap, runBoostMap, runVoltHash);
+            runVoltMap, runStlMap, runBoostMap, runVoltHash,
+            runRangeScan, runVoltBTree, runSortedDelete);
 }
 
 bool isTrue(char* arg) {
@@ -505,7 +713,10 @@ int main(int argc, char *argv[]) {
                 "runVoltMap<0, 1>, "
                 "runStlMap<0, 1>, "
                 "runBoostMap<0, 1>, "
-                "runVoltHash<0, 1>)\n",
+                "runVoltHash<0, 1>, "
+                "runRangeScan<0, 1>, "
+                "runVoltBTree<0, 1>, "
+                "runSortedDelete<0, 1>)\n",
                 argv[0]);
         return 0;
     }
@@ -272,6 +272,40 @@ TEST_F(CompactingMapTest, RandomUniqueRank) {
     ASSERT_TRUE(volt.verifyRank());
 }
 
+TEST_F(CompactingMapTest, BuildFromSorted) {
+    for (int size = 0; size < 300; size++) {
+        std::vector<std::pair<int, int> > entries;
+        for (int i = 0; i < size; i++) {
+            entries.push_back(std::pair<int, int>(i * 2, i));
+        }
+
+        voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator, true> volt(true, IntComparator());
+        volt.buildFromSorted(entries.begin(), size);
+        ASSERT_EQ(size, volt.size());
+        ASSERT_TRUE(volt.verify());
+        ASSERT_TRUE(volt.verifyRank());
+
+        voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator, true>::iterator iter = volt.begin();
+        for (int i = 0; i < size; i++) {
+            ASSERT_FALSE(iter.isEnd());
+            ASSERT_EQ(i * 2, iter.key());
+            ASSERT_EQ(i, iter.value());
+            ASSERT_EQ(i + 1, volt.rankLower(i * 2));
+            iter.moveNext();
+        }
+
+        // The tree stays balanced through later inserts and deletes.
+        for (int i = 0; i < size; i++) {
+            ASSERT_TRUE(volt.insert(std::pair<int, int>(i * 2 + 1, i)));
+            if (i % 3 == 0) {
+                ASSERT_TRUE(volt.erase(i * 2));
+            }
+        }
+        ASSERT_TRUE(volt.verify());
+        ASSERT_TRUE(volt.verifyRank());
+    }
+}
+
 TEST_F(CompactingMapTest, SimpleMultiRank) {
     // Start the counting index feature
     voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator, true> volt(false, IntComparator());
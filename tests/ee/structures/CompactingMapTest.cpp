@@ -23,6 +23,8 @@
 
 #include <iostream>
 #include <map>
+#include <set>
+#include <vector>
 #include <algorithm>
 #include <cstdlib>
 #include <cstdio>
@@ -780,6 +782,56 @@ TEST_F(CompactingMapTest, RandomMulti) {
 // covers this since the defect is actually in ContiguousAllocator.
 // --izzy 3/22/2011
 //
+TEST_F(CompactingMapTest, SortedBatchErase) {
+    const int COUNT = 20000;
+    voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator> volt(true, IntComparator());
+    std::set<int> stl;
+
+    srand(0);
+    std::vector<int> order;
+    for (int i = 0; i < COUNT; i++) {
+        order.push_back(i);
+    }
+    for (int i = COUNT - 1; i > 0; i--) {
+        std::swap(order[i], order[rand() % (i + 1)]);
+    }
+    for (int i = 0; i < COUNT; i++) {
+        ASSERT_TRUE(volt.insert(std::pair<int,int>(order[i], order[i])));
+        stl.insert(order[i]);
+    }
+
+    // Erase runs of neighbours and scattered keys, ascending, each found
+    // from the entry the previous erase left the cursor on.
+    voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator>::iterator cursor;
+    for (int i = 0; i < COUNT; i++) {
+        if (rand() % 3 == 0) {
+            continue;
+        }
+        voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator>::iterator iter = volt.findFrom(cursor, i);
+        ASSERT_FALSE(iter.isEnd());
+        ASSERT_EQ(i, iter.key());
+        volt.eraseAndMoveNext(iter);
+        stl.erase(i);
+        std::set<int>::const_iterator next = stl.upper_bound(i);
+        if (next == stl.end()) {
+            ASSERT_TRUE(iter.isEnd());
+        }
+        else {
+            ASSERT_FALSE(iter.isEnd());
+            ASSERT_EQ(*next, iter.key());
+        }
+        cursor = iter;
+    }
+    ASSERT_TRUE(volt.verify());
+    ASSERT_EQ(static_cast<int64_t>(stl.size()), volt.size());
+    voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator>::iterator iter = volt.begin();
+    for (std::set<int>::const_iterator stli = stl.begin(); stli != stl.end(); ++stli) {
+        ASSERT_EQ(*stli, iter.key());
+        iter.moveNext();
+    }
+    ASSERT_TRUE(iter.isEnd());
+}
+
 // TEST_F(CompactingMapTest, bytesAllocated) {
 //     voltdb::CompactingMap<NormalKeyValuePair<int, int>, IntComparator> volt(true, IntComparator());
 //
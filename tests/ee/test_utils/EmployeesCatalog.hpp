@@ -0,0 +1,192 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TESTS_EE_TEST_UTILS_EMPLOYEESCATALOG_HPP
+#define TESTS_EE_TEST_UTILS_EMPLOYEESCATALOG_HPP
+
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/optional.hpp>
+
+#include "test_utils/Tools.hpp"
+
+#include "common/tabletuple.h"
+#include "storage/table.h"
+
+// Catalog for the following DDL:
+//
+// CREATE TABLE EMPLOYEES (
+//     LAST_NAME VARCHAR(20) NOT NULL,
+//     EMP_ID INTEGER NOT NULL,
+//     MANAGER_ID INTEGER
+// );
+// PARTITION TABLE EMPLOYEES ON LAST_NAME;
+
+const std::string catalogPayload =
+    "add / clusters cluster\n"
+    "set /clusters#cluster localepoch 1199145600\n"
+    "set $PREV securityEnabled false\n"
+    "set $PREV httpdportno -1\n"
+    "set $PREV jsonapi true\n"
+    "set $PREV networkpartition false\n"
+    "set $PREV heartbeatTimeout 90\n"
+    "set $PREV useddlschema false\n"
+    "set $PREV drConsumerEnabled false\n"
+    "set $PREV drProducerEnabled true\n"
+    "set $PREV drRole \"master\"\n"
+    "set $PREV drClusterId 0\n"
+    "set $PREV drProducerPort 5555\n"
+    "set $PREV drMasterHost \"\"\n"
+    "set $PREV drFlushInterval 1000\n"
+    "set $PREV preferredSource 0\n"
+    "add /clusters#cluster databases database\n"
+    "set /clusters#cluster/databases#database schema \"qgRUNDM1MjQ1NDE1NDQ1MjA1NDQxNDI0QwEMWDQ1NEQ1MDRDNEY1OTQ1NDU1MzIwMjgyARIwMTUzNTQ1RjRFNDE0RAEsJDU2NDE1MjQzNDgBCDwyODMyMzAyOTIwNEU0RjU0AQgkNTU0QzRDMkMyMAlYEDVGNDk0ARoIOTRFAXwUNDc0NTUyASpKMgAIRDQxBWwFJF46ABAyOTNCCmrPAAA0AWEQNDk1NjQBcABGEYcENTAF/QA4/t0A/t0Adt0AUkkBCEM0NQXOIVWKRwEZ6kKvAQgxMzAJAlK1ARQwMjkzQgo=\"\n"
+    "set $PREV isActiveActiveDRed false\n"
+    "set $PREV securityprovider \"hash\"\n"
+    "add /clusters#cluster/databases#database groups administrator\n"
+    "set /clusters#cluster/databases#database/groups#administrator admin true\n"
+    "set $PREV defaultproc true\n"
+    "set $PREV defaultprocread true\n"
+    "set $PREV sql true\n"
+    "set $PREV sqlread true\n"
+    "set $PREV allproc true\n"
+    "add /clusters#cluster/databases#database groups user\n"
+    "set /clusters#cluster/databases#database/groups#user admin false\n"
+    "set $PREV defaultproc true\n"
+    "set $PREV defaultprocread true\n"
+    "set $PREV sql true\n"
+    "set $PREV sqlread true\n"
+    "set $PREV allproc true\n"
+    "add /clusters#cluster/databases#database tables EMPLOYEES\n"
+    "set /clusters#cluster/databases#database/tables#EMPLOYEES isreplicated false\n"
+    "set $PREV partitioncolumn /clusters#cluster/databases#database/tables#EMPLOYEES/columns#LAST_NAME\n"
+    "set $PREV estimatedtuplecount 0\n"
+    "set $PREV materializer null\n"
+    "set $PREV signature \"EMPLOYEES|vii\"\n"
+    "set $PREV tuplelimit 2147483647\n"
+    "set $PREV isDRed false\n"
+    "add /clusters#cluster/databases#database/tables#EMPLOYEES columns EMP_ID\n"
+    "set /clusters#cluster/databases#database/tables#EMPLOYEES/columns#EMP_ID index 1\n"
+    "set $PREV type 5\n"
+    "set $PREV size 4\n"
+    "set $PREV nullable false\n"
+    "set $PREV name \"EMP_ID\"\n"
+    "set $PREV defaultvalue null\n"
+    "set $PREV defaulttype 0\n"
+    "set $PREV aggregatetype 0\n"
+    "set $PREV matviewsource null\n"
+    "set $PREV matview null\n"
+    "set $PREV inbytes false\n"
+    "add /clusters#cluster/databases#database/tables#EMPLOYEES columns LAST_NAME\n"
+    "set /clusters#cluster/databases#database/tables#EMPLOYEES/columns#LAST_NAME index 0\n"
+    "set $PREV type 9\n"
+    "set $PREV size 20\n"
+    "set $PREV nullable false\n"
+    "set $PREV name \"LAST_NAME\"\n"
+    "set $PREV defaultvalue null\n"
+    "set $PREV defaulttype 0\n"
+    "set $PREV aggregatetype 0\n"
+    "set $PREV matviewsource null\n"
+    "set $PREV matview null\n"
+    "set $PREV inbytes false\n"
+    "add /clusters#cluster/databases#database/tables#EMPLOYEES columns MANAGER_ID\n"
+    "set /clusters#cluster/databases#database/tables#EMPLOYEES/columns#MANAGER_ID index 2\n"
+    "set $PREV type 5\n"
+    "set $PREV size 4\n"
+    "set $PREV nullable true\n"
+    "set $PREV name \"MANAGER_ID\"\n"
+    "set $PREV defaultvalue null\n"
+    "set $PREV defaulttype 0\n"
+    "set $PREV aggregatetype 0\n"
+    "set $PREV matviewsource null\n"
+    "set $PREV matview null\n"
+    "set $PREV inbytes false\n"
+    "add /clusters#cluster/databases#database snapshotSchedule default\n"
+    "set /clusters#cluster/databases#database/snapshotSchedule#default enabled false\n"
+    "set $PREV frequencyUnit \"h\"\n"
+    "set $PREV frequencyValue 24\n"
+    "set $PREV retain 2\n"
+    "set $PREV prefix \"AUTOSNAP\"\n"
+    "add /clusters#cluster deployment deployment\n"
+    "set /clusters#cluster/deployment#deployment kfactor 0\n"
+    "add /clusters#cluster/deployment#deployment systemsettings systemsettings\n"
+    "set /clusters#cluster/deployment#deployment/systemsettings#systemsettings temptablemaxsize 100\n"
+    "set $PREV snapshotpriority 6\n"
+    "set $PREV elasticduration 50\n"
+    "set $PREV elasticthroughput 2\n"
+    "set $PREV querytimeout 10000\n"
+    "add /clusters#cluster logconfig log\n"
+    "set /clusters#cluster/logconfig#log enabled false\n"
+    "set $PREV synchronous false\n"
+    "set $PREV fsyncInterval 200\n"
+    "set $PREV maxTxns 2147483647\n"
+    "set $PREV logSize 1024\n";
+
+// JSON for a tuple value expression that projects one column of a
+// table.  VALUE_TYPE 9 is VARCHAR, which every EMPLOYEES string column
+// declares as 20 bytes.
+inline std::string columnJson(const std::string& name, int valueType, int columnIdx, int tableIdx) {
+    std::ostringstream oss;
+    oss << "{\"COLUMN_NAME\":\"" << name << "\",\"EXPRESSION\":{\"TYPE\":32,"
+        << "\"VALUE_TYPE\":" << valueType << ",";
+    if (valueType == 9) {
+        oss << "\"VALUE_SIZE\":20,";
+    }
+    oss << "\"COLUMN_IDX\":" << columnIdx << ",\"TABLE_IDX\":" << tableIdx << "}}";
+    return oss.str();
+}
+
+// The three columns of EMPLOYEES, starting at firstIdx in the input tuple.
+inline std::string employeeColumnsJson(int firstIdx, int tableIdx) {
+    return columnJson("LAST_NAME", 9, firstIdx, tableIdx) + ","
+        + columnJson("EMP_ID", 5, firstIdx + 1, tableIdx) + ","
+        + columnJson("MANAGER_ID", 5, firstIdx + 2, tableIdx);
+}
+
+// A sequential scan of EMPLOYEES under the given alias, with an inline
+// projection of all of its columns.
+inline std::string seqScanJson(int id, const std::string& alias) {
+    std::ostringstream oss;
+    oss << "{\"ID\":" << id << ",\"PLAN_NODE_TYPE\":\"SEQSCAN\","
+        << "\"INLINE_NODES\":[{\"ID\":" << id + 10 << ",\"PLAN_NODE_TYPE\":\"PROJECTION\","
+        << "\"OUTPUT_SCHEMA\":[" << employeeColumnsJson(0, 0) << "]}],"
+        << "\"TARGET_TABLE_NAME\":\"EMPLOYEES\",\"TARGET_TABLE_ALIAS\":\"" << alias << "\"}";
+    return oss.str();
+}
+
+typedef std::tuple<std::string, int, boost::optional<int>> InRow;
+
+inline void insertEmployees(voltdb::Table* employeesTable, const std::vector<InRow>& rows) {
+    voltdb::StandAloneTupleStorage storage{employeesTable->schema()};
+    voltdb::TableTuple tupleToInsert = storage.tuple();
+    BOOST_FOREACH(auto initValues, rows) {
+        Tools::initTuple(&tupleToInsert, initValues);
+        employeesTable->insertTuple(tupleToInsert);
+    }
+}
+
+#endif // TESTS_EE_TEST_UTILS_EMPLOYEESCATALOG_HPP
@@ -24,8 +24,15 @@
 #ifndef LARGE_TEMP_TABLE_TOPEND_HPP
 #define LARGE_TEMP_TABLE_TOPEND_HPP
 
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
 
 #include "harness.h"
 
@@ -35,90 +42,134 @@
 
 #include "storage/LargeTempTableBlock.h"
 
-namespace voltdb {
-class TupleSchema;
-}
-
 /**
  * A topend that can be used in unit tests that test large queries.
  * This topend provides methods to store, load and release methods to
- * manipulate large temp tables blocks, which are managed in an
- * in-memory std::map that mocks the filesystem.
+ * manipulate large temp tables blocks.  Like the Java large block
+ * manager, it writes each stored block to its own file, prefixed with
+ * the block's original address, in a temporary directory that is
+ * removed when the topend is destroyed.
  */
 class LargeTempTableTopend : public voltdb::DummyTopend {
 private:
 
     class Block {
     public:
-        Block(char* data, int64_t activeTupleCount, const voltdb::TupleSchema *schema)
-            : m_origAddress(data)
-            , m_data(new char[voltdb::LargeTempTableBlock::BLOCK_SIZE_IN_BYTES])
+        Block(const std::string& path, int64_t activeTupleCount, int64_t storedSize)
+            : m_path(path)
             , m_activeTupleCount(activeTupleCount)
-            , m_schema(schema)
-        {
-            ::memcpy(m_data.get(), data, voltdb::LargeTempTableBlock::BLOCK_SIZE_IN_BYTES);
-        }
-
-        Block()
-            : m_origAddress(NULL)
-            , m_data()
-            , m_activeTupleCount(0)
-            , m_schema(NULL)
+            , m_storedSize(storedSize)
         {
         }
 
-        char* data() {
-            return m_data.get();
+        const std::string& path() const {
+            return m_path;
         }
 
-        char* origAddress() {
-            return m_origAddress;
+        int64_t activeTupleCount() const {
+            return m_activeTupleCount;
         }
 
-        int64_t activeTupleCount() {
-            return m_activeTupleCount;
+        int64_t storedSize() const {
+            return m_storedSize;
         }
 
         std::string debug() const {
             std::ostringstream oss;
-            voltdb::TableTuple tuple{m_data.get(), m_schema};
-            oss << "First tuple: " << tuple.debugSkipNonInlineData() << "\n";
+            oss << m_activeTupleCount << " tuples, " << m_storedSize << " bytes in " << m_path;
             return oss.str();
         }
 
     private:
-        char* m_origAddress;
-        std::unique_ptr<char[]> m_data;
+        std::string m_path;
         int64_t m_activeTupleCount;
-        const voltdb::TupleSchema* m_schema;
+        int64_t m_storedSize;
     };
 
 public:
 
+    /** If canPrefetch is true, the block cache may read stored
+        blocks on its prefetch thread. */
+    explicit LargeTempTableTopend(bool canPrefetch = false)
+        : m_canPrefetch(canPrefetch)
+        , m_storedBytes(0)
+        , m_numBlocksRead(0)
+    {
+        char dirTemplate[] = "/tmp/ltt-topend-XXXXXX";
+        char* dir = ::mkdtemp(dirTemplate);
+        assert(dir != NULL);
+        m_directory = dir;
+    }
+
     bool storeLargeTempTableBlock(voltdb::LargeTempTableBlock* block) {
+        std::lock_guard<std::mutex> guard(m_mutex);
         assert (m_map.count(block->id()) == 0);
 
+        int64_t storedSize = block->storedDataSize();
         std::unique_ptr<char[]> storage = block->releaseData();
-        Block *newBlock = new Block{storage.get(), block->activeTupleCount(), block->schema()};
-        m_map[block->id()] = newBlock;
+        char* origAddress = storage.get();
 
+        std::ostringstream path;
+        path << m_directory << "/" << block->id().getSiteId() << "-" << block->id().getBlockCounter();
+        FILE* file = ::fopen(path.str().c_str(), "wb");
+        if (file == NULL) {
+            return false;
+        }
+        bool success = ::fwrite(&origAddress, sizeof(origAddress), 1, file) == 1
+            && ::fwrite(storage.get(), 1, storedSize, file) == static_cast<size_t>(storedSize);
+        success = ::fclose(file) == 0 && success;
+        if (! success) {
+            return false;
+        }
+
+        m_map[block->id()] = new Block{path.str(), block->activeTupleCount(), storedSize};
+        m_storedBytes += storedSize;
         return true;
     }
 
     bool loadLargeTempTableBlock(voltdb::LargeTempTableBlock* block) {
-        auto it = m_map.find(block->id());
-        assert (it != m_map.end());
-        Block *storedBlock = it->second;
-
         std::unique_ptr<char[]> storage{new char[voltdb::LargeTempTableBlock::BLOCK_SIZE_IN_BYTES]};
-        ::memcpy(storage.get(), storedBlock->data(), voltdb::LargeTempTableBlock::BLOCK_SIZE_IN_BYTES);
-        block->setData(storedBlock->origAddress(), std::move(storage));
-        assert(block->activeTupleCount() == storedBlock->activeTupleCount());
+        char* origAddress = readLargeTempTableBlock(block->id(), storage.get());
+        if (origAddress == NULL) {
+            return false;
+        }
 
+        block->setData(origAddress, std::move(storage));
+        std::lock_guard<std::mutex> guard(m_mutex);
+        assert(block->activeTupleCount() == m_map.find(block->id())->second->activeTupleCount());
         return true;
     }
 
+    bool canPrefetchLargeTempTableBlocks() {
+        return m_canPrefetch;
+    }
+
+    char* readLargeTempTableBlock(voltdb::LargeTempTableBlockId blockId, char* storage) {
+        std::string path;
+        int64_t storedSize;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            auto it = m_map.find(blockId);
+            assert (it != m_map.end());
+            path = it->second->path();
+            storedSize = it->second->storedSize();
+            ++m_numBlocksRead;
+        }
+
+        FILE* file = ::fopen(path.c_str(), "rb");
+        if (file == NULL) {
+            return NULL;
+        }
+        char* origAddress = NULL;
+        bool success = ::fread(&origAddress, sizeof(origAddress), 1, file) == 1
+            && ::fread(storage, 1, storedSize, file) == static_cast<size_t>(storedSize);
+        ::fclose(file);
+
+        return success ? origAddress : NULL;
+    }
+
     bool releaseLargeTempTableBlock(voltdb::LargeTempTableBlockId blockId) {
+        std::lock_guard<std::mutex> guard(m_mutex);
         auto it = m_map.find(blockId);
         if (it == m_map.end()) {
             assert(false);
@@ -126,6 +177,7 @@ public:
         }
 
         Block* storedBlock = it->second;
+        ::unlink(storedBlock->path().c_str());
         m_map.erase(blockId);
         delete storedBlock;
 
@@ -133,11 +185,25 @@ public:
     }
 
     size_t storedBlockCount() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
         return m_map.size();
     }
 
+    /** The total number of block bytes written, including blocks
+        since released. */
+    int64_t storedBytes() const {
+        return m_storedBytes;
+    }
+
+    /** The number of stored blocks read back, on any thread. */
+    int64_t blocksRead() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_numBlocksRead;
+    }
+
     ~LargeTempTableTopend() {
         assert(m_map.size() == 0);
+        ::rmdir(m_directory.c_str());
     }
 
     std::string debug() const {
@@ -152,7 +218,13 @@ public:
 
 private:
 
+    const bool m_canPrefetch;
+    std::string m_directory;
+    // Held while touching the map, which the prefetch thread reads.
+    mutable std::mutex m_mutex;
     std::map<voltdb::LargeTempTableBlockId, Block*> m_map;
+    int64_t m_storedBytes;
+    int64_t m_numBlocksRead;
 };
 
 #endif // LARGE_TEMP_TABLE_TOPEND_HPP
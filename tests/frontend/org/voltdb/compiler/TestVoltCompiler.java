@@ -1303,6 +1303,41 @@ public class TestVoltCompiler extends TestCase {
         }
     }
 
+    public void testDDLCompilerBTreeIndexAllowed() {
+        for (int ii = 0; ii < column_types.length; ii++) {
+            String schema =
+                "create table t(id " + column_types[ii] + " not null, num integer not null);\n" +
+                "create index idx_t_id_btree on t(id);\n" +
+                "create index idx_t_idnum_btree on t(id,num);";
+            VoltCompiler c = compileSchemaForDDLTest(schema, can_be_tree[ii]);
+            assertFalse(c.hasErrors());
+            Table tbl = assertTableT(c);
+            for (String name : new String[] { "idx_t_id_btree", "idx_t_idnum_btree" }) {
+                Index index = tbl.getIndexes().getIgnoreCase(name);
+                assertEquals(IndexType.BTREE.getValue(), index.getType());
+                assertTrue(index.getCountable());
+                assertTrue(IndexType.isScannable(index.getType()));
+            }
+        }
+
+        // A named constraint can ask for one too.
+        String schema =
+            "create table t(id integer not null, num integer not null,\n" +
+            "               constraint pk_btree primary key (id));\n" +
+            "create index idx_t_num on t(num);";
+        VoltCompiler c = compileSchemaForDDLTest(schema, true);
+        assertFalse(c.hasErrors());
+        Table tbl = assertTableT(c);
+        for (Index index : tbl.getIndexes()) {
+            if (index.getUnique()) {
+                assertEquals(IndexType.BTREE.getValue(), index.getType());
+            }
+            else {
+                assertEquals(IndexType.BALANCED_TREE.getValue(), index.getType());
+            }
+        }
+    }
+
     public void testUniqueIndexAllowed() {
         String schema =
                 "create table t(id integer not null, num integer not null);\n" +
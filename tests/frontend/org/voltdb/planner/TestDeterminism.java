@@ -260,6 +260,11 @@ public class TestDeterminism extends PlannerTestCase {
         tryOrderBy = "order by b, c, a";
         assertPlanNeedsSaferDeterminismOrOrderCombo(sql, tryOrderBy, false);
 
+        // B+tree indexes are ordered too.
+        sql = "select * from tuniqbtree";
+        tryOrderBy = "order by b, c, a";
+        assertPlanNeedsSaferDeterminismOrOrderCombo(sql, tryOrderBy, false);
+
         sql = "select * from tpk";
         tryOrderBy = "order by a";
         assertPlanNeedsSaferDeterminismOrOrderCombo(sql, tryOrderBy, false);
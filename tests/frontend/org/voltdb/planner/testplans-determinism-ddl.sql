@@ -48,6 +48,15 @@ create table tuniqcombo (
 
 create unique index cover3_UNIQCOMBO on tuniqcombo (a, c, b);
 
+create table tuniqbtree (
+  a bigint not null,
+  b bigint not null,
+  c bigint not null,
+  z bigint not null
+);
+
+create unique index cover3_UNIQBTREE on tuniqbtree (a, c, b);
+
 create table tpk (
   a bigint not null primary key,
   b bigint not null,